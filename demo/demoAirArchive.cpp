@@ -0,0 +1,159 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+
+/*! \file
+ *
+ * \brief Convert University WY sounding pages into an indexed archive.
+ *
+ */
+
+
+#include "envAirArchive.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+	//! \brief Program demoAirArchive.cpp main application usage.
+	struct Usage
+	{
+		std::filesystem::path theSavePath;
+		std::vector<std::filesystem::path> theLoadPaths;
+
+		explicit
+		Usage
+			( int argc
+			, char * argv[]
+			)
+		{
+			if (2 < argc)
+			{
+				theSavePath = argv[1];
+				for (int narg{2} ; narg < argc ; ++narg)
+				{
+					theLoadPaths.emplace_back(argv[narg]);
+				}
+			}
+			else
+			{
+				std::cerr <<
+					"\nApplication reads Uni WY atmospheric sounding data"
+					"\npages (each file may contain many soundings) and"
+					"\nsaves all soundings into a single indexed binary"
+					"\narchive file. Archive contents are then reported"
+					"\nby reading them back via memory mapped access."
+					;
+				std::cerr << "\n";
+				std::cerr << "Usage: <progName> <archiveFile>"
+					" <UWyoDataPageFile> [<UWyoDataPageFile> ...]\n";
+				std::cerr << "\n";
+			}
+		}
+
+		//! True if all input paths exist
+		bool
+		isValid
+			() const
+		{
+			bool okay{ (! theSavePath.empty()) && (! theLoadPaths.empty()) };
+			for (std::filesystem::path const & loadPath : theLoadPaths)
+			{
+				okay &= std::filesystem::exists(loadPath);
+			}
+			return okay;
+		}
+
+	}; // Usage
+
+} // [anon]
+
+
+/* \brief Convert UWyo sounding text into AirArchive format.
+ *
+ * Usage:
+ * \arg First argument is the path to the archive to be (over)written.
+ * \arg Remaining arguments are paths to files with atmospheric sounding
+ * data (in "select-all/cut-n-paste" format from the University of
+ * Wyoming site: http://weather.uwyo.edu/upperair/sounding.html
+ */
+int
+main
+	( int argc
+	, char * argv[]
+	)
+{
+	Usage const use(argc, argv);
+	if (! use.isValid())
+	{
+		return 1;
+	}
+
+	using namespace aply::env;
+
+	// parse all text pages
+	std::vector<Sounding> soundings;
+	for (std::filesystem::path const & loadPath : use.theLoadPaths)
+	{
+		std::vector<Sounding> const pageSounds{ soundingsFromUWyo(loadPath) };
+		soundings.insert
+			(soundings.end(), pageSounds.cbegin(), pageSounds.cend());
+	}
+
+	// save archive
+	if (! saveAirArchive(use.theSavePath, soundings))
+	{
+		std::cerr << "Failed to write archive: " << use.theSavePath << '\n';
+		return 1;
+	}
+
+	// map archive and report contents
+	AirArchive const archive(use.theSavePath);
+	std::cout << archive.infoString("Archive: " + use.theSavePath.string());
+
+	// time the random access of each archived profile
+	using Clock = std::chrono::steady_clock;
+	for (std::size_t nn{0u} ; nn < archive.size() ; ++nn)
+	{
+		SoundingKey const key{ archive.entryAt(nn).key() };
+		Clock::time_point const t0{ Clock::now() };
+		AirProfile const profile{ archive.airProfileFor(key) };
+		Clock::time_point const t1{ Clock::now() };
+		double const usec
+			{ std::chrono::duration<double, std::micro>(t1 - t0).count() };
+		std::cout
+			<< "  load: " << key.infoBrief()
+			<< "  IoR(1500m): "
+			<< engabra::g3::io::fixed(profile.indexOfRefraction(1500.), 1u, 6u)
+			<< "  time[us]: " << engabra::g3::io::fixed(usec, 6u, 1u)
+			<< '\n';
+	}
+
+	return 0;
+}
@@ -31,6 +31,7 @@
 
 #include "envAirInfo.hpp"
 #include "envAirProfile.hpp"
+#include "envCoesa1976.hpp"
 
 #include <filesystem>
 #include <iostream>
@@ -92,8 +93,8 @@ namespace
  * University of Wyoming site:
  * http://weather.uwyo.edu/upperair/sounding.html
  *
- * Code loads these "Sounding" data. It also loads "COESA1976" model data
- * (from aply::env::sAirInfoCoesa1976 in include/envAirInfo.hpp). It then
+ * Code loads these "Sounding" data. It also uses the "COESA1976" model
+ * (aply::env::coesa::airProfile() in include/envCoesa1976.hpp). It then
  * loops over range of heights above ground. At each height it:
  * \arg Intrpolates AirIndex parameters (e.g. Temp/Pres) at height
  * \arg Computes IoR using AirIndex values for each
@@ -119,10 +120,6 @@ main
 	std::map<aply::env::Height, aply::env::AirInfo> const airMapSounding
 		{ aply::env::airInfoFromUWyoSounding(use.theLoadPath) };
 
-	// Load COESA1976 model (from hard coded data)
-	std::map<aply::env::Height, aply::env::AirInfo> const airMapCoesa1976
-		{ aply::env::sAirInfoCoesa1976 };
-
 	//
 	// Wrap data in AirProfile interpolator
 	//
@@ -131,7 +128,8 @@ main
 	aply::env::AirProfile const profileSounding{ airMapSounding };
 
 	// construct a Standard atmosphere profile for comparison
-	aply::env::AirProfile const profileCoesa1976{ airMapCoesa1976 };
+	aply::env::AirProfile const profileCoesa1976
+		{ aply::env::coesa::airProfile() };
 
 	// generate a table of IoR value comparisons
 	constexpr double maxHeight{ 15000. };
@@ -0,0 +1,151 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Per-step cost of finite difference vs automatic gradients.
+ *
+ */
+
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/indexModel.hpp"
+
+#include <Engabra>
+
+#include <chrono>
+#include <iostream>
+
+
+namespace
+{
+	/*! \brief Wrapper using the (default) finite difference gradient.
+	 *
+	 * Values are those of the wrapped media, but nuGradient() is the
+	 * IndexVolume default (six additional nuValue() evaluations).
+	 */
+	struct FiniteDiffMedia : public aply::env::IndexVolume
+	{
+		aply::env::IndexVolume const * const thePtMedia{ nullptr };
+
+		//! Attach to (external) media.
+		explicit
+		FiniteDiffMedia
+			( aply::env::IndexVolume const * const & ptMedia
+			)
+			: IndexVolume(ptMedia->thePtVolume)
+			, thePtMedia{ ptMedia }
+		{ }
+
+		//! Value from wrapped media.
+		inline
+		virtual
+		double
+		nuValue
+			( engabra::g3::Vector const & rVec
+			) const
+		{
+			return thePtMedia->nuValue(rVec);
+		}
+
+	}; // FiniteDiffMedia
+
+	//! Trace path and return (elapsed [ms], path).
+	std::pair<double, aply::ray::Path>
+	timedPath
+		( aply::env::IndexVolume const & media
+		, aply::ray::Start const & start
+		, double const & propStepDist
+		, double const & saveStepDist
+		, engabra::g3::Vector const & approxEndLoc
+		)
+	{
+		using Clock = std::chrono::steady_clock;
+		aply::ray::Propagator const prop{ &media, propStepDist };
+		aply::ray::Path path(start, saveStepDist, approxEndLoc);
+		Clock::time_point const t0{ Clock::now() };
+		prop.tracePath(&path);
+		Clock::time_point const t1{ Clock::now() };
+		double const msTrace
+			{ std::chrono::duration<double, std::milli>(t1 - t0).count() };
+		return { msTrace, path };
+	}
+
+} // [anon]
+
+
+/*! \brief Compare ray trace cost using finite difference and AD gradients.
+ *
+ * The same exponential atmosphere (env::index::AtmModel) is traced
+ * twice: once with its (exact) AutoDiffVolume gradient and once with
+ * the finite difference default gradient. The time per propagation
+ * step and the difference in end points are reported.
+ */
+int
+main
+	()
+{
+	using namespace aply;
+	using namespace engabra::g3;
+	using engabra::g3::io::fixed;
+
+	env::index::AtmModel const atmAD(env::sEarth);
+	FiniteDiffMedia const atmFD(&atmAD);
+
+	double const & groundRad = env::sEarth.theRadGround;
+	Vector const approxEndLoc{ groundRad * e3 };
+	ray::Start const start
+		{ ray::Start::from
+			( -e3 + .5*e1  // down looking and about 30-deg to the side
+			, (groundRad + 9144.)*e3 // about 30k feet altitude
+			)
+		};
+	constexpr double propStepDist{    .01 };
+	constexpr double saveStepDist{ 1000.  };
+
+	std::pair<double, ray::Path> const runFD
+		{ timedPath(atmFD, start, propStepDist, saveStepDist, approxEndLoc) };
+	std::pair<double, ray::Path> const runAD
+		{ timedPath(atmAD, start, propStepDist, saveStepDist, approxEndLoc) };
+
+	Vector const & endFD = runFD.second.theNodes.back().theCurrLoc;
+	Vector const & endAD = runAD.second.theNodes.back().theCurrLoc;
+	double const pathLength{ magnitude(endAD - start.thePntLoc) };
+	double const numSteps{ pathLength / propStepDist };
+	double const usPerStepFD{ 1000. * runFD.first / numSteps };
+	double const usPerStepAD{ 1000. * runAD.first / numSteps };
+
+	double const speedup{ usPerStepFD / usPerStepAD };
+	double const endDiff{ magnitude(endAD - endFD) };
+	std::cout << "   numSteps: " << fixed(numSteps, 9u, 0u) << '\n';
+	std::cout << "stepFD [us]: " << fixed(usPerStepFD, 3u, 6u) << '\n';
+	std::cout << "stepAD [us]: " << fixed(usPerStepAD, 3u, 6u) << '\n';
+	std::cout << "    speedup: " << fixed(speedup, 3u, 3u) << '\n';
+	std::cout << "endDiff [m]: " << fixed(endDiff, 3u, 9u) << '\n';
+
+	return 0;
+}
@@ -36,6 +36,9 @@
 #include "example/indexModel.hpp"
 
 #include <Engabra>
+
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 
@@ -43,6 +46,34 @@ namespace
 {
 	using namespace engabra::g3;
 
+	//! Largest relative change in Bouguer's invariant, |r^(nu*t)|, on path
+	inline
+	double
+	maxBouguerDrift
+		( aply::ray::Path const & path
+		)
+	{
+		double maxDrift{ 0. };
+		if (! path.theNodes.empty())
+		{
+			auto const invariant
+				{ [] (aply::ray::Node const & node)
+					{
+						Vector const pVec{ node.theNextNu * node.theNextTan };
+						return magnitude((node.theCurrLoc * pVec).theBiv);
+					}
+				};
+			double const begValue{ invariant(path.theNodes.front()) };
+			for (aply::ray::Node const & node : path.theNodes)
+			{
+				double const relDrift
+					{ std::abs(invariant(node) - begValue) / begValue };
+				maxDrift = std::max(maxDrift, relDrift);
+			}
+		}
+		return maxDrift;
+	}
+
 } // [anon]
 
 
@@ -96,5 +127,19 @@ main
 
 	std::cout << "propStepDist: " << io::fixed(propStepDist) << '\n';
 	std::cout << ray::PathView{&path}.infoCurvature() << '\n';
+	std::cout << "bouguerDrift: " << maxBouguerDrift(path) << '\n';
+
+	// same path using symplectic (Hamiltonian) integration steps
+	// that are 10,000 times larger
+	constexpr double symStepDist{ 1. };
+	ray::Propagator const symProp
+		{ &atm, symStepDist, true, ray::SymplecticStep };
+	ray::Path symPath(start, saveStepDist, approxEndLoc);
+	symProp.tracePath(&symPath);
+
+	std::cout << '\n';
+	std::cout << "symStepDist: " << io::fixed(symStepDist) << '\n';
+	std::cout << ray::PathView{&symPath}.infoCurvature() << '\n';
+	std::cout << "bouguerDrift: " << maxBouguerDrift(symPath) << '\n';
 }
 
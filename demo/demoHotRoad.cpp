@@ -33,6 +33,7 @@
 #include "geom.hpp"
 #include "env.hpp"
 #include "ray.hpp"
+#include "mathDual.hpp"
 
 #include <iostream>
 #include <utility>
@@ -138,7 +139,7 @@ namespace road
 	 * due to hot air accumulating above and around a long straight road.
 	 *
 	 */
-	struct CylindricalAir : public aply::env::IndexVolume
+	struct CylindricalAir : public aply::env::AutoDiffVolume<CylindricalAir>
 	{
 		//! Cylindrical tube of (linearly) varying air IoR
 		aply::geom::Cylinder const theTube;
@@ -176,27 +177,46 @@ namespace road
 			, double const & tempOnAxisK
 			, double const & tempOnEdgeK
 			)
-			: IndexVolume{}
+			: AutoDiffVolume{}
 			, theTube{ tube }
 			, theNuInterval{ nuInterval(tempOnAxisK, tempOnEdgeK) }
 		{ }
 
-		//! Index of refraction associated with radial gradient along cylinder
+		/*! \brief IoR associated with radial gradient along cylinder.
+		 *
+		 * Same expressions as geom::Cylinder fraction*() and
+		 * geom::Interval::valueAtFrac() but generic over Scalar
+		 * (double or math::Dual) for use with AutoDiffVolume.
+		 */
+		template <typename Scalar>
 		inline
-		double
-		nuValue
-			( engabra::g3::Vector const & rLoc
+		Scalar
+		nuValueOf
+			( aply::math::Vec3<Scalar> const & rLoc
 			) const
 		{
-			double nu{ engabra::g3::null<double>() };
-			double const lenFrac{ theTube.fractionAlongAxis(rLoc) };
+			namespace math = aply::math;
+			Scalar nu{ engabra::g3::null<double>() };
+			math::Vec3<Scalar> const relLoc
+				{ math::difference(rLoc, theTube.theAxisBeg) };
+			Scalar const along{ math::dot(relLoc, theTube.theAxisDir) };
+			Scalar const lenFrac{ along / theTube.theLength };
 			if ((! (lenFrac < 0.)) && (lenFrac < 1.))
 			{
 				nu = theNuInterval.max(); // default to STP air
-				double const radFrac{ theTube.fractionFromAxis(rLoc) };
+				// distance from axis (avoid infinite derivative on axis)
+				Scalar const distSq{ math::magSq(relLoc) - along*along };
+				Scalar dist{ 0. };
+				if (0. < math::valueOf(distSq))
+				{
+					dist = math::sqrt(distSq);
+				}
+				Scalar const radFrac{ dist / theTube.theRadius };
 				if (radFrac < 1.)
 				{
-					nu = theNuInterval.valueAtFrac(radFrac);
+					double const nuSpan
+						{ theNuInterval.max() - theNuInterval.min() };
+					nu = radFrac * nuSpan + theNuInterval.min();
 				}
 			}
 			return nu;
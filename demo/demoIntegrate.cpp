@@ -24,7 +24,8 @@
 
 /*! \file \brief Demonstrate numerical integration for simple ODE.
  *
- * Demonstrate use of math::DiffEqSystem and math::DiffEqSolve to compute
+ * Demonstrate use of fixed dimension equation systems (ref
+ * mathDiffEqSystemArray.hpp) and math::DiffEqSolveRK4 to compute
  * the solution of a simple second order differential equation system.
  *
  * The problem is associated with a object undergoing constant acceleration
@@ -34,12 +35,12 @@
  * The code in this file solves the problem with two approaches. The first
  * is a simple fininte difference estimation (essentially Euler's method).
  * The second solution uses the 4th order Runge Kutta algorithm from 
- * math::DiffEqSolve (with a vector valued system of equations).
+ * math::DiffEqSolveRK4 (with a vector valued system of equations).
  *
 */
 
-#include "mathDiffEqSolve.hpp"
-#include "mathDiffEqSystem.hpp"
+#include "mathDiffEqSolveRK4.hpp"
+#include "mathDiffEqSystemArray.hpp"
 
 #include <Engabra>
 
@@ -191,7 +192,7 @@ namespace euler
 namespace rk
 {
 	//! \brief System of vector equations for solving acceleration() ODE.
-	struct AccelSystem : public aply::math::DiffEqSystem
+	struct AccelSystem
 	{
 		double const theInitTau{ null<double>() };
 		Vector const theInitPos{ null<Vector>() };
@@ -203,14 +204,11 @@ namespace rk
 			, Vector const initPos
 			, Vector const initVel
 			)
-			: DiffEqSystem()
-			, theInitTau{ initTau }
+			: theInitTau{ initTau }
 			, theInitPos{ initPos }
 			, theInitVel{ initVel }
 		{ }
 
-		virtual ~AccelSystem() = default;
-
 		// [DoxyExample00]
 		/*! \brief Derivatives for rotating rocket problem.
 		*
@@ -231,17 +229,14 @@ namespace rk
 		* y1 = y0'
 		* y2 = y1'
  		*/
-		virtual
-		std::vector<double>
+		inline
+		std::array<double, 6u>
 		operator()
-			( std::pair<double, std::vector<double> > const & tyValues
+			( double const & tau //!< evolution parameter (here time)
+			, std::array<double, 6u> const & yFuncs //!< function values
 			) const
 		{
-			// evoluation parameter (here time)
-			double const & tau = tyValues.first;
-
 			// access function values
-			std::vector<double> const & yFuncs = tyValues.second;
 			double const * ptFuncComp = yFuncs.data();
 
 			// components of vector position function
@@ -266,7 +261,7 @@ namespace rk
 			double const y1c2Prime = accel[1];
 			double const y1c3Prime = accel[2];
 
-			return
+			return std::array<double, 6u>
 				{ // y0Prime vector component derivatives
 				  y0c1Prime, y0c2Prime, y0c3Prime
 				  // y1Prime vector component derivatives
@@ -282,13 +277,14 @@ namespace rk
 		 * \arg Position (y0c[012] = 0.)
 		 * \arg Velocity (y1c[012] = 0.)
  		 */
-		std::pair<double, std::vector<double> >
+		inline
+		aply::math::DiffEqValues<6u>
 		initValues
 			() const
 		{
 			return
 				{ theInitTau
-				, std::vector<double>
+				, std::array<double, 6u>
 					{  // Pos(t0) - init value for each component
 					  theInitPos[0]
 					, theInitPos[1]
@@ -320,12 +316,12 @@ namespace rk
 			(currState.theTau, currState.thePos, currState.theVel);
 
 		// solve system until next step
-		aply::math::DiffEqSolve solver(tauDel);
+		aply::math::DiffEqSolveRK4 const solver(tauDel);
 
-		std::pair<double, std::vector<double> >
+		aply::math::DiffEqValues<6u>
 			const soln{ solver.solutionFor(nextTau, accelSystem) };
 
-		std::vector<double> const & sVals = soln.second;
+		std::array<double, 6u> const & sVals = soln.second;
 		Vector const nextPos{ sVals[0], sVals[1], sVals[2] };
 		Vector const nextVel{ sVals[3], sVals[4], sVals[5] };
 
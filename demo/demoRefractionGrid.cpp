@@ -0,0 +1,130 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+
+/*! \file
+ *
+ * \brief Refraction correction of every pixel in a large aerial frame.
+ *
+ */
+
+
+#include "camRefractionGrid.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	//! Largest correction magnitude for pixels in rows [rowBeg, rowEnd).
+	double
+	maxCorrectionForRows
+		( aply::cam::RefractionGrid const & grid
+		, std::size_t const & rowBeg
+		, std::size_t const & rowEnd
+		)
+	{
+		double maxMagSq{ 0. };
+		std::vector<aply::cam::ImgRowCol> rowDisps;
+		for (std::size_t row{rowBeg} ; row < rowEnd ; ++row)
+		{
+			grid.displacementsForRow(row, &rowDisps);
+			for (aply::cam::ImgRowCol const & disp : rowDisps)
+			{
+				double const magSq{ disp[0]*disp[0] + disp[1]*disp[1] };
+				maxMagSq = std::max(maxMagSq, magSq);
+			}
+		}
+		double const maxMag{ std::sqrt(maxMagSq) };
+		return maxMag;
+	}
+
+} // [anon]
+
+
+/* \brief Build refraction grid for a 100 Mpix frame and correct all pixels.
+ */
+int
+main
+	()
+{
+	using Clock = std::chrono::steady_clock;
+	using engabra::g3::io::fixed;
+
+	// e.g. large format aerial frame: 10k x 10k pixels, 4.6um, 100mm lens
+	aply::cam::Interior const interior
+		{ aply::cam::Interior::frame(10000u, 10000u, 4.6e-6, .100) };
+	constexpr double heightSensor{ 6000. };
+	constexpr double heightGround{  300. };
+
+	Clock::time_point const t0{ Clock::now() };
+	aply::cam::RefractionGrid const grid
+		(interior, heightSensor, heightGround);
+	Clock::time_point const t1{ Clock::now() };
+
+	// correct every pixel (e.g. to resample the image), rows in parallel
+	std::size_t const numThreads
+		{ std::max(1u, std::thread::hardware_concurrency()) };
+	std::size_t const numRows{ interior.theNumRows };
+	std::size_t const tileSize{ (numRows + numThreads - 1u) / numThreads };
+	std::vector<double> tileMaxs(numThreads, 0.);
+	std::vector<std::thread> threads;
+	for (std::size_t nt{0u} ; nt < numThreads ; ++nt)
+	{
+		std::size_t const rowBeg{ std::min(nt * tileSize, numRows) };
+		std::size_t const rowEnd{ std::min(rowBeg + tileSize, numRows) };
+		threads.emplace_back
+			( [& grid, & tileMaxs, nt, rowBeg, rowEnd] ()
+				{ tileMaxs[nt] = maxCorrectionForRows(grid, rowBeg, rowEnd); }
+			);
+	}
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+	Clock::time_point const t2{ Clock::now() };
+
+	double const maxMag
+		{ *std::max_element(tileMaxs.cbegin(), tileMaxs.cend()) };
+	double const msBuild
+		{ std::chrono::duration<double, std::milli>(t1 - t0).count() };
+	double const msApply
+		{ std::chrono::duration<double, std::milli>(t2 - t1).count() };
+
+	std::cout << grid.infoString("RefractionGrid") << '\n';
+	std::cout << "       numThreads: " << numThreads << '\n';
+	std::cout << "maxCorrection[px]: " << fixed(maxMag, 2u, 6u) << '\n';
+	std::cout << "gridBuildTime[ms]: " << fixed(msBuild, 6u, 3u) << '\n';
+	std::cout << "allPixelsTime[ms]: " << fixed(msApply, 6u, 3u) << '\n';
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Propagation step size convergence study for example scenes.
+ *
+ */
+
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/indexModel.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Run study and report recommended step size.
+	void
+	reportStudy
+		( std::string const & title
+		, env::IndexVolume const * const & ptMedia
+		, ray::Start const & start
+		, double const & pathLength
+		, double const & coarseStep
+		, std::size_t const & numRungs
+		, double const & locTol
+		, ray::StepMethod const & stepMethod
+		)
+	{
+		using engabra::g3::io::fixed;
+		ray::StepStudy const study
+			(ptMedia, start, pathLength, coarseStep, numRungs, stepMethod);
+		std::cout << '\n' << study.infoString(title) << '\n';
+		std::cout << "largest step for locTol " << fixed(locTol, 1u, 6u)
+			<< ": " << study.largestStepFor(locTol) << '\n';
+	}
+
+} // [anon]
+
+
+/*! \brief Convergence study (with extrapolation) for several scenes.
+ *
+ * Each scene traces one ray with a ladder of step sizes and reports
+ * the observed order, estimated errors, work (refinement loops) and
+ * the largest step size meeting a location tolerance.
+ */
+int
+main
+	()
+{
+	constexpr double locTol{ 1.e-5 }; // [m]
+	double const & groundRad = env::sEarth.theRadGround;
+
+	// low elevation ray through COESA atmosphere near ground
+	env::coesa::AirVolume const coesa{};
+	ray::Start const lowStart
+		{ ray::Start::from
+			(Vector{ 1., 0., .02 }, (groundRad + 2.) * e3)
+		};
+	std::pair<ray::StepMethod, std::string> const methodNames[]
+		{ { ray::InterfaceStep, "InterfaceStep" }
+		, { ray::ImplicitStep, "ImplicitStep" }
+		, { ray::SymplecticStep, "SymplecticStep" }
+		};
+	for (std::pair<ray::StepMethod, std::string> const & methodName
+		: methodNames)
+	{
+		reportStudy
+			( "COESA, elev ~1.1 deg, 2 km path, " + methodName.second
+			, &coesa, lowStart, 2000., 16., 6u, locTol, methodName.first
+			);
+	}
+
+	// steep ray down through exponential atmosphere (ref demoExpAtmosphere)
+	env::index::AtmModel const atm(env::sEarth);
+	ray::Start const downStart
+		{ ray::Start::from
+			(Vector{ 1., 0., -1. }, (groundRad + 2000.) * e3)
+		};
+	reportStudy
+		( "Exponential atmosphere, 45 deg down, 2 km path"
+		, &atm, downStart, 2000., 16., 6u, locTol, ray::InterfaceStep
+		);
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Timing of batched refraction kernel and packet ray tracing.
+ *
+ */
+
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/indexModel.hpp"
+
+#include <Engabra>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	//! Elapsed time in [ms]
+	inline
+	double
+	msBetween
+		( Clock::time_point const & t0
+		, Clock::time_point const & t1
+		)
+	{
+		return std::chrono::duration<double, std::milli>(t1 - t0).count();
+	}
+
+} // [anon]
+
+
+/*! \brief Microbenchmark for ray::nextTangentDirs() and tracePacket().
+ *
+ * \arg Kernel: time per evaluation of scalar ray::nextTangentDir()
+ * compared with the batched ray::nextTangentDirs() for the same data.
+ *
+ * \arg Tracing: time to trace a bundle of rays through an exponential
+ * atmosphere one at a time (tracePath()) compared with all together
+ * (tracePacket()).
+ */
+int
+main
+	()
+{
+	using namespace aply;
+	using namespace engabra::g3;
+	using engabra::g3::io::fixed;
+
+	// random refraction cases
+	constexpr std::size_t numSamp{ 1024u * 1024u };
+	std::mt19937 gen(72621u);
+	std::uniform_real_distribution<double> distCoord(-1., 1.);
+	std::uniform_real_distribution<double> distNu(1., 1.001);
+	ray::TangentBatch batch;
+	batch.resize(numSamp);
+	std::vector<Vector> tans(numSamp);
+	std::vector<Vector> grads(numSamp);
+	for (std::size_t ns{0u} ; ns < numSamp ; ++ns)
+	{
+		double const tx{ distCoord(gen) };
+		double const ty{ distCoord(gen) };
+		double const tz{ distCoord(gen) };
+		double const gx{ distCoord(gen) };
+		double const gy{ distCoord(gen) };
+		double const gz{ distCoord(gen) };
+		tans[ns] = direction(Vector{ tx, ty, tz });
+		grads[ns] = Vector{ gx, gy, gz };
+		batch.set(ns, tans[ns], distNu(gen), grads[ns], distNu(gen));
+	}
+
+	// scalar kernel
+	Clock::time_point const t0{ Clock::now() };
+	double sumScalar{ 0. };
+	for (std::size_t ns{0u} ; ns < numSamp ; ++ns)
+	{
+		std::pair<Vector, ray::DirChange> const tanChange
+			{ ray::nextTangentDir
+				( tans[ns], batch.theNuPrev[ns]
+				, grads[ns], batch.theNuNext[ns]
+				)
+			};
+		sumScalar += tanChange.first[2];
+	}
+	Clock::time_point const t1{ Clock::now() };
+
+	// batched kernel
+	ray::nextTangentDirs(&batch);
+	Clock::time_point const t2{ Clock::now() };
+	double sumBatch{ 0. };
+	for (double const & nextZ : batch.theNextZ)
+	{
+		sumBatch += nextZ;
+	}
+
+	double const nsScalar{ 1.e6 * msBetween(t0, t1) / double(numSamp) };
+	double const nsBatch{ 1.e6 * msBetween(t1, t2) / double(numSamp) };
+	std::cout << "kernel scalar [ns]: " << fixed(nsScalar, 4u, 3u) << '\n';
+	std::cout << "kernel  batch [ns]: " << fixed(nsBatch, 4u, 3u) << '\n';
+	std::cout << "    kernel speedup: " << fixed(nsScalar/nsBatch, 4u, 3u)
+		<< '\n';
+	std::cout << "  checksum diff: " << fixed(sumBatch - sumScalar, 1u, 12u)
+		<< '\n';
+
+	// bundle of rays through exponential atmosphere
+	env::index::AtmModel const atm(env::sEarth);
+	double const & groundRad = env::sEarth.theRadGround;
+	Vector const staLoc{ (groundRad + 2000.) * e3 };
+	constexpr double propStepDist{ .1 };
+	constexpr double saveStepDist{ 100. };
+	constexpr std::size_t numRays{ 64u };
+	std::vector<ray::Start> starts;
+	for (std::size_t nr{0u} ; nr < numRays ; ++nr)
+	{
+		double const angle{ (double(nr) / double(numRays)) * (.5*pi) };
+		Vector const dir{ std::cos(angle)*e1 - e3 + std::sin(angle)*e2 };
+		starts.emplace_back(ray::Start::from(dir, staLoc));
+	}
+	ray::Propagator const prop{ &atm, propStepDist };
+
+	std::vector<ray::Path> pathsSerial;
+	pathsSerial.reserve(numRays);
+	Clock::time_point const t3{ Clock::now() };
+	for (ray::Start const & start : starts)
+	{
+		pathsSerial.emplace_back(ray::Path(start, saveStepDist));
+		pathsSerial.back().reserveForDistance(2000.);
+		prop.tracePath(&(pathsSerial.back()));
+	}
+	Clock::time_point const t4{ Clock::now() };
+
+	std::vector<ray::Path> pathsPacket;
+	pathsPacket.reserve(numRays);
+	std::vector<ray::Path *> ptPaths;
+	for (ray::Start const & start : starts)
+	{
+		pathsPacket.emplace_back(ray::Path(start, saveStepDist));
+		pathsPacket.back().reserveForDistance(2000.);
+		ptPaths.emplace_back(&(pathsPacket.back()));
+	}
+	Clock::time_point const t5{ Clock::now() };
+	prop.tracePacket(ptPaths);
+	Clock::time_point const t6{ Clock::now() };
+
+	double maxDiff{ 0. };
+	for (std::size_t nr{0u} ; nr < numRays ; ++nr)
+	{
+		Vector const & locS = pathsSerial[nr].theNodes.back().theCurrLoc;
+		Vector const & locP = pathsPacket[nr].theNodes.back().theCurrLoc;
+		maxDiff = std::max(maxDiff, magnitude(locP - locS));
+	}
+
+	std::cout << " trace serial [ms]: " << fixed(msBetween(t3, t4), 6u, 3u)
+		<< '\n';
+	std::cout << " trace packet [ms]: " << fixed(msBetween(t5, t6), 6u, 3u)
+		<< '\n';
+	std::cout << "end loc maxDiff[m]: " << fixed(maxDiff, 1u, 12u) << '\n';
+
+	return 0;
+}
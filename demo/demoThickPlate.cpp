@@ -181,15 +181,25 @@ main
 	// starting rays to trace
 	std::vector<ray::Start> const starts{ app::rayStarts(station) };
 
-	// trace and report each ray
-	std::ofstream ofs(use.theSaveName);
+	// data consumers (paths) for each ray
+	std::vector<ray::Path> paths;
+	paths.reserve(starts.size());
+	std::vector<ray::Path *> ptPaths;
+	ptPaths.reserve(starts.size());
 	for (ray::Start const & start : starts)
 	{
-		// propagation while interacting with data consumer(path)
-		ray::Path path(start, saveStepDist);
-		path.reserveForDistance(10.);
-		prop.tracePath(&path);
+		paths.emplace_back(ray::Path(start, saveStepDist));
+		paths.back().reserveForDistance(10.);
+		ptPaths.emplace_back(&(paths.back()));
+	}
+
+	// propagate the bundle of rays together (same as tracePath() for each)
+	prop.tracePacket(ptPaths);
 
+	// report each ray
+	std::ofstream ofs(use.theSaveName);
+	for (ray::Path const & path : paths)
+	{
 		// save path info for this ray
 		for (ray::Node const & node : path.theNodes)
 		{
@@ -33,6 +33,7 @@
 
 
 #include "mathDiffEqSystem.hpp"
+#include "mathDiffEqSystemArray.hpp"
 
 #include <Engabra>
 
@@ -198,6 +199,49 @@ namespace diffeq
 
 	}; // UniformAccel
 
+
+	/*! \brief Fixed dimension (std::array) version of UniformAccel.
+	 *
+	 * Same equation system as UniformAccel, but expressed in form
+	 * compatible with the templated solvers (e.g. DiffEqSolveRK4).
+	 * Ref mathDiffEqSystemArray.hpp
+	 */
+	struct UniformAccelArray
+	{
+		//! Equation system (and analytic solutions) being wrapped.
+		UniformAccel const theAccelSystem;
+
+		//! Derivative values: (y0' = y1, y1' = g)
+		inline
+		std::array<double, 2u>
+		operator()
+			( double const & // xValue
+			, std::array<double, 2u> const & yFuncs
+			) const
+		{
+			return std::array<double, 2u>
+				{ yFuncs[1]
+				, UniformAccel::theAccel
+				};
+		}
+
+		//! Initial time, position, and velocity
+		inline
+		aply::math::DiffEqValues<2u>
+		initValues
+			() const
+		{
+			return
+				{ theAccelSystem.theTime0
+				, std::array<double, 2u>
+					{ theAccelSystem.theHeight0
+					, theAccelSystem.theSpeed0
+					}
+				};
+		}
+
+	}; // UniformAccelArray
+
 } // [diffeq]
 
 } // [examp]
@@ -35,6 +35,7 @@
 
 
 #include "env.hpp"
+#include "mathDual.hpp"
 
 #include <Engabra>
 
@@ -119,6 +120,48 @@ namespace index
 	}; // Slab
 
 
+	/*! \brief Index of refraction varying linearly with location.
+	 *
+	 * nuValue(rVec) = nuAtOrigin + (gradient . rVec)
+	 *
+	 * E.g. IoR decreasing with height (mirage) for a negative gradient
+	 * along e3. Rays curve toward higher IoR along smooth (analytic)
+	 * paths. Provide an ActiveVolume to keep the value positive.
+	 */
+	struct Linear : public IndexVolume
+	{
+		Vector const theGradient{ null<Vector>() };
+		double const theNuOrigin{ null<double>() };
+
+		//! Value constructor
+		inline
+		explicit
+		Linear
+			( Vector const & gradient
+			, double const & nuAtOrigin
+			, std::shared_ptr<ActiveVolume>
+				const & ptVolume = sPtAllSpace
+			)
+			: IndexVolume(ptVolume)
+			, theGradient{ gradient }
+			, theNuOrigin{ nuAtOrigin }
+		{
+		}
+
+		//! \brief Index of refraction value at vector location rVec.
+		inline
+		virtual
+		double
+		nuValue
+			( Vector const & rVec
+			) const
+		{
+			return (theNuOrigin + (rVec * theGradient).theSca[0]);
+		}
+
+	}; // Linear
+
+
 	/*! \brief Simple example of a spherical shape with constant index.
 	 */
 	struct Sphere : public IndexVolume
@@ -271,14 +314,15 @@ namespace index
 			, theBeta{ beta(v0, v1, r0, r1) }
 		{ }
 
-		//! Classic exponential decay model
+		//! Classic exponential decay model (Scalar: double or math::Dual)
+		template <typename Scalar>
 		inline
-		double
+		Scalar
 		operator()
-			( double const & radius
+			( Scalar const & radius
 			) const
 		{
-			return theAlpha * std::exp(-theBeta * radius);
+			return theAlpha * math::exp(-theBeta * radius);
 		}
 
 		//! Descriptive information about this instance.
@@ -304,7 +348,7 @@ namespace index
 
 
 	//! Atmospheric model : nu = alpha*exp(-beta*radius)
-	struct AtmModel : public IndexVolume
+	struct AtmModel : public AutoDiffVolume<AtmModel>
 	{
 		std::pair<double, double> const the_v0r0{}; //!< 1st boundary loc/val
 		std::pair<double, double> const the_v1r1{}; //!< 2nd boundary loc/val
@@ -323,7 +367,7 @@ namespace index
 		inline
 		AtmModel
 			()
-			: IndexVolume()
+			: AutoDiffVolume()
 			, theNuFunc{}
 		{ }
 
@@ -334,7 +378,7 @@ namespace index
 			, std::shared_ptr<ActiveVolume>
 				const & ptVolume = sPtAllSpace
 			)
-			: IndexVolume(ptVolume)
+			: AutoDiffVolume(ptVolume)
 			, the_v0r0{ planet.theNuGround, planet.theRadGround }
 			, the_v1r1{ planet.theNuSpace, planet.theRadSpace }
 			, theNuFunc
@@ -357,16 +401,16 @@ namespace index
 		}
 
 
-		//! Index of refraction value at vector location rVec
-		virtual
+		//! Index of refraction (Scalar: double or math::Dual) at rVec
+		template <typename Scalar>
 		inline
-		double
-		nuValue
-			( Vector const & rVec
+		Scalar
+		nuValueOf
+			( math::Vec3<Scalar> const & rVec
 			) const
 		{
-			double nu{ null<double>() }; // out of model
-			double const rMag{ magnitude(rVec) };
+			Scalar nu{ null<double>() }; // out of model
+			Scalar const rMag{ math::magnitude(rVec) };
 			if (! (rMag < theMinRad) && (rMag < theMaxRad))
 			{
 				nu = theNuFunc(rMag);
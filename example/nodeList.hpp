@@ -0,0 +1,89 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+
+#ifndef aply_examp_nodeList_INCL_
+#define aply_examp_nodeList_INCL_
+
+/*! \file
+ *
+ * \brief Minimal ray node consumer for testing and demonstration.
+ *
+ */
+
+
+#include "rayNode.hpp"
+#include "rayStart.hpp"
+
+#include <cstddef>
+#include <vector>
+
+
+namespace aply
+{
+namespace examp
+{
+
+	/*! \brief Minimal ray node consumer recording every node (ref ray::Path)
+	 *
+	 * Satisfies the Consumer interface used by ray::Propagator (and
+	 * similar) path tracing methods without any decimation of nodes.
+	 */
+	struct NodeList
+	{
+		ray::Start const theStart{};
+		std::vector<ray::Node> theNodes{};
+
+		inline
+		std::size_t
+		size
+			() const
+		{
+			return theNodes.size();
+		}
+
+		inline
+		std::size_t
+		capacity
+			() const
+		{
+			return theNodes.capacity();
+		}
+
+		inline
+		void
+		emplace_back
+			( ray::Node const & node
+			)
+		{
+			theNodes.emplace_back(node);
+		}
+
+	}; // NodeList
+
+} // [examp]
+} // [aply]
+
+#endif // aply_examp_nodeList_INCL_
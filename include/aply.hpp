@@ -32,6 +32,7 @@
  */
 
 
+#include "cam.hpp"
 #include "env.hpp"
 #include "ray.hpp"
 
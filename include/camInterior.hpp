@@ -0,0 +1,183 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_cam_Interior_INCL_
+#define aply_cam_Interior_INCL_
+
+/*! \file
+\brief Declarations for aply::cam::Interior
+*/
+
+
+#include <Engabra>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+
+namespace aply
+{
+namespace cam
+{
+
+	/*! \brief Image location (or displacement) as (row, column) [pixel].
+	 *
+	 * Continuous coordinates for which the center of pixel (row, col)
+	 * is at location {row, col}.
+	 */
+	using ImgRowCol = std::array<double, 2u>;
+
+	/*! \brief Camera interior orientation (ideal central perspective).
+	 *
+	 * Frame cameras have numRows by numCols pixels. Pushbroom cameras
+	 * are described by a single row (the detector line) for which the
+	 * same interior geometry applies to every scan line.
+	 */
+	struct Interior
+	{
+		//! Number of pixel rows (1 for pushbroom detector line).
+		std::size_t theNumRows{ 0u };
+
+		//! Number of pixel columns.
+		std::size_t theNumCols{ 0u };
+
+		//! Detector pixel size [m/pixel].
+		double thePixelPitch{ engabra::g3::null<double>() };
+
+		//! Principal distance (aka focal length) [m].
+		double thePrincipalDistance{ engabra::g3::null<double>() };
+
+		//! Image location of the principal point [pixel].
+		ImgRowCol thePrincipalPoint
+			{ engabra::g3::null<double>(), engabra::g3::null<double>() };
+
+
+		//! \brief Frame camera with principal point at format center.
+		inline
+		static
+		Interior
+		frame
+			( std::size_t const & numRows
+			, std::size_t const & numCols
+			, double const & pixelPitch
+			, double const & principalDistance
+			)
+		{
+			return Interior
+				{ numRows
+				, numCols
+				, pixelPitch
+				, principalDistance
+				, ImgRowCol
+					{ .5 * static_cast<double>(numRows - 1u)
+					, .5 * static_cast<double>(numCols - 1u)
+					}
+				};
+		}
+
+		//! \brief Pushbroom (single line) camera with centered principal point.
+		inline
+		static
+		Interior
+		pushbroom
+			( std::size_t const & numCols
+			, double const & pixelPitch
+			, double const & principalDistance
+			)
+		{
+			return frame(1u, numCols, pixelPitch, principalDistance);
+		}
+
+		//! True if instance contains valid data.
+		inline
+		bool
+		isValid
+			() const
+		{
+			return
+				(  (0u < theNumRows)
+				&& (0u < theNumCols)
+				&& (0. < thePixelPitch)
+				&& (0. < thePrincipalDistance)
+				&& engabra::g3::isValid(thePrincipalPoint[0])
+				&& engabra::g3::isValid(thePrincipalPoint[1])
+				);
+		}
+
+		//! Radial image distance [pixel] for off-axis angle [rad].
+		inline
+		double
+		radialPixelsForAngle
+			( double const & angle
+			) const
+		{
+			return (thePrincipalDistance * std::tan(angle) / thePixelPitch);
+		}
+
+		//! Off-axis angle [rad] for radial image distance [pixel].
+		inline
+		double
+		angleForRadialPixels
+			( double const & radialPixels
+			) const
+		{
+			double const radialDist{ radialPixels * thePixelPitch };
+			return std::atan(radialDist / thePrincipalDistance);
+		}
+
+		//! Descriptive information about this instance.
+		inline
+		std::string
+		infoString
+			( std::string const & title = {}
+			) const
+		{
+			std::ostringstream oss;
+			if (! title.empty())
+			{
+				oss << title << '\n';
+			}
+			using engabra::g3::io::fixed;
+			oss << "          theNumRows: " << theNumRows << '\n';
+			oss << "          theNumCols: " << theNumCols << '\n';
+			oss << "       thePixelPitch: "
+				<< fixed(thePixelPitch, 1u, 9u) << '\n';
+			oss << "thePrincipalDistance: "
+				<< fixed(thePrincipalDistance, 1u, 6u) << '\n';
+			oss << "   thePrincipalPoint: "
+				<< fixed(thePrincipalPoint[0], 6u, 3u)
+				<< ' ' << fixed(thePrincipalPoint[1], 6u, 3u);
+			return oss.str();
+		}
+
+	}; // Interior
+
+} // [cam]
+} // [aply]
+
+#endif // aply_cam_Interior_INCL_
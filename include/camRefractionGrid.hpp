@@ -0,0 +1,208 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_cam_RefractionGrid_INCL_
+#define aply_cam_RefractionGrid_INCL_
+
+/*! \file
+\brief Declarations for aply::cam::RefractionGrid
+*/
+
+
+#include "camInterior.hpp"
+#include "envAirProfile.hpp"
+#include "envCoesa1976.hpp"
+#include "envPlanet.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace cam
+{
+
+/*! \brief Image space refraction displacements for every pixel of a camera.
+
+For a (near) vertical image, the refraction deviation of a ray
+(ref aply::ray::Refraction::angularDeviationFromStart()) depends only
+on the magnitude of the ray's off-nadir look angle. Image displacements
+are therefore radial about the image nadir point with a magnitude that
+is a function of radial image distance only.
+
+Construction evaluates this radial function (a 1D curve sampled at one
+pixel intervals) for all look angles at once with aply::ray::RefractionFan.
+The curve is then expanded into a regular grid of displacement values
+(every cellSize pixels) over the image format. Grid rows are filled in
+parallel by independent threads (tiles of grid rows).
+
+Displacements for any image location are obtained by bilinear
+interpolation of the grid (ref displacementAt()).
+
+The displacement is that to be \b added to a measured (refracted)
+image location to obtain the location at which the ideal (straight
+line) ray to the ground point would have imaged. I.e.
+\code
+correctedRowCol = rowCol + displacementAt(rowCol)
+\endcode
+
+Pushbroom cameras are handled with an Interior having a single row.
+The grid then has one row of nodes and interpolation is linear along
+the detector line.
+
+\par Example
+\snippet test/test_RefractionGrid.cpp DoxyExample01
+
+*/
+
+class RefractionGrid
+{
+
+private: // data
+
+	//! Cached construction value.
+	Interior theInterior{};
+
+	//! Image location of the nadir point [pixel].
+	ImgRowCol theNadirRowCol
+		{ engabra::g3::null<double>(), engabra::g3::null<double>() };
+
+	//! Spacing between grid nodes [pixel].
+	std::size_t theCellSize{ 0u };
+
+	//! Number of grid nodes in row direction.
+	std::size_t theNumNodeRows{ 0u };
+
+	//! Number of grid nodes in column direction.
+	std::size_t theNumNodeCols{ 0u };
+
+	//! Radial displacement [pixel] at each radial pixel distance.
+	std::vector<double> theRadialDisps{};
+
+	//! Displacement at grid nodes (row major order).
+	std::vector<ImgRowCol> theNodeDisps{};
+
+public: // methods
+
+	//! default null constructor
+	RefractionGrid
+		() = default;
+
+	/*! \brief Construct displacement grid for a vertical image.
+	 *
+	 * The camera is at heightSensor and the imaged terrain is at
+	 * heightGround (both relative to radiusEarth). The image nadir
+	 * point is taken to be the principal point.
+	 *
+	 * Grid construction uses numThreads threads (if zero, use
+	 * std::thread::hardware_concurrency()).
+	 */
+	explicit
+	RefractionGrid
+		( Interior const & interior
+		, double const & heightSensor
+		, double const & heightGround
+		, env::AirProfile const & airProfile
+			= env::coesa::airProfile()
+		, double const & radiusEarth = env::sEarth.theRadGround
+		, std::size_t const & cellSize = 32u
+		, std::size_t const & numThreads = 0u
+		);
+
+	//! Check if instance is valid
+	bool
+	isValid
+		() const;
+
+	//! Camera interior orientation used for construction.
+	Interior const &
+	interior
+		() const;
+
+	/*! \brief Radial displacement [pixel] at radial distance from nadir.
+	 *
+	 * Linear interpolation of the 1D curve (positive values are
+	 * directed away from the nadir point). Null for radialPixels
+	 * beyond the image format.
+	 */
+	double
+	radialDisplacementAt
+		( double const & radialPixels
+		) const;
+
+	/*! \brief Displacement [pixel] at image location (bilinear on grid).
+	 *
+	 * Null if rowCol is outside the image format.
+	 */
+	ImgRowCol
+	displacementAt
+		( ImgRowCol const & rowCol
+		) const;
+
+	/*! \brief Displacements for every pixel of an image row.
+	 *
+	 * Values are the same as displacementAt() for each pixel center
+	 * {row, col} along the row. Interpolation weights are shared along
+	 * the row (e.g. for efficient correction/resampling of entire
+	 * images). The ptRowDisps vector is resized to the number of columns.
+	 * Values are null if row is outside of the image format.
+	 */
+	void
+	displacementsForRow
+		( std::size_t const & row
+		, std::vector<ImgRowCol> * const & ptRowDisps
+		) const;
+
+	//! Convenience: rowCol + displacementAt(rowCol)
+	ImgRowCol
+	correctedRowCol
+		( ImgRowCol const & rowCol
+		) const;
+
+	//! Descriptive information about this instance.
+	std::string
+	infoString
+		( std::string const & title=std::string()
+		) const;
+
+private:
+
+	//! Populate theNodeDisps for node rows in range [rowBeg, rowEnd).
+	void
+	fillNodeRows
+		( std::size_t const rowBeg
+		, std::size_t const rowEnd
+		);
+
+};
+
+} // [cam]
+} // [aply]
+
+#endif // aply_cam_RefractionGrid_INCL_
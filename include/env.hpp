@@ -33,8 +33,11 @@
 
 
 #include "envIndexVolume.hpp"
+#include "envAutoDiffVolume.hpp"
+#include "envIndexGrid.hpp"
 #include "envActiveVolume.hpp"
 #include "envPlanet.hpp"
+#include "envCoesa1976.hpp"
 
 
 namespace aply
@@ -0,0 +1,299 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_env_AirArchive_INCL_
+#define aply_env_AirArchive_INCL_
+
+/*! \file
+ *
+ * \brief Indexed binary archive for collections of sounding profiles.
+ *
+ * Archive file layout (native byte order, all fields 8-byte aligned):
+ * \arg Header: magic "APLYAIR1", profile count, index offset, data offset
+ * \arg Index: one ArchiveEntry per profile, sorted by (station, time)
+ * \arg Data: per profile, four columns (height, temperature, pressure,
+ * relative humidity) each holding numLevels doubles.
+ *
+ * A reader (AirArchive) memory-maps the file so that any single profile
+ * is located by binary search in the index and accessed in place without
+ * touching the remainder of the file.
+ */
+
+
+#include "envAirInfo.hpp"
+#include "envAirProfile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace env
+{
+
+	/*! \brief Key identifying a sounding by station and observation time.
+	 *
+	 * The time key is encoded as decimal integer "yyyymmddhh" (UTC) such
+	 * that natural integer ordering is chronological. E.g. the UWyo
+	 * header "72562 LBF North Platte Observations at 12Z 09 Jan 2024"
+	 * produces SoundingKey{ 72562u, 2024010912 }.
+	 */
+	struct SoundingKey
+	{
+		//! WMO station number (e.g. 72562)
+		std::uint32_t theStationId{ 0u };
+
+		//! Observation time as "yyyymmddhh" (e.g. 2024010912).
+		std::int64_t theTimeKey{ 0 };
+
+		//! Time key value associated with individual date/time components.
+		static
+		std::int64_t
+		timeKeyFor
+			( int const & year
+			, int const & month
+			, int const & day
+			, int const & hour
+			);
+
+		//! True if station id and time are both nonzero.
+		bool
+		isValid
+			() const;
+
+		//! Strict weak order by station then by time.
+		bool
+		operator<
+			( SoundingKey const & other
+			) const;
+
+		//! True if both station and time are the same.
+		bool
+		operator==
+			( SoundingKey const & other
+			) const;
+
+		//! \brief Short description of values.
+		std::string
+		infoBrief
+			() const;
+
+	}; // SoundingKey
+
+	//! \brief Collection of AirInfo samples along with station/time key.
+	struct Sounding
+	{
+		//! Station and observation time.
+		SoundingKey theKey{};
+
+		//! Station letter code (e.g. "LBF") - up to four characters.
+		std::string theStationCode{};
+
+		//! Air properties ordered by height.
+		std::map<Height, AirInfo> theAirInfoMap{};
+
+		/*! \brief Key (and station code) from UWyo sounding header line.
+		 *
+		 * Header line is of form, e.g.
+		 * "72562 LBF North Platte Observations at 12Z 09 Jan 2024".
+		 * Returns instance with invalid key if line is not a header.
+		 */
+		static
+		Sounding
+		fromUWyoHeader
+			( std::string const & headerLine
+			);
+
+		//! True if key is valid and at least two samples are present.
+		bool
+		isValid
+			() const;
+
+	}; // Sounding
+
+	/*! \brief Load all soundings present in (concatenated) UWyo text pages.
+	 *
+	 * Each sounding begins with an "... Observations at ..." header line
+	 * and is followed by data records in the same format as handled by
+	 * airInfoFromUWyoSounding(). Data records preceeding the first
+	 * header are ignored.
+	 */
+	std::vector<Sounding>
+	soundingsFromUWyo
+		( std::istream & istrm
+		);
+
+	//! \brief Load all soundings present in UWyo data page file.
+	std::vector<Sounding>
+	soundingsFromUWyo
+		( std::filesystem::path const & inPath
+		);
+
+	/*! \brief Write soundings into an indexed binary archive file.
+	 *
+	 * Soundings are sorted by key in the archive index. If the same key
+	 * occurs more than once, the last occurrence is retained. Invalid
+	 * soundings are skipped. Returns true on successful write.
+	 */
+	bool
+	saveAirArchive
+		( std::filesystem::path const & outPath
+		, std::vector<Sounding> const & soundings
+		);
+
+
+	//! \brief Index record (on disk) describing one archived profile.
+	struct ArchiveEntry
+	{
+		std::uint32_t theStationId; //!< SoundingKey::theStationId
+		char theStationCode[4]; //!< Station code (not null terminated)
+		std::int64_t theTimeKey; //!< SoundingKey::theTimeKey
+		std::uint64_t theDataOffset; //!< Byte offset of column data
+		std::uint64_t theNumLevels; //!< Number of values in each column
+
+		//! Key associated with this entry.
+		SoundingKey
+		key
+			() const;
+
+		//! Station code as a string (trailing nulls removed).
+		std::string
+		stationCode
+			() const;
+	};
+
+	static_assert(32u == sizeof(ArchiveEntry), "ArchiveEntry must pack");
+
+	//! \brief Columnar (zero-copy) view into an archived profile.
+	struct ProfileView
+	{
+		std::size_t theNumLevels{ 0u }; //!< Number of values per column
+		double const * theHighs{ nullptr }; //!< Heights [m]
+		double const * theTemps{ nullptr }; //!< Temperatures [K]
+		double const * thePress{ nullptr }; //!< Pressures [Pa]
+		double const * theRelHs{ nullptr }; //!< Relative humidity [-]
+
+		//! True if view refers to (at least) two levels of data.
+		bool
+		isValid
+			() const;
+
+		//! AirInfo for data level ndx (null if ndx is out of range).
+		AirInfo
+		airInfoAt
+			( std::size_t const & ndx
+			) const;
+
+		//! Interpolation wrapper containing (a copy of) the viewed data.
+		AirProfile
+		airProfile
+			() const;
+	};
+
+	/*! \brief Memory-mapped reader for archive produced by saveAirArchive().
+	 *
+	 * Opening the archive maps the file and validates the header and
+	 * index. Profile data are only paged in as they are accessed.
+	 *
+	 * \note The instance is not copyable (it owns the mapping). Views
+	 * returned by profileViewFor() are valid only while the archive
+	 * instance exists.
+	 */
+	class AirArchive
+	{
+		void const * theMapAddr{ nullptr };
+		std::size_t theMapSize{ 0u };
+		ArchiveEntry const * theEntries{ nullptr };
+		std::size_t theNumEntries{ 0u };
+
+	public:
+
+		//! Map archive file into memory (check isValid() for success).
+		explicit
+		AirArchive
+			( std::filesystem::path const & archivePath
+			);
+
+		//! Release the mapping
+		~AirArchive
+			();
+
+		AirArchive(AirArchive const &) = delete;
+		AirArchive & operator=(AirArchive const &) = delete;
+
+		//! True if archive was successfully mapped and index is consistent.
+		bool
+		isValid
+			() const;
+
+		//! Number of profiles present in archive.
+		std::size_t
+		size
+			() const;
+
+		//! Index entry (in key order) for ndx < size().
+		ArchiveEntry const &
+		entryAt
+			( std::size_t const & ndx
+			) const;
+
+		//! Pointer to entry matching key (nullptr if not present).
+		ArchiveEntry const *
+		entryFor
+			( SoundingKey const & key
+			) const;
+
+		//! Columnar view of profile data (invalid view if key not present)
+		ProfileView
+		profileViewFor
+			( SoundingKey const & key
+			) const;
+
+		//! Interpolation wrapper for profile (invalid if key not present).
+		AirProfile
+		airProfileFor
+			( SoundingKey const & key
+			) const;
+
+		//! \brief Description of archive contents.
+		std::string
+		infoString
+			( std::string const & title = {}
+			) const;
+
+	}; // AirArchive
+
+
+} // [env]
+} // [aply]
+
+
+#endif // aply_env_AirArchive_INCL_
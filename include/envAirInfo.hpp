@@ -65,6 +65,33 @@ namespace env
 			return (1. + refractivity);
 		}
 
+		/*! \brief Ratio of group to phase refractivity, (ng-1)/(n-1).
+		 *
+		 * Uses the dispersion of the Barrell and Sears (1939) formula
+		 * for dry air, N = A + B/lambda^2 + C/lambda^4, for which the
+		 * group refractivity, N - lambda*dN/dlambda, is
+		 * A + 3B/lambda^2 + 5C/lambda^4. The ratio is (to good
+		 * approximation) independent of pressure and temperature, and
+		 * so applies to refractivity from any air model (e.g. to
+		 * convert optical path length to group path length).
+		 */
+		inline
+		double
+		groupRatio
+			( double const & wavelengthMicrons
+			)
+		{
+			constexpr double cA{ 287.604 };
+			constexpr double cB{ 1.6288 };
+			constexpr double cC{ .0136 };
+			double const invLamSq
+				{ 1. / (wavelengthMicrons * wavelengthMicrons) };
+			double const phase{ cA + invLamSq * (cB + invLamSq * cC) };
+			double const group
+				{ cA + invLamSq * (3.*cB + invLamSq * (5.*cC)) };
+			return (group / phase);
+		}
+
 	} // [ior]
 
 	//! \brief Simple container for air property values.
@@ -138,8 +165,11 @@ namespace env
 	 *
 	 * Data (most likely) taken from Gyer's 1996 PE&RS paper on refraction.
 	 * Gyer (ref 'gyer1996:AtmRefraction' entry in theory/Papers.bib).
+	 *
+	 * Tabulated (reference) values only up to 26 km. The analytic model
+	 * in envCoesa1976.hpp (ref coesa::airProfile()) is used as default.
 	 */
-	std::map<double, AirInfo> const sAirInfoCoesa1976
+	inline std::map<double, AirInfo> const sAirInfoCoesa1976
 		{ //           [m]     [K]   [Pa]
 		  { -1000., AirInfo{ -1000.0, 294.66, 113930. } }
 		, {     0., AirInfo{     0.0, 288.16, 101325. } }
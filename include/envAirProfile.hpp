@@ -36,13 +36,48 @@
 
 #include "envAirInfo.hpp"
 
+#include <cstddef>
+#include <vector>
+
 
 namespace aply
 {
 namespace env
 {
 
+/*! \brief Analytic air property source (e.g. env::coesa::sAirModel).
+ *
+ * Plain function pointers (no state) such that instances can be
+ * constexpr data (with no static initialization).
+ */
+struct AirModel
+{
+	//! AirInfo values at height (null if not modeled).
+	AirInfo(*theAirInfoFunc)(double const & height){ nullptr };
+
+	//! Index of refraction at height (null if not modeled).
+	double(*theIoRFunc)(double const & height){ nullptr };
+
+	//! Heights at which model derivatives are discontinuous (ascending).
+	double const * theBreakHeights{ nullptr };
+
+	//! Number of values in theBreakHeights.
+	std::size_t theNumBreaks{ 0u };
+
+	//! True if model functions are available.
+	inline
+	bool
+	isValid
+		() const
+	{
+		return ((nullptr != theAirInfoFunc) && (nullptr != theIoRFunc));
+	}
+};
+
 /*! \brief Wrapper to interpolate AirInfo data from (ordered) collections.
+ *
+ * If theAirModel is valid, it is evaluated directly and theAirInfoMap
+ * is not used.
 */
 
 struct AirProfile
@@ -50,6 +85,9 @@ struct AirProfile
 	//! Collection of AirInfo properties ordered by height above ground.
 	std::map<Height, AirInfo> theAirInfoMap{};
 
+	//! Analytic model (used instead of theAirInfoMap if valid).
+	AirModel theAirModel{};
+
 	//! AirInfo values interpolated at given high above ground (elevation).
 	AirInfo
 	airInfoAtHeight
@@ -62,7 +100,12 @@ struct AirProfile
 		( double const & height
 		) const;
 
-	//! True if theAirInfoMap has at least two entries (needed to interpolate).
+	//! Heights at which profile values (may) have derivative changes.
+	std::vector<Height>
+	breakHeights
+		() const;
+
+	//! True if theAirModel is valid or theAirInfoMap has two+ entries.
 	bool
 	isValid
 		() const;
@@ -0,0 +1,145 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_env_AutoDiffVolume_INCL_
+#define aply_env_AutoDiffVolume_INCL_
+
+/*! \file
+ *
+ * \brief IndexVolume with gradient by forward automatic differentiation.
+ *
+ */
+
+
+#include "envIndexVolume.hpp"
+#include "mathDual.hpp"
+
+#include <Engabra>
+
+#include <memory>
+#include <utility>
+
+
+namespace aply
+{
+namespace env
+{
+	/*! \brief IndexVolume base providing exact gradients (via math::Dual).
+	 *
+	 * The (CRTP) Model class derives from AutoDiffVolume<Model> and
+	 * provides a single IoR expression written generically over the
+	 * scalar type:
+	 * \code
+	 * template <typename Scalar>
+	 * Scalar
+	 * nuValueOf
+	 * 	( math::Vec3<Scalar> const & rVec
+	 * 	) const;
+	 * \endcode
+	 *
+	 * This class then implements:
+	 * \arg nuValue() - by evaluating nuValueOf<double>().
+	 * \arg nuGradient() - by evaluating nuValueOf<math::Dual>() once.
+	 * \arg nuValueAndGradient() - from the same single evaluation.
+	 *
+	 * The gradient is exact (to roundoff) and does not depend on the
+	 * stepSize argument (which is ignored). This replaces the six extra
+	 * nuValue() evaluations of the default finite difference gradient.
+	 *
+	 * \note Media with discontinuous IoR (e.g. piecewise constant
+	 * slabs or lenses) have zero gradient almost everywhere. Ray
+	 * propagation through such media relies on the finite difference
+	 * gradient "seeing" the interface, so those should continue to use
+	 * the IndexVolume::nuGradient() default.
+	 *
+	 * Example:
+	 * \snippet test_AutoDiffVolume.cpp DoxyExample02
+	 */
+	template <typename Model>
+	struct AutoDiffVolume : public IndexVolume
+	{
+		//! \brief Construct media IoR volume (clipped by ActiveVolume)
+		inline
+		explicit
+		AutoDiffVolume
+			( std::shared_ptr<ActiveVolume> const & ptVolume = sPtAllSpace
+			)
+			: IndexVolume(ptVolume)
+		{ }
+
+		//! Index of refraction value from Model::nuValueOf<double>().
+		inline
+		virtual
+		double
+		nuValue
+			( Vector const & rVec
+			) const
+		{
+			return model().nuValueOf(math::vec3Of(rVec));
+		}
+
+		//! Exact gradient from Model::nuValueOf<math::Dual>().
+		inline
+		virtual
+		Vector
+		nuGradient
+			( Vector const & rVec
+			, double const & // stepSize - not used
+			) const
+		{
+			math::Dual const nu{ model().nuValueOf(math::dualVec3Of(rVec)) };
+			return nu.gradient();
+		}
+
+		//! Value and exact gradient from one Model::nuValueOf<math::Dual>().
+		inline
+		virtual
+		std::pair<double, Vector>
+		nuValueAndGradient
+			( Vector const & rVec
+			, double const & // stepSize - not used
+			) const
+		{
+			math::Dual const nu{ model().nuValueOf(math::dualVec3Of(rVec)) };
+			return { nu.theValue, nu.gradient() };
+		}
+
+	private:
+
+		//! Derived class instance
+		inline
+		Model const &
+		model
+			() const
+		{
+			return static_cast<Model const &>(*this);
+		}
+
+	}; // AutoDiffVolume
+
+} // [env]
+} // [aply]
+
+#endif // aply_env_AutoDiffVolume_INCL_
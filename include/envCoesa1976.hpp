@@ -0,0 +1,356 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_env_Coesa1976_INCL_
+#define aply_env_Coesa1976_INCL_
+
+/*! \file
+ *
+ * \brief Analytic (layered) US Standard Atmosphere 1976 model.
+ *
+ */
+
+
+#include "envAirProfile.hpp"
+#include "envIndexVolume.hpp"
+#include "envPlanet.hpp"
+
+#include <Engabra>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+
+namespace aply
+{
+namespace env
+{
+
+/*! \brief US Standard Atmosphere 1976 (COESA) computed from layer formulas.
+ *
+ * Temperature is piecewise linear in geopotential height (layers with
+ * constant lapse rate). Pressure follows from hydrostatic equilibrium
+ * within each layer, i.e. with T = Tb + L*(H-Hb):
+ * \code
+ * P = Pb * (Tb/T)^(g0*M/(R*L))         // L != 0
+ * P = Pb * exp(-g0*M*(H-Hb)/(R*Tb))    // L == 0
+ * \endcode
+ *
+ * The index of refraction, n(h), is computed from P and T with the same
+ * Bomford expression used by AirInfo (ref ior::bomford()). The vertical
+ * derivative, dn/dh, is evaluated in closed form from the same layer
+ * expressions.
+ *
+ * All data are constexpr (no static initialization) and evaluation
+ * uses a short linear search of the layer table (no map lookup). The
+ * model is valid for geometric heights from -5 km to 86 km. Values
+ * are null outside this range.
+ *
+ * The model may be used:
+ * \arg as an AirProfile source, ref coesa::airProfile().
+ * \arg as a (spherically symmetric) IndexVolume, ref coesa::AirVolume.
+ */
+namespace coesa
+{
+	//! \brief Parameters defining one atmospheric layer.
+	struct Layer
+	{
+		//! Geopotential height of layer base [m'].
+		double theBaseGeoHigh;
+
+		//! Temperature at layer base [K].
+		double theBaseTemp;
+
+		//! Temperature lapse rate dT/dH [K/m'].
+		double theLapseRate;
+
+		//! Pressure at layer base [Pa].
+		double theBasePres;
+	};
+
+	/*! \brief Layer parameters (up to geopotential height of 84852 m').
+	 *
+	 * Base pressures are carried to full precision (i.e. evaluated
+	 * from the layer below) so that values are continuous at the layer
+	 * boundaries. (Published tables round these to about 7 digits).
+	 */
+	constexpr std::array<Layer, 7u> sLayers
+		{{ //      [m']      [K]    [K/m']        [Pa]
+		   {     0.,  288.15,  -.0065,  101325.              }
+		 , { 11000.,  216.65,   .0,      22632.063973462926  }
+		 , { 20000.,  216.65,   .001,     5474.888669677778  }
+		 , { 32000.,  228.65,   .0028,     868.0186847552288 }
+		 , { 47000.,  270.65,   .0,        110.90630555496605}
+		 , { 51000.,  270.65,  -.0028,      66.93887311868737}
+		 , { 71000.,  214.65,  -.002,        3.9564204280407327}
+		}};
+
+	//! Effective Earth radius for geopotential conversion [m].
+	constexpr double sRadGeoPot{ 6356766. };
+
+	//! Hydrostatic constant g0*M0/R* [K/m'].
+	constexpr double sGravMolOverGas{ 0.03416319473631036 };
+
+	//! Lowest geometric height of model [m].
+	constexpr double sMinHeight{ -5000. };
+
+	//! Highest geometric height of model [m].
+	constexpr double sMaxHeight{ 86000. };
+
+	//! Geopotential height [m'] for geometric height [m].
+	constexpr
+	double
+	geoPotHeightFor
+		( double const & height
+		)
+	{
+		return (sRadGeoPot * height) / (sRadGeoPot + height);
+	}
+
+	//! Geometric height [m] for geopotential height [m'].
+	constexpr
+	double
+	heightForGeoPot
+		( double const & geoHigh
+		)
+	{
+		return (sRadGeoPot * geoHigh) / (sRadGeoPot - geoHigh);
+	}
+
+	//! Geometric heights of layer boundaries (lapse rate changes) [m].
+	constexpr std::array<double, 6u> sBreakHeights
+		{ heightForGeoPot(sLayers[1].theBaseGeoHigh)
+		, heightForGeoPot(sLayers[2].theBaseGeoHigh)
+		, heightForGeoPot(sLayers[3].theBaseGeoHigh)
+		, heightForGeoPot(sLayers[4].theBaseGeoHigh)
+		, heightForGeoPot(sLayers[5].theBaseGeoHigh)
+		, heightForGeoPot(sLayers[6].theBaseGeoHigh)
+		};
+
+	//! Index into sLayers of the layer containing geoHigh.
+	constexpr
+	std::size_t
+	layerIndexFor
+		( double const & geoHigh
+		)
+	{
+		std::size_t ndx{ 0u };
+		while ( ((ndx + 1u) < sLayers.size())
+			 && (! (geoHigh < sLayers[ndx + 1u].theBaseGeoHigh))
+			  )
+		{
+			++ndx;
+		}
+		return ndx;
+	}
+
+	//! True if height is within range of model.
+	constexpr
+	bool
+	isInRange
+		( double const & height
+		)
+	{
+		return ((! (height < sMinHeight)) && (! (sMaxHeight < height)));
+	}
+
+	/*! \brief Temperature [K] and pressure [Pa] at geometric height [m].
+	 *
+	 * Null values if height is outside model range.
+	 */
+	inline
+	std::pair<double, double>
+	tempPresAt
+		( double const & height
+		)
+	{
+		std::pair<double, double> tempPres
+			{ engabra::g3::null<double>(), engabra::g3::null<double>() };
+		if (isInRange(height))
+		{
+			double const geoHigh{ geoPotHeightFor(height) };
+			Layer const & layer = sLayers[layerIndexFor(geoHigh)];
+			double const delGeo{ geoHigh - layer.theBaseGeoHigh };
+			double const temp
+				{ layer.theBaseTemp + layer.theLapseRate * delGeo };
+			double pres{ layer.theBasePres };
+			if (0. == layer.theLapseRate)
+			{
+				pres *= std::exp(-sGravMolOverGas * delGeo / layer.theBaseTemp);
+			}
+			else
+			{
+				double const expo{ sGravMolOverGas / layer.theLapseRate };
+				pres *= std::pow(layer.theBaseTemp / temp, expo);
+			}
+			tempPres = std::make_pair(temp, pres);
+		}
+		return tempPres;
+	}
+
+	//! AirInfo values (temperature, pressure) at geometric height [m].
+	inline
+	AirInfo
+	airInfoAt
+		( double const & height
+		)
+	{
+		std::pair<double, double> const tempPres{ tempPresAt(height) };
+		return AirInfo{ height, tempPres.first, tempPres.second };
+	}
+
+	//! Index of refraction at geometric height [m].
+	inline
+	double
+	indexOfRefraction
+		( double const & height
+		)
+	{
+		std::pair<double, double> const tempPres{ tempPresAt(height) };
+		return ior::bomford(tempPres.second, tempPres.first);
+	}
+
+	/*! \brief Vertical gradient, dn/dh, of index of refraction [1/m].
+	 *
+	 * With refractivity N = (n-1) proportional to P/T, and with the
+	 * hydrostatic relation dP/dH = -(g0*M/R)*P/T, the derivative with
+	 * respect to geometric height is
+	 * \code
+	 * dn/dh = -N * ((g0*M/R) + L) / T * (dH/dh)
+	 * \endcode
+	 * where dH/dh = (r0/(r0+h))^2.
+	 */
+	inline
+	double
+	indexGradient
+		( double const & height
+		)
+	{
+		double grad{ engabra::g3::null<double>() };
+		if (isInRange(height))
+		{
+			std::pair<double, double> const tempPres{ tempPresAt(height) };
+			double const & temp = tempPres.first;
+			double const refractivity
+				{ ior::bomford(tempPres.second, temp) - 1. };
+			double const geoHigh{ geoPotHeightFor(height) };
+			double const lapse{ sLayers[layerIndexFor(geoHigh)].theLapseRate };
+			double const radRatio{ sRadGeoPot / (sRadGeoPot + height) };
+			grad = -refractivity * ((sGravMolOverGas + lapse) / temp)
+				* (radRatio * radRatio);
+		}
+		return grad;
+	}
+
+	//! AirProfile source (ref AirProfile::theAirModel) for this model.
+	constexpr AirModel sAirModel
+		{ &airInfoAt
+		, &indexOfRefraction
+		, sBreakHeights.data()
+		, sBreakHeights.size()
+		};
+
+	//! AirProfile evaluating this model (no interpolation table).
+	inline
+	AirProfile
+	airProfile
+		()
+	{
+		return AirProfile{ {}, sAirModel };
+	}
+
+	/*! \brief Spherically symmetric IoR volume for the COESA atmosphere.
+	 *
+	 * Index of refraction at location rVec is that of the model at
+	 * height (magnitude(rVec) - radiusEarth). The gradient is evaluated
+	 * analytically (in the radial direction).
+	 */
+	struct AirVolume : public env::IndexVolume
+	{
+		//! Distance from origin at which model height is zero.
+		double const theRadiusEarth{ engabra::g3::null<double>() };
+
+		//! Construct for given Earth radius (clipped by ActiveVolume)
+		inline
+		explicit
+		AirVolume
+			( double const & radiusEarth = sEarth.theRadGround
+			, std::shared_ptr<ActiveVolume> const & ptVolume = sPtAllSpace
+			)
+			: env::IndexVolume(ptVolume)
+			, theRadiusEarth{ radiusEarth }
+		{ }
+
+		//! Index of refraction value at vector location rVec
+		inline
+		virtual
+		double
+		nuValue
+			( Vector const & rVec
+			) const
+		{
+			return indexOfRefraction(magnitude(rVec) - theRadiusEarth);
+		}
+
+		//! Analytic gradient (stepSize is not used).
+		inline
+		virtual
+		Vector
+		nuGradient
+			( Vector const & rVec
+			, double const & // stepSize
+			) const
+		{
+			double const rMag{ magnitude(rVec) };
+			double const dNuDh{ indexGradient(rMag - theRadiusEarth) };
+			return (dNuDh / rMag) * rVec;
+		}
+
+		//! Value and analytic gradient (sharing height computation).
+		inline
+		virtual
+		std::pair<double, Vector>
+		nuValueAndGradient
+			( Vector const & rVec
+			, double const & // stepSize
+			) const
+		{
+			double const rMag{ magnitude(rVec) };
+			double const height{ rMag - theRadiusEarth };
+			double const dNuDh{ indexGradient(height) };
+			return { indexOfRefraction(height), (dNuDh / rMag) * rVec };
+		}
+
+	}; // AirVolume
+
+} // [coesa]
+
+} // [env]
+} // [aply]
+
+#endif // aply_env_Coesa1976_INCL_
@@ -0,0 +1,359 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_env_IndexGrid_INCL_
+#define aply_env_IndexGrid_INCL_
+
+/*! \file
+ *
+ * \brief IndexVolume with IoR values sampled on a regular grid.
+ *
+ */
+
+
+#include "envIndexVolume.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace aply
+{
+namespace env
+{
+	/*! \brief IoR values at the nodes of a regular (cubic cell) grid.
+	 *
+	 * The nuValue() is the trilinear interpolation of the node values
+	 * (null outside of the grid) and nuGradient() is the (exact)
+	 * gradient of that interpolation.
+	 *
+	 * For cell by cell propagation (ref ray::GridPropagator), each cell
+	 * is also described by a linear model (ref cellNuAndGradient())
+	 * comprising the interpolated value and gradient at the cell center.
+	 */
+	struct IndexGrid : public IndexVolume
+	{
+		//! Index (along each axis) of a grid cell (or node).
+		using Cell = std::array<std::size_t, 3u>;
+
+		//! Location of grid node [0,0,0] (minimum corner).
+		Vector const theOrigin{ null<Vector>() };
+
+		//! Distance between adjacent nodes (along each axis).
+		double const theDelta{ null<double>() };
+
+		//! Number of nodes along each axis (two or more each if valid).
+		std::array<std::size_t, 3u> const theNumNodes{ 0u, 0u, 0u };
+
+		//! IoR value at each node (x index varies fastest).
+		std::vector<double> const theNus{};
+
+		//! Construct from node values (e.g. from a numeric model).
+		inline
+		explicit
+		IndexGrid
+			( Vector const & origin
+			, double const & delta
+			, std::array<std::size_t, 3u> const & numNodes
+			, std::vector<double> const & nus
+			, std::shared_ptr<ActiveVolume> const & ptVolume = sPtAllSpace
+			)
+			: IndexVolume(ptVolume)
+			, theOrigin{ origin }
+			, theDelta{ delta }
+			, theNumNodes{ numNodes }
+			, theNus{ nus }
+		{ }
+
+		//! Grid with node values sampled from (qualified) media IoR.
+		inline
+		static
+		IndexGrid
+		sampled
+			( IndexVolume const & media
+			, Vector const & origin
+			, double const & delta
+			, std::array<std::size_t, 3u> const & numNodes
+			)
+		{
+			std::vector<double> nus;
+			nus.reserve(numNodes[0] * numNodes[1] * numNodes[2]);
+			for (std::size_t iz{0u} ; iz < numNodes[2] ; ++iz)
+			{
+				for (std::size_t iy{0u} ; iy < numNodes[1] ; ++iy)
+				{
+					for (std::size_t ix{0u} ; ix < numNodes[0] ; ++ix)
+					{
+						Vector const rNode
+							{ origin + delta * Vector
+								{ static_cast<double>(ix)
+								, static_cast<double>(iy)
+								, static_cast<double>(iz)
+								}
+							};
+						nus.emplace_back(media.qualifiedNuValue(rNode));
+					}
+				}
+			}
+			return IndexGrid(origin, delta, numNodes, nus);
+		}
+
+		//! True if instance is valid
+		inline
+		bool
+		isValid
+			() const
+		{
+			return
+				(  engabra::g3::isValid(theOrigin)
+				&& (0. < theDelta)
+				&& (1u < theNumNodes[0])
+				&& (1u < theNumNodes[1])
+				&& (1u < theNumNodes[2])
+				&& (theNus.size()
+					== (theNumNodes[0] * theNumNodes[1] * theNumNodes[2]))
+				);
+		}
+
+		//! Value indicating a location outside of the grid.
+		inline
+		static
+		Cell
+		nullCell
+			()
+		{
+			constexpr std::size_t bad
+				{ std::numeric_limits<std::size_t>::max() };
+			return Cell{ bad, bad, bad };
+		}
+
+		//! True if cell is within the grid
+		inline
+		bool
+		isCell
+			( Cell const & cell
+			) const
+		{
+			// (first test excludes overflow, e.g. of nullCell() values)
+			return
+				(  (cell[0] < theNumNodes[0])
+				&& (cell[1] < theNumNodes[1])
+				&& (cell[2] < theNumNodes[2])
+				&& ((cell[0] + 1u) < theNumNodes[0])
+				&& ((cell[1] + 1u) < theNumNodes[1])
+				&& ((cell[2] + 1u) < theNumNodes[2])
+				);
+		}
+
+		//! Cell containing location (or nullCell() if outside grid)
+		inline
+		Cell
+		cellFor
+			( Vector const & rVec
+			) const
+		{
+			Cell cell{ nullCell() };
+			if (isValid())
+			{
+				bool isIn{ true };
+				Cell tmp{};
+				for (std::size_t ax{0u} ; isIn && (ax < 3u) ; ++ax)
+				{
+					double const last
+						{ static_cast<double>(theNumNodes[ax] - 1u) };
+					double const frac{ (rVec[ax] - theOrigin[ax]) / theDelta };
+					isIn = ((! (frac < 0.)) && (! (last < frac)));
+					if (isIn)
+					{
+						// upper grid face belongs to the last cell
+						std::size_t const ndx{ static_cast<std::size_t>(frac) };
+						tmp[ax] = std::min(ndx, theNumNodes[ax] - 2u);
+					}
+				}
+				if (isIn)
+				{
+					cell = tmp;
+				}
+			}
+			return cell;
+		}
+
+		//! Location of cell minimum corner (node with same index)
+		inline
+		Vector
+		cellMinCorner
+			( Cell const & cell
+			) const
+		{
+			return
+				( theOrigin
+				+ theDelta * Vector
+					{ static_cast<double>(cell[0])
+					, static_cast<double>(cell[1])
+					, static_cast<double>(cell[2])
+					}
+				);
+		}
+
+		//! IoR value at grid node
+		inline
+		double
+		nodeNu
+			( std::size_t const & ix
+			, std::size_t const & iy
+			, std::size_t const & iz
+			) const
+		{
+			return theNus[ix + theNumNodes[0]*(iy + theNumNodes[1]*iz)];
+		}
+
+		//! Trilinear interpolation value and gradient in cell at fracs
+		inline
+		std::pair<double, Vector>
+		cellNuAndGradientAt
+			( Cell const & cell
+			, std::array<double, 3u> const & fracs
+				//!< Location within cell (each in [0,1])
+			) const
+		{
+			double nu{ 0. };
+			std::array<double, 3u> grad{ 0., 0., 0. };
+			for (std::size_t corner{0u} ; corner < 8u ; ++corner)
+			{
+				// corner offset (0 or 1) along each axis
+				std::array<std::size_t, 3u> const offs
+					{ (corner & 1u)
+					, ((corner >> 1u) & 1u)
+					, ((corner >> 2u) & 1u)
+					};
+				std::array<double, 3u> wts{};
+				std::array<double, 3u> dWts{};
+				for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+				{
+					wts[ax] = (0u == offs[ax]) ? (1. - fracs[ax]) : fracs[ax];
+					dWts[ax] = (0u == offs[ax]) ? -1. : 1.;
+				}
+				double const cornerNu
+					{ nodeNu
+						( cell[0] + offs[0]
+						, cell[1] + offs[1]
+						, cell[2] + offs[2]
+						)
+					};
+				nu += cornerNu * wts[0] * wts[1] * wts[2];
+				grad[0] += cornerNu * dWts[0] * wts[1] * wts[2];
+				grad[1] += cornerNu * wts[0] * dWts[1] * wts[2];
+				grad[2] += cornerNu * wts[0] * wts[1] * dWts[2];
+			}
+			double const scl{ 1. / theDelta };
+			return { nu, Vector{ scl*grad[0], scl*grad[1], scl*grad[2] } };
+		}
+
+		/*! \brief Linear model for cell: value and gradient at its center.
+		 *
+		 * The gradient is the average (over the cell) of the trilinear
+		 * interpolation gradient.
+		 */
+		inline
+		std::pair<double, Vector>
+		cellNuAndGradient
+			( Cell const & cell
+			) const
+		{
+			return cellNuAndGradientAt(cell, { .5, .5, .5 });
+		}
+
+		//! Trilinear interpolation value and gradient (null if outside).
+		inline
+		std::pair<double, Vector>
+		gridNuAndGradient
+			( Vector const & rVec
+			) const
+		{
+			std::pair<double, Vector> nuGrad{ null<double>(), null<Vector>() };
+			Cell const cell{ cellFor(rVec) };
+			if (isCell(cell))
+			{
+				Vector const rMin{ cellMinCorner(cell) };
+				std::array<double, 3u> const fracs
+					{ (rVec[0] - rMin[0]) / theDelta
+					, (rVec[1] - rMin[1]) / theDelta
+					, (rVec[2] - rMin[2]) / theDelta
+					};
+				nuGrad = cellNuAndGradientAt(cell, fracs);
+			}
+			return nuGrad;
+		}
+
+		//! Trilinear interpolation of node values (null outside of grid)
+		inline
+		virtual
+		double
+		nuValue
+			( Vector const & rVec
+			) const
+		{
+			return gridNuAndGradient(rVec).first;
+		}
+
+		//! Gradient of trilinear interpolation (stepSize is not used)
+		inline
+		virtual
+		Vector
+		nuGradient
+			( Vector const & rVec
+			, double const & // stepSize
+			) const
+		{
+			return gridNuAndGradient(rVec).second;
+		}
+
+		//! Value and gradient from the same interpolation
+		inline
+		virtual
+		std::pair<double, Vector>
+		nuValueAndGradient
+			( Vector const & rVec
+			, double const & // stepSize
+			) const
+		{
+			return gridNuAndGradient(rVec);
+		}
+
+	}; // IndexGrid
+
+} // [env]
+} // [aply]
+
+#endif // aply_env_IndexGrid_INCL_
+
@@ -37,6 +37,7 @@
 #include <Engabra>
 
 #include <memory>
+#include <utility>
 
 
 namespace aply
@@ -102,6 +103,27 @@ namespace env
 			return nu;
 		}
 
+		/*! \brief Value (null if outside thePtVolume) and gradient at rVec.
+		 *
+		 * Qualified (ref qualifiedNuValue()) version of
+		 * nuValueAndGradient().
+		 */
+		inline
+		std::pair<double, Vector>
+		qualifiedNuValueAndGradient
+			( Vector const & rVec
+			, double const & stepSize
+			) const
+		{
+			std::pair<double, Vector> nuGrad
+				{ nuValueAndGradient(rVec, stepSize) };
+			if (! thePtVolume->contains(rVec))
+			{
+				nuGrad.first = null<double>(); // default to stop condition
+			}
+			return nuGrad;
+		}
+
 		/*! \brief Index of refraction value at vector location rVec.
 		 *
 	 	 * Note: return nuValue = null<double>() to indicate the edges
@@ -138,6 +160,25 @@ namespace env
 				};
 		}
 
+		/*! \brief Index of refraction value and gradient at rVec.
+		 *
+		 * Default implementation calls nuValue() and nuGradient().
+		 * Derived classes may override this to share computations
+		 * (e.g. distance to a shape) between value and gradient.
+		 */
+		inline
+		virtual
+		std::pair<double, Vector>
+		nuValueAndGradient
+			( Vector const & rVec
+				//!< Location at which to evaluate
+			, double const & stepSize
+				//!< Step size passed to nuGradient()
+			) const
+		{
+			return { nuValue(rVec), nuGradient(rVec, stepSize) };
+		}
+
 	}; // IndexVolume
 
 } // [env]
@@ -0,0 +1,118 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_Crossing_INCL_
+#define aply_math_Crossing_INCL_
+
+/*! \file
+\brief Declarations for math::crossingParameter()
+*/
+
+
+#include <cmath>
+#include <limits>
+
+
+namespace aply
+{
+namespace math
+{
+
+	/*! \brief Smallest parameter at which uniform acceleration spans gap.
+	 *
+	 * Returns the smallest positive sigma for which
+	 * \verbatim
+	 *   (accel/4)*sigma^2 + rate*sigma == gap
+	 * \endverbatim
+	 * This is the ray parameter at which a path, with location
+	 * r(sigma) = r0 + p0*sigma + (G/4)*sigma^2 (e.g. a ray in media for
+	 * which nu^2 is linear with gradient G), reaches a boundary plane
+	 * when:
+	 * \arg gap: (non negative) distance from r0 to the boundary
+	 * \arg rate: component of p0 toward the boundary
+	 * \arg accel: component of G toward the boundary
+	 *
+	 * A path on the boundary (gap==0) crosses it immediately (zero is
+	 * returned) if it is moving (or accelerating) toward the boundary.
+	 * Returns infinity if the path never reaches the boundary.
+	 */
+	inline
+	double
+	crossingParameter
+		( double const & gap
+		, double const & rate
+		, double const & accel
+		)
+	{
+		constexpr double never{ std::numeric_limits<double>::infinity() };
+		double sigma{ never };
+		if ((0. == gap) && ((0. < rate) || ((0. == rate) && (0. < accel))))
+		{
+			sigma = 0.;
+		}
+		else
+		{
+			double const aa{ .25 * accel };
+			double const & bb = rate;
+			double const cc{ -gap };
+			double roots[2]{ never, never };
+			if (0. == aa)
+			{
+				if (0. != bb)
+				{
+					roots[0] = -cc / bb;
+				}
+			}
+			else
+			{
+				double const disc{ bb*bb - 4.*aa*cc };
+				if (! (disc < 0.))
+				{
+					// numerically stable roots
+					double const sqrtDisc{ std::sqrt(disc) };
+					double const qq{ -.5 * (bb + std::copysign(sqrtDisc, bb)) };
+					if (0. != qq)
+					{
+						roots[0] = qq / aa;
+						roots[1] = cc / qq;
+					}
+				}
+			}
+			for (double const & root : roots)
+			{
+				if ((0. < root) && (root < sigma))
+				{
+					sigma = root;
+				}
+			}
+		}
+		return sigma;
+	}
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_Crossing_INCL_
+
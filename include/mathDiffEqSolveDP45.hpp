@@ -0,0 +1,638 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_DiffEqSolveDP45_INCL_
+#define aply_math_DiffEqSolveDP45_INCL_
+
+/*! \file
+\brief Declarations for math::DiffEqSolveDP45
+*/
+
+
+#include "mathDiffEqSystemArray.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+
+namespace aply
+{
+namespace math
+{
+
+	//! \brief Work counters reported by adaptive solvers.
+	struct DiffEqStats
+	{
+		//! Number of steps that satisfied the error tolerance.
+		std::size_t theNumAccept{ 0u };
+
+		//! Number of steps rejected (and repeated with smaller size).
+		std::size_t theNumReject{ 0u };
+
+		//! Number of System::operator() evaluations.
+		std::size_t theNumEval{ 0u };
+	};
+
+	/*! \brief Continuous (dense output) interpolant for one accepted step.
+	 *
+	 * Coefficients are those of Hairer, Norsett and Wanner (Solving
+	 * Ordinary Differential Equations I, Sec II.6, "contd5") such that
+	 * for theta=(x-theBeg)/theDel the interpolated values are
+	 * \code
+	 * y(x) = r1 + theta*(r2 + (1-theta)*(r3 + theta*(r4 + (1-theta)*r5)))
+	 * \endcode
+	 */
+	template <std::size_t Dim>
+	struct DenseStep
+	{
+		//! Independent value at start of step.
+		double theBeg;
+
+		//! Signed step size (such that step ends at theBeg+theDel).
+		double theDel;
+
+		//! Coefficients r1..r5 (each of dimension Dim).
+		std::array<std::array<double, Dim>, 5u> theCoefs;
+
+		//! Interpolated function values at xValue (within step).
+		inline
+		std::array<double, Dim>
+		valuesAt
+			( double const & xValue
+			) const
+		{
+			double const theta{ (xValue - theBeg) / theDel };
+			double const theta1{ 1. - theta };
+			std::array<double, Dim> values;
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				values[nn] = theCoefs[0][nn] + theta
+					* ( theCoefs[1][nn] + theta1
+					* ( theCoefs[2][nn] + theta
+					* ( theCoefs[3][nn] + theta1
+					*   theCoefs[4][nn] )));
+			}
+			return values;
+		}
+	};
+
+	/*! \brief Continuous solution over the interval covered by a solve.
+	 *
+	 * Collection of DenseStep interpolants (in order of integration).
+	 */
+	template <std::size_t Dim>
+	struct DenseSolution
+	{
+		//! Interpolants for each accepted step.
+		std::vector<DenseStep<Dim> > theSteps{};
+
+		//! True if at least one step is present.
+		inline
+		bool
+		isValid
+			() const
+		{
+			return (! theSteps.empty());
+		}
+
+		//! Solution values at xValue (null values if outside of solution).
+		inline
+		std::array<double, Dim>
+		valuesAt
+			( double const & xValue
+			) const
+		{
+			std::array<double, Dim> values;
+			values.fill(engabra::g3::null<double>());
+			if (isValid())
+			{
+				// steps are ordered in direction of integration
+				double const dir{ (theSteps.front().theDel < 0.) ? -1. : 1. };
+				double const xBeg{ theSteps.front().theBeg };
+				DenseStep<Dim> const & last = theSteps.back();
+				double const xEnd{ last.theBeg + last.theDel };
+				if ( (! (dir*(xValue - xBeg) < 0.))
+				  && (! (dir*(xEnd - xValue) < 0.))
+				   )
+				{
+					// last step starting at or before xValue
+					typename std::vector<DenseStep<Dim> >::const_iterator
+						const itNext
+						{ std::upper_bound
+							( theSteps.cbegin(), theSteps.cend(), xValue
+							, [& dir]
+								(double const & xx, DenseStep<Dim> const & step)
+								{ return (dir*xx < dir*step.theBeg); }
+							)
+						};
+					values = std::prev(itNext)->valuesAt(xValue);
+				}
+			}
+			return values;
+		}
+	};
+
+
+/*! \brief Adaptive Dormand-Prince 5(4) solver for fixed size systems.
+
+Embedded Runge-Kutta pair (Dormand and Prince, 1980) with local
+extrapolation (the 5th order solution is propagated) and error control
+on the embedded 4th order estimate. Each step is accepted when the
+scaled error norm
+
+\code
+err = sqrt( (1/Dim) * sum_i( (errEst_i / (tolAbs + tolRel*|y_i|))^2 ) )
+\endcode
+
+is not larger than 1. Otherwise the step is rejected and repeated with
+a reduced step size. New step sizes are predicted from (.9*err^(-1/5))
+limited to the range [.2, 10.] times the current step.
+
+The System type must conform to the fixed dimension interface described
+in mathDiffEqSystemArray.hpp.
+
+Solutions that cannot be obtained (e.g. step size underflow near a
+singularity or exceeding the maximum step count) are returned as null
+(ref engabra::g3::isValid()).
+
+\par Example
+\snippet test/test_DiffEqSolve.cpp DoxyExample02
+
+*/
+
+class DiffEqSolveDP45
+{
+	//! Absolute tolerance for each function value.
+	double theTolAbs;
+
+	//! Relative tolerance for each function value.
+	double theTolRel;
+
+	//! Maximum number of steps (accepted or rejected) per solution.
+	std::size_t theMaxSteps;
+
+public: // methods
+
+	//! Construct with error tolerances.
+	explicit
+	DiffEqSolveDP45
+		( double const & tolAbs = 1.e-10
+		, double const & tolRel = 1.e-10
+		, std::size_t const & maxSteps = 100000u
+		)
+		: theTolAbs{ tolAbs }
+		, theTolRel{ tolRel }
+		, theMaxSteps{ maxSteps }
+	{ }
+
+	//! Solution values at xValue (starting from system.initValues())
+	template <typename System>
+	inline
+	DiffEqValues<sDiffEqDim<System> >
+	solutionFor
+		( double const & xValue
+		, System const & system
+		, DiffEqStats * const & ptStats = nullptr
+		) const
+	{
+		DiffEqValues<sDiffEqDim<System> > const init{ system.initValues() };
+		return DiffEqValues<sDiffEqDim<System> >
+			{ xValue, valuesFrom(init, xValue, system, ptStats) };
+	}
+
+	//! Function values integrated from xyBeg to xEnd.
+	template <typename System, std::size_t Dim>
+	inline
+	std::array<double, Dim>
+	valuesFrom
+		( DiffEqValues<Dim> const & xyBeg
+		, double const & xEnd
+		, System const & system
+		, DiffEqStats * const & ptStats = nullptr
+		) const
+	{
+		// no dense output needed here
+		auto const ignoreStep{ [] (DenseStep<Dim> const &) { } };
+		return integrate(xyBeg, xEnd, system, ignoreStep, ptStats);
+	}
+
+	/*! \brief Solution values at each of xValues (in a single pass).
+	 *
+	 * Integration proceeds once from system.initValues() toward the
+	 * farthest of xValues. Values at intermediate xValues are obtained
+	 * from the dense output interpolant of the step containing them
+	 * (i.e. requested values do not alter step size selection).
+	 * Returned values are in the same order as xValues (in any order
+	 * on input). Entries for xValues on the opposite side of the start
+	 * (from the farthest one) are null.
+	 */
+	template <typename System>
+	inline
+	std::vector<DiffEqValues<sDiffEqDim<System> > >
+	solutionsAt
+		( std::vector<double> const & xValues
+		, System const & system
+		, DiffEqStats * const & ptStats = nullptr
+		) const
+	{
+		constexpr std::size_t Dim{ sDiffEqDim<System> };
+		std::vector<DiffEqValues<Dim> > solns
+			(xValues.size(), nullDiffEqValues<Dim>());
+		DiffEqValues<Dim> const init{ system.initValues() };
+		std::vector<std::size_t> const ndxs
+			{ diffEqOutputOrder(init.first, xValues) };
+		if (! ndxs.empty())
+		{
+			double const xFar{ xValues[ndxs.back()] };
+			double const dir{ (xFar < init.first) ? -1. : 1. };
+
+			// values at start point
+			std::vector<std::size_t>::const_iterator itNdx{ ndxs.cbegin() };
+			while ((ndxs.cend() != itNdx) && (xValues[*itNdx] == init.first))
+			{
+				solns[*itNdx] = init;
+				++itNdx;
+			}
+
+			// interpolate values within each step
+			auto const interpInStep
+				{ [& solns, & xValues, & itNdx, & ndxs, & dir]
+					(DenseStep<Dim> const & step)
+					{
+						double const xStepEnd{ step.theBeg + step.theDel };
+						while ( (ndxs.cend() != itNdx)
+							 && (! (dir*(xStepEnd - xValues[*itNdx]) < 0.))
+							  )
+						{
+							double const & xValue = xValues[*itNdx];
+							solns[*itNdx] = DiffEqValues<Dim>
+								{ xValue, step.valuesAt(xValue) };
+							++itNdx;
+						}
+					}
+				};
+			std::array<double, Dim> const yEnd
+				{ integrate(init, xFar, system, interpInStep, ptStats) };
+
+			// (rounding) remainders are at end point
+			if (engabra::g3::isValid(yEnd[0]))
+			{
+				for ( ; ndxs.cend() != itNdx ; ++itNdx)
+				{
+					solns[*itNdx] = DiffEqValues<Dim>{ xFar, yEnd };
+				}
+			}
+		}
+		return solns;
+	}
+
+	/*! \brief Continuous solution between system.initValues() and xValue.
+	 *
+	 * The returned DenseSolution can be evaluated at any x within the
+	 * integration interval with (approximately) the same accuracy as
+	 * that achieved at the individual step end points.
+	 */
+	template <typename System>
+	inline
+	DenseSolution<sDiffEqDim<System> >
+	denseSolutionFor
+		( double const & xValue
+		, System const & system
+		, DiffEqStats * const & ptStats = nullptr
+		) const
+	{
+		constexpr std::size_t Dim{ sDiffEqDim<System> };
+		DenseSolution<Dim> dense{};
+		auto const saveStep
+			{ [& dense] (DenseStep<Dim> const & step)
+				{ dense.theSteps.emplace_back(step); }
+			};
+		std::array<double, Dim> const yEnd
+			{ integrate(system.initValues(), xValue, system, saveStep, ptStats)
+			};
+		if (! engabra::g3::isValid(yEnd[0]))
+		{
+			dense.theSteps.clear();
+		}
+		return dense;
+	}
+
+private:
+
+	//! Scaled RMS norm of values (w.r.t. tolerance scales).
+	template <std::size_t Dim>
+	inline
+	static
+	double
+	scaledNorm
+		( std::array<double, Dim> const & values
+		, std::array<double, Dim> const & scales
+		)
+	{
+		double sumSq{ 0. };
+		for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+		{
+			double const ratio{ values[nn] / scales[nn] };
+			sumSq += ratio * ratio;
+		}
+		return std::sqrt(sumSq / static_cast<double>(Dim));
+	}
+
+	/*! \brief Starting step size (Hairer et.al. Sec II.4 algorithm).
+	 *
+	 * Uses one additional System evaluation.
+	 */
+	template <typename System, std::size_t Dim>
+	inline
+	double
+	initialStep
+		( double const & xBeg
+		, std::array<double, Dim> const & yBeg
+		, std::array<double, Dim> const & fBeg
+		, double const & xEnd
+		, System const & system
+		, DiffEqStats & stats
+		) const
+	{
+		double const span{ std::abs(xEnd - xBeg) };
+		double const dir{ (xEnd < xBeg) ? -1. : 1. };
+		std::array<double, Dim> scales;
+		for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+		{
+			scales[nn] = theTolAbs + theTolRel * std::abs(yBeg[nn]);
+		}
+		double const d0{ scaledNorm(yBeg, scales) };
+		double const d1{ scaledNorm(fBeg, scales) };
+		double h0{ 1.e-6 * span };
+		if ((1.e-10 < d0) && (1.e-10 < d1))
+		{
+			h0 = .01 * (d0 / d1);
+		}
+		h0 = std::min(h0, span);
+
+		// explicit Euler step to estimate second derivative
+		std::array<double, Dim> yTmp;
+		for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+		{
+			yTmp[nn] = yBeg[nn] + dir*h0 * fBeg[nn];
+		}
+		std::array<double, Dim> const fTmp{ system(xBeg + dir*h0, yTmp) };
+		++stats.theNumEval;
+		std::array<double, Dim> fDif;
+		for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+		{
+			fDif[nn] = fTmp[nn] - fBeg[nn];
+		}
+		double const d2{ scaledNorm(fDif, scales) / h0 };
+
+		double const dMax{ std::max(d1, d2) };
+		double h1{ std::max(1.e-6, h0 * 1.e-3) };
+		if (1.e-15 < dMax)
+		{
+			h1 = std::pow(.01 / dMax, .2);
+		}
+		return dir * std::min(std::min(100. * h0, h1), span);
+	}
+
+	//! Core integration loop (stepConsumer receives accepted steps)
+	template <typename System, std::size_t Dim, typename StepConsumer>
+	inline
+	std::array<double, Dim>
+	integrate
+		( DiffEqValues<Dim> const & xyBeg
+		, double const & xEnd
+		, System const & system
+		, StepConsumer const & stepConsumer
+		, DiffEqStats * const & ptStats
+		) const
+	{
+		using Array = std::array<double, Dim>;
+
+		// Dormand-Prince 5(4) tableau
+		constexpr double c2{ 1./5. };
+		constexpr double c3{ 3./10. };
+		constexpr double c4{ 4./5. };
+		constexpr double c5{ 8./9. };
+		constexpr double a21{ 1./5. };
+		constexpr double a31{ 3./40. };
+		constexpr double a32{ 9./40. };
+		constexpr double a41{ 44./45. };
+		constexpr double a42{ -56./15. };
+		constexpr double a43{ 32./9. };
+		constexpr double a51{ 19372./6561. };
+		constexpr double a52{ -25360./2187. };
+		constexpr double a53{ 64448./6561. };
+		constexpr double a54{ -212./729. };
+		constexpr double a61{ 9017./3168. };
+		constexpr double a62{ -355./33. };
+		constexpr double a63{ 46732./5247. };
+		constexpr double a64{ 49./176. };
+		constexpr double a65{ -5103./18656. };
+		constexpr double a71{ 35./384. };
+		constexpr double a73{ 500./1113. };
+		constexpr double a74{ 125./192. };
+		constexpr double a75{ -2187./6784. };
+		constexpr double a76{ 11./84. };
+		// error estimate weights (5th minus 4th order)
+		constexpr double e1{ 71./57600. };
+		constexpr double e3{ -71./16695. };
+		constexpr double e4{ 71./1920. };
+		constexpr double e5{ -17253./339200. };
+		constexpr double e6{ 22./525. };
+		constexpr double e7{ -1./40. };
+		// dense output weights
+		constexpr double d1{ -12715105075./11282082432. };
+		constexpr double d3{ 87487479700./32700410799. };
+		constexpr double d4{ -10690763975./1880347072. };
+		constexpr double d5{ 701980252875./199316789632. };
+		constexpr double d6{ -1453857185./822651844. };
+		constexpr double d7{ 69997945./29380423. };
+
+		// step size controller
+		constexpr double safety{ .9 };
+		constexpr double facMin{ .2 };
+		constexpr double facMax{ 10. };
+
+		DiffEqStats stats{};
+
+		double xCurr{ xyBeg.first };
+		Array yCurr(xyBeg.second);
+		Array yNext;
+		Array k1{ system(xCurr, yCurr) };
+		++stats.theNumEval;
+		Array k2, k3, k4, k5, k6, k7, yTmp;
+
+		bool okay{ true };
+		double hh{ 0. };
+		if (! (xCurr == xEnd))
+		{
+			hh = initialStep(xCurr, yCurr, k1, xEnd, system, stats);
+		}
+		double const dir{ (hh < 0.) ? -1. : 1. };
+		bool lastRejected{ false };
+		std::size_t numSteps{ 0u };
+		while (okay && (0. < dir*(xEnd - xCurr)))
+		{
+			// limit step to end exactly at xEnd
+			bool const isLast{ ! (dir*(xCurr + hh - xEnd) < 0.) };
+			if (isLast)
+			{
+				hh = xEnd - xCurr;
+			}
+
+			// stage evaluations
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yTmp[nn] = yCurr[nn] + hh*(a21*k1[nn]);
+			}
+			k2 = system(xCurr + c2*hh, yTmp);
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yTmp[nn] = yCurr[nn] + hh*(a31*k1[nn] + a32*k2[nn]);
+			}
+			k3 = system(xCurr + c3*hh, yTmp);
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yTmp[nn] = yCurr[nn]
+					+ hh*(a41*k1[nn] + a42*k2[nn] + a43*k3[nn]);
+			}
+			k4 = system(xCurr + c4*hh, yTmp);
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yTmp[nn] = yCurr[nn]
+					+ hh*( a51*k1[nn] + a52*k2[nn]
+					     + a53*k3[nn] + a54*k4[nn]);
+			}
+			k5 = system(xCurr + c5*hh, yTmp);
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yTmp[nn] = yCurr[nn]
+					+ hh*( a61*k1[nn] + a62*k2[nn] + a63*k3[nn]
+					     + a64*k4[nn] + a65*k5[nn]);
+			}
+			double const xNext{ isLast ? xEnd : (xCurr + hh) };
+			k6 = system(xNext, yTmp);
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yNext[nn] = yCurr[nn]
+					+ hh*( a71*k1[nn] + a73*k3[nn] + a74*k4[nn]
+					     + a75*k5[nn] + a76*k6[nn]);
+			}
+			k7 = system(xNext, yNext);
+			stats.theNumEval += 6u;
+
+			// error estimate
+			Array errEst;
+			Array scales;
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				errEst[nn] = hh*( e1*k1[nn] + e3*k3[nn] + e4*k4[nn]
+				                + e5*k5[nn] + e6*k6[nn] + e7*k7[nn]);
+				scales[nn] = theTolAbs + theTolRel
+					* std::max(std::abs(yCurr[nn]), std::abs(yNext[nn]));
+			}
+			double const err{ scaledNorm(errEst, scales) };
+
+			// predict next step size
+			double fac{ facMax };
+			if (0. < err)
+			{
+				fac = safety * std::pow(err, -.2);
+			}
+			fac = std::min(facMax, std::max(facMin, fac));
+
+			bool const isValidErr{ engabra::g3::isValid(err) };
+			if (isValidErr && (! (1. < err))) // includes err==0.
+			{
+				// accept step
+				DenseStep<Dim> step{ xCurr, hh, {} };
+				for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+				{
+					double const yDif{ yNext[nn] - yCurr[nn] };
+					double const bspl{ hh*k1[nn] - yDif };
+					step.theCoefs[0][nn] = yCurr[nn];
+					step.theCoefs[1][nn] = yDif;
+					step.theCoefs[2][nn] = bspl;
+					step.theCoefs[3][nn] = yDif - hh*k7[nn] - bspl;
+					step.theCoefs[4][nn] = hh*( d1*k1[nn] + d3*k3[nn]
+						+ d4*k4[nn] + d5*k5[nn] + d6*k6[nn] + d7*k7[nn]);
+				}
+				stepConsumer(step);
+
+				xCurr = xNext;
+				yCurr = yNext;
+				k1 = k7; // first same as last
+				if (lastRejected)
+				{
+					fac = std::min(1., fac);
+				}
+				lastRejected = false;
+				++stats.theNumAccept;
+			}
+			else
+			{
+				lastRejected = true;
+				++stats.theNumReject;
+			}
+			hh *= fac;
+
+			// check for runaway conditions (if not yet at end)
+			++numSteps;
+			bool const atEnd{ ! (0. < dir*(xEnd - xCurr)) };
+			double const hMin
+				{ 16. * std::numeric_limits<double>::epsilon()
+				* std::max(1., std::abs(xCurr))
+				};
+			okay =
+				(  isValidErr
+				&& ( atEnd
+				  || ((numSteps < theMaxSteps) && (hMin < std::abs(hh)))
+				   )
+				);
+		}
+
+		if (! okay)
+		{
+			yCurr.fill(engabra::g3::null<double>());
+		}
+		if (ptStats)
+		{
+			*ptStats = stats;
+		}
+		return yCurr;
+	}
+
+}; // DiffEqSolveDP45
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_DiffEqSolveDP45_INCL_
@@ -0,0 +1,206 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_DiffEqSolveRK4_INCL_
+#define aply_math_DiffEqSolveRK4_INCL_
+
+/*! \file
+\brief Declarations for math::DiffEqSolveRK4
+*/
+
+
+#include "mathDiffEqSystemArray.hpp"
+
+#include <cmath>
+#include <vector>
+
+
+namespace aply
+{
+namespace math
+{
+
+/*! \brief Fixed step 4th order Runge-Kutta solver for fixed size systems.
+
+Equivalent to aply::math::DiffEqSolve (same step sequence and
+arithmetic) but operating on System types that conform to the fixed
+dimension interface described in mathDiffEqSystemArray.hpp. All stage
+values are held in std::array instances so that stepping performs no
+heap allocations.
+
+\par Example
+\snippet test/test_DiffEqSolve.cpp DoxyExample01
+
+*/
+
+class DiffEqSolveRK4
+{
+	//! Integration step size (sign is determined by solution direction).
+	double theStep;
+
+public: // methods
+
+	//! Construct with a given stepsize.
+	explicit
+	DiffEqSolveRK4
+		( double const & stepSize
+		)
+		: theStep{ stepSize }
+	{ }
+
+	/*! \brief Solution values at xValue (starting from system.initValues())
+	 *
+	 * Integration proceeds in steps of (+/-)stepSize from the initial
+	 * x value toward xValue. The final step is shortened to end exactly
+	 * at xValue.
+	 */
+	template <typename System>
+	inline
+	DiffEqValues<sDiffEqDim<System> >
+	solutionFor
+		( double const & xValue
+		, System const & system
+		) const
+	{
+		DiffEqValues<sDiffEqDim<System> > const init{ system.initValues() };
+		return DiffEqValues<sDiffEqDim<System> >
+			{ xValue, valuesFrom(init, xValue, system) };
+	}
+
+	/*! \brief Solution values at each of xValues (in a single pass).
+	 *
+	 * Integration proceeds from system.initValues() through the xValues
+	 * in order of distance from the start (in any order on input) and
+	 * each solution is continued from the previous one. Returned values
+	 * are in the same order as xValues. Entries for xValues on the
+	 * opposite side of the start (from the farthest one) are null.
+	 */
+	template <typename System>
+	inline
+	std::vector<DiffEqValues<sDiffEqDim<System> > >
+	solutionsAt
+		( std::vector<double> const & xValues
+		, System const & system
+		) const
+	{
+		constexpr std::size_t Dim{ sDiffEqDim<System> };
+		std::vector<DiffEqValues<Dim> > solns
+			(xValues.size(), nullDiffEqValues<Dim>());
+		DiffEqValues<Dim> xyCurr{ system.initValues() };
+		for (std::size_t const & ndx
+			: diffEqOutputOrder(xyCurr.first, xValues))
+		{
+			double const & xNext = xValues[ndx];
+			xyCurr = DiffEqValues<Dim>
+				{ xNext, valuesFrom(xyCurr, xNext, system) };
+			solns[ndx] = xyCurr;
+		}
+		return solns;
+	}
+
+	/*! \brief Function values integrated from xyBeg to xEnd.
+	 *
+	 * Useful for continuing a solution (e.g. from a previous end point).
+	 */
+	template <typename System, std::size_t Dim>
+	inline
+	std::array<double, Dim>
+	valuesFrom
+		( DiffEqValues<Dim> const & xyBeg
+		, double const & xEnd
+		, System const & system
+		) const
+	{
+		using Array = std::array<double, Dim>;
+
+		double const & start = xyBeg.first;
+		Array yVec(xyBeg.second);
+		Array tmp;
+
+		double delta{ std::abs(theStep) };
+		if (xEnd < start)
+		{
+			delta = -delta;
+		}
+		double delo2{ delta / 2. };
+		double delo6{ delta / 6. };
+
+		bool done{ false };
+		std::size_t nstep{ 0u };
+		while (! done)
+		{
+			// shorten last step to end exactly at xEnd
+			double const tparm{ start + static_cast<double>(nstep) * delta };
+			if (std::abs(xEnd - tparm) < std::abs(delta))
+			{
+				delta = xEnd - tparm;
+				delo2 = delta / 2.;
+				delo6 = delta / 6.;
+				done = true;
+			}
+
+			// K1 = f(xn, yn)
+			Array const F1{ system(tparm, yVec) };
+
+			// K2 = f(xn+h/2 , yn+K1*h/2)
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				tmp[nn] = yVec[nn] + delo2 * F1[nn];
+			}
+			Array const F2{ system(tparm + delo2, tmp) };
+
+			// K3 = f(xn+h/2 , yn+K2*h/2)
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				tmp[nn] = yVec[nn] + delo2 * F2[nn];
+			}
+			Array const F3{ system(tparm + delo2, tmp) };
+
+			// K4 = f(xn+h , yn+K3*h)
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				tmp[nn] = yVec[nn] + delta * F3[nn];
+			}
+			Array const F4{ system(tparm + delta, tmp) };
+
+			// yn + (h/6) * (F1 + 2.*K2 + 2.*K3 + F4)
+			for (std::size_t nn{0u} ; nn < Dim ; ++nn)
+			{
+				yVec[nn] += delo6
+					* (F1[nn] + (2.*(F2[nn] + F3[nn])) + F4[nn]);
+			}
+
+			++nstep;
+		}
+
+		return yVec;
+	}
+
+}; // DiffEqSolveRK4
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_DiffEqSolveRK4_INCL_
@@ -164,11 +164,9 @@ scalar equations.
 
 \par Example of Vector-valued 2nd order ODE system:
 
-Functor implementation:
-\snippet demo/demoIntegrate.cpp DoxyExample00
-
-Initial values implementation:
-\snippet demo/demoIntegrate.cpp DoxyExample01
+Ref the fixed dimension (std::array) example in demo/demoIntegrate.cpp
+as described in mathDiffEqSystemArray.hpp. The same equation structure
+applies to this (std::vector) interface.
 
 
 */
@@ -0,0 +1,169 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_DiffEqSystemArray_INCL_
+#define aply_math_DiffEqSystemArray_INCL_
+
+
+/*! \file
+\brief Declarations for fixed dimension differential equation systems.
+
+The templated solvers (e.g. aply::math::DiffEqSolveRK4) accept any
+System type that expresses the same equation structure as the (run-time
+polymorphic) aply::math::DiffEqSystem, but with dependent values held
+in a std::array<double, Dim>. A conforming System type provides
+(non-virtual) member functions:
+
+\code
+// Derivative values (y0', y1', ...) at independent value x.
+std::array<double, Dim>
+operator()
+	( double const & xValue
+	, std::array<double, Dim> const & yValues
+	) const;
+
+// Initial conditions (x0, (y0, y1, ...)).
+aply::math::DiffEqValues<Dim>
+initValues
+	() const;
+\endcode
+
+Since the system type is a template parameter of the solver, the
+operator() calls are resolved at compile time (and generally inlined)
+and the integration step loop uses only stack storage (no heap
+allocations).
+
+\b Example:
+
+Ref: aply::examp::diffeq::UniformAccelArray in example/diffeqSystem.hpp
+
+Vector-valued 2nd order ODE system functor implementation:
+\snippet demo/demoIntegrate.cpp DoxyExample00
+
+Initial values implementation:
+\snippet demo/demoIntegrate.cpp DoxyExample01
+*/
+
+
+#include <Engabra>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace aply
+{
+namespace math
+{
+
+	/*! \brief Independent value and (fixed size) dependent function values.
+	 *
+	 * Fixed size analog of the std::pair<double, std::vector<double> >
+	 * used by aply::math::DiffEqSystem.
+	 * \arg .first: independent parameter, x
+	 * \arg .second: dependent function values, (y0, y1, ...)
+	 */
+	template <std::size_t Dim>
+	using DiffEqValues = std::pair<double, std::array<double, Dim> >;
+
+	/*! \brief Dimension of System (number of simultaneous equations).
+	 *
+	 * Value is deduced from the return type of System::initValues().
+	 */
+	template <typename System>
+	constexpr std::size_t sDiffEqDim
+		{ std::tuple_size
+			< typename decltype(std::declval<System const &>().initValues())
+				::second_type
+			>::value
+		};
+
+	/*! \brief Order in which xValues are reached when integrating from xBeg.
+	 *
+	 * The integration direction is that toward the xValues element
+	 * farthest from xBeg. Returned indices (into xValues) are ordered
+	 * by increasing distance from xBeg. Indices of values on the
+	 * opposite side of xBeg (and of null values) are omitted.
+	 */
+	inline
+	std::vector<std::size_t>
+	diffEqOutputOrder
+		( double const & xBeg
+		, std::vector<double> const & xValues
+		)
+	{
+		// direction toward farthest (valid) value
+		double xFar{ xBeg };
+		for (double const & xValue : xValues)
+		{
+			if ( engabra::g3::isValid(xValue)
+			  && (std::abs(xFar - xBeg) < std::abs(xValue - xBeg))
+			   )
+			{
+				xFar = xValue;
+			}
+		}
+		double const dir{ (xFar < xBeg) ? -1. : 1. };
+
+		std::vector<std::size_t> ndxs;
+		ndxs.reserve(xValues.size());
+		for (std::size_t ndx{0u} ; ndx < xValues.size() ; ++ndx)
+		{
+			if (! (dir*(xValues[ndx] - xBeg) < 0.)) // false for null
+			{
+				ndxs.emplace_back(ndx);
+			}
+		}
+		std::stable_sort
+			( ndxs.begin(), ndxs.end()
+			, [& xValues, & dir]
+				(std::size_t const & ndxA, std::size_t const & ndxB)
+				{ return (dir*xValues[ndxA] < dir*xValues[ndxB]); }
+			);
+		return ndxs;
+	}
+
+	//! Null instance of DiffEqValues (e.g. for values not computed).
+	template <std::size_t Dim>
+	inline
+	DiffEqValues<Dim>
+	nullDiffEqValues
+		()
+	{
+		DiffEqValues<Dim> nulls{ engabra::g3::null<double>(), {} };
+		nulls.second.fill(engabra::g3::null<double>());
+		return nulls;
+	}
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_DiffEqSystemArray_INCL_
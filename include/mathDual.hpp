@@ -0,0 +1,389 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_Dual_INCL_
+#define aply_math_Dual_INCL_
+
+/*! \file
+\brief Declarations for math::Dual (forward mode automatic differentiation)
+*/
+
+
+#include <Engabra>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+
+namespace aply
+{
+namespace math
+{
+
+/*! \brief Dual number carrying a value and its 3D (spatial) gradient.
+
+Arithmetic and elementary functions propagate the gradient with the
+chain rule (forward mode automatic differentiation). Code written
+generically over the scalar type (e.g. 'template <typename Scalar>')
+can therefore be evaluated with 'double' for the value alone, or with
+'Dual' for the value and its exact gradient in a single evaluation.
+
+Comparison operators compare values only (so that branches select the
+same expression for both scalar types).
+
+Example:
+\snippet test_AutoDiffVolume.cpp DoxyExample01
+*/
+struct Dual
+{
+	//! Function value.
+	double theValue{ engabra::g3::null<double>() };
+
+	//! Partial derivatives of value w.r.t. (x,y,z) coordinates.
+	std::array<double, 3u> theGrad{ 0., 0., 0. };
+
+	//! Default (null) instance.
+	Dual
+		() = default;
+
+	//! Constant (zero gradient) - implicit for use in generic expressions.
+	constexpr
+	Dual
+		( double const & value
+		)
+		: theValue{ value }
+		, theGrad{ 0., 0., 0. }
+	{ }
+
+	//! Value and gradient.
+	constexpr
+	explicit
+	Dual
+		( double const & value
+		, std::array<double, 3u> const & grad
+		)
+		: theValue{ value }
+		, theGrad{ grad }
+	{ }
+
+	//! Independent variable: value with unit partial for coordinate ndx.
+	static
+	constexpr
+	Dual
+	variable
+		( double const & value
+		, std::size_t const & ndx
+		)
+	{
+		std::array<double, 3u> grad{ 0., 0., 0. };
+		grad[ndx] = 1.;
+		return Dual(value, grad);
+	}
+
+	//! Gradient as an engabra Vector.
+	inline
+	engabra::g3::Vector
+	gradient
+		() const
+	{
+		return engabra::g3::Vector{ theGrad[0], theGrad[1], theGrad[2] };
+	}
+
+}; // Dual
+
+
+//! Value of double (for generic code).
+inline
+double
+valueOf
+	( double const & arg
+	)
+{
+	return arg;
+}
+
+//! Value of Dual (for generic code).
+inline
+double
+valueOf
+	( Dual const & arg
+	)
+{
+	return arg.theValue;
+}
+
+//! Function value fVal with chain rule gradient (dfdx * arg.theGrad).
+inline
+Dual
+chain
+	( Dual const & arg
+	, double const & fVal
+	, double const & dfdx
+	)
+{
+	return Dual
+		( fVal
+		, { dfdx*arg.theGrad[0], dfdx*arg.theGrad[1], dfdx*arg.theGrad[2] }
+		);
+}
+
+//! Negation.
+inline
+Dual
+operator-
+	( Dual const & arg
+	)
+{
+	return chain(arg, -arg.theValue, -1.);
+}
+
+//! Sum.
+inline
+Dual
+operator+
+	( Dual const & aa
+	, Dual const & bb
+	)
+{
+	return Dual
+		( aa.theValue + bb.theValue
+		, { aa.theGrad[0] + bb.theGrad[0]
+		  , aa.theGrad[1] + bb.theGrad[1]
+		  , aa.theGrad[2] + bb.theGrad[2]
+		  }
+		);
+}
+
+//! Difference.
+inline
+Dual
+operator-
+	( Dual const & aa
+	, Dual const & bb
+	)
+{
+	return Dual
+		( aa.theValue - bb.theValue
+		, { aa.theGrad[0] - bb.theGrad[0]
+		  , aa.theGrad[1] - bb.theGrad[1]
+		  , aa.theGrad[2] - bb.theGrad[2]
+		  }
+		);
+}
+
+//! Product.
+inline
+Dual
+operator*
+	( Dual const & aa
+	, Dual const & bb
+	)
+{
+	double const & av = aa.theValue;
+	double const & bv = bb.theValue;
+	return Dual
+		( av * bv
+		, { bv*aa.theGrad[0] + av*bb.theGrad[0]
+		  , bv*aa.theGrad[1] + av*bb.theGrad[1]
+		  , bv*aa.theGrad[2] + av*bb.theGrad[2]
+		  }
+		);
+}
+
+//! Quotient.
+inline
+Dual
+operator/
+	( Dual const & aa
+	, Dual const & bb
+	)
+{
+	double const inv{ 1. / bb.theValue };
+	double const quo{ aa.theValue * inv };
+	return Dual
+		( quo
+		, { inv * (aa.theGrad[0] - quo*bb.theGrad[0])
+		  , inv * (aa.theGrad[1] - quo*bb.theGrad[1])
+		  , inv * (aa.theGrad[2] - quo*bb.theGrad[2])
+		  }
+		);
+}
+
+//! Value comparison.
+inline
+bool
+operator<
+	( Dual const & aa
+	, Dual const & bb
+	)
+{
+	return (aa.theValue < bb.theValue);
+}
+
+//! Square root (double).
+inline
+double
+sqrt
+	( double const & arg
+	)
+{
+	return std::sqrt(arg);
+}
+
+//! Square root (Dual).
+inline
+Dual
+sqrt
+	( Dual const & arg
+	)
+{
+	double const root{ std::sqrt(arg.theValue) };
+	return chain(arg, root, .5 / root);
+}
+
+//! Exponential (double).
+inline
+double
+exp
+	( double const & arg
+	)
+{
+	return std::exp(arg);
+}
+
+//! Exponential (Dual).
+inline
+Dual
+exp
+	( Dual const & arg
+	)
+{
+	double const val{ std::exp(arg.theValue) };
+	return chain(arg, val, val);
+}
+
+//! Natural logarithm (double).
+inline
+double
+log
+	( double const & arg
+	)
+{
+	return std::log(arg);
+}
+
+//! Natural logarithm (Dual).
+inline
+Dual
+log
+	( Dual const & arg
+	)
+{
+	return chain(arg, std::log(arg.theValue), 1. / arg.theValue);
+}
+
+//! Location vector with components of generic scalar type.
+template <typename Scalar>
+using Vec3 = std::array<Scalar, 3u>;
+
+//! Components of engabra Vector (e.g. for Vec3<double> evaluation).
+inline
+Vec3<double>
+vec3Of
+	( engabra::g3::Vector const & vec
+	)
+{
+	return Vec3<double>{ vec[0], vec[1], vec[2] };
+}
+
+//! Independent variables (unit partials) seeded from engabra Vector.
+inline
+Vec3<Dual>
+dualVec3Of
+	( engabra::g3::Vector const & vec
+	)
+{
+	return Vec3<Dual>
+		{ Dual::variable(vec[0], 0u)
+		, Dual::variable(vec[1], 1u)
+		, Dual::variable(vec[2], 2u)
+		};
+}
+
+//! Difference of generic location and (constant) engabra Vector.
+template <typename Scalar>
+inline
+Vec3<Scalar>
+difference
+	( Vec3<Scalar> const & aVec
+	, engabra::g3::Vector const & bVec
+	)
+{
+	return Vec3<Scalar>
+		{ aVec[0] - bVec[0]
+		, aVec[1] - bVec[1]
+		, aVec[2] - bVec[2]
+		};
+}
+
+//! Scalar (dot) product of generic location and (constant) direction.
+template <typename Scalar>
+inline
+Scalar
+dot
+	( Vec3<Scalar> const & aVec
+	, engabra::g3::Vector const & bVec
+	)
+{
+	return (aVec[0]*bVec[0] + aVec[1]*bVec[1] + aVec[2]*bVec[2]);
+}
+
+//! Squared magnitude of generic location.
+template <typename Scalar>
+inline
+Scalar
+magSq
+	( Vec3<Scalar> const & aVec
+	)
+{
+	return (aVec[0]*aVec[0] + aVec[1]*aVec[1] + aVec[2]*aVec[2]);
+}
+
+//! Magnitude of generic location.
+template <typename Scalar>
+inline
+Scalar
+magnitude
+	( Vec3<Scalar> const & aVec
+	)
+{
+	return sqrt(magSq(aVec));
+}
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_Dual_INCL_
@@ -0,0 +1,326 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_QuadratureGK_INCL_
+#define aply_math_QuadratureGK_INCL_
+
+/*! \file
+\brief Declarations for math::QuadratureGK
+*/
+
+
+#include <Engabra>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+
+namespace aply
+{
+namespace math
+{
+
+	//! \brief Work counters reported by adaptive quadrature.
+	struct QuadratureStats
+	{
+		//! Number of subintervals in final partition of integration range.
+		std::size_t theNumIntervals{ 0u };
+
+		//! Number of integrand function evaluations.
+		std::size_t theNumEval{ 0u };
+	};
+
+/*! \brief Adaptive Gauss-Kronrod (7-15 point) quadrature of 1D functions.
+
+Integral estimates are computed with the 15-point Kronrod rule and the
+difference from the embedded 7-point Gauss rule is used as an error
+estimate. The subinterval with the largest error estimate is bisected
+until the total error estimate is not larger than
+
+\code
+max(tolAbs, tolRel * |integral|)
+\endcode
+
+Rule nodes are interior to each subinterval (the integrand is never
+evaluated at interval end points), so functions with integrable end
+point singularities can be integrated directly. Inverse square root
+end point behavior, e.g. f(x) ~ 1/sqrt(x-xSing), can be integrated
+much more efficiently with integralFromSingular() which removes the
+singularity with a change of variable.
+
+Integrals that cannot be determined (e.g. non-finite integrand values
+or exceeding the maximum number of subintervals) are returned as null
+(ref engabra::g3::isValid()).
+
+The Func type must provide: 'double operator()(double const & x) const'.
+
+\par Example
+\snippet test/test_QuadratureGK.cpp DoxyExample01
+
+*/
+
+class QuadratureGK
+{
+	//! Absolute tolerance on integral value.
+	double theTolAbs;
+
+	//! Relative tolerance on integral value.
+	double theTolRel;
+
+	//! Maximum number of subintervals per integral.
+	std::size_t theMaxIntervals;
+
+	//! Integral estimate over one subinterval.
+	struct Piece
+	{
+		//! Start of subinterval.
+		double theBeg;
+		//! End of subinterval.
+		double theEnd;
+		//! Kronrod (15-point) integral estimate.
+		double theValue;
+		//! Magnitude of Kronrod minus Gauss (7-point) estimates.
+		double theError;
+
+		//! Ordering for heap with largest error at front.
+		inline
+		bool
+		operator<
+			( Piece const & other
+			) const
+		{
+			return (theError < other.theError);
+		}
+	};
+
+public: // data
+
+	//! Kronrod abscissae (positive half, ref QUADPACK qk15).
+	static constexpr std::array<double, 8u> sNodesK
+		{ 0.991455371120812639206854697526329
+		, 0.949107912342758524526189684047851
+		, 0.864864423359769072789712788640926
+		, 0.741531185599394439863864773280788
+		, 0.586087235467691130294144845693013
+		, 0.405845151377397166906606412076961
+		, 0.207784955007898467600689403773245
+		, 0.000000000000000000000000000000000
+		};
+	//! Kronrod weights for each of sNodesK.
+	static constexpr std::array<double, 8u> sWeightsK
+		{ 0.022935322010529224963732008058970
+		, 0.063092092629978553290700663189204
+		, 0.104790010322250183839876322541518
+		, 0.140653259715525918745189590510238
+		, 0.169004726639267902826583426598550
+		, 0.190350578064785409913256402421014
+		, 0.204432940075298892414161999234649
+		, 0.209482141084727828012999174891714
+		};
+	//! Gauss weights (Gauss nodes are the odd indexed sNodesK).
+	static constexpr std::array<double, 4u> sWeightsG
+		{ 0.129484966168869693270611432679082
+		, 0.279705391489276667901467771423780
+		, 0.381830050505118944950369775488975
+		, 0.417959183673469387755102040816327
+		};
+
+public: // methods
+
+	//! Construct with error tolerances.
+	explicit
+	QuadratureGK
+		( double const & tolAbs = 1.e-12
+		, double const & tolRel = 1.e-12
+		, std::size_t const & maxIntervals = 1000u
+		)
+		: theTolAbs{ tolAbs }
+		, theTolRel{ tolRel }
+		, theMaxIntervals{ maxIntervals }
+	{ }
+
+	/*! \brief Integral of func from xBeg to xEnd.
+	 *
+	 * The result is signed (e.g. is negative of the integral from
+	 * xEnd to xBeg).
+	 */
+	template <typename Func>
+	inline
+	double
+	integralOf
+		( Func const & func
+		, double const & xBeg
+		, double const & xEnd
+		, QuadratureStats * const & ptStats = nullptr
+		) const
+	{
+		QuadratureStats stats{};
+		std::vector<Piece> pieces;
+		pieces.reserve(theMaxIntervals);
+		pieces.emplace_back(pieceFor(func, xBeg, xEnd, stats));
+		double sumValue{ pieces.front().theValue };
+		double sumError{ pieces.front().theError };
+
+		while ( engabra::g3::isValid(sumValue)
+			&& engabra::g3::isValid(sumError)
+			&& (toleranceFor(sumValue) < sumError)
+			&& (pieces.size() < theMaxIntervals)
+			  )
+		{
+			// bisect subinterval with largest error estimate
+			std::pop_heap(pieces.begin(), pieces.end());
+			Piece const worst{ pieces.back() };
+			pieces.pop_back();
+			double const xMid{ .5 * (worst.theBeg + worst.theEnd) };
+			Piece const piece1{ pieceFor(func, worst.theBeg, xMid, stats) };
+			Piece const piece2{ pieceFor(func, xMid, worst.theEnd, stats) };
+			pieces.emplace_back(piece1);
+			std::push_heap(pieces.begin(), pieces.end());
+			pieces.emplace_back(piece2);
+			std::push_heap(pieces.begin(), pieces.end());
+
+			sumValue += (piece1.theValue + piece2.theValue - worst.theValue);
+			sumError += (piece1.theError + piece2.theError - worst.theError);
+		}
+
+		// final sums (without incremental update roundoff)
+		double value{ 0. };
+		double error{ 0. };
+		for (Piece const & piece : pieces)
+		{
+			value += piece.theValue;
+			error += piece.theError;
+		}
+		if (! ( engabra::g3::isValid(value)
+			 && engabra::g3::isValid(error)
+			 && (! (toleranceFor(value) < error))
+			  )
+		   )
+		{
+			value = engabra::g3::null<double>();
+		}
+
+		stats.theNumIntervals = pieces.size();
+		if (ptStats)
+		{
+			*ptStats = stats;
+		}
+		return value;
+	}
+
+	/*! \brief Integral of func from 0 to delEnd (singular at 0).
+	 *
+	 * Intended for integrands behaving as 1/sqrt(del) in the
+	 * neighborhood of del=0. The substitution
+	 * \code
+	 * del = delEnd*t^2
+	 * \endcode
+	 * produces the (nonsingular) integral over t in [0,1] of
+	 * \code
+	 * 2*delEnd*t * funcOfDel(delEnd*t^2)
+	 * \endcode
+	 * The substitution is also harmless for integrands that are
+	 * smooth at del=0.
+	 *
+	 * To integrate f(x) from xSing to xOther, use funcOfDel(del)
+	 * as f(xSing+del) and delEnd as (xOther-xSing). The offset form
+	 * allows funcOfDel to evaluate (x-xSing) dependent terms without
+	 * loss of precision (e.g. since adaptive refinement concentrates
+	 * evaluations near the singularity where (xSing+del) would be
+	 * dominated by roundoff).
+	 */
+	template <typename Func>
+	inline
+	double
+	integralFromSingular
+		( Func const & funcOfDel
+		, double const & delEnd
+		, QuadratureStats * const & ptStats = nullptr
+		) const
+	{
+		auto const funcOfT
+			{ [& funcOfDel, & delEnd]
+				(double const & tt)
+				{ return (2.*delEnd*tt) * funcOfDel(delEnd*tt*tt); }
+			};
+		return integralOf(funcOfT, 0., 1., ptStats);
+	}
+
+private:
+
+	//! Error tolerance associated with integral value
+	inline
+	double
+	toleranceFor
+		( double const & value
+		) const
+	{
+		return std::max(theTolAbs, theTolRel * std::abs(value));
+	}
+
+	//! Gauss-Kronrod 7-15 integral and error estimate over one interval.
+	template <typename Func>
+	inline
+	static
+	Piece
+	pieceFor
+		( Func const & func
+		, double const & xBeg
+		, double const & xEnd
+		, QuadratureStats & stats
+		)
+	{
+		double const xMid{ .5 * (xEnd + xBeg) };
+		double const xHalf{ .5 * (xEnd - xBeg) };
+
+		double const fMid{ func(xMid) };
+		double sumK{ sWeightsK[7] * fMid };
+		double sumG{ sWeightsG[3] * fMid };
+		for (std::size_t nn{0u} ; nn < 7u ; ++nn)
+		{
+			double const dx{ xHalf * sNodesK[nn] };
+			double const fSum{ func(xMid - dx) + func(xMid + dx) };
+			sumK += sWeightsK[nn] * fSum;
+			if (1u == (nn % 2u))
+			{
+				sumG += sWeightsG[nn/2u] * fSum;
+			}
+		}
+		stats.theNumEval += 15u;
+
+		double const valueK{ xHalf * sumK };
+		double const valueG{ xHalf * sumG };
+		return Piece{ xBeg, xEnd, valueK, std::abs(valueK - valueG) };
+	}
+
+};
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_QuadratureGK_INCL_
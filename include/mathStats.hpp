@@ -0,0 +1,271 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_math_Stats_INCL_
+#define aply_math_Stats_INCL_
+
+/*! \file
+\brief Declarations for math::RunningStats and math::Histogram
+*/
+
+
+#include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+
+namespace aply
+{
+namespace math
+{
+
+	/*! \brief Single pass (Welford) mean, variance and range of samples.
+	 *
+	 * Numerically stable for long sample sequences. Instances that
+	 * accumulated separate samples (e.g. one per thread) are combined
+	 * with merge() (Chan et al. pairwise update), which gives the same
+	 * results (to roundoff) as accumulating all samples in one.
+	 */
+	struct RunningStats
+	{
+		std::size_t theCount{ 0u }; //!< Number of samples
+		double theMean{ 0. }; //!< Mean of samples
+		double theSumSqDev{ 0. }; //!< Sum of squared deviations from mean
+		double theMin{ std::numeric_limits<double>::infinity() };
+		double theMax{ -std::numeric_limits<double>::infinity() };
+
+		//! Incorporate sample value (non-finite values are ignored)
+		inline
+		void
+		add // RunningStats::
+			( double const & value
+			)
+		{
+			if (std::isfinite(value))
+			{
+				++theCount;
+				double const delta{ value - theMean };
+				theMean += delta / static_cast<double>(theCount);
+				theSumSqDev += delta * (value - theMean);
+				theMin = std::min(theMin, value);
+				theMax = std::max(theMax, value);
+			}
+		}
+
+		//! Incorporate all samples accumulated by other
+		inline
+		void
+		merge // RunningStats::
+			( RunningStats const & other
+			)
+		{
+			if (0u == other.theCount)
+			{
+				return;
+			}
+			if (0u == theCount)
+			{
+				*this = other;
+				return;
+			}
+			double const numA{ static_cast<double>(theCount) };
+			double const numB{ static_cast<double>(other.theCount) };
+			double const numAB{ numA + numB };
+			double const delta{ other.theMean - theMean };
+			theCount += other.theCount;
+			theMean += delta * (numB / numAB);
+			theSumSqDev += other.theSumSqDev
+				+ delta*delta * (numA*numB / numAB);
+			theMin = std::min(theMin, other.theMin);
+			theMax = std::max(theMax, other.theMax);
+		}
+
+		//! Sample mean (null if no samples)
+		inline
+		double
+		mean // RunningStats::
+			() const
+		{
+			double value{ engabra::g3::null<double>() };
+			if (0u < theCount)
+			{
+				value = theMean;
+			}
+			return value;
+		}
+
+		//! Sample (unbiased) variance (null if fewer than two samples)
+		inline
+		double
+		variance // RunningStats::
+			() const
+		{
+			double value{ engabra::g3::null<double>() };
+			if (1u < theCount)
+			{
+				value = theSumSqDev / static_cast<double>(theCount - 1u);
+			}
+			return value;
+		}
+
+		//! Square root of variance()
+		inline
+		double
+		stdDev // RunningStats::
+			() const
+		{
+			return std::sqrt(variance());
+		}
+
+	}; // RunningStats
+
+	/*! \brief Counts of samples within uniform bins over [min, max).
+	 *
+	 * Samples outside the range are counted in theNumUnder or
+	 * theNumOver (and non-finite ones in theNumInvalid). Histograms
+	 * with the same bins are combined with merge().
+	 */
+	struct Histogram
+	{
+		double theMin{ 0. }; //!< Start of first bin
+		double theMax{ 1. }; //!< End of last bin
+		std::vector<std::size_t> theCounts{}; //!< Count in each bin
+		std::size_t theNumUnder{ 0u }; //!< Count of samples below theMin
+		std::size_t theNumOver{ 0u }; //!< Count of samples at/above theMax
+		std::size_t theNumInvalid{ 0u }; //!< Count of non-finite samples
+
+		//! Default instance with no bins
+		Histogram
+			() = default;
+
+		//! Histogram with numBins (uniform) bins spanning [minValue, maxValue)
+		inline
+		explicit
+		Histogram
+			( double const & minValue
+			, double const & maxValue
+			, std::size_t const & numBins
+			)
+			: theMin{ minValue }
+			, theMax{ maxValue }
+			, theCounts(numBins, 0u)
+		{ }
+
+		//! Width of each bin
+		inline
+		double
+		binWidth // Histogram::
+			() const
+		{
+			return (theMax - theMin) / static_cast<double>(theCounts.size());
+		}
+
+		//! Value at center of bin ndx
+		inline
+		double
+		binCenter // Histogram::
+			( std::size_t const & ndx
+			) const
+		{
+			return theMin + (static_cast<double>(ndx) + .5) * binWidth();
+		}
+
+		//! Incorporate sample value
+		inline
+		void
+		add // Histogram::
+			( double const & value
+			)
+		{
+			if (! std::isfinite(value))
+			{
+				++theNumInvalid;
+			}
+			else
+			if (value < theMin)
+			{
+				++theNumUnder;
+			}
+			else
+			{
+				double const dubNdx{ (value - theMin) / binWidth() };
+				std::size_t const ndx{ static_cast<std::size_t>(dubNdx) };
+				if ((value < theMax) && (ndx < theCounts.size()))
+				{
+					++theCounts[ndx];
+				}
+				else
+				{
+					++theNumOver;
+				}
+			}
+		}
+
+		//! True if other has the same bins (range and count) as this
+		inline
+		bool
+		sameBinsAs // Histogram::
+			( Histogram const & other
+			) const
+		{
+			return
+				(  (theMin == other.theMin)
+				&& (theMax == other.theMax)
+				&& (theCounts.size() == other.theCounts.size())
+				);
+		}
+
+		//! Incorporate counts from other (false if bins differ)
+		inline
+		bool
+		merge // Histogram::
+			( Histogram const & other
+			)
+		{
+			bool const sameBins{ sameBinsAs(other) };
+			if (sameBins)
+			{
+				for (std::size_t nn{0u} ; nn < theCounts.size() ; ++nn)
+				{
+					theCounts[nn] += other.theCounts[nn];
+				}
+				theNumUnder += other.theNumUnder;
+				theNumOver += other.theNumOver;
+				theNumInvalid += other.theNumInvalid;
+			}
+			return sameBins;
+		}
+
+	}; // Histogram
+
+} // [math]
+} // [aply]
+
+#endif // aply_math_Stats_INCL_
+
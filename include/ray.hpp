@@ -32,12 +32,23 @@
  */
 
 
+#include "rayAsyncPathWriter.hpp"
+#include "rayBundleStats.hpp"
+#include "rayCheckpoint.hpp"
 #include "rayDirChange.hpp"
+#include "rayGridPropagator.hpp"
 #include "rayNode.hpp"
+#include "rayNodeGenerator.hpp"
 #include "rayPath.hpp"
+#include "rayPathArchive.hpp"
+#include "rayPathPool.hpp"
+#include "rayPathSummary.hpp"
 #include "rayPathView.hpp"
 #include "rayPropagator.hpp"
 #include "rayStart.hpp"
+#include "rayStepStudy.hpp"
+#include "rayStratified.hpp"
+#include "rayTangentBatch.hpp"
 
 #include <iostream>
 
@@ -0,0 +1,355 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_AsyncPathWriter_INCL_
+#define aply_ray_AsyncPathWriter_INCL_
+
+/*! \file
+ *
+ * \brief Asynchronous (dedicated I/O thread) output of traced ray paths.
+ *
+ * Tracing threads hand completed paths to per-thread single producer,
+ * single consumer (lock-free) queues (PathRing). One I/O thread drains
+ * the queues and appends the paths to a PathWriter archive in order of
+ * (caller assigned) sequence number. The archive content is therefore
+ * independent of thread scheduling.
+ */
+
+
+#include "rayNode.hpp"
+#include "rayPathArchive.hpp"
+#include "rayStart.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	//! \brief Completed ray path in transit to the I/O thread.
+	struct PathRecord
+	{
+		std::size_t theSeq{ 0u }; //!< Output order (unique per archive)
+		Vector theTanDir{ null<Vector>() }; //!< Start::theTanDir
+		Vector thePntLoc{ null<Vector>() }; //!< Start::thePntLoc
+		std::vector<Node> theNodes{}; //!< Path nodes
+	};
+
+	/*! \brief Bounded single producer, single consumer lock-free queue.
+	 *
+	 * Exactly one thread may call tryPush() and exactly one (other)
+	 * thread may call tryPop(). Records are moved (not copied) in
+	 * and out of the queue (node storage is handed off, not copied).
+	 */
+	class PathRing
+	{
+		std::vector<PathRecord> theSlots;
+
+		//! Count of records popped (written only by consumer)
+		alignas(64) std::atomic<std::size_t> theHead{ 0u };
+
+		//! Count of records pushed (written only by producer)
+		alignas(64) std::atomic<std::size_t> theTail{ 0u };
+
+	public:
+
+		//! Queue holding up to capacity (at least one) records.
+		explicit
+		PathRing
+			( std::size_t const & capacity
+			);
+
+		//! Number of records the queue can hold.
+		std::size_t
+		capacity
+			() const;
+
+		//! Move record into queue - false (record untouched) if full.
+		bool
+		tryPush
+			( PathRecord && record
+			);
+
+		//! Move oldest record into *ptRecord - false if queue is empty.
+		bool
+		tryPop
+			( PathRecord * const & ptRecord
+			);
+
+		//! Sequence number of oldest record (consumer) - false if empty.
+		bool
+		tryPeekSeq
+			( std::size_t * const & ptSeq
+			) const;
+
+	}; // PathRing
+
+	/*! \brief PathWriter driven by a dedicated I/O thread.
+	 *
+	 * Each of numProducers tracing threads pushes its completed paths
+	 * with push(producerNdx, ...) using its own producerNdx. Each queue
+	 * holds ringSize records. When a queue is full, push() waits
+	 * (yields) until the I/O thread has made room (backpressure).
+	 *
+	 * Paths are written in ascending sequence number order. Sequence
+	 * numbers must be unique and contiguous from zero (e.g. the ray
+	 * index) and each producer must push its own numbers in ascending
+	 * order. Records arriving ahead of the next expected number are
+	 * held (in the I/O thread) until the gap is filled. A record is
+	 * only taken from a queue if its sequence number is less than
+	 * reorderWindow past the next expected number. Otherwise, it is
+	 * left in the queue (which fills, so that its producer waits).
+	 * Memory in flight is therefore bounded by numProducers*ringSize
+	 * queued records plus fewer than reorderWindow held records,
+	 * regardless of how far apart the producers are in sequence.
+	 *
+	 * If the sequence numbers have gaps, producers ahead of a gap
+	 * by more than reorderWindow wait indefinitely. Once finish() is
+	 * called (after all producers are done), the window no longer
+	 * applies and any remaining records are written in ascending
+	 * order.
+	 *
+	 * Example:
+	 * \snippet test_AsyncPathWriter.cpp DoxyExample01
+	 */
+	class AsyncPathWriter
+	{
+		PathWriter theWriter;
+		std::vector<std::unique_ptr<PathRing> > theRings{};
+		std::map<std::size_t, PathRecord> theHeldRecords{};
+		std::size_t theNextSeq{ 0u };
+		std::size_t theReorderWindow{ 1u };
+		std::atomic<std::size_t> theMaxNumHeld{ 0u };
+		std::atomic<std::size_t> theNumWritten{ 0u };
+		std::atomic<bool> theIsDone{ false };
+		std::atomic<bool> theIsOkay{ false };
+		std::thread theThread{};
+
+		//! Append record to archive (in I/O thread)
+		void
+		writeRecord
+			( PathRecord const & record
+			);
+
+		//! Append record, or hold it until it is next in sequence.
+		void
+		acceptRecord
+			( PathRecord && record
+			);
+
+		//! I/O thread main loop
+		void
+		drainQueues
+			();
+
+	public:
+
+		/*! \brief Create archive and start the I/O thread.
+		 *
+		 * Arguments outPath and useDeltaLocs are as for PathWriter.
+		 * The reorderWindow (at least one) limits the number of
+		 * records held for reordering (ref class description).
+		 */
+		explicit
+		AsyncPathWriter
+			( std::filesystem::path const & outPath
+			, std::size_t const & numProducers
+			, std::size_t const & ringSize = 64u
+			, bool const & useDeltaLocs = false
+			, std::size_t const & reorderWindow = 256u
+			);
+
+		//! Calls finish() if not done already.
+		~AsyncPathWriter
+			();
+
+		AsyncPathWriter(AsyncPathWriter const &) = delete;
+		AsyncPathWriter & operator=(AsyncPathWriter const &) = delete;
+
+		//! True if archive was created and all writes have succeeded.
+		bool
+		isValid
+			() const;
+
+		//! Number of producer queues.
+		std::size_t
+		numProducers
+			() const;
+
+		//! Number of paths written to archive so far.
+		std::size_t
+		numWritten
+			() const;
+
+		//! Largest number of records held for reordering (so far).
+		std::size_t
+		maxNumHeld
+			() const;
+
+		/*! \brief Hand off path (waits while producer queue is full).
+		 *
+		 * Must only be called from one thread per producerNdx. Returns
+		 * false (nothing queued) if producerNdx is out of range or if
+		 * finish() has been called.
+		 */
+		bool
+		push
+			( std::size_t const & producerNdx
+			, std::size_t const & seq
+			, Start const & start
+			, std::vector<Node> && nodes
+			);
+
+		/*! \brief Write all queued paths, join thread, and close archive.
+		 *
+		 * Must be called after all producers have finished pushing.
+		 * Returns true if all paths were written and the archive closed.
+		 */
+		bool
+		finish
+			();
+
+	}; // AsyncPathWriter
+
+	/*! \brief Consumer (ref Propagator::tracePath()) for AsyncPathWriter.
+	 *
+	 * Nodes of the (one) ray are accumulated and handed off (moved)
+	 * to the writer by flush(), which the destructor calls if needed.
+	 */
+	struct AsyncPathStream
+	{
+		//! Starting boundary condition (direction and location) for the ray
+		Start const theStart{};
+
+		//! Writer to which to hand off the ray.
+		AsyncPathWriter * const thePtWriter{ nullptr };
+
+		//! Producer (queue) index of calling thread.
+		std::size_t const theProducerNdx{ 0u };
+
+		//! Output sequence number for the ray.
+		std::size_t const theSeq{ 0u };
+
+	private:
+
+		std::vector<Node> theNodes{};
+		std::size_t theMaxNodes{ 0u };
+		bool theIsFlushed{ false };
+
+	public:
+
+		//! Consumer to accept up to maxNodes nodes.
+		inline
+		explicit
+		AsyncPathStream
+			( Start const & start
+			, AsyncPathWriter * const & ptWriter
+			, std::size_t const & producerNdx
+			, std::size_t const & seq
+			, std::size_t const & maxNodes
+			)
+			: theStart{ start }
+			, thePtWriter{ ptWriter }
+			, theProducerNdx{ producerNdx }
+			, theSeq{ seq }
+			, theNodes{}
+			, theMaxNodes{ maxNodes }
+			, theIsFlushed{ false }
+		{
+			theNodes.reserve(maxNodes);
+		}
+
+		//! Hand off ray to writer (if not yet done)
+		inline
+		~AsyncPathStream
+			()
+		{
+			flush();
+		}
+
+		AsyncPathStream(AsyncPathStream const &) = delete;
+		AsyncPathStream & operator=(AsyncPathStream const &) = delete;
+
+		//! Number of nodes consumed.
+		inline
+		std::size_t
+		size // AsyncPathStream::
+			() const
+		{
+			return theNodes.size();
+		}
+
+		//! Maximum number of nodes to consume.
+		inline
+		std::size_t
+		capacity // AsyncPathStream::
+			() const
+		{
+			return theMaxNodes;
+		}
+
+		//! Accept node
+		inline
+		void
+		emplace_back // AsyncPathStream::
+			( ray::Node const & node
+			)
+		{
+			theNodes.emplace_back(node);
+		}
+
+		//! Hand off ray to writer (once) - true if successful.
+		inline
+		bool
+		flush // AsyncPathStream::
+			()
+		{
+			bool okay{ theIsFlushed };
+			if ((! theIsFlushed) && thePtWriter)
+			{
+				okay = thePtWriter->push
+					(theProducerNdx, theSeq, theStart, std::move(theNodes));
+				theIsFlushed = true;
+			}
+			return okay;
+		}
+
+	}; // AsyncPathStream
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_AsyncPathWriter_INCL_
+
@@ -0,0 +1,119 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_BundleStats_INCL_
+#define aply_ray_BundleStats_INCL_
+
+/*! \file
+\brief Declarations for ray::BundleStats
+*/
+
+
+#include "mathStats.hpp"
+#include "rayPathSummary.hpp"
+
+#include <cstddef>
+#include <string>
+
+
+namespace aply
+{
+namespace ray
+{
+
+/*! \brief Aggregate (constant memory) statistics of a bundle of rays.
+
+Each added PathSummary contributes its total deviation magnitude,
+end deflection and path distance to running statistics (mean,
+variance, range) and to histograms of deviation and deflection.
+
+For multi-threaded tracing, each thread accumulates into its own
+instance (no locking or shared state) and the per-thread instances
+are combined with merge() after the threads finish.
+
+Example:
+\snippet test_BundleStats.cpp DoxyExample01
+
+*/
+struct BundleStats
+{
+	//! Number of rays added (including those without a valid path)
+	std::size_t theNumRays{ 0u };
+
+	//! Number of rays with fewer than two nodes (metrics undefined)
+	std::size_t theNumEmpty{ 0u };
+
+	//! Magnitude of PathSummary::totalDeviation() [rad]
+	math::RunningStats theDeviations{};
+
+	//! PathSummary::endDeflection() [length]
+	math::RunningStats theDeflections{};
+
+	//! PathSummary::pathDistance() [length]
+	math::RunningStats thePathDists{};
+
+	//! Histogram of theDeviations values
+	math::Histogram theDevHist{};
+
+	//! Histogram of theDeflections values
+	math::Histogram theDeflHist{};
+
+	//! default null constructor (histograms without bins)
+	BundleStats
+		() = default;
+
+	//! Histograms with numBins bins from zero to maxDev and maxDefl.
+	explicit
+	BundleStats
+		( double const & maxDeviation
+		, double const & maxDeflection
+		, std::size_t const & numBins = 64u
+		);
+
+	//! Incorporate metrics of one ray path
+	void
+	add
+		( PathSummary const & summary
+		);
+
+	//! Incorporate all rays accumulated by other (false if bins differ).
+	bool
+	merge
+		( BundleStats const & other
+		);
+
+	//! Descriptive information about this instance
+	std::string
+	infoString
+		( std::string const & title = {}
+		) const;
+
+}; // BundleStats
+
+} // [ray]
+} // [aply]
+
+#endif // aply_ray_BundleStats_INCL_
+
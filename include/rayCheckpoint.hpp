@@ -0,0 +1,134 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_Checkpoint_INCL_
+#define aply_ray_Checkpoint_INCL_
+
+/*! \file
+ *
+ * \brief Save and restore of (partially traced) ray path state.
+ *
+ */
+
+
+#include "rayNode.hpp"
+#include "rayPath.hpp"
+#include "rayPropagator.hpp"
+#include "rayStart.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	/*! \brief Complete state of a (long) trace in progress.
+	 *
+	 * Holds the Path (nodes, arc and optical distances, bookkeeping), the
+	 * propagation state (Propagator::TraceState) and LoopStats
+	 * counters. A trace resumed from a checkpoint (with the same
+	 * Propagator configuration) produces the same nodes, to the
+	 * last bit, as if it had not been interrupted.
+	 *
+	 * Checkpoint files are binary (native byte order). save() writes
+	 * to a temporary file which is then renamed, so that an existing
+	 * checkpoint file is not lost if the program is interrupted
+	 * while saving.
+	 *
+	 * Example:
+	 * \snippet test_Checkpoint.cpp DoxyExample01
+	 */
+	struct Checkpoint
+	{
+		//! Path Start
+		Start const theStart{};
+		//! Path::theSaveDist
+		double theSaveDist{ null<double>() };
+		//! Path capacity (controls path termination)
+		std::size_t theCapacity{ 0u };
+		//! Path::theNodes
+		std::vector<Node> theNodes{};
+		//! Path::theArcDists
+		std::vector<double> theArcDists{};
+		//! Path::theOptDists
+		std::vector<double> theOptDists{};
+		//! Path::bookkeeping()
+		Path::Bookkeeping theBookkeeping{};
+		//! Propagation state (ref Propagator::continuePath())
+		Propagator::TraceState theTraceState{};
+		//! Accumulated propagation statistics
+		LoopStats theStats{};
+
+		//! Checkpoint of path (traced to state with stats).
+		static
+		Checkpoint
+		from
+			( Path const & path
+			, Propagator::TraceState const & state
+			, LoopStats const & stats = {}
+			);
+
+		//! Checkpoint loaded from file (!isValid() on failure).
+		static
+		Checkpoint
+		load
+			( std::filesystem::path const & loadPath
+			);
+
+		//! True if instance has valid path parameters.
+		bool
+		isValid
+			() const;
+
+		//! Save to file - true if successful.
+		bool
+		save
+			( std::filesystem::path const & savePath
+			) const;
+
+		//! Path (with capacity) restored to state at checkpoint.
+		Path
+		path
+			() const;
+
+		//! Descriptive information about this instance
+		std::string
+		infoString
+			( std::string const & title = {}
+			) const;
+
+	}; // Checkpoint
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_Checkpoint_INCL_
+
@@ -94,6 +94,8 @@ namespace ray
 			case Converged: name = "Converged"; break;
 			case Diverged:  name = "Diverged";  break;
 			case Reflected: name = "Reflected"; break;
+			case Stopped:   name = "Stopped";   break;
+			case Started:   name = "Started";   break;
 			default: name = "Null"; break;
 		}
 		return name;
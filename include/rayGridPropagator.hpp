@@ -0,0 +1,330 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_GridPropagator_INCL_
+#define aply_ray_GridPropagator_INCL_
+
+/*! \file
+ *
+ * \brief Cell by cell ray propagation through gridded media.
+ *
+ */
+
+
+#include "envIndexGrid.hpp"
+#include "mathCrossing.hpp"
+#include "rayDirChange.hpp"
+#include "rayNode.hpp"
+#include "rayPropagator.hpp"
+
+#include <Engabra>
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+
+namespace aply
+{
+namespace ray
+{
+	using namespace engabra::g3;
+
+	/*! \brief Propagate rays through an env::IndexGrid one cell at a time.
+	 *
+	 * Within each grid cell, the media is modeled with nu^2 linear
+	 * in location, i.e. with value and gradient (nuC, gC) of the cell
+	 * center (ref env::IndexGrid::cellNuAndGradient()),
+	 * \verbatim
+	 *   nu^2(r) = nuC^2 + 2*nuC*gC.(r - rC)
+	 * \endverbatim
+	 * For this model, the ray path is (exactly) a parabola (nearly a
+	 * circular arc) in parameter sigma, with "momentum" p = nu*tangent:
+	 * \verbatim
+	 *   r(sigma) = r0 + p0*sigma + (G/4)*sigma^2 ; G = 2*nuC*gC
+	 *   p(sigma) = p0 + (G/2)*sigma
+	 * \endverbatim
+	 * The cell exit location is the smallest crossing of the six cell
+	 * faces (each the root of a quadratic, ref math::crossingParameter())
+	 * so that the cells along the ray are walked as with a 3D digital
+	 * differential analyzer (DDA). Adjacent cell models differ slightly
+	 * at common faces and the ray tangent is updated with
+	 * nextTangentDir() there (only).
+	 *
+	 * Nodes are provided to the consumer at the start and at each cell
+	 * face crossing. The computation effort therefore depends on the
+	 * number of cells crossed (rather than on a step size). The last
+	 * node (with theDirChange Stopped) is where the ray leaves the grid.
+	 *
+	 * Example:
+	 * \snippet test_GridPropagator.cpp DoxyExample01
+	 */
+	struct GridPropagator
+	{
+		//! Gridded media through which to propagate rays
+		env::IndexGrid const * const thePtGrid{ nullptr };
+
+	private:
+
+		//! Linear (in nu^2) media model for one grid cell.
+		struct CellModel
+		{
+			//! Center of cell
+			Vector theCenter{ null<Vector>() };
+			//! IoR at cell center
+			double theNuC{ null<double>() };
+			//! Gradient of nu^2 (constant within cell)
+			Vector theQGrad{ null<Vector>() };
+
+			//! Model IoR value at location (null if not positive).
+			inline
+			double
+			nuAt // CellModel::
+				( Vector const & rVec
+				) const
+			{
+				double nu{ null<double>() };
+				Vector const rDelta{ rVec - theCenter };
+				double const qDelta{ (theQGrad * rDelta).theSca[0] };
+				double const qVal{ theNuC*theNuC + qDelta };
+				if (0. < qVal)
+				{
+					nu = std::sqrt(qVal);
+				}
+				return nu;
+			}
+		};
+
+		//! Linear model for cell
+		inline
+		CellModel
+		modelFor // GridPropagator::
+			( env::IndexGrid::Cell const & cell
+			) const
+		{
+			double const & delta = thePtGrid->theDelta;
+			Vector const rMin{ thePtGrid->cellMinCorner(cell) };
+			std::pair<double, Vector> const nuGrad
+				{ thePtGrid->cellNuAndGradient(cell) };
+			return CellModel
+				{ rMin + (.5*delta) * Vector{ 1., 1., 1. }
+				, nuGrad.first
+				, (2.*nuGrad.first) * nuGrad.second
+				};
+		}
+
+		/*! \brief Cell (adjacent across face) or nullCell() if outside.
+		 *
+		 * The face is perpendicular to axis and on the positive side of
+		 * the cell if isUp (else on the negative side).
+		 */
+		inline
+		env::IndexGrid::Cell
+		neighborOf // GridPropagator::
+			( env::IndexGrid::Cell const & cell
+			, std::size_t const & axis
+			, bool const & isUp
+			) const
+		{
+			env::IndexGrid::Cell nbr{ env::IndexGrid::nullCell() };
+			if (isUp)
+			{
+				if ((cell[axis] + 2u) < thePtGrid->theNumNodes[axis])
+				{
+					nbr = cell;
+					nbr[axis] = cell[axis] + 1u;
+				}
+			}
+			else
+			if (0u < cell[axis])
+			{
+				nbr = cell;
+				nbr[axis] = cell[axis] - 1u;
+			}
+			return nbr;
+		}
+
+	public:
+
+		//! True if instance is valid
+		inline
+		bool
+		isValid // GridPropagator::
+			() const
+		{
+			return (thePtGrid && thePtGrid->isValid());
+		}
+
+		/*! \brief Propagate ray from ptConsumer->theStart through grid.
+		 *
+		 * Nodes are provided to the consumer (with emplace_back()) at
+		 * each cell face crossing until the ray leaves the grid or
+		 * until ptConsumer->capacity() nodes are consumed. Note that
+		 * ray::Path archives nodes by distance (e.g. use a theSaveDist
+		 * no larger than the grid cell size to keep every node).
+		 */
+		template <typename Consumer>
+		inline
+		void
+		tracePath // GridPropagator::
+			( Consumer * const & ptConsumer
+			) const
+		{
+			env::IndexGrid::Cell cell{ env::IndexGrid::nullCell() };
+			double nuBeg{ null<double>() };
+			CellModel model{};
+			if (isValid() && ptConsumer)
+			{
+				cell = thePtGrid->cellFor(ptConsumer->theStart.thePntLoc);
+				if (thePtGrid->isCell(cell))
+				{
+					model = modelFor(cell);
+					nuBeg = model.nuAt(ptConsumer->theStart.thePntLoc);
+				}
+			}
+			if (! engabra::g3::isValid(nuBeg))
+			{
+				return; // start is outside of grid
+			}
+
+			env::IndexGrid const & grid = *thePtGrid;
+			Vector const tBeg{ direction(ptConsumer->theStart.theTanDir) };
+			Vector const & rBeg = ptConsumer->theStart.thePntLoc;
+			if (ptConsumer->size() < ptConsumer->capacity())
+			{
+				ptConsumer->emplace_back
+					(Node{ tBeg, nuBeg, rBeg, nuBeg, tBeg, Started });
+			}
+
+			std::array<Vector, 3u> const axes{ e1, e2, e3 };
+			constexpr double never{ std::numeric_limits<double>::infinity() };
+			Vector rCurr{ rBeg };
+			Vector pCurr{ nuBeg * tBeg };
+			while (ptConsumer->size() < ptConsumer->capacity())
+			{
+				// closed form exit through one of the six cell faces
+				Vector const rMin{ grid.cellMinCorner(cell) };
+				double const & delta = grid.theDelta;
+				Vector const & accel = model.theQGrad;
+				double sigExit{ never };
+				std::size_t exitAxis{ 0u };
+				bool exitUp{ false };
+				for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+				{
+					double const & lo = rMin[ax];
+					double const hi{ lo + delta };
+					// (roundoff) keep current location within the cell
+					double const rAx{ std::min(hi, std::max(lo, rCurr[ax])) };
+					double const & pAx = pCurr[ax];
+					double const & aAx = accel[ax];
+					double const sigUp
+						{ math::crossingParameter(hi - rAx, pAx, aAx) };
+					double const sigDn
+						{ math::crossingParameter(rAx - lo, -pAx, -aAx) };
+					if (sigUp < sigExit)
+					{
+						sigExit = sigUp;
+						exitAxis = ax;
+						exitUp = true;
+					}
+					if (sigDn < sigExit)
+					{
+						sigExit = sigDn;
+						exitAxis = ax;
+						exitUp = false;
+					}
+				}
+				if (! (sigExit < never))
+				{
+					break; // e.g. degenerate (zero) momentum
+				}
+
+				// propagate to exit face (set exactly onto face)
+				Vector const rExit
+					{ rCurr + sigExit*pCurr + (.25*sigExit*sigExit)*accel };
+				std::array<double, 3u> comps{ rExit[0], rExit[1], rExit[2] };
+				comps[exitAxis] = exitUp
+					? (rMin[exitAxis] + delta)
+					: rMin[exitAxis];
+				Vector const rNext{ comps[0], comps[1], comps[2] };
+				Vector const pExit{ pCurr + (.5*sigExit)*accel };
+				Vector const tPrev{ direction(pExit) };
+				// (same evaluation as nuNext, e.g. equal for uniform media)
+				double const nuPrev{ model.nuAt(rNext) };
+
+				// media on far side of face
+				env::IndexGrid::Cell const nbr
+					{ neighborOf(cell, exitAxis, exitUp) };
+				double nuNext{ null<double>() };
+				CellModel nbrModel{};
+				if (grid.isCell(nbr))
+				{
+					nbrModel = modelFor(nbr);
+					nuNext = nbrModel.nuAt(rNext);
+				}
+				if (! engabra::g3::isValid(nuNext))
+				{
+					// leaving grid
+					ptConsumer->emplace_back
+						(Node{ tPrev, nuPrev, rNext, nuPrev, tPrev, Stopped });
+					break;
+				}
+
+				// refraction at face between adjacent cell models
+				std::pair<Vector, DirChange> tanChange{ tPrev, Unaltered };
+				if (! (nuNext == nuPrev))
+				{
+					double const sign{ exitUp ? 1. : -1. };
+					Vector const gFace
+						{ (sign * (nuNext - nuPrev)) * axes[exitAxis] };
+					tanChange = nextTangentDir(tPrev, nuPrev, gFace, nuNext);
+				}
+				Vector const & tNext = tanChange.first;
+				DirChange const & change = tanChange.second;
+				if (Reflected == change)
+				{
+					nuNext = nuPrev; // remain in this cell
+				}
+				else
+				{
+					cell = nbr;
+					model = nbrModel;
+				}
+
+				ptConsumer->emplace_back
+					(Node{ tPrev, nuPrev, rNext, nuNext, tNext, change });
+
+				rCurr = rNext;
+				pCurr = nuNext * tNext;
+			}
+		}
+
+	}; // GridPropagator
+
+} // [ray]
+} // [aply]
+
+#endif // aply_ray_GridPropagator_INCL_
+
@@ -0,0 +1,273 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_NodeGenerator_INCL_
+#define aply_ray_NodeGenerator_INCL_
+
+/*! \file
+ *
+ * \brief Pull-based (lazy) production of ray path nodes.
+ *
+ */
+
+
+#include "rayNode.hpp"
+#include "rayPropagator.hpp"
+#include "rayStart.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	/*! \brief Produce ray path nodes on demand (one step per node).
+	 *
+	 * An explicit state machine equivalent to Propagator::tracePath()
+	 * (the same nodes in the same order) but driven by the caller.
+	 * Each call to next() performs exactly one propagation step, so
+	 * the caller may
+	 * \arg consume only as many nodes as are needed (e.g. stop at a
+	 * target) without computing (or storing) the rest of the path.
+	 * \arg interleave many rays cooperatively on one thread (e.g.
+	 * round robin over several generators).
+	 *
+	 * No nodes are stored, other than the most recent one. The
+	 * propagator (and its media) must outlive the generator.
+	 *
+	 * The generator is also a (single pass) input range:
+	 * \snippet test_NodeGenerator.cpp DoxyExample01
+	 */
+	class NodeGenerator
+	{
+		Propagator const * thePtPropagator{ nullptr };
+		Propagator::TraceState theState{};
+		LoopStats * thePtStats{ nullptr };
+		std::optional<Node> theNode{};
+		std::size_t theNumNodes{ 0u };
+
+	public:
+
+		//! \brief Single pass iterator over generated nodes.
+		class iterator
+		{
+			NodeGenerator * thePtGen{ nullptr };
+
+		public:
+
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Node;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Node const *;
+			using reference = Node const &;
+
+			//! End (exhausted) iterator.
+			iterator
+				() = default;
+
+			//! Iterator referencing generator current node.
+			inline
+			explicit
+			iterator
+				( NodeGenerator * const & ptGen
+				)
+				: thePtGen{ ptGen }
+			{ }
+
+			//! Current node.
+			inline
+			Node const &
+			operator* // NodeGenerator::iterator::
+				() const
+			{
+				return thePtGen->node();
+			}
+
+			//! Access current node members.
+			inline
+			Node const *
+			operator-> // NodeGenerator::iterator::
+				() const
+			{
+				return &(thePtGen->node());
+			}
+
+			//! Generate next node (becomes end() once path has stopped).
+			inline
+			iterator &
+			operator++ // NodeGenerator::iterator::
+				()
+			{
+				if (! thePtGen->next())
+				{
+					thePtGen = nullptr;
+				}
+				return *this;
+			}
+
+			//! True if both are end() or both refer to same generator.
+			inline
+			bool
+			operator== // NodeGenerator::iterator::
+				( iterator const & other
+				) const
+			{
+				return (thePtGen == other.thePtGen);
+			}
+
+			//! Negation of operator==()
+			inline
+			bool
+			operator!= // NodeGenerator::iterator::
+				( iterator const & other
+				) const
+			{
+				return (! operator==(other));
+			}
+
+		}; // iterator
+
+		//! Default null instance (not active)
+		NodeGenerator
+			() = default;
+
+		/*! \brief Generator for path from start through propagator media.
+		 *
+		 * If ptStats is provided, the refinement loop work is
+		 * accumulated into it (ref Propagator::tracePath()).
+		 */
+		inline
+		explicit
+		NodeGenerator
+			( Propagator const & propagator
+			, Start const & start
+			, LoopStats * const & ptStats = nullptr
+			)
+			: thePtPropagator{ &propagator }
+			, theState{ propagator.traceStateFor(start) }
+			, thePtStats{ ptStats }
+			, theNode{}
+			, theNumNodes{ 0u }
+		{ }
+
+		//! True if more nodes may be produced (path has not stopped).
+		inline
+		bool
+		isActive // NodeGenerator::
+			() const
+		{
+			return (thePtPropagator && (! theState.theIsStopped));
+		}
+
+		//! Number of nodes produced so far.
+		inline
+		std::size_t
+		numNodes // NodeGenerator::
+			() const
+		{
+			return theNumNodes;
+		}
+
+		/*! \brief Produce the next node - false if path has stopped.
+		 *
+		 * After a true return, the node is available from node().
+		 */
+		inline
+		bool
+		next // NodeGenerator::
+			()
+		{
+			bool okay{ false };
+			if (isActive())
+			{
+				Node const node
+					{ thePtPropagator->nextNode(&theState, thePtStats) };
+				okay = (! (Stopped == node.theDirChange));
+				if (okay)
+				{
+					theNode.emplace(node);
+					++theNumNodes;
+				}
+			}
+			if (! okay)
+			{
+				theNode.reset();
+			}
+			return okay;
+		}
+
+		//! True if a (most recently produced) node is available.
+		inline
+		bool
+		hasNode // NodeGenerator::
+			() const
+		{
+			return theNode.has_value();
+		}
+
+		//! Most recently produced node (only valid if hasNode()).
+		inline
+		Node const &
+		node // NodeGenerator::
+			() const
+		{
+			return *theNode;
+		}
+
+		//! Iterator at first (newly generated) node - begin once only.
+		inline
+		iterator
+		begin // NodeGenerator::
+			()
+		{
+			iterator iter{};
+			if (next())
+			{
+				iter = iterator(this);
+			}
+			return iter;
+		}
+
+		//! Iterator after last node
+		inline
+		iterator
+		end // NodeGenerator::
+			()
+		{
+			return iterator{};
+		}
+
+	}; // NodeGenerator
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_NodeGenerator_INCL_
+
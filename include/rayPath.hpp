@@ -61,6 +61,85 @@ namespace ray
 	 */
 	struct Path
 	{
+		/*! \brief Node consideration progress (e.g. to resume a path).
+		 *
+		 * Together with theNodes, theArcDists and theOptDists, the
+		 * information needed to continue considering nodes exactly as
+		 * if the path had never been interrupted (ref Checkpoint).
+		 */
+		struct Bookkeeping // Path::
+		{
+			//! Residual arc-length since last archived node
+			double theResidArcDist{ null<double>() };
+			//! The location of the last considered node
+			Vector theLastSeenLoc{ null<Vector>() };
+			//! Residual optical path length since last archived node
+			double theResidOptDist{ null<double>() };
+			//! IoR (theNextNu) at the last considered node
+			double theLastSeenNu{ null<double>() };
+
+			/*! \brief Accumulate node distances, true if node is to be saved.
+			 *
+			 * Adds the arc and optical distance from the previously
+			 * considered node. If the (first) node is to be saved, the
+			 * residual distances since the last saved node are returned
+			 * in (*ptArcDist, *ptOptDist) and are then reset to zero.
+			 * Shared by Path::considerNode() and PooledPath.
+			 */
+			inline
+			bool
+			consider // Path::Bookkeeping::
+				( ray::Node const & node
+					//!< Node to consider (e.g. from Propagator)
+				, double const & saveDist
+					//!< Save node if residual arc distance reaches this
+				, bool const & isFirst
+					//!< True for the first node (always saved)
+				, double * const & ptArcDist
+					//!< Arc distance since last saved node (if saved)
+				, double * const & ptOptDist
+					//!< Optical distance since last saved node (if saved)
+				)
+			{
+				if (isFirst)
+				{
+					theResidArcDist = 0.;
+					theResidOptDist = 0.;
+				}
+				else
+				{
+					// check distance from previously considered node
+					Vector const delta{ node.theCurrLoc - theLastSeenLoc };
+					double const deltaMag{ magnitude(delta) };
+					// increment residual arc length by this much
+					theResidArcDist += deltaMag;
+					// and optical length with IoR on either side of step
+					double const stepNu
+						{ .5 * (theLastSeenNu + node.thePrevNu) };
+					theResidOptDist += stepNu * deltaMag;
+				}
+
+				// always save the first node, else if save distance reached
+				bool const saveThisNode
+					{ isFirst || (! (theResidArcDist < saveDist)) };
+				if (saveThisNode)
+				{
+					// report distances since last saved node and restart
+					*ptArcDist = theResidArcDist;
+					*ptOptDist = theResidOptDist;
+					theResidArcDist = 0.;
+					theResidOptDist = 0.;
+				}
+
+				// remember the last considered node (whether saved or not)
+				theLastSeenLoc = node.theCurrLoc;
+				theLastSeenNu = node.theNextNu;
+
+				return saveThisNode;
+			}
+
+		}; // Bookkeeping
+
 		//! Starting boundary condition (direction and location) for the ray
 		Start const theStart{};
 		//! Increment specifying how often to archive path data in theNodes.
@@ -72,13 +151,19 @@ namespace ray
 		 * \arg theArcDists[ndx] : arc distance from node[ndx-1] to node[ndx]
 		 */
 		std::vector<double> theArcDists{};
+		/*! \brief Optical path length (integral of IoR over arc length).
+		 *
+		 * \arg theOptDists[ndx] : optical distance from node[ndx-1]
+		 * to node[ndx]. Between considered nodes, the IoR is the
+		 * average of the previous node theNextNu and the current node
+		 * thePrevNu (i.e. the values on either side of the step).
+		 */
+		std::vector<double> theOptDists{};
 
 	private:
 
-		//! Track (approximate) residual arc-length since last archived node
-		double theResidArcDist{ null<double>() };
-		//! The location of the last considered (but generally not saved) node
-		Vector theLastSeenLoc{ null<Vector>() };
+		//! Residual distances and last considered (not saved) node info
+		Bookkeeping theBook{};
 
 		//! Estimate collection size needed to span between beg/end locations.
 		inline
@@ -116,8 +201,8 @@ namespace ray
 			, theSaveDist{ saveStepDist }
 			, theNodes{}
 			, theArcDists{}
-			, theResidArcDist{ null<double>() }
-			, theLastSeenLoc{ null<Vector>() }
+			, theOptDists{}
+			, theBook{}
 		{
 			// estimate distance (as if straight line)
 			if (engabra::g3::isValid(approxEndLoc))
@@ -193,42 +278,40 @@ namespace ray
 			( ray::Node const & node
 			)
 		{
-			bool saveThisNode{ false };
-
-			if (theNodes.empty())
-			{
-				saveThisNode = true;
-				theResidArcDist = 0.;
-			}
-			else
-			{
-				// check distance from previously considered node
-				Vector const delta{ node.theCurrLoc - theLastSeenLoc };
-				double const deltaMag{ magnitude(delta) };
-				// increment residual arc length by this much
-				theResidArcDist += deltaMag;
-			}
-
-			// check if save distance is exceeded
-			if (! (theResidArcDist < theSaveDist))
-			{
-				saveThisNode = true;
-			}
-
-			if (saveThisNode)
+			double arcDist{ null<double>() };
+			double optDist{ null<double>() };
+			bool const isFirst{ theNodes.empty() };
+			if (theBook.consider
+				(node, theSaveDist, isFirst, &arcDist, &optDist))
 			{
-				// always add the first node
 				theNodes.emplace_back(node);
-
-				// record arch length since last saved node
-				theArcDists.emplace_back(theResidArcDist);
-
-				// set residual arc distance
-				theResidArcDist = 0.;
+				// record arc and optical lengths since last saved node
+				theArcDists.emplace_back(arcDist);
+				theOptDists.emplace_back(optDist);
 			}
+		}
+
+		//! Progress of node consideration (ref setBookkeeping()).
+		inline
+		Bookkeeping
+		bookkeeping // Path::
+			() const
+		{
+			return theBook;
+		}
 
-			// remember the last considered node (whether added or not)
-			theLastSeenLoc = node.theCurrLoc;
+		/*! \brief Restore node consideration progress.
+		 *
+		 * For use (with theNodes, theArcDists and theOptDists restored)
+		 * to resume a path, e.g. from a Checkpoint.
+		 */
+		inline
+		void
+		setBookkeeping // Path::
+			( Bookkeeping const & bookkeeping
+			)
+		{
+			theBook = bookkeeping;
 		}
 
 		//! Descriptive information about this instance
@@ -0,0 +1,348 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_PathArchive_INCL_
+#define aply_ray_PathArchive_INCL_
+
+/*! \file
+ *
+ * \brief Streaming binary (columnar) archive of traced ray paths.
+ *
+ * Archive file layout (native byte order, all fields 8-byte aligned):
+ * \arg Header: magic "APLYRAY1", flags (e.g. sPathDeltaLocs)
+ * \arg Data: per ray (in order written), columns each with numNodes
+ * values (ref PathColumns) appended as each ray is completed.
+ * \arg Index: one PathEntry per ray (written when archive is closed)
+ * \arg Trailer: magic, ray count, index offset, flags (last 32 bytes)
+ *
+ * Rays are written in sequence (e.g. at disk bandwidth) by a
+ * PathWriter, most easily by tracing each ray into a PathStream
+ * consumer. A reader (PathArchive) memory-maps the file, locates the
+ * index from the trailer and accesses any ray in place.
+ */
+
+
+#include "rayNode.hpp"
+#include "rayStart.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	//! Flag bit: locations are stored as (float) deltas from previous.
+	constexpr std::uint64_t sPathDeltaLocs{ 1u };
+
+	//! \brief Index record (on disk) describing one archived ray path.
+	struct PathEntry
+	{
+		double theStartDir[3]; //!< Start::theTanDir
+		double theStartLoc[3]; //!< Start::thePntLoc
+		double theBaseLoc[3]; //!< Location of first node
+		std::uint64_t theDataOffset; //!< Byte offset of column data
+		std::uint64_t theNumNodes; //!< Number of values in each column
+		std::uint64_t theReserved; //!< (zero)
+
+		//! Start (initial) conditions of the ray.
+		Start
+		start
+			() const;
+	};
+
+	static_assert(96u == sizeof(PathEntry), "PathEntry must pack");
+
+	/*! \brief Columnar (zero-copy) view into an archived ray path.
+	 *
+	 * Node locations are available as either (full precision) theLocs
+	 * or (if the archive is delta encoded) as theLocDeltas relative to
+	 * the previous (decoded) location, starting from theBaseLoc.
+	 */
+	struct PathColumns
+	{
+		std::size_t theNumNodes{ 0u }; //!< Number of values per column
+		Vector theBaseLoc{ null<Vector>() }; //!< Location of first node
+		double const * theLocs[3]{}; //!< Node::theCurrLoc (if not delta)
+		float const * theLocDeltas[3]{}; //!< Location deltas (if delta)
+		double const * thePrevTans[3]{}; //!< Node::thePrevTan
+		double const * thePrevNus{ nullptr }; //!< Node::thePrevNu
+		double const * theNextNus{ nullptr }; //!< Node::theNextNu
+		double const * theNextTans[3]{}; //!< Node::theNextTan
+		std::uint8_t const * theChanges{ nullptr }; //!< Node::theDirChange
+
+		//! True if view refers to (at least) one node of data.
+		bool
+		isValid
+			() const;
+
+		//! Nodes decoded from the columns (in path order).
+		std::vector<Node>
+		nodes
+			() const;
+	};
+
+	/*! \brief Sequential writer of (many) ray paths into archive file.
+	 *
+	 * Column data for each ray are written (appended) by appendRay()
+	 * and the index (and trailer) by close(), which the destructor
+	 * calls if it was not called already.
+	 *
+	 * If useDeltaLocs is true, node locations are stored (lossy) as
+	 * float differences from the previously decoded location. This
+	 * reduces the location storage by half. The decoded locations
+	 * have errors (not accumulating along the path) of about float
+	 * epsilon times the node spacing.
+	 */
+	class PathWriter
+	{
+		std::ofstream theOfs{};
+		std::uint64_t theFlags{ 0u };
+		std::uint64_t theOffset{ 0u };
+		std::vector<PathEntry> theEntries{};
+		bool theIsOpen{ false };
+
+	public:
+
+		//! Create archive file (check isValid() for success).
+		explicit
+		PathWriter
+			( std::filesystem::path const & outPath
+			, bool const & useDeltaLocs = false
+			);
+
+		//! Close (finalize) archive if not done already.
+		~PathWriter
+			();
+
+		PathWriter(PathWriter const &) = delete;
+		PathWriter & operator=(PathWriter const &) = delete;
+
+		//! True if file is open and all writes have succeeded.
+		bool
+		isValid
+			() const;
+
+		//! Number of rays appended so far.
+		std::size_t
+		numRays
+			() const;
+
+		//! Append column data for one ray path.
+		bool
+		appendRay
+			( Start const & start
+			, std::vector<Node> const & nodes
+			);
+
+		//! Write index and trailer - returns true if archive is complete.
+		bool
+		close
+			();
+
+	}; // PathWriter
+
+	/*! \brief Consumer (ref Propagator::tracePath()) writing to PathWriter.
+	 *
+	 * Nodes of the (one) ray are buffered and appended to the writer
+	 * (with PathWriter::appendRay()) by flush(), which the destructor
+	 * calls if needed. Memory use is bounded by the nodes of one ray
+	 * (at most maxNodes) regardless of the number of rays written.
+	 *
+	 * Example:
+	 * \snippet test_PathArchive.cpp DoxyExample01
+	 */
+	struct PathStream
+	{
+		//! Starting boundary condition (direction and location) for the ray
+		Start const theStart{};
+
+		//! Archive into which to write the ray.
+		PathWriter * const thePtWriter{ nullptr };
+
+	private:
+
+		std::vector<Node> theNodes{};
+		bool theIsFlushed{ false };
+
+	public:
+
+		//! Consumer to accept up to maxNodes nodes.
+		inline
+		explicit
+		PathStream
+			( Start const & start
+			, PathWriter * const & ptWriter
+			, std::size_t const & maxNodes
+			)
+			: theStart{ start }
+			, thePtWriter{ ptWriter }
+			, theNodes{}
+			, theIsFlushed{ false }
+		{
+			theNodes.reserve(maxNodes);
+		}
+
+		//! Append ray to archive (if not yet done)
+		inline
+		~PathStream
+			()
+		{
+			flush();
+		}
+
+		PathStream(PathStream const &) = delete;
+		PathStream & operator=(PathStream const &) = delete;
+
+		//! Number of nodes consumed.
+		inline
+		std::size_t
+		size // PathStream::
+			() const
+		{
+			return theNodes.size();
+		}
+
+		//! Maximum number of nodes to consume.
+		inline
+		std::size_t
+		capacity // PathStream::
+			() const
+		{
+			return theNodes.capacity();
+		}
+
+		//! Accept node
+		inline
+		void
+		emplace_back // PathStream::
+			( ray::Node const & node
+			)
+		{
+			theNodes.emplace_back(node);
+		}
+
+		//! Append ray to archive (once) - true if successful.
+		inline
+		bool
+		flush // PathStream::
+			()
+		{
+			bool okay{ theIsFlushed };
+			if ((! theIsFlushed) && thePtWriter)
+			{
+				okay = thePtWriter->appendRay(theStart, theNodes);
+				theIsFlushed = true;
+			}
+			return okay;
+		}
+
+	}; // PathStream
+
+	/*! \brief Memory-mapped reader for archive produced by PathWriter.
+	 *
+	 * Opening the archive maps the file and validates the trailer and
+	 * index. Path data are only paged in as they are accessed.
+	 *
+	 * \note The instance is not copyable (it owns the mapping). Views
+	 * returned by columnsAt() are valid only while the archive
+	 * instance exists.
+	 */
+	class PathArchive
+	{
+		void const * theMapAddr{ nullptr };
+		std::size_t theMapSize{ 0u };
+		PathEntry const * theEntries{ nullptr };
+		std::size_t theNumEntries{ 0u };
+		std::uint64_t theFlags{ 0u };
+
+	public:
+
+		//! Map archive file into memory (check isValid() for success).
+		explicit
+		PathArchive
+			( std::filesystem::path const & archivePath
+			);
+
+		//! Release the mapping
+		~PathArchive
+			();
+
+		PathArchive(PathArchive const &) = delete;
+		PathArchive & operator=(PathArchive const &) = delete;
+
+		//! True if archive was successfully mapped and index is consistent.
+		bool
+		isValid
+			() const;
+
+		//! Number of ray paths present in archive.
+		std::size_t
+		size
+			() const;
+
+		//! True if locations are delta encoded (ref sPathDeltaLocs).
+		bool
+		hasDeltaLocs
+			() const;
+
+		//! Index entry (in order written) for ndx < size().
+		PathEntry const &
+		entryAt
+			( std::size_t const & ndx
+			) const;
+
+		//! Columnar view of ray path data (invalid if ndx out of range).
+		PathColumns
+		columnsAt
+			( std::size_t const & ndx
+			) const;
+
+		//! Nodes of ray path (empty if ndx out of range).
+		std::vector<Node>
+		nodesAt
+			( std::size_t const & ndx
+			) const;
+
+		//! \brief Description of archive contents.
+		std::string
+		infoString
+			( std::string const & title = {}
+			) const;
+
+	}; // PathArchive
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_PathArchive_INCL_
+
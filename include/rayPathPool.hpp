@@ -0,0 +1,355 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_PathPool_INCL_
+#define aply_ray_PathPool_INCL_
+
+/*! \file
+ *
+ * \brief Pooled (contiguous slab) storage for the nodes of many paths.
+ *
+ * A PathArena stores the nodes (with arc and optical distances) of
+ * many paths in a few large slabs (one heap allocation per slab
+ * rather than several per path). A PathPool holds one arena per
+ * tracing thread. After a batch has been analyzed, reset() discards
+ * all paths but retains the slabs so that subsequent batches
+ * allocate nothing.
+ *
+ * Paths are written with the PooledPath consumer and are accessed
+ * (in order traced, per arena) as PathSpan views.
+ */
+
+
+#include "rayNode.hpp"
+#include "rayPath.hpp"
+#include "rayStart.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	//! \brief View of one path stored in a PathArena.
+	struct PathSpan
+	{
+		//! Starting boundary condition (direction and location) for the ray
+		Start const theStart{};
+		//! Archived nodes (contiguous)
+		Node const * const thePtNodes{ nullptr };
+		//! Arc distance from previous node (ref Path::theArcDists)
+		double const * const thePtArcDists{ nullptr };
+		//! Optical distance from previous node (ref Path::theOptDists)
+		double const * const thePtOptDists{ nullptr };
+		//! Number of nodes (and arc and optical distances)
+		std::size_t const theNumNodes{ 0u };
+
+		//! Number of nodes
+		inline
+		std::size_t
+		size // PathSpan::
+			() const
+		{
+			return theNumNodes;
+		}
+
+		//! Node at ndx (must be less than size())
+		inline
+		Node const &
+		operator[] // PathSpan::
+			( std::size_t const & ndx
+			) const
+		{
+			return thePtNodes[ndx];
+		}
+
+		//! First node (path must not be empty)
+		inline
+		Node const &
+		front // PathSpan::
+			() const
+		{
+			return thePtNodes[0u];
+		}
+
+		//! Last node (path must not be empty)
+		inline
+		Node const &
+		back // PathSpan::
+			() const
+		{
+			return thePtNodes[theNumNodes - 1u];
+		}
+
+		//! Distance along path (ref PathView::pathDistance()).
+		inline
+		double
+		pathDistance // PathSpan::
+			() const
+		{
+			double sum{ 0. };
+			for (std::size_t nn{0u} ; nn < theNumNodes ; ++nn)
+			{
+				sum += thePtArcDists[nn];
+			}
+			return sum;
+		}
+
+		//! Optical path length (ref PathView::opticalDistance()).
+		inline
+		double
+		opticalDistance // PathSpan::
+			() const
+		{
+			double sum{ 0. };
+			for (std::size_t nn{0u} ; nn < theNumNodes ; ++nn)
+			{
+				sum += thePtOptDists[nn];
+			}
+			return sum;
+		}
+
+	}; // PathSpan
+
+	/*! \brief Slab storage for paths produced by a single thread.
+	 *
+	 * Nodes are appended to the currently open range (at most one
+	 * range is open at a time). A range is opened with enough slab
+	 * space for its maximum size. When closed, the unused space is
+	 * available to the next range, so the paths are stored packed.
+	 *
+	 * \note Not thread safe: use one arena per thread (ref PathPool).
+	 * PathSpan views are valid until reset() (or destruction).
+	 */
+	class PathArena
+	{
+		//! Storage for many paths
+		struct Slab
+		{
+			std::vector<Node> theNodes{};
+			std::vector<double> theArcDists{};
+			std::vector<double> theOptDists{};
+		};
+
+		//! Location of a (closed) path in slabs
+		struct Entry
+		{
+			Start const theStart;
+			std::size_t const theSlabNdx;
+			std::size_t const theBegNdx;
+			std::size_t const theNumNodes;
+		};
+
+		std::size_t theSlabSize{ 0u };
+		std::vector<std::unique_ptr<Slab> > theSlabs{};
+		std::size_t theCurrSlab{ 0u };
+		std::vector<Entry> theEntries{};
+		std::size_t theOpenBeg{ 0u };
+		bool theIsOpen{ false };
+
+	public:
+
+		//! Arena with slabs holding (at least) slabSize nodes each
+		explicit
+		PathArena
+			( std::size_t const & slabSize = (1u << 16u)
+			);
+
+		/*! \brief Open a range for up to maxNodes nodes.
+		 *
+		 * Returns false (nothing opened) if a range is already open.
+		 */
+		bool
+		open
+			( std::size_t const & maxNodes
+			);
+
+		//! Number of nodes in open range.
+		std::size_t
+		openSize
+			() const;
+
+		//! Append to open range (which must have space: openSize() < max)
+		void
+		append
+			( Node const & node
+			, double const & arcDist
+			, double const & optDist
+			);
+
+		//! Close open range, recording it as a path from start.
+		void
+		close
+			( Start const & start
+			);
+
+		//! Discard all paths (slab memory is retained for reuse).
+		void
+		reset
+			();
+
+		//! Number of (closed) paths stored.
+		std::size_t
+		size
+			() const;
+
+		//! Number of slabs allocated.
+		std::size_t
+		numSlabs
+			() const;
+
+		//! View of stored path (ndx < size())
+		PathSpan
+		pathAt
+			( std::size_t const & ndx
+			) const;
+
+	}; // PathArena
+
+	//! \brief Collection of arenas (e.g. one per tracing thread).
+	class PathPool
+	{
+		std::vector<std::unique_ptr<PathArena> > theArenas{};
+
+	public:
+
+		//! Pool of numArenas arenas (with slabs of slabSize nodes).
+		explicit
+		PathPool
+			( std::size_t const & numArenas
+			, std::size_t const & slabSize = (1u << 16u)
+			);
+
+		//! Number of arenas
+		std::size_t
+		numArenas
+			() const;
+
+		//! Arena ndx (e.g. for exclusive use by thread ndx)
+		PathArena &
+		arena
+			( std::size_t const & ndx
+			);
+
+		//! Arena ndx (e.g. for analysis)
+		PathArena const &
+		arena
+			( std::size_t const & ndx
+			) const;
+
+		//! Total number of paths stored in all arenas
+		std::size_t
+		numPaths
+			() const;
+
+		//! Total number of slabs allocated in all arenas
+		std::size_t
+		numSlabs
+			() const;
+
+		//! Discard all paths in all arenas (retaining slab memory).
+		void
+		reset
+			();
+
+	}; // PathPool
+
+	/*! \brief Consumer (ref Path) storing archived nodes in a PathArena.
+	 *
+	 * Nodes are archived (decimated) with theSaveDist exactly as by
+	 * Path, but are stored (directly) in the arena. The path is
+	 * recorded in the arena by finish(), which the destructor calls
+	 * if needed.
+	 *
+	 * Example:
+	 * \snippet test_PathPool.cpp DoxyExample01
+	 */
+	struct PooledPath
+	{
+		//! Starting boundary condition (direction and location) for the ray
+		Start const theStart{};
+		//! Increment specifying how often to archive path data.
+		double const theSaveDist{ null<double>() };
+
+	private:
+
+		PathArena * const thePtArena{ nullptr };
+		std::size_t const theMaxNodes{ 0u };
+		Path::Bookkeeping theBook{};
+		bool theIsOpen{ false };
+
+	public:
+
+		//! Consumer archiving up to maxNodes nodes into *ptArena.
+		explicit
+		PooledPath
+			( Start const & start
+			, double const & saveStepDist
+			, PathArena * const & ptArena
+			, std::size_t const & maxNodes
+			);
+
+		//! Record path in arena (if not already done).
+		~PooledPath
+			();
+
+		PooledPath(PooledPath const &) = delete;
+		PooledPath & operator=(PooledPath const &) = delete;
+
+		//! Number of nodes archived.
+		std::size_t
+		size
+			() const;
+
+		//! Maximum number of nodes to archive.
+		std::size_t
+		capacity
+			() const;
+
+		//! Process a node - archive it if beyond theSaveDist (ref Path)
+		void
+		emplace_back
+			( ray::Node const & node
+			);
+
+		//! Record path in arena (once).
+		void
+		finish
+			();
+
+	}; // PooledPath
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_PathPool_INCL_
+
@@ -0,0 +1,316 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_PathSummary_INCL_
+#define aply_ray_PathSummary_INCL_
+
+/*! \file
+ *
+ * \brief Endpoint-only (constant memory) path consumer.
+ *
+ */
+
+
+#include "rayNode.hpp"
+#include "rayPath.hpp"
+#include "rayPathView.hpp"
+#include "rayStart.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <optional>
+#include <sstream>
+#include <string>
+
+
+namespace aply
+{
+namespace ray
+{
+	using namespace engabra::g3;
+
+	/*! \brief Consumer providing PathView metrics without storing nodes.
+	 *
+	 * Retains only the first and last consumed nodes and accumulates
+	 * the (propagation resolution) path and optical distances as
+	 * nodes arrive.
+	 * The metric methods are equivalent to those of PathView for a
+	 * Path which archived the same nodes (and whose last archived
+	 * node is the last one traced).
+	 *
+	 * Memory use is constant regardless of path length, so that (e.g.
+	 * with BundleStats) very many rays can be processed.
+	 *
+	 * Example:
+	 * \snippet test_PathSummary.cpp DoxyExample01
+	 */
+	struct PathSummary
+	{
+		//! Starting boundary condition (direction and location) for the ray
+		Start const theStart{};
+
+		//! Maximum number of nodes to consume (controls termination)
+		std::size_t const theMaxNodes{ 0u };
+
+	private:
+
+		std::optional<Node> theBegNode{};
+		std::optional<Node> theEndNode{};
+		std::size_t theNumNodes{ 0u };
+		double thePathDist{ 0. };
+		double theOptDist{ 0. };
+
+	public:
+
+		//! Consumer to accept up to maxNodes nodes.
+		inline
+		explicit
+		PathSummary
+			( Start const & start
+			, std::size_t const & maxNodes
+			)
+			: theStart{ start }
+			, theMaxNodes{ maxNodes }
+		{ }
+
+		//! Number of nodes consumed.
+		inline
+		std::size_t
+		size // PathSummary::
+			() const
+		{
+			return theNumNodes;
+		}
+
+		//! Maximum number of nodes to consume.
+		inline
+		std::size_t
+		capacity // PathSummary::
+			() const
+		{
+			return theMaxNodes;
+		}
+
+		//! Accept node (update end node, path and optical distances)
+		inline
+		void
+		emplace_back // PathSummary::
+			( ray::Node const & node
+			)
+		{
+			if (theEndNode)
+			{
+				Vector const & prevLoc = theEndNode->theCurrLoc;
+				double const deltaMag
+					{ magnitude(node.theCurrLoc - prevLoc) };
+				thePathDist += deltaMag;
+				// as Path::considerNode()
+				double const stepNu
+					{ .5 * (theEndNode->theNextNu + node.thePrevNu) };
+				theOptDist += stepNu * deltaMag;
+			}
+			else
+			{
+				theBegNode.emplace(node);
+			}
+			theEndNode.emplace(node);
+			++theNumNodes;
+		}
+
+		//! First node in path (or null if not present)
+		inline
+		Node
+		begNode // PathSummary::
+			() const
+		{
+			if (theBegNode)
+			{
+				return *theBegNode;
+			}
+			return Node{};
+		}
+
+		//! Last node in path (or null if not present)
+		inline
+		Node
+		endNode // PathSummary::
+			() const
+		{
+			if (theEndNode)
+			{
+				return *theEndNode;
+			}
+			return Node{};
+		}
+
+		//! Direction (of tangent) at first node
+		inline
+		Vector
+		begDirection // PathSummary::
+			() const
+		{
+			return begNode().thePrevTan;
+		}
+
+		//! Direction (of tangent) at last node
+		inline
+		Vector
+		endDirection // PathSummary::
+			() const
+		{
+			return endNode().theNextTan;
+		}
+
+		//! Direction of direct path (from first location to end location)
+		inline
+		Vector
+		netDirection // PathSummary::
+			() const
+		{
+			Vector dir{ null<Vector>() };
+			if (1u < theNumNodes)
+			{
+				Vector const netDiff
+					{ endNode().theCurrLoc - begNode().theCurrLoc };
+				dir = direction(netDiff);
+			}
+			return dir;
+		}
+
+		//! Angle from netDirection() toward begin tangent
+		inline
+		BiVector
+		begDeviation // PathSummary::
+			() const
+		{
+			return angleFromInto(netDirection(), begDirection());
+		}
+
+		//! Angle from netDirection() toward end tangent
+		inline
+		BiVector
+		endDeviation // PathSummary::
+			() const
+		{
+			return angleFromInto(netDirection(), endDirection());
+		}
+
+		//! Angle from begDir toward endDir
+		inline
+		BiVector
+		totalDeviation // PathSummary::
+			() const
+		{
+			return angleFromInto(begDirection(), endDirection());
+		}
+
+		//! Distance along path (propagation resolution approximation).
+		inline
+		double
+		pathDistance // PathSummary::
+			() const
+		{
+			return thePathDist;
+		}
+
+		//! Optical path length, integral of IoR along path (ref Path).
+		inline
+		double
+		opticalDistance // PathSummary::
+			() const
+		{
+			return theOptDist;
+		}
+
+		//! Group path length (ref groupDistanceFor()).
+		inline
+		double
+		groupDistance // PathSummary::
+			( double const & groupRatio = 1.
+			) const
+		{
+			return groupDistanceFor(thePathDist, theOptDist, groupRatio);
+		}
+
+		//! Group delay [s] (pulse travel time) for groupDistance() [m].
+		inline
+		double
+		groupDelay // PathSummary::
+			( double const & groupRatio = 1.
+			) const
+		{
+			return (groupDistance(groupRatio) / sLightSpeed);
+		}
+
+		//! Distance subtended by begDeviation() at pathDistance().
+		inline
+		double
+		begDeflection // PathSummary::
+			() const
+		{
+			return (magnitude(begDeviation()) * pathDistance());
+		}
+
+		//! Distance subtended by endDeviation() at pathDistance().
+		inline
+		double
+		endDeflection // PathSummary::
+			() const
+		{
+			return (magnitude(endDeviation()) * pathDistance());
+		}
+
+		//! Descriptive information about this instance
+		inline
+		std::string
+		infoString // PathSummary::
+			( std::string const & title = {}
+			) const
+		{
+			std::ostringstream oss;
+			if (! title.empty())
+			{
+				oss << title << '\n';
+			}
+			oss << "numNodes: " << theNumNodes
+				<< "  of(capacity)  " << theMaxNodes;
+			oss << '\n';
+			oss << "totalDeviation: " << io::fixed(totalDeviation(), 2u, 9u);
+			oss << '\n';
+			oss << "  pathDistance: " << io::fixed(pathDistance(), 6u, 3u);
+			oss << '\n';
+			oss << " endDeflection: " << io::fixed(endDeflection(), 6u, 3u);
+			return oss.str();
+		}
+
+	}; // PathSummary
+
+} // [ray]
+} // [aply]
+
+
+#endif // aply_ray_PathSummary_INCL_
+
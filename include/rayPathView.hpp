@@ -47,12 +47,56 @@ namespace ray
 {
 	using namespace engabra::g3;
 
+	//! Speed of light in vacuum [m/s]
+	constexpr double sLightSpeed{ 299792458. };
+
+	/*! \brief Group path length from arc and (phase) optical lengths.
+	 *
+	 * The groupRatio is the ratio of group refractivity to (phase)
+	 * refractivity, (ng-1)/(n-1), e.g. env::ior::groupRatio(). For
+	 * air it depends (essentially) only on wavelength, so that the
+	 * group path length follows from the optical path length as
+	 *
+	 * \verbatim
+	 *	groupDist = arcDist + groupRatio*(optDist - arcDist)
+	 * \endverbatim
+	 */
+	inline
+	double
+	groupDistanceFor
+		( double const & arcDist
+		, double const & optDist
+		, double const & groupRatio
+		)
+	{
+		return (arcDist + groupRatio * (optDist - arcDist));
+	}
+
+	//! Directed angle between fromVec and intoVec (null if either is null)
+	inline
+	BiVector
+	angleFromInto
+		( Vector const & fromVec
+		, Vector const & intoVec
+		)
+	{
+		BiVector angle{ null<BiVector>() };
+		if (engabra::g3::isValid(fromVec) && engabra::g3::isValid(intoVec))
+		{
+			Spinor const expSpin(fromVec * intoVec);
+			Spinor const logSpin{ logG2(expSpin) };
+			angle = logSpin.theBiv;
+		}
+		return angle;
+	}
+
 	//! Provide view of interesting path information
 	struct PathView
 	{
 		//! Must be set by consumer
 		std::vector<Node> const * const thePtNodes;
 		std::vector<double> const * const thePtArcDists;
+		std::vector<double> const * const thePtOptDists;
 
 		/*! \brief Attach an instance to (EXTERNALLY managed!!) path data.
 		 *
@@ -65,6 +109,7 @@ namespace ray
 			)
 			: thePtNodes{ &(ptPath->theNodes) }
 			, thePtArcDists{ &(ptPath->theArcDists) }
+			, thePtOptDists{ &(ptPath->theOptDists) }
 		{ }
 
 		//! First node in path (or null if not present)
@@ -136,14 +181,7 @@ namespace ray
 			, Vector const & intoVec
 			) const
 		{
-			BiVector angle{ null<BiVector>() };
-			if (engabra::g3::isValid(fromVec) && engabra::g3::isValid(intoVec))
-			{
-				Spinor const expSpin(fromVec * intoVec);
-				Spinor const logSpin{ logG2(expSpin) };
-				angle = logSpin.theBiv;
-			}
-			return angle;
+			return ray::angleFromInto(fromVec, intoVec);
 		}
 
 		//! Angle from netDirection() toward begin tangent
@@ -186,6 +224,40 @@ namespace ray
 			return distSum;
 		}
 
+		//! Optical path length, integral of IoR along path (ref Path).
+		inline
+		double
+		opticalDistance // PathView::
+			() const
+		{
+			double const distSum
+				{ std::accumulate
+					(thePtOptDists->cbegin(), thePtOptDists->cend(), 0.)
+				};
+			return distSum;
+		}
+
+		//! Group path length (ref groupDistanceFor()).
+		inline
+		double
+		groupDistance // PathView::
+			( double const & groupRatio = 1.
+			) const
+		{
+			return groupDistanceFor
+				(pathDistance(), opticalDistance(), groupRatio);
+		}
+
+		//! Group delay [s] (pulse travel time) for groupDistance() [m].
+		inline
+		double
+		groupDelay // PathView::
+			( double const & groupRatio = 1.
+			) const
+		{
+			return (groupDistance(groupRatio) / sLightSpeed);
+		}
+
 		//! Distance subtended by begDeviation() at pathDistance().
 		inline
 		double
@@ -223,6 +295,8 @@ namespace ray
 			oss << '\n';
 			oss << "  pathDistance: " << io::fixed(pathDistance(), 6u, 3u);
 			oss << '\n';
+			oss << "   opticalDist: " << io::fixed(opticalDistance(), 6u, 3u);
+			oss << '\n';
 			oss << " begDeflection: " << io::fixed(begDeflection(), 6u, 3u);
 			oss << '\n';
 			oss << " endDeflection: " << io::fixed(endDeflection(), 6u, 3u);
@@ -34,6 +34,8 @@
 
 #include "rayDirChange.hpp"
 #include "rayNode.hpp"
+#include "rayStart.hpp"
+#include "rayTangentBatch.hpp"
 
 #include "env.hpp"
 
@@ -42,6 +44,7 @@
 #include <cmath>
 #include <limits>
 #include <utility>
+#include <vector>
 
 
 namespace aply
@@ -113,12 +116,165 @@ namespace ray
 		return tanDirChange;
 	}
 
+	/*! \brief Tangent direction after implicit (midpoint) smooth media step.
+	 *
+	 * Along a ray path, the tangent direction evolves according to
+	 * dt/ds = t.W(t) with bivector W(t) = (t^g)/nu (g the IoR gradient).
+	 * This function solves the implicit midpoint form of one step
+	 * \verbatim
+	 *   tNext - tPrev = h tMid.W(tMid) ; tMid = direction(tPrev + tNext)
+	 * \endverbatim
+	 * with h = stepDist and with g and nu held fixed. Written as
+	 * a*x + x*b = D in x = tNext (ref test_Sylvester.cpp), with
+	 * a = 1/2 + (h/(2m))W, b = reverse(a), m = |tPrev + tNext|, the
+	 * solution has closed form: a rotation of tPrev toward g (in the
+	 * plane of tPrev^g) by angle 2*psi, with
+	 * \verbatim
+	 *   tan(psi) = c*sin(theta) / (1 + c*cos(theta))
+	 *   c = h*|g|/(2*nu) ; theta = angle(tPrev, g)
+	 * \endverbatim
+	 *
+	 * The step is stable for any step size (the angle between the
+	 * tangent and g never increases in magnitude) and is reversible
+	 * (the step from -tNext returns -tPrev).
+	 */
+	inline
+	Vector
+	implicitTangentDir
+		( Vector const & tPrev //!< Must be unit length
+		, double const & nu //!< IoR at step midpoint
+		, Vector const & grad //!< IoR gradient at step midpoint
+		, double const & stepDist
+		)
+	{
+		Vector tNext{ tPrev };
+		// rotation parameters: c*cos(theta) and sq(c*sin(theta))
+		Vector const kVec{ (.5*stepDist/nu) * grad };
+		double const kDotT{ (kVec * tPrev).theSca[0] };
+		double const yy{ 1. + kDotT };
+		double const xxSq{ magSq(kVec) - sq(kDotT) };
+		double const denom{ xxSq + sq(yy) };
+		if (0. < denom)
+		{
+			// component of kVec perpendicular to tPrev (magnitude xx)
+			Vector const kPerp{ kVec - kDotT*tPrev };
+			// cos(2*psi)*tPrev + sin(2*psi)*direction(kPerp)
+			tNext = (1./denom) * ((sq(yy) - xxSq)*tPrev + (2.*yy)*kPerp);
+		}
+		return tNext;
+	}
+
+	//! Method for updating tangent direction at each propagation step
+	enum StepMethod
+	{
+		  InterfaceStep //!< Refraction at (iterated) idealized interface
+		, ImplicitStep //!< Closed form implicit midpoint rule (smooth media)
+		, SymplecticStep //!< Hamiltonian leapfrog on optical momentum
+
+	}; // StepMethod
+
+	//! Work counters for the iterative refraction estimation in Propagator
+	struct LoopStats
+	{
+		//! Number of propagation steps (all kinds)
+		std::size_t theNumSteps{ 0u };
+		//! Number of steps with significant gradient (that require iteration)
+		std::size_t theNumRefracts{ 0u };
+		//! Total number of IoR/tangent loop iterations (over theNumRefracts)
+		std::size_t theNumLoops{ 0u };
+		//! Largest number of loop iterations used for any one step
+		std::size_t theMaxLoops{ 0u };
+
+		//! Note that numLoop iterations were used for a refracting step
+		inline
+		void
+		addRefract // LoopStats::
+			( std::size_t const & numLoop
+			)
+		{
+			++theNumRefracts;
+			theNumLoops += numLoop;
+			if (theMaxLoops < numLoop)
+			{
+				theMaxLoops = numLoop;
+			}
+		}
+
+		//! Average loop iterations per refracting step (null if none)
+		inline
+		double
+		loopsPerRefract // LoopStats::
+			() const
+		{
+			double avg{ null<double>() };
+			if (0u < theNumRefracts)
+			{
+				avg = (double)theNumLoops / (double)theNumRefracts;
+			}
+			return avg;
+		}
+
+	}; // LoopStats
+
 	//! Ray propagation functions
 	struct Propagator
 	{
 		env::IndexVolume const * const thePtMedia{ nullptr };
 		double const theStepDist{ null<double>() };
 
+		/*! If true, accelerate the IoR/tangent fixed-point iteration.
+		 *
+		 * The first estimate of the next tangent is extrapolated from
+		 * the tangents of the previous steps (rather than starting
+		 * at the incident tangent), and successive exit IoR values
+		 * are combined by secant extrapolation of the fixed-point
+		 * residual. This reduces the number of iterations in smooth
+		 * media, but the results differ from those of the plain
+		 * iteration (e.g. by about 1.e-5 in node locations for
+		 * demoThickPlate). Near IoR discontinuities the secant may
+		 * extrapolate to (exit) IoR values that do not occur in the
+		 * media. Therefore off by default (opt-in for smooth media).
+		 */
+		bool const theUseAcceleration{ false };
+
+		/*! Tangent update method used at each step.
+		 *
+		 * InterfaceStep (default) treats each step as refraction (or
+		 * reflection) at an idealized interface and is suitable for
+		 * media with discontinuities (e.g. Slab).
+		 *
+		 * ImplicitStep treats the path as a solution of the ray
+		 * equation in smooth media. The tangent rotation at each node
+		 * (ref implicitTangentDir()) is evaluated with the IoR and
+		 * gradient at the node, which is the midpoint between
+		 * adjacent half steps. The result is reversible, needs no
+		 * iteration, and remains stable for step sizes much larger
+		 * than the scale of strong gradients. It never produces
+		 * Reflected changes (rays turn continuously).
+		 *
+		 * SymplecticStep treats the ray as a Hamiltonian system with
+		 * position, r, and optical momentum, p = nu*t, evolving in
+		 * parameter sigma (ds = nu*dSigma) as
+		 * \verbatim
+		 *   dr/dSigma = p ; dp/dSigma = nu*grad(nu)
+		 * \endverbatim
+		 * and integrates it with the Stormer-Verlet (leapfrog) method
+		 * using a fixed sigma step (theStepDist divided by IoR at the
+		 * path start). Node spacing is theStepDist times the ratio of
+		 * local to starting IoR. Nodes are at the kick (gradient
+		 * evaluation) locations and the node tangent and IoR values
+		 * are the direction and magnitude of the (half step) momentum
+		 * on each side, so that the node momentum is the average
+		 * .5*(thePrevNu*thePrevTan + theNextNu*theNextTan). The method
+		 * is time reversible (a reverse trace retraces the same nodes
+		 * if its theStepDist is scaled by the ratio of the IoR at the
+		 * two path starts), and holds quadratic invariants such as
+		 * the angular momentum, r^p (i.e. Bouguer's nu*|r|*sin(zenith)
+		 * in spherically symmetric media), to roundoff for any step
+		 * size. Like ImplicitStep, it is for smooth media.
+		 */
+		StepMethod const theStepMethod{ InterfaceStep };
+
 	private:
 
 		struct Step // Propagator::
@@ -126,9 +282,278 @@ namespace ray
 			double theNextNu;
 			Vector theNextTan;
 			DirChange theChange;
+			double theNextDist; //!< Distance to next node
 
 		}; // Step
 
+		/*! \brief State of the iterative exit IoR (and tangent) estimation.
+		 *
+		 * Shared by nextStep() and tracePacket(). Each loop iteration:
+		 * \arg evalLocation() provides the point at which to evaluate IoR
+		 * \arg nuToUse() provides the (accelerated) exit IoR estimate
+		 * \arg update() incorporates the resulting tangent direction
+		 */
+		struct Refinement // Propagator::
+		{
+			//! Location at which step starts
+			Vector theLocCurr{ null<Vector>() };
+			//! IoR gradient at theLocCurr
+			Vector theGradCurr{ null<Vector>() };
+			//! Current estimate of exiting tangent direction
+			Vector theTanNext{ null<Vector>() };
+			//! Current estimate of exiting IoR
+			double theNuNext{ null<double>() };
+			//! Boundary action for theTanNext
+			DirChange theChange{ Null };
+			//! Squared change in tangent direction from last iteration
+			double theDifSq{ null<double>() };
+			//! Number of iterations performed
+			std::size_t theNumLoop{ 0u };
+			bool theIsReflection{ false };
+			bool theDoLoop{ true };
+			bool theUseSecant{ false };
+			//! Exit IoR used two iterations ago (secant history)
+			double theNuUsedPrev{ null<double>() };
+			//! IoR evaluated with theNuUsedPrev (secant history)
+			double theNuEvalPrev{ null<double>() };
+
+			//! Tolerance until epsilon < difSq (sqrt(eps)<|dif|)
+			static
+			double
+			tolDifSq // Propagator::Refinement::
+				()
+			{
+				return std::numeric_limits<double>::epsilon();
+			}
+
+			//! Start iteration from tangent direction tBeg
+			inline
+			explicit
+			Refinement // Propagator::Refinement::
+				( Vector const & rCurr
+				, Vector const & gCurr
+				, Vector const & tBeg
+				, bool const & useSecant
+				)
+				: theLocCurr{ rCurr }
+				, theGradCurr{ gCurr }
+				, theTanNext{ tBeg }
+				, theDifSq{ 2.*tolDifSq() } // large value to force first loop
+				, theUseSecant{ useSecant }
+			{ }
+
+			//! Default construction is a null instance
+			Refinement // Propagator::Refinement::
+				() = default;
+
+			//! True if another iteration is needed (counts the iteration)
+			inline
+			bool
+			nextLoop // Propagator::Refinement::
+				()
+			{
+				constexpr std::size_t maxLoop{ 10u }; // avoid infinite loop
+				bool const doNext
+					{  (tolDifSq() < theDifSq)
+					&& (theNumLoop < maxLoop)
+					&& theDoLoop
+					};
+				if (doNext)
+				{
+					++theNumLoop;
+				}
+				return doNext;
+			}
+
+			//! Location at which to evaluate exit IoR for this iteration
+			inline
+			Vector
+			evalLocation // Propagator::Refinement::
+				( double const & stepDist
+				)
+			{
+				Vector qNext{ null<Vector>() };
+				if (! theIsReflection)
+				{
+					// update refraction index to midpoint of predicted next
+					// interval (along evolving next tangent direction).
+					qNext = theLocCurr + .5*stepDist*theTanNext;
+				}
+				else
+				// if (theIsReflection) // perfect reflection
+				{
+					Vector const gDir{ direction(theGradCurr) };
+					qNext = theLocCurr + .5*stepDist*gDir;
+					// No need to iterate further for perfect reflection
+					theDoLoop = false; // exit after updating next ray step
+				}
+				return qNext;
+			}
+
+			/*! Exit IoR to use given the value, nuEval, at evalLocation().
+			 *
+			 * The iteration x[k] = G(x[k-1]) (with x the exit IoR and
+			 * G() the IoR evaluated along the tangent x produces) is
+			 * accelerated by secant extrapolation to the zero of the
+			 * residual G(x)-x. Falls back to nuEval (plain iteration)
+			 * when there is not enough history, on reflection, or when
+			 * the secant estimate is degenerate.
+			 */
+			inline
+			double
+			nuToUse // Propagator::Refinement::
+				( double const & nuEval
+				)
+			{
+				double nuUse{ nuEval };
+				if ( theUseSecant
+				  && (! theIsReflection)
+				  && engabra::g3::isValid(nuEval)
+				  && engabra::g3::isValid(theNuUsedPrev)
+				  && engabra::g3::isValid(theNuEvalPrev)
+				   )
+				{
+					double const resPrev{ theNuEvalPrev - theNuUsedPrev };
+					double const resCurr{ nuEval - theNuNext };
+					double const denom{ resCurr - resPrev };
+					// residuals at roundoff level carry no slope information
+					double const resTol
+						{ 16.*std::numeric_limits<double>::epsilon()
+						* std::abs(nuEval)
+						};
+					if ((resTol < std::abs(resCurr)) && (0. != denom))
+					{
+						double const nuSec
+							{ theNuNext
+							- resCurr * (theNuNext - theNuUsedPrev) / denom
+							};
+						if (engabra::g3::isValid(nuSec))
+						{
+							nuUse = nuSec;
+						}
+					}
+				}
+				if (engabra::g3::isValid(theNuNext))
+				{
+					theNuUsedPrev = theNuNext;
+					theNuEvalPrev = nuEval;
+				}
+				theNuNext = nuUse;
+				return nuUse;
+			}
+
+			//! Incorporate tangent direction result. False if Stopped.
+			inline
+			bool
+			update // Propagator::Refinement::
+				( std::pair<Vector, DirChange> const & tDirChange
+				)
+			{
+				// check for stop condition
+				if (Stopped == tDirChange.second)
+				{
+					return false;
+				}
+
+				// note reflection condition for next loop iteration
+				theIsReflection = (Reflected == tDirChange.second);
+				if (theIsReflection)
+				{
+					// secant history is not meaningful across reflection
+					theNuUsedPrev = null<double>();
+					theNuEvalPrev = null<double>();
+				}
+
+				// evaluate convergence of tangent direction
+				Vector const & tResult = tDirChange.first;
+				theDifSq = magSq(tResult - theTanNext);
+
+				// update tangent direction
+				theTanNext = tResult;
+				theChange = tDirChange.second;
+				return true;
+			}
+
+		}; // Refinement
+
+		//! Incident tangents of recent steps (for next tangent prediction)
+		struct TangentHistory // Propagator::
+		{
+			//! Incident tangent direction one step ago
+			Vector theTanAgo1{ null<Vector>() };
+			//! Incident tangent direction two steps ago
+			Vector theTanAgo2{ null<Vector>() };
+
+			//! Record incident tangent, tPrev, of step that resulted in change
+			inline
+			void
+			shift // Propagator::TangentHistory::
+				( Vector const & tPrev
+				, DirChange const & change
+				)
+			{
+				if (Reflected == change)
+				{
+					// path is not smooth across reflection
+					theTanAgo1 = null<Vector>();
+					theTanAgo2 = null<Vector>();
+				}
+				else
+				{
+					theTanAgo2 = theTanAgo1;
+					theTanAgo1 = tPrev;
+				}
+			}
+
+			/*! Extrapolation of tangent history through tPrev one step ahead.
+			 *
+			 * Quadratic (or linear if only one prior tangent is available)
+			 * in step count. Returns tPrev if there is no history.
+			 */
+			inline
+			Vector
+			predictedFrom // Propagator::TangentHistory::
+				( Vector const & tPrev
+				) const
+			{
+				Vector tExtrap{ tPrev };
+				if (engabra::g3::isValid(theTanAgo1))
+				{
+					if (engabra::g3::isValid(theTanAgo2))
+					{
+						tExtrap = 3.*tPrev - 3.*theTanAgo1 + theTanAgo2;
+					}
+					else
+					{
+						tExtrap = 2.*tPrev - theTanAgo1;
+					}
+				}
+				Vector tBeg{ tPrev };
+				if (0. < magSq(tExtrap))
+				{
+					tBeg = direction(tExtrap);
+				}
+				return tBeg;
+			}
+
+		}; // TangentHistory
+
+		//! Starting tangent estimate for refinement iteration.
+		inline
+		Vector
+		initialTangent // Propagator::
+			( Vector const & tPrev
+			, TangentHistory const & tanHistory
+			) const
+		{
+			Vector tBeg{ tPrev };
+			if (theUseAcceleration)
+			{
+				tBeg = tanHistory.predictedFrom(tPrev);
+			}
+			return tBeg;
+		}
+
 		//! Estimate next tangent based on local object refraction
 		inline
 		Step
@@ -136,6 +561,8 @@ namespace ray
 			( Vector const & tPrev //!< Must be unit length
 			, double const & nuPrev
 			, Vector const & rCurr
+			, TangentHistory const & tanHistory
+			, LoopStats * const & ptStats
 			) const
 		{
 			double nuNext{ null<double>() };
@@ -153,7 +580,8 @@ namespace ray
 				Vector const qNext{ rCurr + .5*theStepDist*tNext };
 
 				// update estimated forward next refraction index value
-				// (which should be same as previous)
+				// (a zero gradient sample does not imply uniform IoR, e.g.
+				// at a stationary point or near an oblique interface)
 				nuNext = thePtMedia->qualifiedNuValue(qNext);
 
 				// update tangent direction
@@ -165,64 +593,39 @@ namespace ray
 			else
 			// if (gTol < gMag) // ray path (tangent direction) changes
 			{
-				bool isReflection{ false }; // used to exit early 
 				//
 				// iterate on determination of exit media IoR
 				// (ref Refraction.lyx doc)
 				//
-				// location at which to evaluate nuNext (iteratively refined)
-				Vector qNext{ rCurr + .5*theStepDist*tNext };
-				//
-				// tolerance until epsilon < difSq (sqrt(eps)<|dif|)
-				static double const tolDifSq
-					{ std::numeric_limits<double>::epsilon() };
-				double difSq{ 2.*tolDifSq }; // large value to force first loop
-				constexpr std::size_t maxLoop{ 10u }; // avoid infinite loop
-				std::size_t numLoop{ 0u };
-				bool doLoop{ true };
-				while ((tolDifSq < difSq) && (numLoop++ < maxLoop) && doLoop)
+				Refinement refine
+					( rCurr, gCurr
+					, initialTangent(tPrev, tanHistory)
+					, theUseAcceleration
+					);
+				while (refine.nextLoop())
 				{
-					// update IoR evaluation location
-					if (! isReflection)
-					{
-						// update refraction index to midpoint of predicted next
-						// interval (along evolving next tangent direction).
-						qNext = rCurr + .5*theStepDist*tNext;
-					}
-					else
-					// if (isReflection) // perfect reflection
-					{
-						Vector const gDir{ direction(gCurr) };
-						qNext = rCurr + .5*theStepDist*gDir;
-						// No need to iterate further for perfect reflection
-						doLoop = false; // exit after updating next ray step
-					}
-
 					// update estimated forward next refraction index value
-					nuNext = thePtMedia->qualifiedNuValue(qNext);
+					Vector const qNext{ refine.evalLocation(theStepDist) };
+					double const nuEval{ thePtMedia->qualifiedNuValue(qNext) };
+					double const nuUse{ refine.nuToUse(nuEval) };
 
 					// update tangent direction
-					std::pair<Vector, DirChange> const tDirChange
-						{ nextTangentDir(tPrev, nuPrev, gCurr, nuNext) };
-
-					// check for stop condition
-					if (Stopped == tDirChange.second)
+					if (! refine.update
+						(nextTangentDir(tPrev, nuPrev, gCurr, nuUse)))
 					{
 						break;
 					}
 
-					// note reflection condition for next loop iteration
-					isReflection = (Reflected == tDirChange.second);
-
-					// evaluate convergence of tangent direction
-					Vector const & tResult = tDirChange.first;
-					difSq = magSq(tResult - tNext);
+				} // while loop on refraction index estimation
 
-					// update tangent direction
-					tNext = tResult;
-					change = tDirChange.second;
+				nuNext = refine.theNuNext;
+				tNext = refine.theTanNext;
+				change = refine.theChange;
 
-				} // while loop on refraction index estimation
+				if (ptStats)
+				{
+					ptStats->addRefract(refine.theNumLoop);
+				}
 
 			} // significant gCurr magnitude
 
@@ -232,7 +635,168 @@ namespace ray
 				change = Stopped;
 			}
 
-			return Step{ nuNext, tNext, change };
+			if (ptStats)
+			{
+				++(ptStats->theNumSteps);
+			}
+
+			return Step{ nuNext, tNext, change, theStepDist };
+		}
+
+		/*! Tangent and IoR for next step (ref theStepMethod: ImplicitStep)
+		 *
+		 * The tangent is rotated over rotDist (theStepDist except at
+		 * the start of a path where tPrev is the tangent at rCurr and
+		 * a half step brings it to the middle of the next interval).
+		 */
+		inline
+		Step
+		implicitStep // Propagator::
+			( Vector const & tPrev //!< Must be unit length
+			, Vector const & rCurr
+			, double const & rotDist
+			, LoopStats * const & ptStats
+			) const
+		{
+			Vector tNext{ tPrev };
+			DirChange change{ Unaltered };
+			std::pair<double, Vector> const nuGradCurr
+				{ thePtMedia->qualifiedNuValueAndGradient(rCurr, theStepDist) };
+			double const & nuCurr = nuGradCurr.first;
+			Vector const & gCurr = nuGradCurr.second;
+			static double const gTol // enough to unitize gCurr
+				{ std::numeric_limits<double>::min() };
+			if ( engabra::g3::isValid(nuCurr)
+			  && engabra::g3::isValid(gCurr)
+			  && (gTol < magnitude(gCurr))
+			   )
+			{
+				tNext = implicitTangentDir(tPrev, nuCurr, gCurr, rotDist);
+				double const tDotG{ (tPrev * gCurr).theSca[0] };
+				if (tDotG < 0.) // propagating into less dense media
+				{
+					change = Diverged;
+				}
+				else
+				if (0. < tDotG) // propagating into more dense media
+				{
+					change = Converged;
+				}
+			}
+
+			// IoR representative of the next step interval
+			double const nuNext
+				{ thePtMedia->qualifiedNuValue(rCurr + .5*theStepDist*tNext) };
+			if (! engabra::g3::isValid(nuNext))
+			{
+				change = Stopped;
+			}
+
+			if (ptStats)
+			{
+				++(ptStats->theNumSteps);
+			}
+
+			return Step{ nuNext, tNext, change, theStepDist };
+		}
+
+		/*! Momentum for next step (ref theStepMethod: SymplecticStep)
+		 *
+		 * The incident momentum is nuPrev*tPrev (except at the path
+		 * start where it is the IoR at rCurr times tPrev and where a
+		 * half step kick brings it to the middle of the next interval).
+		 */
+		inline
+		Step
+		symplecticStep // Propagator::
+			( Vector const & tPrev //!< Must be unit length
+			, double const & nuPrev
+			, Vector const & rCurr
+			, double const & sigmaDist //!< Parameter step (ds = nu*dSigma)
+			, bool const & isFirstNode
+			, LoopStats * const & ptStats
+			) const
+		{
+			Step step{ null<double>(), tPrev, Stopped, null<double>() };
+			std::pair<double, Vector> const nuGradCurr
+				{ thePtMedia->qualifiedNuValueAndGradient(rCurr, theStepDist) };
+			double const & nuCurr = nuGradCurr.first;
+			Vector const & gCurr = nuGradCurr.second;
+			if ( engabra::g3::isValid(nuCurr)
+			  && engabra::g3::isValid(gCurr)
+			   )
+			{
+				// kick: change in momentum, dp = nu*grad(nu)*dSigma
+				Vector pCurr{ nuPrev * tPrev };
+				double kickDist{ sigmaDist };
+				if (isFirstNode)
+				{
+					pCurr = nuCurr * tPrev;
+					kickDist = .5 * sigmaDist;
+				}
+				Vector const pNext{ pCurr + (kickDist * nuCurr) * gCurr };
+				double const pMag{ magnitude(pNext) };
+
+				if (0. < pMag)
+				{
+					step.theNextNu = pMag;
+					step.theNextTan = (1./pMag) * pNext;
+					// drift: change in location, dr = p*dSigma
+					step.theNextDist = sigmaDist * pMag;
+
+					double const tDotG{ (tPrev * gCurr).theSca[0] };
+					step.theChange = Unaltered;
+					if (tDotG < 0.) // propagating into less dense media
+					{
+						step.theChange = Diverged;
+					}
+					else
+					if (0. < tDotG) // propagating into more dense media
+					{
+						step.theChange = Converged;
+					}
+				}
+			}
+
+			if (ptStats)
+			{
+				++(ptStats->theNumSteps);
+			}
+
+			return step;
+		}
+
+		//! Step to next node using theStepMethod
+		inline
+		Step
+		stepFor // Propagator::
+			( Vector const & tPrev //!< Must be unit length
+			, double const & nuPrev
+			, Vector const & rCurr
+			, TangentHistory const & tanHistory
+			, double const & sigmaDist
+			, bool const & isFirstNode
+			, LoopStats * const & ptStats
+			) const
+		{
+			switch (theStepMethod)
+			{
+				case ImplicitStep:
+					return implicitStep
+						( tPrev, rCurr
+						, (isFirstNode ? .5 : 1.) * theStepDist
+						, ptStats
+						);
+				case SymplecticStep:
+					return symplecticStep
+						( tPrev, nuPrev, rCurr, sigmaDist
+						, isFirstNode, ptStats
+						);
+				case InterfaceStep:
+				default:
+					return nextStep
+						(tPrev, nuPrev, rCurr, tanHistory, ptStats);
+			}
 		}
 
 		//! Predicted next location stepsize units along tangent from rVec
@@ -248,6 +812,30 @@ namespace ray
 
 	public:
 
+		/*! \brief Resumable propagation state of one path.
+		 *
+		 * Created by traceStateFor() and advanced by nextNode(), e.g.
+		 * to produce nodes on demand (ref NodeGenerator).
+		 */
+		struct TraceState // Propagator::
+		{
+			//! Tangent (direction) incident on current node
+			Vector theTanPrev{ null<Vector>() };
+			//! Location of current (next to be produced) node
+			Vector theLocCurr{ null<Vector>() };
+			//! IoR incident on current node
+			double theNuPrev{ null<double>() };
+			//! Parameter step for SymplecticStep (theStepDist / IoR at start)
+			double theSigmaDist{ null<double>() };
+			//! Recent tangents (for tangent prediction)
+			TangentHistory theTanHistory{};
+			//! True until first node has been produced
+			bool theIsFirstNode{ true };
+			//! True once propagation has left the media (or failed)
+			bool theIsStopped{ true };
+
+		}; // TraceState
+
 		//! True if this instance is valid
 		inline
 		bool
@@ -257,68 +845,398 @@ namespace ray
 			return engabra::g3::isValid(theStepDist);
 		}
 
+		//! Propagation state at start of path (stopped if !isValid()).
+		inline
+		TraceState
+		traceStateFor // Propagator::
+			( Start const & start
+			) const
+		{
+			TraceState state{};
+			if (isValid())
+			{
+				Vector const & tBeg = start.theTanDir;
+				Vector const & rBeg = start.thePntLoc;
+
+				// start with initial conditions
+				state.theTanPrev = tBeg;
+				state.theLocCurr = rBeg;
+
+				// incident media IoR
+				Vector const rPrev{ (rBeg - .5*theStepDist*tBeg) };
+				state.theNuPrev = thePtMedia->qualifiedNuValue(rPrev);
+
+				// fixed parameter step, ds = nu*dSigma, for which the
+				// first SymplecticStep covers theStepDist of arc length
+				double const nuBeg{ thePtMedia->qualifiedNuValue(rBeg) };
+				state.theSigmaDist = theStepDist / nuBeg;
+				state.theIsStopped = false;
+			}
+			return state;
+		}
+
+		/*! \brief Node at current state and advance state to next one.
+		 *
+		 * Returns a node with theDirChange of Stopped (and null
+		 * values) once the path has left the media. Calling this
+		 * repeatedly is equivalent to (and is how) tracePath().
+		 */
+		inline
+		Node
+		nextNode // Propagator::
+			( TraceState * const & ptState
+			, LoopStats * const & ptStats = nullptr
+			) const
+		{
+			TraceState & state = *ptState;
+
+			// compute next tangent and IoR (if not already stopped)
+			Step stepNext{ null<double>(), state.theTanPrev, Stopped, 0. };
+			if (! state.theIsStopped)
+			{
+				stepNext = stepFor
+					( state.theTanPrev, state.theNuPrev, state.theLocCurr
+					, state.theTanHistory
+					, state.theSigmaDist, state.theIsFirstNode, ptStats
+					);
+			}
+			Vector const & tNext = stepNext.theNextTan;
+			double const & nuNext = stepNext.theNextNu;
+			DirChange const & change = stepNext.theChange;
+
+			// check for ray termination condition
+			if (Stopped == change)
+			{
+				state.theIsStopped = true;
+				return Node
+					{ null<Vector>(), null<double>()
+					, null<Vector>()
+					, null<double>(), null<Vector>()
+					, Stopped
+					};
+			}
+
+			// propagate ray to next node location
+			Vector const rNext
+				{ state.theLocCurr + stepNext.theNextDist * tNext };
+
+			if (state.theIsFirstNode)
+			{
+				state.theTanPrev = tNext;
+				state.theNuPrev = nuNext;
+			}
+
+			// node for current location
+			Node const currNode
+				{ state.theTanPrev, state.theNuPrev, state.theLocCurr
+				, nuNext, tNext, change
+				};
+
+			// update state for next node
+			state.theTanHistory.shift(state.theTanPrev, change);
+			state.theTanPrev = tNext;
+			state.theLocCurr = rNext;
+			state.theNuPrev = nuNext;
+			state.theIsFirstNode = false;
+
+			return currNode;
+		}
+
 		/*! Perform forward integration step by step.
 		 *
 		 * Essentially is Euler's method for integration of the ray path
 		 * (with all attendent pitfalls).
 		 *
+		 * If ptStats is provided, the refinement loop work is
+		 * accumulated into it.
 		 */
 		template <typename Consumer>
 		inline
 		void
 		tracePath // Propagator::
 			( Consumer * const & ptConsumer
+			, LoopStats * const & ptStats = nullptr
 			) const
 		{
 			if (isValid() && ptConsumer)
 			{
-				Vector const & tBeg = ptConsumer->theStart.theTanDir;
-				Vector const & rBeg = ptConsumer->theStart.thePntLoc;
-
-				// start with initial conditions
-				Vector tPrev{ tBeg };
-				Vector rCurr{ rBeg };
-
-				// incident media IoR
-				Vector const rPrev{ (rBeg - .5*theStepDist*tBeg) };
-				double nuPrev{ thePtMedia->qualifiedNuValue(rPrev) };
+				TraceState state{ traceStateFor(ptConsumer->theStart) };
+				continuePath(ptConsumer, &state, ptStats);
+			}
+		}
 
+		/*! \brief Continue propagation (from *ptState) into consumer.
+		 *
+		 * Same as tracePath() but starting from (and updating) the
+		 * given state, and taking at most maxSteps steps. E.g.
+		 * \arg Extend a path: after ptConsumer->reserve() of more
+		 * space, continue with the state at which the previous call
+		 * ended (without re-tracing from theStart).
+		 * \arg Checkpoint a long trace: proceed in chunks of maxSteps
+		 * and save the state between chunks (ref Checkpoint).
+		 *
+		 * Returns the number of nodes provided to the consumer.
+		 */
+		template <typename Consumer>
+		inline
+		std::size_t
+		continuePath // Propagator::
+			( Consumer * const & ptConsumer
+			, TraceState * const & ptState
+			, LoopStats * const & ptStats = nullptr
+			, std::size_t const & maxSteps
+				= std::numeric_limits<std::size_t>::max()
+			) const
+		{
+			std::size_t numSteps{ 0u };
+			if (isValid() && ptConsumer && ptState)
+			{
 				// propagate until path approximate reaches requested length
 				// or encounteres a NaN value for index of refraction
-				bool isFirstNode{ true }; // use to set path start values
-				while (ptConsumer->size() < ptConsumer->capacity())
+				while ( (ptConsumer->size() < ptConsumer->capacity())
+					 && (numSteps < maxSteps)
+					  )
 				{
-					// determine propagation change at this step
-					Step const stepNext{ nextStep(tPrev, nuPrev, rCurr) };
-					Vector const & tNext = stepNext.theNextTan;
-					double const & nuNext = stepNext.theNextNu;
-					DirChange const & change = stepNext.theChange;
-
-					// check for ray termination condition
-					if (Stopped == change)
+					Node const node{ nextNode(ptState, ptStats) };
+					if (Stopped == node.theDirChange)
 					{
 						break;
 					}
+					// give consumer opportunity to record node data
+					ptConsumer->emplace_back(node);
+					++numSteps;
+				}
+			}
+			return numSteps;
+		}
+
+		/*! \brief Trace several paths in lockstep (same results as tracePath).
+		 *
+		 * Each propagation step is performed for all (active) paths
+		 * together. The iterative refraction tangent estimation (ref
+		 * nextStep()) is evaluated for all paths at once with the
+		 * batched nextTangentDirs() kernel. Results agree with those
+		 * of tracePath() (for each consumer) to within roundoff.
+		 *
+		 * For ImplicitStep and SymplecticStep (which have no iteration
+		 * to batch), each consumer is traced individually with
+		 * tracePath().
+		 */
+		template <typename Consumer>
+		inline
+		void
+		tracePacket // Propagator::
+			( std::vector<Consumer *> const & ptConsumers
+			, LoopStats * const & ptStats = nullptr
+			) const
+		{
+			if (! isValid())
+			{
+				return;
+			}
+			if (! (InterfaceStep == theStepMethod))
+			{
+				for (Consumer * const & ptConsumer : ptConsumers)
+				{
+					tracePath(ptConsumer, ptStats);
+				}
+				return;
+			}
 
-					// propagate ray to next node location
-					Vector const rNext{ nextLocation(rCurr, tNext) };
+			//! Per path propagation state (ref tracePath() variables)
+			struct RayState
+			{
+				Consumer * theConsumer;
+				Vector theTanPrev;
+				TangentHistory theTanHistory;
+				Vector theLocCurr;
+				double theNuPrev;
+				bool theIsFirstNode;
+				bool theIsActive;
+
+				// nextStep() variables
+				Refinement theRefine;
+				Vector theTanNext;
+				double theNuNext;
+				DirChange theChange;
+				bool theIsIterating;
+			};
+
+			static double const gTol{ std::numeric_limits<double>::min() };
+
+			// initial conditions
+			std::vector<RayState> states;
+			states.reserve(ptConsumers.size());
+			for (Consumer * const & ptConsumer : ptConsumers)
+			{
+				if (ptConsumer)
+				{
+					Vector const & tBeg = ptConsumer->theStart.theTanDir;
+					Vector const & rBeg = ptConsumer->theStart.thePntLoc;
+					Vector const rPrev{ (rBeg - .5*theStepDist*tBeg) };
+					RayState state{};
+					state.theConsumer = ptConsumer;
+					state.theTanPrev = tBeg;
+					state.theLocCurr = rBeg;
+					state.theNuPrev = thePtMedia->qualifiedNuValue(rPrev);
+					state.theIsFirstNode = true;
+					state.theIsActive = true;
+					states.emplace_back(state);
+				}
+			}
 
-					if (isFirstNode)
+			TangentBatch batch;
+			std::vector<RayState *> ptIters;
+			ptIters.reserve(states.size());
+			bool anyActive{ ! states.empty() };
+			while (anyActive)
+			{
+				// gradient evaluation (and unaltered propagation)
+				for (RayState & state : states)
+				{
+					Consumer * const & ptConsumer = state.theConsumer;
+					if (! (ptConsumer->size() < ptConsumer->capacity()))
 					{
-						tPrev = tNext;
-						nuPrev = nuNext;
+						state.theIsActive = false;
 					}
+					state.theIsIterating = false;
+					if (! state.theIsActive)
+					{
+						continue;
+					}
+					Vector const gCurr
+						{ thePtMedia->nuGradient
+							(state.theLocCurr, theStepDist)
+						};
+					state.theTanNext = state.theTanPrev;
+					state.theNuNext = null<double>();
+					state.theChange = Null;
+					if (! (gTol < magnitude(gCurr))) // unaltered
+					{
+						Vector const qNext
+							{ state.theLocCurr
+							+ .5*theStepDist*state.theTanNext
+							};
+						state.theNuNext = thePtMedia->qualifiedNuValue(qNext);
+						state.theChange = Unaltered;
+					}
+					else
+					{
+						state.theRefine = Refinement
+							( state.theLocCurr, gCurr
+							, initialTangent
+								(state.theTanPrev, state.theTanHistory)
+							, theUseAcceleration
+							);
+						state.theIsIterating = true;
+					}
+				}
 
-					// give consumer opportunity to record node data
+				// iterate on exit media IoR, all paths together
+				bool anyIterating{ true };
+				while (anyIterating)
+				{
+					ptIters.clear();
+					for (RayState & state : states)
+					{
+						if (state.theIsIterating)
+						{
+							state.theIsIterating = state.theRefine.nextLoop();
+						}
+						if (state.theIsIterating)
+						{
+							ptIters.emplace_back(&state);
+						}
+					}
+					anyIterating = (! ptIters.empty());
+					if (! anyIterating)
+					{
+						break;
+					}
+
+					batch.resize(ptIters.size());
+					for (std::size_t nb{0u} ; nb < ptIters.size() ; ++nb)
+					{
+						Refinement & refine = ptIters[nb]->theRefine;
+						Vector const qNext{ refine.evalLocation(theStepDist) };
+						double const nuEval
+							{ thePtMedia->qualifiedNuValue(qNext) };
+						batch.set
+							( nb
+							, ptIters[nb]->theTanPrev, ptIters[nb]->theNuPrev
+							, refine.theGradCurr, refine.nuToUse(nuEval)
+							);
+					}
+
+					nextTangentDirs(&batch);
+
+					for (std::size_t nb{0u} ; nb < ptIters.size() ; ++nb)
+					{
+						RayState & state = *(ptIters[nb]);
+						std::pair<Vector, DirChange> const tDirChange
+							{ batch.nextTanAt(nb), batch.theChanges[nb] };
+						if (! state.theRefine.update(tDirChange))
+						{
+							state.theIsIterating = false;
+						}
+					}
+				}
+
+				// record nodes and advance (ref tracePath())
+				anyActive = false;
+				for (RayState & state : states)
+				{
+					if (! state.theIsActive)
+					{
+						continue;
+					}
+					if (Null == state.theChange) // refined this step
+					{
+						Refinement const & refine = state.theRefine;
+						state.theTanNext = refine.theTanNext;
+						state.theNuNext = refine.theNuNext;
+						state.theChange = refine.theChange;
+						if (ptStats)
+						{
+							ptStats->addRefract(refine.theNumLoop);
+						}
+					}
+					if (ptStats)
+					{
+						++(ptStats->theNumSteps);
+					}
+					if (! engabra::g3::isValid(state.theNuNext))
+					{
+						state.theChange = Stopped;
+					}
+					if (Stopped == state.theChange)
+					{
+						state.theIsActive = false;
+						continue;
+					}
+
+					Vector const & tNext = state.theTanNext;
+					double const & nuNext = state.theNuNext;
+					Vector const rNext{ nextLocation(state.theLocCurr, tNext) };
+					if (state.theIsFirstNode)
+					{
+						state.theTanPrev = tNext;
+						state.theNuPrev = nuNext;
+					}
 					Node const nextNode
-						{ tPrev, nuPrev, rCurr, nuNext, tNext, change };
-					ptConsumer->emplace_back(nextNode);
-
-					// update state for next node
-					tPrev = tNext;
-					rCurr = rNext;
-					nuPrev = nuNext;
-					isFirstNode = false;
+						{ state.theTanPrev, state.theNuPrev
+						, state.theLocCurr
+						, nuNext, tNext, state.theChange
+						};
+					state.theConsumer->emplace_back(nextNode);
+
+					state.theTanHistory.shift
+						(state.theTanPrev, state.theChange);
+					state.theTanPrev = tNext;
+					state.theLocCurr = rNext;
+					state.theNuPrev = nuNext;
+					state.theIsFirstNode = false;
+					anyActive = true;
 				}
 			}
 		}
@@ -35,10 +35,14 @@
 
 
 #include "envAirProfile.hpp"
+#include "envCoesa1976.hpp"
+#include "mathDiffEqSystemArray.hpp"
 
 #include <Engabra>
 
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -47,6 +51,32 @@ namespace aply
 namespace ray
 {
 
+	//! \brief Counters reported by Refraction::thetaAngleWithin().
+	struct RefractionStats
+	{
+		//! Number of results provided by closed form approximation.
+		std::size_t theNumFast{ 0u };
+
+		//! Number of results requiring numeric integration.
+		std::size_t theNumSlow{ 0u };
+
+		//! Fraction of results provided by the approximation (fast path).
+		inline
+		double
+		fastFraction
+			() const
+		{
+			double frac{ engabra::g3::null<double>() };
+			std::size_t const numAll{ theNumFast + theNumSlow };
+			if (0u < numAll)
+			{
+				frac = static_cast<double>(theNumFast)
+					 / static_cast<double>(numAll);
+			}
+			return frac;
+		}
+	};
+
 /*! \brief Determine angle and displacement due to refraction.
 
 This class computes the displacement that results when a ray of light
@@ -146,7 +176,7 @@ private: // data
 	 *	- theInitRadTheta.second: has size of 1u and contains
 	 *		- [0] : Theta_c angle (ray path polar angle from center of Earth)
 	 */
-	std::pair<double, std::vector<double> > theInitRadTheta{};
+	math::DiffEqValues<1u> theInitRadTheta{};
 
 public: // methods
 
@@ -180,7 +210,7 @@ public: // methods
 		, double const & radiusSensor
 		, double const & radiusEarth
 		, env::AirProfile const & airProfile
-			= aply::env::AirProfile{ aply::env::sAirInfoCoesa1976 }
+			= aply::env::coesa::airProfile()
 		);
 
 	// destructor -- compiler provided
@@ -199,6 +229,10 @@ public: // methods
 	 *
 	 * Ref Gyer 1996 Fig 2.
 	 *
+	 * The Gyer Eqn[12] integral is evaluated by adaptive quadrature
+	 * (ref math::QuadratureGK) which remains accurate for grazing rays
+	 * (e.g. radiusEnd at, or very near, the ray's tangent radius).
+	 *
 	 * \note This function performs numerical integration computations
 	 *       and therefore can take a non-trivial amount of time.
 	 */
@@ -207,6 +241,73 @@ public: // methods
 		( double const & radiusEnd
 		) const;
 
+	/*! \brief Closed form approximation to thetaAngleAt().
+	 *
+	 * Returns a pair with:
+	 *	- .first: approximate Theta_c value
+	 *	- .second: estimate of the magnitude of the approximation error
+	 *
+	 * The approximation is the (exact) straight line polar angle plus
+	 * a first order (in refractivity) correction. The correction uses
+	 * a flat Earth (constant zenith angle) geometry and an exponential
+	 * refractivity profile, N(h) = N0*exp(-(h-h0)/H), with surface
+	 * refractivity (N0) and scale height (H) fit to the AirProfile at
+	 * the ray end points. A profile value at the mid height is used to
+	 * correct for the profile departure from exponential form.
+	 *
+	 * The error estimate combines the size of that profile correction
+	 * with the magnitude of the neglected geometric and second order
+	 * terms. It is conservative (typically several times larger than
+	 * the actual error) and grows rapidly toward horizontal look angles
+	 * (e.g. is null for rays that do not reach radiusEnd).
+	 *
+	 * This requires only three AirProfile evaluations.
+	 */
+	std::pair<double, double>
+	thetaAngleApprox
+		( double const & radiusEnd
+		) const;
+
+	/*! \brief Theta_c (as thetaAngleAt()) within tolerance tolTheta.
+	 *
+	 * Returns thetaAngleApprox() result if its error estimate is not
+	 * larger than tolTheta. Otherwise, the result is computed by
+	 * numeric integration with thetaAngleAt().
+	 *
+	 * If ptStats is provided, the counter corresponding to the path
+	 * taken is \b incremented (e.g. to accumulate hit rate over many
+	 * calls). E.g.
+	 *
+	 * \snippet test/test_Refraction.cpp DoxyExample02
+	 *
+	 * \note Deviation angles, e.g. angularDeviationFromStart(), are
+	 *       differences of nearly equal angles. Errors in theta are
+	 *       amplified in the deviation by (about) the ratio of
+	 *       radiusEnd to path length.
+	 */
+	double
+	thetaAngleWithin
+		( double const & radiusEnd
+		, double const & tolTheta
+		, RefractionStats * const & ptStats = nullptr
+		) const;
+
+	/*! \brief Theta_c angles at each of radiiEnd (with one integration).
+	 *
+	 * Equivalent to calling thetaAngleAt() for each radiiEnd element
+	 * (including grazing rays), but the ray is integrated only once
+	 * (to the radius farthest from the start). The range is split at
+	 * the AirProfile data heights and at each of radiiEnd, and the
+	 * quadrature of each piece is accumulated outward from the start.
+	 * Returned angles are in same order as radiiEnd. Radii on the
+	 * other side of the start radius (relative to the farthest one)
+	 * produce null values.
+	 */
+	std::vector<double>
+	thetaAnglesAt
+		( std::vector<double> const & radiiEnd
+		) const;
+
 	/*! \brief Angular deviation of ray end as observed from start point.
 	 *
 	 * The ray leaves the start point (ref #theInitRadTheta) at a look
@@ -229,6 +330,24 @@ public: // methods
 			//!< Angle subtended by ray path \b from \b Earth \b center.
 		) const;
 
+	/*! \brief Angular deviation for ray with given start and end geometry.
+	 *
+	 * Ref angularDeviationFromStart() for which this is the
+	 * implementation (e.g. useful with batch theta computations).
+	 */
+	static
+	double
+	angularDeviationFor
+		( double const & lookAngle
+			//!< Look angle (from Nadir) with which ray leaves start.
+		, double const & radiusStart
+			//!< Distance from \b center of Earth at which ray starts.
+		, double const & radiusEnd
+			//!< Distance from \b center of Earth at which ray terminates.
+		, double const & thetaEnd
+			//!< Angle subtended by ray path \b from \b Earth \b center.
+		);
+
 	/*! \brief Convienience: angularDeviationFromStart(thetaAngleAt(radiusEnd))
 	 *
 	 * \note: This performs numeric integration and therefore may take
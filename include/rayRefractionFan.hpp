@@ -0,0 +1,170 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_RefractionFan_INCL_
+#define aply_ray_RefractionFan_INCL_
+
+/*! \file
+\brief Declarations for ray::RefractionFan
+*/
+
+
+#include "envAirProfile.hpp"
+#include "envCoesa1976.hpp"
+
+#include <Engabra>
+
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+/*! \brief Refraction for many look angles integrated in lockstep.
+
+Computes the same quantities as aply::ray::Refraction for an entire
+collection (fan) of look angles that share a common start radius,
+Earth radius and env::AirProfile.
+
+The Gyer Eqn[12] integrand,
+\code
+dTheta/dr = k / (r * sqrt(n(r)^2*r^2 - k^2))
+\endcode
+depends on the look angle only through the refractive invariant, k.
+Integration is therefore performed over one common set of abscissae
+(adaptive Gauss-Kronrod 7-15 quadrature with the pieces and convergence
+criteria of aply::ray::Refraction::thetaAngleAt(), including the grazing
+ray substitution for the lowest piece). Subintervals are bisected until
+every fan member satisfies the tolerance. The index of refraction is
+evaluated only once per abscissa and the integrand is then evaluated for
+all k values in a contiguous (auto-vectorizable) inner loop.
+
+Fan members that do not attain the tolerance in lockstep (e.g. rays
+near their tangent radius for which roundoff in the index of refraction
+limits the attainable accuracy) are evaluated individually with
+aply::ray::Refraction::thetaAngleAt().
+
+E.g.
+\snippet test/test_RefractionFan.cpp DoxyExample00
+
+*/
+
+class RefractionFan
+{
+
+private: // data
+
+	//! Cached construction value.
+	std::vector<double> theLookAngles{};
+
+	//! Cached construction value.
+	double theStartRadius{ engabra::g3::null<double>() };
+
+	//! \brief Defines the "zero-elevation" location relative to ECEF origin.
+	double theRadiusEarth{ engabra::g3::null<double>() };
+
+	//! \brief Atmospheric model providing IoR as function of \b elevation.
+	env::AirProfile theAirProfile{};
+
+	//! \brief Absolute tolerance on each theta integration piece.
+	double theTolAbs{ engabra::g3::null<double>() };
+
+	//! \brief Snell's constant (Gyer "k") for each of theLookAngles.
+	std::vector<double> theRefInvariants{};
+
+	//! \brief Squares of theRefInvariants values.
+	std::vector<double> theRefInvariantSqs{};
+
+public: // methods
+
+	//! default null constructor
+	RefractionFan
+		() = default;
+
+	/*! \brief Construct refraction engine for many look angles.
+	 *
+	 * Geometry conventions are the same as for aply::ray::Refraction.
+	 * The tolAbs is the absolute tolerance [rad] on theta for each
+	 * integration piece (the default is that used by Refraction).
+	 */
+	explicit
+	RefractionFan
+		( std::vector<double> const & lookAngles
+		, double const & radiusSensor
+		, double const & radiusEarth
+		, env::AirProfile const & airProfile
+			= aply::env::coesa::airProfile()
+		, double const & tolAbs = 1.e-15
+		);
+
+	//! Check if instance is valid
+	bool
+	isValid
+		() const;
+
+	//! Number of look angles in the fan.
+	std::size_t
+	size
+		() const;
+
+	//! Look angles (in the order provided to constructor).
+	std::vector<double> const &
+	lookAngles
+		() const;
+
+	/*! \brief Theta_c angle at radiusEnd for each of lookAngles().
+	 *
+	 * Ref aply::ray::Refraction::thetaAngleAt(). Values are null for
+	 * look angles with rays that do not reach radiusEnd.
+	 */
+	std::vector<double>
+	thetaAnglesAt
+		( double const & radiusEnd
+		) const;
+
+	/*! \brief Deviation at start for rays ending at radiusEnd.
+	 *
+	 * Ref aply::ray::Refraction::angularDeviationFromStart().
+	 */
+	std::vector<double>
+	angularDeviationsFromStart
+		( double const & radiusEnd
+		) const;
+
+	//! Descriptive information about this instance.
+	std::string
+	infoString
+		( std::string const & title=std::string()
+		) const;
+
+};
+
+} // ray
+} // aply
+
+#endif // aply_ray_RefractionFan_INCL_
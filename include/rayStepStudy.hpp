@@ -0,0 +1,210 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_StepStudy_INCL_
+#define aply_ray_StepStudy_INCL_
+
+/*! \file
+\brief Declarations for ray::StepStudy
+*/
+
+
+#include "envIndexVolume.hpp"
+#include "rayPropagator.hpp"
+#include "rayStart.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+/*! \brief Step size convergence study (with Richardson extrapolation).
+
+The same ray is traced (in parallel) with a ladder of propagation step
+sizes, h[k] = coarseStep/2^k, each for the same total path parameter
+(numSteps[k]*h[k]). The results compared are the end location and the
+deviation (angle between start and end tangent directions).
+
+The observed order of convergence, p, is estimated from the three
+finest rungs as
+
+\verbatim
+	p = log2( |Q[k-2] - Q[k-1]| / |Q[k-1] - Q[k]| )
+\endverbatim
+
+and the Richardson extrapolated (step size zero) result is
+
+\verbatim
+	Qx = Q[k] + (Q[k] - Q[k-1]) / (2^p - 1)
+\endverbatim
+
+The error of each rung is estimated as its difference from Qx, except
+for the finest rung, for which it is |Q[k] - Q[k-1]| / (2^p - 1). If
+the differences do not decrease (or are at roundoff level) the order
+is null, Qx is the finest rung result, and the rung errors are null
+(there is no evidence of convergence).
+
+The largest step size meeting an error tolerance (largestStepFor())
+together with the work statistics of each rung (LoopStats) support
+choosing the least expensive propagation step size for a scene.
+
+Example:
+\snippet test_StepStudy.cpp DoxyExample01
+
+*/
+
+class StepStudy
+{
+
+public: // types
+
+	//! Result of tracing with one step size.
+	struct Rung
+	{
+		//! Propagation step size
+		double theStepDist{ engabra::g3::null<double>() };
+		//! Number of steps taken (to same total path parameter)
+		std::size_t theNumSteps{ 0u };
+		//! Location at end of steps
+		engabra::g3::Vector theEndLoc{ engabra::g3::null<Vector>() };
+		//! Angle [rad] between start and end tangent directions
+		double theDeviation{ engabra::g3::null<double>() };
+		//! Estimated error (magnitude) of theEndLoc
+		double theLocError{ engabra::g3::null<double>() };
+		//! Estimated error (magnitude) of theDeviation
+		double theDevError{ engabra::g3::null<double>() };
+		//! Propagation work (number of steps and refinement loops)
+		LoopStats theStats{};
+
+		//! True if all steps were taken (ray remained within media)
+		bool
+		isValid
+			() const;
+	};
+
+private: // data
+
+	//! Results for each step size (coarsest first)
+	std::vector<Rung> theRungs{};
+
+	//! Observed order of convergence of end location
+	double theLocOrder{ engabra::g3::null<double>() };
+
+	//! Observed order of convergence of deviation
+	double theDevOrder{ engabra::g3::null<double>() };
+
+	//! Extrapolated (zero step size) end location
+	engabra::g3::Vector theExtrapLoc{ engabra::g3::null<Vector>() };
+
+	//! Extrapolated (zero step size) deviation
+	double theExtrapDev{ engabra::g3::null<double>() };
+
+public: // methods
+
+	//! default null constructor
+	StepStudy
+		() = default;
+
+	/*! \brief Trace start (with numRungs step sizes) through media.
+	 *
+	 * Each ray is traced for (about) pathLength (rounded up to a
+	 * multiple of coarseStep) with a Propagator configured with
+	 * stepMethod and useAcceleration. Rungs are traced in parallel
+	 * (one thread each). At least three rungs are needed for an
+	 * order (and extrapolation) estimate.
+	 */
+	explicit
+	StepStudy
+		( env::IndexVolume const * const & ptMedia
+		, Start const & start
+		, double const & pathLength
+		, double const & coarseStep
+		, std::size_t const & numRungs = 5u
+		, StepMethod const & stepMethod = InterfaceStep
+		, bool const & useAcceleration = false
+		);
+
+	//! True if all rungs are valid and an extrapolation is available
+	bool
+	isValid
+		() const;
+
+	//! Results for each step size (coarsest first)
+	std::vector<Rung> const &
+	rungs
+		() const;
+
+	//! Observed order of convergence of end location (null if unknown)
+	double
+	locOrder
+		() const;
+
+	//! Observed order of convergence of deviation (null if unknown)
+	double
+	devOrder
+		() const;
+
+	//! Richardson extrapolated (zero step size) end location
+	engabra::g3::Vector
+	extrapolatedLoc
+		() const;
+
+	//! Richardson extrapolated (zero step size) deviation
+	double
+	extrapolatedDeviation
+		() const;
+
+	/*! \brief Largest rung step size with errors within tolerances.
+	 *
+	 * Null if no (valid) rung meets both tolerances, or if the order
+	 * is null (for devTol, only if it is finite).
+	 */
+	double
+	largestStepFor
+		( double const & locTol
+		, double const & devTol = std::numeric_limits<double>::infinity()
+		) const;
+
+	//! Descriptive information about this instance (table of rungs)
+	std::string
+	infoString
+		( std::string const & title = {}
+		) const;
+
+}; // StepStudy
+
+} // [ray]
+} // [aply]
+
+#endif // aply_ray_StepStudy_INCL_
+
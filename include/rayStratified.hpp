@@ -0,0 +1,332 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_Stratified_INCL_
+#define aply_ray_Stratified_INCL_
+
+/*! \file
+\brief Declarations for ray::Stratified
+*/
+
+
+#include "envAirProfile.hpp"
+#include "rayNode.hpp"
+#include "rayStart.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+
+/*! \brief Layer-exact ray propagation through stratified media.
+
+The media IoR depends on only one coordinate, either height along e3
+(planar layers) or distance from the origin (spherical shells, e.g. an
+env::AirProfile above a spherical Earth centered at the origin). The
+ray then lies in a plane and has a conserved Snell/Bouguer invariant
+(n*sin(zenith) for planar layers, r*n*sin(zenith) for shells).
+
+Spherical shells are mapped to planar layers with the (conformal)
+Earth flattening transformation
+
+\verbatim
+	w = R*ln(r/R) ; u = R*theta ; nf = n*r/R
+\endverbatim
+
+which preserves angles and turns the Bouguer invariant into the planar
+Snell invariant, C = nf*cos(elevation). For planar layers w is height
+and nf is n.
+
+The media is modeled with layers within which nf^2 is linear in w,
+i.e. nf^2 = Q(w) = Qk + Bk*(w-wk). With ray parameter, sigma, such that
+d(location)/d(sigma) = nf*tangent, the path within a layer is exact
+
+\verbatim
+	pw(sigma) = pw0 + (Bk/2)*sigma   (vertical "momentum" nf*sin(elev))
+	 w(sigma) =  w0 + pw0*sigma + (Bk/4)*sigma^2
+	 u(sigma) =  u0 + C*sigma
+\endverbatim
+
+The layer exit is the root of a quadratic. Turning points (where pw
+changes sign, e.g. ducting or "mirage" reflection) need no special
+treatment. Arc length, the integral of sqrt(C^2+pw^2) d(sigma), also
+has a closed form.
+
+The cost to traverse a layer is therefore independent of the layer
+thickness and the path is exact (to roundoff) for the layered model
+of the media. Nodes are reported at arbitrary (arc length) spacing.
+For spherical shells, the arc length is (r/R) times the flattened arc
+length and the node spacing is exact to second order in the change
+in height (relative to R) between nodes.
+
+Example:
+\snippet test_Stratified.cpp DoxyExample01
+
+*/
+
+class Stratified
+{
+
+public: // types
+
+	//! Propagation state (in flattened coordinates) of one ray.
+	struct RayState
+	{
+		//! Index of layer containing ray (or npos if outside)
+		std::size_t theLayer{ std::numeric_limits<std::size_t>::max() };
+		//! Flattened height coordinate
+		double theW{ engabra::g3::null<double>() };
+		//! Flattened horizontal coordinate (from start location)
+		double theU{ engabra::g3::null<double>() };
+		//! Vertical component of (flattened) ray "momentum", nf*sin(elev)
+		double thePw{ engabra::g3::null<double>() };
+		//! Snell invariant - horizontal "momentum", nf*cos(elev)
+		double theC{ engabra::g3::null<double>() };
+		//! Start location for planar, origin (Earth center) for spherical
+		engabra::g3::Vector theOrigin{ engabra::g3::null<Vector>() };
+		//! Upward direction (at start location)
+		engabra::g3::Vector theDirUp{ engabra::g3::null<Vector>() };
+		//! Horizontal direction of propagation (at start location)
+		engabra::g3::Vector theDirFwd{ engabra::g3::null<Vector>() };
+
+		//! True if ray is within the layered domain.
+		inline
+		bool
+		isInside
+			() const
+		{
+			return (theLayer < std::numeric_limits<std::size_t>::max());
+		}
+	};
+
+private: // data
+
+	//! Flattening (Earth) radius - null for planar layers.
+	double theRadius{ engabra::g3::null<double>() };
+
+	//! Flattened height coordinate of layer boundaries (ascending).
+	std::vector<double> theWs{};
+
+	//! Flattened IoR squared value at each of theWs.
+	std::vector<double> theQs{};
+
+	//! Rate of change of theQs w.r.t. theWs within each layer.
+	std::vector<double> theSlopes{};
+
+private: // methods
+
+	//! Index of layer containing w (or npos if outside all layers).
+	std::size_t
+	layerIndexFor
+		( double const & wVal
+		) const;
+
+	//! Flattened IoR squared at w within layer ndx.
+	double
+	qValueFor
+		( std::size_t const & ndx
+		, double const & wVal
+		) const;
+
+	//! Ratio of actual to flattened arc length at w (unity if planar).
+	double
+	scaleFor
+		( double const & wVal
+		) const;
+
+	//! Actual arc length along ray for (in layer) parameter change sigma.
+	double
+	arcLengthFor
+		( RayState const & state
+		, double const & sigma
+		) const;
+
+	//! Ray parameter change (less than sigMax) producing arc length.
+	double
+	sigmaForArc
+		( RayState const & state
+		, double const & arcDist
+		, double const & sigMax
+		) const;
+
+public: // methods
+
+	//! default null constructor
+	Stratified
+		() = default;
+
+	/*! \brief Layers with boundaries at heights with IoR values nus.
+	 *
+	 * If radiusEarth is null, layers are planar with heights along e3
+	 * (from origin). Otherwise, layers are spherical shells (centered
+	 * on origin) with heights relative to radiusEarth.
+	 *
+	 * The heights must be strictly increasing (else !isValid()).
+	 */
+	explicit
+	Stratified
+		( std::vector<double> const & heights
+		, std::vector<double> const & nus
+		, double const & radiusEarth = engabra::g3::null<double>()
+		);
+
+	/*! \brief Spherical shells sampling airProfile at heights.
+	 *
+	 * The heights should include any airProfile.breakHeights() that
+	 * are within the range of interest.
+	 */
+	explicit
+	Stratified
+		( std::vector<double> const & heights
+		, env::AirProfile const & airProfile
+		, double const & radiusEarth
+		);
+
+	//! True if instance is valid
+	bool
+	isValid
+		() const;
+
+	//! Number of layers modeled
+	std::size_t
+	numLayers
+		() const;
+
+	//! Index of refraction (as modeled) at location (null if outside)
+	double
+	nuValue
+		( engabra::g3::Vector const & rVec
+		) const;
+
+	//! State (inside() or not) for ray starting at location in direction
+	RayState
+	rayStateFor
+		( Start const & start
+		) const;
+
+	/*! \brief Propagate state forward by arc length distance.
+	 *
+	 * Returns false (with state at the boundary crossing location)
+	 * if the ray leaves the layered domain before arcDist.
+	 */
+	bool
+	advance
+		( RayState * const & ptState
+		, double const & arcDist
+		) const;
+
+	//! Location corresponding to ray state
+	engabra::g3::Vector
+	locationFor
+		( RayState const & state
+		) const;
+
+	//! Unitary ray tangent direction corresponding to ray state
+	engabra::g3::Vector
+	tangentFor
+		( RayState const & state
+		) const;
+
+	//! Index of refraction (as modeled) corresponding to ray state
+	double
+	nuFor
+		( RayState const & state
+		) const;
+
+	//! Classification of IoR change along ray at state
+	DirChange
+	changeFor
+		( RayState const & state
+		) const;
+
+	/*! \brief Propagate ray from ptConsumer->theStart.
+	 *
+	 * Nodes are provided to the consumer (with emplace_back()) every
+	 * nodeDist of arc length, until the ray leaves the layered domain
+	 * or until ptConsumer->capacity() nodes are consumed. The final
+	 * node is at the location where the ray exits the domain. Since
+	 * the path is exact, node thePrevTan and theNextTan are the (same)
+	 * tangent and thePrevNu and theNextNu are the IoR at the node.
+	 *
+	 * Computation effort per node is constant (independent of
+	 * nodeDist) and nodeDist may be arbitrarily large. (Note that
+	 * ray::Path decimates nodes by chord distance, so nodeDist should
+	 * be less than the Path::theSaveDist).
+	 */
+	template <typename Consumer>
+	inline
+	void
+	tracePath
+		( Consumer * const & ptConsumer
+		, double const & nodeDist
+		) const
+	{
+		if (isValid() && ptConsumer && (0. < nodeDist))
+		{
+			RayState state{ rayStateFor(ptConsumer->theStart) };
+			bool isInside{ state.isInside() };
+			bool isExit{ false };
+			while (isInside && (ptConsumer->size() < ptConsumer->capacity()))
+			{
+				// advance (a copy) first to detect the final node
+				RayState stateNext{ state };
+				isInside = advance(&stateNext, nodeDist);
+				isExit = (! isInside);
+
+				Vector const tan{ tangentFor(state) };
+				double const nu{ nuFor(state) };
+				DirChange const change{ changeFor(state) };
+				Node const node{ tan, nu, locationFor(state), nu, tan, change };
+				ptConsumer->emplace_back(node);
+
+				state = stateNext;
+			}
+
+			// add node at location where ray leaves the domain
+			if (isExit && (ptConsumer->size() < ptConsumer->capacity()))
+			{
+				Vector const tan{ tangentFor(state) };
+				double const nu{ nuFor(state) };
+				Node const node
+					{ tan, nu, locationFor(state), nu, tan, Stopped };
+				ptConsumer->emplace_back(node);
+			}
+		}
+	}
+
+}; // Stratified
+
+} // [ray]
+} // [aply]
+
+#endif // aply_ray_Stratified_INCL_
+
@@ -0,0 +1,158 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+#ifndef aply_ray_TangentBatch_INCL_
+#define aply_ray_TangentBatch_INCL_
+
+/*! \file
+ *
+ * \brief Batched (structure of arrays) refraction tangent computation.
+ *
+ */
+
+
+#include "rayDirChange.hpp"
+
+#include <Engabra>
+
+#include <cstddef>
+#include <vector>
+
+
+namespace aply
+{
+namespace ray
+{
+	using namespace engabra::g3;
+
+	/*! \brief Inputs and results for batched nextTangentDirs() evaluation.
+	 *
+	 * Data are stored as separate arrays for each component (structure
+	 * of arrays) so that the loops in nextTangentDirs() can be
+	 * vectorized by the compiler. Where supported, the kernel is built
+	 * for several SIMD instruction sets with the one used selected at
+	 * run time (ref src/rayTangentBatch.cpp).
+	 */
+	struct TangentBatch
+	{
+		// inputs
+		std::vector<double> theTanX{}; //!< Incident tangent (unitary)
+		std::vector<double> theTanY{}; //!< Incident tangent (unitary)
+		std::vector<double> theTanZ{}; //!< Incident tangent (unitary)
+		std::vector<double> theGradX{}; //!< IoR gradient (non-zero)
+		std::vector<double> theGradY{}; //!< IoR gradient (non-zero)
+		std::vector<double> theGradZ{}; //!< IoR gradient (non-zero)
+		std::vector<double> theNuPrev{}; //!< Incoming IoR
+		std::vector<double> theNuNext{}; //!< Exiting IoR
+
+		// results
+		std::vector<double> theNextX{}; //!< Exiting tangent direction
+		std::vector<double> theNextY{}; //!< Exiting tangent direction
+		std::vector<double> theNextZ{}; //!< Exiting tangent direction
+		std::vector<DirChange> theChanges{}; //!< Boundary action
+
+		//! Number of entries in each array.
+		inline
+		std::size_t
+		size
+			() const
+		{
+			return theTanX.size();
+		}
+
+		//! Set size of all arrays (values are not initialized).
+		inline
+		void
+		resize
+			( std::size_t const & numElem
+			)
+		{
+			for (std::vector<double> * const & ptArray
+				: { &theTanX, &theTanY, &theTanZ
+				  , &theGradX, &theGradY, &theGradZ
+				  , &theNuPrev, &theNuNext
+				  , &theNextX, &theNextY, &theNextZ
+				  })
+			{
+				ptArray->resize(numElem);
+			}
+			theChanges.resize(numElem);
+		}
+
+		//! Assign input values (same arguments as nextTangentDir()).
+		inline
+		void
+		set
+			( std::size_t const & ndx
+			, Vector const & tDirPrev
+			, double const & nuPrev
+			, Vector const & gCurr
+			, double const & nuNext
+			)
+		{
+			theTanX[ndx] = tDirPrev[0];
+			theTanY[ndx] = tDirPrev[1];
+			theTanZ[ndx] = tDirPrev[2];
+			theNuPrev[ndx] = nuPrev;
+			theGradX[ndx] = gCurr[0];
+			theGradY[ndx] = gCurr[1];
+			theGradZ[ndx] = gCurr[2];
+			theNuNext[ndx] = nuNext;
+		}
+
+		//! Result tangent direction (after nextTangentDirs()).
+		inline
+		Vector
+		nextTanAt
+			( std::size_t const & ndx
+			) const
+		{
+			return Vector{ theNextX[ndx], theNextY[ndx], theNextZ[ndx] };
+		}
+
+	}; // TangentBatch
+
+	/*! \brief Evaluate nextTangentDir() for all entries in the batch.
+	 *
+	 * Results agree with (scalar) nextTangentDir() to within roundoff.
+	 * The geometric algebra products there are expanded here into
+	 * equivalent dot and cross products. With
+	 * \arg rho = nuPrev/nuNext
+	 * \arg xi = sqrt(g^2 - rho^2*|t x g|^2)
+	 *
+	 * the exiting tangent is:
+	 * \arg t - 2*(t.g)/g^2 * g -- for (xi^2 < 0) - total reflection
+	 * \arg (+/-xi*g + rho*(g^2*t - (t.g)*g))/g^2 -- for (0 </> t.g)
+	 * \arg t -- for (t.g == 0) or invalid nuPrev (Stopped)
+	 */
+	void
+	nextTangentDirs
+		( TangentBatch * const & ptBatch
+		);
+
+} // [ray]
+} // [aply]
+
+#endif // aply_ray_TangentBatch_INCL_
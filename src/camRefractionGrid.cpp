@@ -0,0 +1,361 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for aply::cam::RefractionGrid
+*/
+
+
+#include "camRefractionGrid.hpp"
+
+#include "rayRefractionFan.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+
+namespace
+{
+	//! Null valued image location.
+	inline
+	aply::cam::ImgRowCol
+	nullRowCol
+		()
+	{
+		using engabra::g3::null;
+		return aply::cam::ImgRowCol{ null<double>(), null<double>() };
+	}
+
+	//! Interpolation cell index and fraction for grid coordinate.
+	inline
+	std::pair<std::size_t, double>
+	cellFraction
+		( double const & gridCoord
+		, std::size_t const & numNodes
+		)
+	{
+		std::pair<std::size_t, double> ndxFrac{ 0u, 0. };
+		if (1u < numNodes)
+		{
+			std::size_t const ndx
+				{ std::min
+					( static_cast<std::size_t>(gridCoord)
+					, numNodes - 2u
+					)
+				};
+			double const frac{ gridCoord - static_cast<double>(ndx) };
+			ndxFrac = std::make_pair(ndx, frac);
+		}
+		return ndxFrac;
+	}
+
+} // [anon]
+
+
+namespace aply
+{
+namespace cam
+{
+
+RefractionGrid :: RefractionGrid
+	( Interior const & interior
+	, double const & heightSensor
+	, double const & heightGround
+	, env::AirProfile const & airProfile
+	, double const & radiusEarth
+	, std::size_t const & cellSize
+	, std::size_t const & numThreads
+	)
+	: theInterior{ interior }
+	, theNadirRowCol{ interior.thePrincipalPoint }
+	, theCellSize{ cellSize }
+	, theNumNodeRows{ 0u }
+	, theNumNodeCols{ 0u }
+	, theRadialDisps{}
+	, theNodeDisps{}
+{
+	if (! (theInterior.isValid() && (0u < theCellSize)))
+	{
+		return;
+	}
+
+	// grid nodes (every cellSize pixels) cover the entire format
+	std::size_t const & cell = theCellSize;
+	theNumNodeRows = 1u + (theInterior.theNumRows + cell - 2u) / cell;
+	theNumNodeCols = 1u + (theInterior.theNumCols + cell - 2u) / cell;
+
+	// largest radial distance (from nadir) of any grid node
+	double const rowMax{ static_cast<double>((theNumNodeRows-1u) * cell) };
+	double const colMax{ static_cast<double>((theNumNodeCols-1u) * cell) };
+	double const dRowMax
+		{ std::max(theNadirRowCol[0], rowMax - theNadirRowCol[0]) };
+	double const dColMax
+		{ std::max(theNadirRowCol[1], colMax - theNadirRowCol[1]) };
+	double const rhoMax{ std::hypot(dRowMax, dColMax) };
+
+	// 1D curve: look angles at one pixel intervals of radial distance
+	std::size_t const numRho
+		{ 2u + static_cast<std::size_t>(std::ceil(rhoMax)) };
+	std::vector<double> lookAngles(numRho);
+	for (std::size_t nn{0u} ; nn < numRho ; ++nn)
+	{
+		double const rho{ static_cast<double>(nn) };
+		lookAngles[nn] = theInterior.angleForRadialPixels(rho);
+	}
+
+	// refraction deviations for all look angles in one integration
+	double const radiusSensor{ radiusEarth + heightSensor };
+	double const radiusGround{ radiusEarth + heightGround };
+	ray::RefractionFan const fan
+		(lookAngles, radiusSensor, radiusEarth, airProfile);
+	std::vector<double> const deviations
+		{ fan.angularDeviationsFromStart(radiusGround) };
+
+	// radial image displacement: ideal minus observed image location
+	// (deviations are observed look angle minus ideal straight line angle)
+	theRadialDisps.resize(numRho);
+	for (std::size_t nn{0u} ; nn < numRho ; ++nn)
+	{
+		double const idealAngle{ lookAngles[nn] - deviations[nn] };
+		theRadialDisps[nn] = theInterior.radialPixelsForAngle(idealAngle)
+			- static_cast<double>(nn);
+	}
+
+	// expand radial curve into grid (in parallel over tiles of rows)
+	theNodeDisps.resize(theNumNodeRows * theNumNodeCols);
+	std::size_t numTiles{ numThreads };
+	if (0u == numTiles)
+	{
+		numTiles = std::max(1u, std::thread::hardware_concurrency());
+	}
+	numTiles = std::min(numTiles, theNumNodeRows);
+	std::size_t const tileSize{ (theNumNodeRows + numTiles - 1u) / numTiles };
+	std::vector<std::thread> threads;
+	threads.reserve(numTiles);
+	for (std::size_t rowBeg{0u} ; rowBeg < theNumNodeRows ; rowBeg += tileSize)
+	{
+		std::size_t const rowEnd{ std::min(rowBeg + tileSize, theNumNodeRows) };
+		threads.emplace_back
+			(&RefractionGrid::fillNodeRows, this, rowBeg, rowEnd);
+	}
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void
+RefractionGrid :: fillNodeRows
+	( std::size_t const rowBeg
+	, std::size_t const rowEnd
+	)
+{
+	for (std::size_t nr{rowBeg} ; nr < rowEnd ; ++nr)
+	{
+		double const rowNode{ static_cast<double>(nr * theCellSize) };
+		double const dRow{ rowNode - theNadirRowCol[0] };
+		ImgRowCol * const ptRow{ theNodeDisps.data() + nr*theNumNodeCols };
+		for (std::size_t nc{0u} ; nc < theNumNodeCols ; ++nc)
+		{
+			double const colNode{ static_cast<double>(nc * theCellSize) };
+			double const dCol{ colNode - theNadirRowCol[1] };
+			double const rho{ std::hypot(dRow, dCol) };
+			ImgRowCol disp{ 0., 0. };
+			if (0. < rho)
+			{
+				// radial direction away from nadir
+				double const scl{ radialDisplacementAt(rho) / rho };
+				disp = ImgRowCol{ scl * dRow, scl * dCol };
+			}
+			ptRow[nc] = disp;
+		}
+	}
+}
+
+bool
+RefractionGrid :: isValid
+	() const
+{
+	return
+		(  (! theNodeDisps.empty())
+		&& (theNumNodeRows * theNumNodeCols == theNodeDisps.size())
+		);
+}
+
+Interior const &
+RefractionGrid :: interior
+	() const
+{
+	return theInterior;
+}
+
+double
+RefractionGrid :: radialDisplacementAt
+	( double const & radialPixels
+	) const
+{
+	double disp{ engabra::g3::null<double>() };
+	std::size_t const numRho{ theRadialDisps.size() };
+	if ( (1u < numRho)
+	  && (! (radialPixels < 0.))
+	  && (! (static_cast<double>(numRho - 1u) < radialPixels))
+	   )
+	{
+		std::pair<std::size_t, double> const ndxFrac
+			{ cellFraction(radialPixels, numRho) };
+		double const & disp0 = theRadialDisps[ndxFrac.first];
+		double const & disp1 = theRadialDisps[ndxFrac.first + 1u];
+		disp = disp0 + ndxFrac.second * (disp1 - disp0);
+	}
+	return disp;
+}
+
+ImgRowCol
+RefractionGrid :: displacementAt
+	( ImgRowCol const & rowCol
+	) const
+{
+	ImgRowCol disp{ nullRowCol() };
+	double const rowLast{ static_cast<double>(theInterior.theNumRows-1u) };
+	double const colLast{ static_cast<double>(theInterior.theNumCols-1u) };
+	if ( isValid()
+	  && (! (rowCol[0] < 0.)) && (! (rowLast < rowCol[0]))
+	  && (! (rowCol[1] < 0.)) && (! (colLast < rowCol[1]))
+	   )
+	{
+		double const cellSize{ static_cast<double>(theCellSize) };
+		std::pair<std::size_t, double> const rowFrac
+			{ cellFraction(rowCol[0] / cellSize, theNumNodeRows) };
+		std::pair<std::size_t, double> const colFrac
+			{ cellFraction(rowCol[1] / cellSize, theNumNodeCols) };
+
+		// neighboring nodes (coincide for single row/col grids)
+		std::size_t const nr0{ rowFrac.first };
+		std::size_t const nc0{ colFrac.first };
+		std::size_t const nr1{ std::min(nr0 + 1u, theNumNodeRows - 1u) };
+		std::size_t const nc1{ std::min(nc0 + 1u, theNumNodeCols - 1u) };
+		ImgRowCol const & d00 = theNodeDisps[nr0*theNumNodeCols + nc0];
+		ImgRowCol const & d01 = theNodeDisps[nr0*theNumNodeCols + nc1];
+		ImgRowCol const & d10 = theNodeDisps[nr1*theNumNodeCols + nc0];
+		ImgRowCol const & d11 = theNodeDisps[nr1*theNumNodeCols + nc1];
+
+		double const & wr = rowFrac.second;
+		double const & wc = colFrac.second;
+		for (std::size_t nn{0u} ; nn < 2u ; ++nn)
+		{
+			double const d0{ d00[nn] + wc * (d01[nn] - d00[nn]) };
+			double const d1{ d10[nn] + wc * (d11[nn] - d10[nn]) };
+			disp[nn] = d0 + wr * (d1 - d0);
+		}
+	}
+	return disp;
+}
+
+void
+RefractionGrid :: displacementsForRow
+	( std::size_t const & row
+	, std::vector<ImgRowCol> * const & ptRowDisps
+	) const
+{
+	std::vector<ImgRowCol> & rowDisps = *ptRowDisps;
+	std::size_t const numCols{ theInterior.theNumCols };
+	rowDisps.resize(numCols);
+	if (! (isValid() && (row < theInterior.theNumRows)))
+	{
+		rowDisps.assign(numCols, nullRowCol());
+		return;
+	}
+
+	// blend adjacent node rows (once for entire image row)
+	double const cellSize{ static_cast<double>(theCellSize) };
+	std::pair<std::size_t, double> const rowFrac
+		{ cellFraction(static_cast<double>(row) / cellSize, theNumNodeRows) };
+	std::size_t const nr0{ rowFrac.first };
+	std::size_t const nr1{ std::min(nr0 + 1u, theNumNodeRows - 1u) };
+	double const & wr = rowFrac.second;
+	ImgRowCol const * const ptNode0{ &(theNodeDisps[nr0*theNumNodeCols]) };
+	ImgRowCol const * const ptNode1{ &(theNodeDisps[nr1*theNumNodeCols]) };
+	std::vector<ImgRowCol> blends(theNumNodeCols);
+	for (std::size_t nc{0u} ; nc < theNumNodeCols ; ++nc)
+	{
+		for (std::size_t nn{0u} ; nn < 2u ; ++nn)
+		{
+			double const & d0 = ptNode0[nc][nn];
+			double const & d1 = ptNode1[nc][nn];
+			blends[nc][nn] = d0 + wr * (d1 - d0);
+		}
+	}
+
+	// linear interpolation across each cell of blended values
+	double const invCell{ 1. / cellSize };
+	for (std::size_t col{0u} ; col < numCols ; ++col)
+	{
+		std::size_t const nc0{ col / theCellSize };
+		std::size_t const nc1{ std::min(nc0 + 1u, theNumNodeCols - 1u) };
+		double const wc
+			{ invCell * static_cast<double>(col - nc0*theCellSize) };
+		ImgRowCol const & b0 = blends[nc0];
+		ImgRowCol const & b1 = blends[nc1];
+		rowDisps[col] = ImgRowCol
+			{ b0[0] + wc * (b1[0] - b0[0])
+			, b0[1] + wc * (b1[1] - b0[1])
+			};
+	}
+}
+
+ImgRowCol
+RefractionGrid :: correctedRowCol
+	( ImgRowCol const & rowCol
+	) const
+{
+	ImgRowCol const disp{ displacementAt(rowCol) };
+	return ImgRowCol{ rowCol[0] + disp[0], rowCol[1] + disp[1] };
+}
+
+std::string
+RefractionGrid :: infoString
+	( std::string const & title
+	) const
+{
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	using engabra::g3::io::fixed;
+	oss << theInterior.infoString("Interior") << '\n';
+	oss
+		<< "cellSize: " << theCellSize
+		<< "  numNodeRows: " << theNumNodeRows
+		<< "  numNodeCols: " << theNumNodeCols
+		<< "  numRadialSamples: " << theRadialDisps.size()
+		;
+	return oss.str();
+}
+
+} // [cam]
+} // [aply]
@@ -0,0 +1,603 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for aply::env::AirArchive and related functions.
+*/
+
+
+#include "envAirArchive.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace aply
+{
+namespace env
+{
+
+	//! Private implementation detail utilities.
+	namespace priv
+	{
+		//! Archive file identification (first bytes of archive file).
+		constexpr std::array<char, 8u> sArchiveMagic
+			{ 'A', 'P', 'L', 'Y', 'A', 'I', 'R', '1' };
+
+		//! \brief Fixed size preamble at start of archive file.
+		struct ArchiveHeader
+		{
+			std::array<char, 8u> theMagic; //!< sArchiveMagic
+			std::uint64_t theNumEntries; //!< number of profiles
+			std::uint64_t theIndexOffset; //!< byte offset to first entry
+			std::uint64_t theDataOffset; //!< byte offset to column data
+		};
+
+		static_assert(32u == sizeof(ArchiveHeader), "ArchiveHeader pack");
+
+		//! Number of (double) columns stored for each profile.
+		constexpr std::size_t sNumColumns{ 4u };
+
+		//! Month number [1,12] from English abbreviation (0 if unknown)
+		int
+		monthFor
+			( std::string const & monName
+			)
+		{
+			static std::array<char const *, 12u> const sMonNames
+				{ "Jan", "Feb", "Mar", "Apr", "May", "Jun"
+				, "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+				};
+			int month{ 0 };
+			for (std::size_t nn{0u} ; nn < sMonNames.size() ; ++nn)
+			{
+				if (monName == sMonNames[nn])
+				{
+					month = static_cast<int>(nn + 1u);
+					break;
+				}
+			}
+			return month;
+		}
+
+		//! Put binary representation of item into stream.
+		template <typename Type>
+		inline
+		void
+		putBinary
+			( std::ostream & ostrm
+			, Type const & item
+			)
+		{
+			ostrm.write(reinterpret_cast<char const *>(&item), sizeof(item));
+		}
+
+	} // [priv]
+
+
+//
+// SoundingKey
+//
+
+// static
+std::int64_t
+SoundingKey :: timeKeyFor
+	( int const & year
+	, int const & month
+	, int const & day
+	, int const & hour
+	)
+{
+	return
+		( std::int64_t{ year } * 1000000
+		+ std::int64_t{ month } * 10000
+		+ std::int64_t{ day } * 100
+		+ std::int64_t{ hour }
+		);
+}
+
+bool
+SoundingKey :: isValid
+	() const
+{
+	return ((0u < theStationId) && (0 < theTimeKey));
+}
+
+bool
+SoundingKey :: operator<
+	( SoundingKey const & other
+	) const
+{
+	return
+		(  (theStationId < other.theStationId)
+		|| (  (theStationId == other.theStationId)
+		   && (theTimeKey < other.theTimeKey)
+		   )
+		);
+}
+
+bool
+SoundingKey :: operator==
+	( SoundingKey const & other
+	) const
+{
+	return
+		(  (theStationId == other.theStationId)
+		&& (theTimeKey == other.theTimeKey)
+		);
+}
+
+std::string
+SoundingKey :: infoBrief
+	() const
+{
+	std::ostringstream oss;
+	oss << std::setw(5u) << std::setfill('0') << theStationId
+		<< ' ' << theTimeKey;
+	return oss.str();
+}
+
+
+//
+// Sounding
+//
+
+// static
+Sounding
+Sounding :: fromUWyoHeader
+	( std::string const & headerLine
+	)
+{
+	Sounding sounding{};
+	// e.g. "72562 LBF North Platte Observations at 12Z 09 Jan 2024"
+	static std::regex const rxHeader
+		( "^\\s*([0-9]+)\\s+([A-Z0-9]{1,4})?.*Observations at\\s+"
+		  "([0-9]{1,2})Z\\s+([0-9]{1,2})\\s+([A-Za-z]{3})\\s+([0-9]{4})"
+		);
+	std::smatch match;
+	if (std::regex_search(headerLine, match, rxHeader))
+	{
+		int const hour{ std::stoi(match[3].str()) };
+		int const day{ std::stoi(match[4].str()) };
+		int const month{ priv::monthFor(match[5].str()) };
+		int const year{ std::stoi(match[6].str()) };
+		if (0 < month)
+		{
+			unsigned long const station{ std::stoul(match[1].str()) };
+			sounding.theKey.theStationId
+				= static_cast<std::uint32_t>(station);
+			sounding.theKey.theTimeKey
+				= SoundingKey::timeKeyFor(year, month, day, hour);
+			sounding.theStationCode = match[2].str();
+		}
+	}
+	return sounding;
+}
+
+bool
+Sounding :: isValid
+	() const
+{
+	return (theKey.isValid() && (1u < theAirInfoMap.size()));
+}
+
+std::vector<Sounding>
+soundingsFromUWyo
+	( std::istream & istrm
+	)
+{
+	std::vector<Sounding> soundings;
+	std::string line;
+	while (std::getline(istrm, line))
+	{
+		// header line begins a new sounding
+		Sounding const header{ Sounding::fromUWyoHeader(line) };
+		if (header.theKey.isValid())
+		{
+			soundings.emplace_back(header);
+			continue;
+		}
+		// data records - same qualification as airInfoFromUWyoSounding()
+		static std::regex const rxNonDigit("[A-Z]");
+		if (soundings.empty() || std::regex_search(line, rxNonDigit))
+		{
+			continue;
+		}
+		AirInfo const info{ AirInfo::fromUWyoRecord(line) };
+		if (info.isValid())
+		{
+			soundings.back().theAirInfoMap[info.height()] = info;
+		}
+	}
+	return soundings;
+}
+
+std::vector<Sounding>
+soundingsFromUWyo
+	( std::filesystem::path const & inPath
+	)
+{
+	std::ifstream ifs(inPath.native());
+	return soundingsFromUWyo(ifs);
+}
+
+bool
+saveAirArchive
+	( std::filesystem::path const & outPath
+	, std::vector<Sounding> const & soundings
+	)
+{
+	// order (and de-duplicate) the valid soundings by key
+	std::map<SoundingKey, Sounding const *> keySounds;
+	for (Sounding const & sounding : soundings)
+	{
+		if (sounding.isValid())
+		{
+			keySounds[sounding.theKey] = &sounding;
+		}
+	}
+
+	std::size_t const numEntries{ keySounds.size() };
+	std::uint64_t const indexOffset{ sizeof(priv::ArchiveHeader) };
+	std::uint64_t const dataOffset
+		{ indexOffset + numEntries * sizeof(ArchiveEntry) };
+
+	// assemble index
+	std::vector<ArchiveEntry> entries;
+	entries.reserve(numEntries);
+	std::uint64_t nextOffset{ dataOffset };
+	for (std::pair<SoundingKey const, Sounding const *> const & keySound
+		: keySounds)
+	{
+		Sounding const & sounding = *(keySound.second);
+		ArchiveEntry entry{};
+		entry.theStationId = sounding.theKey.theStationId;
+		std::strncpy
+			( entry.theStationCode
+			, sounding.theStationCode.c_str()
+			, sizeof(entry.theStationCode)
+			);
+		entry.theTimeKey = sounding.theKey.theTimeKey;
+		entry.theDataOffset = nextOffset;
+		entry.theNumLevels = sounding.theAirInfoMap.size();
+		entries.emplace_back(entry);
+		nextOffset += priv::sNumColumns * entry.theNumLevels * sizeof(double);
+	}
+
+	std::ofstream ofs(outPath.native(), std::ios::binary | std::ios::trunc);
+	if (ofs.good())
+	{
+		priv::ArchiveHeader const header
+			{ priv::sArchiveMagic, numEntries, indexOffset, dataOffset };
+		priv::putBinary(ofs, header);
+		for (ArchiveEntry const & entry : entries)
+		{
+			priv::putBinary(ofs, entry);
+		}
+
+		// column data for each profile (in index order)
+		std::vector<double> column;
+		for (std::pair<SoundingKey const, Sounding const *> const & keySound
+			: keySounds)
+		{
+			std::map<Height, AirInfo> const & infoMap
+				= keySound.second->theAirInfoMap;
+			column.resize(infoMap.size());
+			using Member = double AirInfo::*;
+			constexpr std::array<Member, priv::sNumColumns> members
+				{ &AirInfo::theHigh, &AirInfo::theTemp
+				, &AirInfo::thePres, &AirInfo::theRelH
+				};
+			for (Member const & member : members)
+			{
+				std::transform
+					( infoMap.cbegin(), infoMap.cend()
+					, column.begin()
+					, [& member]
+						(std::pair<Height const, AirInfo> const & hInfo)
+						{ return hInfo.second.*member; }
+					);
+				ofs.write
+					( reinterpret_cast<char const *>(column.data())
+					, column.size() * sizeof(double)
+					);
+			}
+		}
+	}
+	return ofs.good();
+}
+
+
+//
+// ArchiveEntry
+//
+
+SoundingKey
+ArchiveEntry :: key
+	() const
+{
+	return SoundingKey{ theStationId, theTimeKey };
+}
+
+std::string
+ArchiveEntry :: stationCode
+	() const
+{
+	std::size_t const len
+		{ strnlen(theStationCode, sizeof(theStationCode)) };
+	return std::string(theStationCode, len);
+}
+
+
+//
+// ProfileView
+//
+
+bool
+ProfileView :: isValid
+	() const
+{
+	return ((1u < theNumLevels) && (nullptr != theHighs));
+}
+
+AirInfo
+ProfileView :: airInfoAt
+	( std::size_t const & ndx
+	) const
+{
+	AirInfo info{};
+	if (ndx < theNumLevels)
+	{
+		info = AirInfo
+			{ theHighs[ndx], theTemps[ndx], thePress[ndx], theRelHs[ndx] };
+	}
+	return info;
+}
+
+AirProfile
+ProfileView :: airProfile
+	() const
+{
+	AirProfile profile{};
+	for (std::size_t ndx{0u} ; ndx < theNumLevels ; ++ndx)
+	{
+		// heights are stored in increasing order, so hint at end
+		profile.theAirInfoMap.emplace_hint
+			(profile.theAirInfoMap.cend(), theHighs[ndx], airInfoAt(ndx));
+	}
+	return profile;
+}
+
+
+//
+// AirArchive
+//
+
+AirArchive :: AirArchive
+	( std::filesystem::path const & archivePath
+	)
+{
+	int const fd{ ::open(archivePath.c_str(), O_RDONLY) };
+	if (! (fd < 0))
+	{
+		struct stat status{};
+		if ((0 == ::fstat(fd, &status)) && (0 < status.st_size))
+		{
+			std::size_t const mapSize
+				{ static_cast<std::size_t>(status.st_size) };
+			void * const addr
+				{ ::mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0) };
+			if (MAP_FAILED != addr)
+			{
+				theMapAddr = addr;
+				theMapSize = mapSize;
+			}
+		}
+		// mapping remains valid after descriptor is closed
+		::close(fd);
+	}
+
+	// check header and index consistency
+	if (! (theMapSize < sizeof(priv::ArchiveHeader)))
+	{
+		char const * const base{ static_cast<char const *>(theMapAddr) };
+		priv::ArchiveHeader header{};
+		std::memcpy(&header, base, sizeof(header));
+		// (sizes compared by subtraction/division to avoid wrap around)
+		std::size_t const indexBeg{ header.theIndexOffset };
+		bool okay
+			{  (priv::sArchiveMagic == header.theMagic)
+			&& (0u == (indexBeg % alignof(ArchiveEntry)))
+			&& (! (indexBeg < sizeof(header)))
+			&& (! (theMapSize < indexBeg))
+			};
+		if (okay)
+		{
+			std::size_t const maxEntries
+				{ (theMapSize - indexBeg) / sizeof(ArchiveEntry) };
+			okay = (! (maxEntries < header.theNumEntries));
+		}
+		if (okay)
+		{
+			ArchiveEntry const * const entries
+				{ reinterpret_cast<ArchiveEntry const *>
+					(base + header.theIndexOffset)
+				};
+			std::size_t const numEntries{ header.theNumEntries };
+			for (std::size_t nn{0u} ; okay && (nn < numEntries) ; ++nn)
+			{
+				ArchiveEntry const & entry = entries[nn];
+				std::size_t const dataBeg{ entry.theDataOffset };
+				okay =
+					(  (0u == (dataBeg % alignof(double)))
+					&& (! (dataBeg < sizeof(header)))
+					&& (! (theMapSize < dataBeg))
+					&& ((0u == nn) || (entries[nn-1u].key() < entry.key()))
+					);
+				if (okay)
+				{
+					constexpr std::size_t levelSize
+						{ priv::sNumColumns * sizeof(double) };
+					std::size_t const maxLevels
+						{ (theMapSize - dataBeg) / levelSize };
+					okay = (! (maxLevels < entry.theNumLevels));
+				}
+			}
+			if (okay)
+			{
+				theEntries = entries;
+				theNumEntries = numEntries;
+			}
+		}
+	}
+}
+
+AirArchive :: ~AirArchive
+	()
+{
+	if (nullptr != theMapAddr)
+	{
+		::munmap(const_cast<void *>(theMapAddr), theMapSize);
+	}
+}
+
+bool
+AirArchive :: isValid
+	() const
+{
+	return (nullptr != theEntries);
+}
+
+std::size_t
+AirArchive :: size
+	() const
+{
+	return theNumEntries;
+}
+
+ArchiveEntry const &
+AirArchive :: entryAt
+	( std::size_t const & ndx
+	) const
+{
+	return theEntries[ndx];
+}
+
+ArchiveEntry const *
+AirArchive :: entryFor
+	( SoundingKey const & key
+	) const
+{
+	ArchiveEntry const * ptEntry{ nullptr };
+	if (isValid())
+	{
+		ArchiveEntry const * const beg{ theEntries };
+		ArchiveEntry const * const end{ theEntries + theNumEntries };
+		ArchiveEntry const * const found
+			{ std::lower_bound
+				( beg, end, key
+				, [] (ArchiveEntry const & entry, SoundingKey const & key)
+					{ return (entry.key() < key); }
+				)
+			};
+		if ((end != found) && (found->key() == key))
+		{
+			ptEntry = found;
+		}
+	}
+	return ptEntry;
+}
+
+ProfileView
+AirArchive :: profileViewFor
+	( SoundingKey const & key
+	) const
+{
+	ProfileView view{};
+	ArchiveEntry const * const ptEntry{ entryFor(key) };
+	if (ptEntry)
+	{
+		char const * const base{ static_cast<char const *>(theMapAddr) };
+		std::size_t const numLevels{ ptEntry->theNumLevels };
+		double const * const data
+			{ reinterpret_cast<double const *>(base + ptEntry->theDataOffset)
+			};
+		view.theNumLevels = numLevels;
+		view.theHighs = data;
+		view.theTemps = data + numLevels;
+		view.thePress = data + 2u*numLevels;
+		view.theRelHs = data + 3u*numLevels;
+	}
+	return view;
+}
+
+AirProfile
+AirArchive :: airProfileFor
+	( SoundingKey const & key
+	) const
+{
+	return profileViewFor(key).airProfile();
+}
+
+std::string
+AirArchive :: infoString
+	( std::string const & title
+	) const
+{
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	oss << "isValid: " << std::boolalpha << isValid()
+		<< "  numProfiles: " << size() << '\n';
+	for (std::size_t nn{0u} ; nn < size() ; ++nn)
+	{
+		ArchiveEntry const & entry = entryAt(nn);
+		oss
+			<< "  " << entry.key().infoBrief()
+			<< ' ' << std::setw(4u) << std::left << entry.stationCode()
+			<< std::right
+			<< "  numLevels: " << entry.theNumLevels
+			<< '\n';
+	}
+	return oss.str();
+}
+
+
+} // [env]
+} // [aply]
@@ -50,6 +50,11 @@ AirProfile :: airInfoAtHeight
 	) const
 {
 	AirInfo info{};
+	if (theAirModel.isValid())
+	{
+		info = theAirModel.theAirInfoFunc(height);
+	}
+	else
 	if (isValid())
 	{
 		// get first occurring entry not less than 'height'
@@ -94,6 +99,11 @@ AirProfile :: indexOfRefraction
 	) const
 {
 	double ior{ engabra::g3::null<double>() };
+	if (theAirModel.isValid())
+	{
+		ior = theAirModel.theIoRFunc(height);
+	}
+	else
 	if (isValid())
 	{
 		AirInfo info{ airInfoAtHeight(height) };
@@ -102,12 +112,36 @@ AirProfile :: indexOfRefraction
 	return ior;
 }
 
+std::vector<Height>
+AirProfile :: breakHeights
+	() const
+{
+	std::vector<Height> heights;
+	if (theAirModel.isValid())
+	{
+		heights.assign
+			( theAirModel.theBreakHeights
+			, theAirModel.theBreakHeights + theAirModel.theNumBreaks
+			);
+	}
+	else
+	{
+		heights.reserve(theAirInfoMap.size());
+		for (std::map<Height, AirInfo>::value_type const & heightInfo
+			: theAirInfoMap)
+		{
+			heights.emplace_back(heightInfo.first);
+		}
+	}
+	return heights;
+}
+
 bool
 AirProfile :: isValid
 	() const
 {
 	// need at least two values to be able to interpolate.
-	return (1u < theAirInfoMap.size());
+	return (theAirModel.isValid() || (1u < theAirInfoMap.size()));
 }
 
 
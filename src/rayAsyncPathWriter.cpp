@@ -0,0 +1,305 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::PathRing and ray::AsyncPathWriter
+*/
+
+
+#include "rayAsyncPathWriter.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+
+namespace aply
+{
+namespace ray
+{
+
+//
+// PathRing
+//
+
+PathRing :: PathRing
+	( std::size_t const & capacity
+	)
+	: theSlots(std::max(std::size_t{ 1u }, capacity))
+{ }
+
+std::size_t
+PathRing :: capacity
+	() const
+{
+	return theSlots.size();
+}
+
+bool
+PathRing :: tryPush
+	( PathRecord && record
+	)
+{
+	bool okay{ false };
+	std::size_t const tail{ theTail.load(std::memory_order_relaxed) };
+	std::size_t const head{ theHead.load(std::memory_order_acquire) };
+	if ((tail - head) < theSlots.size())
+	{
+		theSlots[tail % theSlots.size()] = std::move(record);
+		theTail.store(tail + 1u, std::memory_order_release);
+		okay = true;
+	}
+	return okay;
+}
+
+bool
+PathRing :: tryPop
+	( PathRecord * const & ptRecord
+	)
+{
+	bool okay{ false };
+	std::size_t const head{ theHead.load(std::memory_order_relaxed) };
+	std::size_t const tail{ theTail.load(std::memory_order_acquire) };
+	if (head != tail)
+	{
+		*ptRecord = std::move(theSlots[head % theSlots.size()]);
+		theHead.store(head + 1u, std::memory_order_release);
+		okay = true;
+	}
+	return okay;
+}
+
+bool
+PathRing :: tryPeekSeq
+	( std::size_t * const & ptSeq
+	) const
+{
+	bool okay{ false };
+	std::size_t const head{ theHead.load(std::memory_order_relaxed) };
+	std::size_t const tail{ theTail.load(std::memory_order_acquire) };
+	if (head != tail)
+	{
+		*ptSeq = theSlots[head % theSlots.size()].theSeq;
+		okay = true;
+	}
+	return okay;
+}
+
+//
+// AsyncPathWriter
+//
+
+void
+AsyncPathWriter :: writeRecord
+	( PathRecord const & record
+	)
+{
+	Start const start{ record.theTanDir, record.thePntLoc };
+	if (! theWriter.appendRay(start, record.theNodes))
+	{
+		theIsOkay.store(false, std::memory_order_relaxed);
+	}
+	theNumWritten.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void
+AsyncPathWriter :: acceptRecord
+	( PathRecord && record
+	)
+{
+	if (theNextSeq == record.theSeq)
+	{
+		writeRecord(record);
+		++theNextSeq;
+
+		// write any held records that are now in sequence
+		std::map<std::size_t, PathRecord>::iterator
+			itHeld{ theHeldRecords.begin() };
+		while ((theHeldRecords.end() != itHeld)
+			&& (theNextSeq == itHeld->first))
+		{
+			writeRecord(itHeld->second);
+			++theNextSeq;
+			itHeld = theHeldRecords.erase(itHeld);
+		}
+	}
+	else
+	{
+		theHeldRecords.emplace(record.theSeq, std::move(record));
+		if (theMaxNumHeld.load(std::memory_order_relaxed)
+			< theHeldRecords.size())
+		{
+			theMaxNumHeld.store
+				(theHeldRecords.size(), std::memory_order_relaxed);
+		}
+	}
+}
+
+void
+AsyncPathWriter :: drainQueues
+	()
+{
+	PathRecord record{};
+	bool isDone{ false };
+	while (! isDone)
+	{
+		// check before draining so that no final record is missed
+		bool const wasSignaled{ theIsDone.load(std::memory_order_acquire) };
+
+		bool gotAny{ false };
+		for (std::unique_ptr<PathRing> const & ptRing : theRings)
+		{
+			// leave records too far ahead in queue (backpressure)
+			std::size_t seq{ 0u };
+			while ( ptRing->tryPeekSeq(&seq)
+				&& ( wasSignaled
+				  || (seq < theNextSeq)
+				  || ((seq - theNextSeq) < theReorderWindow)
+				   )
+				&& ptRing->tryPop(&record)
+				  )
+			{
+				gotAny = true;
+				acceptRecord(std::move(record));
+			}
+		}
+
+		isDone = (wasSignaled && (! gotAny));
+		if ((! isDone) && (! gotAny))
+		{
+			// idle - wait briefly for producers
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	}
+
+	// sequence gaps: write remaining records in order
+	for (std::pair<std::size_t const, PathRecord> const & held
+		: theHeldRecords)
+	{
+		writeRecord(held.second);
+	}
+	theHeldRecords.clear();
+}
+
+AsyncPathWriter :: AsyncPathWriter
+	( std::filesystem::path const & outPath
+	, std::size_t const & numProducers
+	, std::size_t const & ringSize
+	, bool const & useDeltaLocs
+	, std::size_t const & reorderWindow
+	)
+	: theWriter(outPath, useDeltaLocs)
+	, theReorderWindow{ std::max(std::size_t{ 1u }, reorderWindow) }
+{
+	if (theWriter.isValid() && (0u < numProducers))
+	{
+		theRings.reserve(numProducers);
+		for (std::size_t nn{0u} ; nn < numProducers ; ++nn)
+		{
+			theRings.emplace_back(std::make_unique<PathRing>(ringSize));
+		}
+		theIsOkay.store(true);
+		theThread = std::thread(&AsyncPathWriter::drainQueues, this);
+	}
+}
+
+AsyncPathWriter :: ~AsyncPathWriter
+	()
+{
+	finish();
+}
+
+bool
+AsyncPathWriter :: isValid
+	() const
+{
+	return theIsOkay.load(std::memory_order_relaxed);
+}
+
+std::size_t
+AsyncPathWriter :: numProducers
+	() const
+{
+	return theRings.size();
+}
+
+std::size_t
+AsyncPathWriter :: numWritten
+	() const
+{
+	return theNumWritten.load(std::memory_order_relaxed);
+}
+
+std::size_t
+AsyncPathWriter :: maxNumHeld
+	() const
+{
+	return theMaxNumHeld.load(std::memory_order_relaxed);
+}
+
+bool
+AsyncPathWriter :: push
+	( std::size_t const & producerNdx
+	, std::size_t const & seq
+	, Start const & start
+	, std::vector<Node> && nodes
+	)
+{
+	bool okay
+		{  (producerNdx < theRings.size())
+		&& (! theIsDone.load(std::memory_order_relaxed))
+		};
+	if (okay)
+	{
+		PathRing & ring = *(theRings[producerNdx]);
+		PathRecord record{ seq, start.theTanDir, start.thePntLoc, {} };
+		record.theNodes = std::move(nodes);
+		while (! ring.tryPush(std::move(record)))
+		{
+			// backpressure - wait for I/O thread to catch up
+			std::this_thread::yield();
+		}
+	}
+	return okay;
+}
+
+bool
+AsyncPathWriter :: finish
+	()
+{
+	theIsDone.store(true, std::memory_order_release);
+	if (theThread.joinable())
+	{
+		theThread.join();
+		bool const okClose{ theWriter.close() };
+		theIsOkay.store
+			(theIsOkay.load(std::memory_order_relaxed) && okClose);
+	}
+	return isValid();
+}
+
+
+} // [ray]
+} // [aply]
+
@@ -0,0 +1,132 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::BundleStats
+*/
+
+
+#include "rayBundleStats.hpp"
+
+#include <Engabra>
+
+#include <sstream>
+
+
+namespace aply
+{
+namespace ray
+{
+
+BundleStats :: BundleStats
+	( double const & maxDeviation
+	, double const & maxDeflection
+	, std::size_t const & numBins
+	)
+	: theNumRays{ 0u }
+	, theNumEmpty{ 0u }
+	, theDeviations{}
+	, theDeflections{}
+	, thePathDists{}
+	, theDevHist(0., maxDeviation, numBins)
+	, theDeflHist(0., maxDeflection, numBins)
+{ }
+
+void
+BundleStats :: add
+	( PathSummary const & summary
+	)
+{
+	++theNumRays;
+	if (summary.size() < 2u)
+	{
+		++theNumEmpty;
+	}
+	else
+	{
+		double const deviation{ magnitude(summary.totalDeviation()) };
+		double const deflection{ summary.endDeflection() };
+		theDeviations.add(deviation);
+		theDeflections.add(deflection);
+		thePathDists.add(summary.pathDistance());
+		theDevHist.add(deviation);
+		theDeflHist.add(deflection);
+	}
+}
+
+bool
+BundleStats :: merge
+	( BundleStats const & other
+	)
+{
+	// check all before changing any (no partial merge)
+	bool const okay
+		{  theDevHist.sameBinsAs(other.theDevHist)
+		&& theDeflHist.sameBinsAs(other.theDeflHist)
+		};
+	if (okay)
+	{
+		theDevHist.merge(other.theDevHist);
+		theDeflHist.merge(other.theDeflHist);
+		theNumRays += other.theNumRays;
+		theNumEmpty += other.theNumEmpty;
+		theDeviations.merge(other.theDeviations);
+		theDeflections.merge(other.theDeflections);
+		thePathDists.merge(other.thePathDists);
+	}
+	return okay;
+}
+
+std::string
+BundleStats :: infoString
+	( std::string const & title
+	) const
+{
+	using engabra::g3::io::fixed;
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	oss << "numRays: " << theNumRays << "  numEmpty: " << theNumEmpty;
+	oss << '\n';
+	oss << "  deviation mean,sigma: "
+		<< fixed(theDeviations.mean(), 1u, 9u)
+		<< ' ' << fixed(theDeviations.stdDev(), 1u, 9u);
+	oss << '\n';
+	oss << " deflection mean,sigma: "
+		<< fixed(theDeflections.mean(), 6u, 6u)
+		<< ' ' << fixed(theDeflections.stdDev(), 6u, 6u);
+	oss << '\n';
+	oss << "   pathDist mean,sigma: "
+		<< fixed(thePathDists.mean(), 6u, 3u)
+		<< ' ' << fixed(thePathDists.stdDev(), 6u, 3u);
+	return oss.str();
+}
+
+
+} // [ray]
+} // [aply]
+
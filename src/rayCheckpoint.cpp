@@ -0,0 +1,373 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::Checkpoint
+*/
+
+
+#include "rayCheckpoint.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	//! Private implementation detail utilities.
+	namespace priv
+	{
+		//! Checkpoint file identification (first and last bytes of file).
+		constexpr std::array<char, 8u> sCheckMagic
+			{ 'A', 'P', 'L', 'Y', 'C', 'K', 'P', '3' };
+
+		//! Put binary representation of item into stream.
+		template <typename Type>
+		inline
+		void
+		putBinary
+			( std::ostream & ostrm
+			, Type const & item
+			)
+		{
+			ostrm.write(reinterpret_cast<char const *>(&item), sizeof(item));
+		}
+
+		//! Get item from binary representation in stream.
+		template <typename Type>
+		inline
+		Type
+		getBinary
+			( std::istream & istrm
+			)
+		{
+			Type item{};
+			istrm.read(reinterpret_cast<char *>(&item), sizeof(item));
+			return item;
+		}
+
+		//! Put vector components into stream.
+		inline
+		void
+		putVector
+			( std::ostream & ostrm
+			, Vector const & vec
+			)
+		{
+			putBinary(ostrm, vec[0]);
+			putBinary(ostrm, vec[1]);
+			putBinary(ostrm, vec[2]);
+		}
+
+		//! Get vector from components in stream.
+		inline
+		Vector
+		getVector
+			( std::istream & istrm
+			)
+		{
+			double const xx{ getBinary<double>(istrm) };
+			double const yy{ getBinary<double>(istrm) };
+			double const zz{ getBinary<double>(istrm) };
+			return Vector{ xx, yy, zz };
+		}
+
+		//! Put size (or count or flag) into stream (as 64 bit value).
+		inline
+		void
+		putSize
+			( std::ostream & ostrm
+			, std::size_t const & size
+			)
+		{
+			putBinary(ostrm, static_cast<std::uint64_t>(size));
+		}
+
+		//! Get size (or count or flag) from stream.
+		inline
+		std::size_t
+		getSize
+			( std::istream & istrm
+			)
+		{
+			return static_cast<std::size_t>(getBinary<std::uint64_t>(istrm));
+		}
+
+	} // [priv]
+
+
+Checkpoint
+Checkpoint :: from
+	( Path const & path
+	, Propagator::TraceState const & state
+	, LoopStats const & stats
+	)
+{
+	return Checkpoint
+		{ path.theStart
+		, path.theSaveDist
+		, path.capacity()
+		, path.theNodes
+		, path.theArcDists
+		, path.theOptDists
+		, path.bookkeeping()
+		, state
+		, stats
+		};
+}
+
+Checkpoint
+Checkpoint :: load
+	( std::filesystem::path const & loadPath
+	)
+{
+	using namespace priv;
+	std::ifstream ifs(loadPath.native(), std::ios::binary);
+
+	std::array<char, 8u> const begMagic
+		{ getBinary<std::array<char, 8u> >(ifs) };
+	Vector const tanDir{ getVector(ifs) };
+	Vector const pntLoc{ getVector(ifs) };
+	if (! (ifs.good() && (sCheckMagic == begMagic)))
+	{
+		return Checkpoint{};
+	}
+
+	Checkpoint check{ Start{ tanDir, pntLoc } };
+	check.theSaveDist = getBinary<double>(ifs);
+	check.theCapacity = getSize(ifs);
+
+	Path::Bookkeeping & book = check.theBookkeeping;
+	book.theResidArcDist = getBinary<double>(ifs);
+	book.theLastSeenLoc = getVector(ifs);
+	book.theResidOptDist = getBinary<double>(ifs);
+	book.theLastSeenNu = getBinary<double>(ifs);
+
+	Propagator::TraceState & state = check.theTraceState;
+	state.theTanPrev = getVector(ifs);
+	state.theLocCurr = getVector(ifs);
+	state.theNuPrev = getBinary<double>(ifs);
+	state.theSigmaDist = getBinary<double>(ifs);
+	state.theTanHistory.theTanAgo1 = getVector(ifs);
+	state.theTanHistory.theTanAgo2 = getVector(ifs);
+	state.theIsFirstNode = (0u != getSize(ifs));
+	state.theIsStopped = (0u != getSize(ifs));
+
+	LoopStats & stats = check.theStats;
+	stats.theNumSteps = getSize(ifs);
+	stats.theNumRefracts = getSize(ifs);
+	stats.theNumLoops = getSize(ifs);
+	stats.theMaxLoops = getSize(ifs);
+
+	// limit (pre)allocation to what the file could hold
+	std::error_code errCode{};
+	std::uintmax_t const fileSize
+		{ std::filesystem::file_size(loadPath, errCode) };
+	std::size_t const numNodes{ getSize(ifs) };
+	if (ifs.good() && (numNodes < (fileSize / sizeof(double))))
+	{
+		check.theNodes.reserve(numNodes);
+		for (std::size_t nn{0u} ; ifs.good() && (nn < numNodes) ; ++nn)
+		{
+			Vector const prevTan{ getVector(ifs) };
+			double const prevNu{ getBinary<double>(ifs) };
+			Vector const currLoc{ getVector(ifs) };
+			double const nextNu{ getBinary<double>(ifs) };
+			Vector const nextTan{ getVector(ifs) };
+			DirChange const change{ static_cast<DirChange>(getSize(ifs)) };
+			check.theNodes.emplace_back
+				(Node{ prevTan, prevNu, currLoc, nextNu, nextTan, change });
+		}
+	}
+	std::size_t const numArcs{ getSize(ifs) };
+	if (ifs.good() && (numArcs < (fileSize / sizeof(double))))
+	{
+		check.theArcDists.reserve(numArcs);
+		for (std::size_t nn{0u} ; ifs.good() && (nn < numArcs) ; ++nn)
+		{
+			check.theArcDists.emplace_back(getBinary<double>(ifs));
+		}
+	}
+	std::size_t const numOpts{ getSize(ifs) };
+	if (ifs.good() && (numOpts < (fileSize / sizeof(double))))
+	{
+		check.theOptDists.reserve(numOpts);
+		for (std::size_t nn{0u} ; ifs.good() && (nn < numOpts) ; ++nn)
+		{
+			check.theOptDists.emplace_back(getBinary<double>(ifs));
+		}
+	}
+
+	std::array<char, 8u> const endMagic
+		{ getBinary<std::array<char, 8u> >(ifs) };
+	bool const okay
+		{  ifs.good()
+		&& (sCheckMagic == endMagic)
+		&& (numNodes == check.theNodes.size())
+		&& (numArcs == check.theArcDists.size())
+		&& (numOpts == check.theOptDists.size())
+		};
+	if (! okay)
+	{
+		return Checkpoint{};
+	}
+	return check;
+}
+
+bool
+Checkpoint :: isValid
+	() const
+{
+	return
+		(  engabra::g3::isValid(theStart.theTanDir)
+		&& engabra::g3::isValid(theStart.thePntLoc)
+		&& engabra::g3::isValid(theSaveDist)
+		&& (theNodes.size() == theArcDists.size())
+		&& (theNodes.size() == theOptDists.size())
+		);
+}
+
+bool
+Checkpoint :: save
+	( std::filesystem::path const & savePath
+	) const
+{
+	using namespace priv;
+	std::filesystem::path tmpPath{ savePath };
+	tmpPath += ".tmp";
+	bool okay{ false };
+	{
+		std::ofstream ofs(tmpPath.native(), std::ios::binary | std::ios::trunc);
+
+		putBinary(ofs, sCheckMagic);
+		putVector(ofs, theStart.theTanDir);
+		putVector(ofs, theStart.thePntLoc);
+		putBinary(ofs, theSaveDist);
+		putSize(ofs, theCapacity);
+
+		putBinary(ofs, theBookkeeping.theResidArcDist);
+		putVector(ofs, theBookkeeping.theLastSeenLoc);
+		putBinary(ofs, theBookkeeping.theResidOptDist);
+		putBinary(ofs, theBookkeeping.theLastSeenNu);
+
+		Propagator::TraceState const & state = theTraceState;
+		putVector(ofs, state.theTanPrev);
+		putVector(ofs, state.theLocCurr);
+		putBinary(ofs, state.theNuPrev);
+		putBinary(ofs, state.theSigmaDist);
+		putVector(ofs, state.theTanHistory.theTanAgo1);
+		putVector(ofs, state.theTanHistory.theTanAgo2);
+		putSize(ofs, state.theIsFirstNode ? 1u : 0u);
+		putSize(ofs, state.theIsStopped ? 1u : 0u);
+
+		putSize(ofs, theStats.theNumSteps);
+		putSize(ofs, theStats.theNumRefracts);
+		putSize(ofs, theStats.theNumLoops);
+		putSize(ofs, theStats.theMaxLoops);
+
+		putSize(ofs, theNodes.size());
+		for (Node const & node : theNodes)
+		{
+			putVector(ofs, node.thePrevTan);
+			putBinary(ofs, node.thePrevNu);
+			putVector(ofs, node.theCurrLoc);
+			putBinary(ofs, node.theNextNu);
+			putVector(ofs, node.theNextTan);
+			putSize(ofs, static_cast<std::size_t>(node.theDirChange));
+		}
+		putSize(ofs, theArcDists.size());
+		for (double const & arcDist : theArcDists)
+		{
+			putBinary(ofs, arcDist);
+		}
+		putSize(ofs, theOptDists.size());
+		for (double const & optDist : theOptDists)
+		{
+			putBinary(ofs, optDist);
+		}
+
+		putBinary(ofs, sCheckMagic);
+		ofs.close();
+		okay = (! ofs.fail());
+	}
+
+	// replace previous checkpoint (only) once new one is complete
+	if (okay)
+	{
+		std::error_code errCode{};
+		std::filesystem::rename(tmpPath, savePath, errCode);
+		okay = (! errCode);
+	}
+	return okay;
+}
+
+Path
+Checkpoint :: path
+	() const
+{
+	Path path(theStart, theSaveDist);
+	path.reserve(std::max(theCapacity, theNodes.size()));
+	for (Node const & node : theNodes)
+	{
+		path.theNodes.emplace_back(node);
+	}
+	path.theArcDists = theArcDists;
+	path.theOptDists = theOptDists;
+	path.setBookkeeping(theBookkeeping);
+	return path;
+}
+
+std::string
+Checkpoint :: infoString
+	( std::string const & title
+	) const
+{
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	oss << "isValid: " << std::boolalpha << isValid()
+		<< "  numNodes: " << theNodes.size()
+		<< "  capacity: " << theCapacity
+		<< "  numSteps: " << theStats.theNumSteps
+		<< "  isStopped: " << theTraceState.theIsStopped
+		;
+	return oss.str();
+}
+
+
+} // [ray]
+} // [aply]
+
@@ -0,0 +1,653 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::PathWriter, ray::PathArchive and related
+*/
+
+
+#include "rayPathArchive.hpp"
+
+#include <Engabra>
+
+#include <array>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace aply
+{
+namespace ray
+{
+
+	//! Private implementation detail utilities.
+	namespace priv
+	{
+		//! Archive file identification (first and last bytes of file).
+		constexpr std::array<char, 8u> sPathMagic
+			{ 'A', 'P', 'L', 'Y', 'R', 'A', 'Y', '1' };
+
+		//! \brief Fixed size preamble at start of archive file.
+		struct PathHeader
+		{
+			std::array<char, 8u> theMagic; //!< sPathMagic
+			std::uint64_t theFlags; //!< e.g. sPathDeltaLocs
+			std::uint64_t theReserved[2]; //!< (zeros)
+		};
+
+		static_assert(32u == sizeof(PathHeader), "PathHeader pack");
+
+		//! \brief Fixed size record at end of archive file.
+		struct PathTrailer
+		{
+			std::uint64_t theNumEntries; //!< number of ray paths
+			std::uint64_t theIndexOffset; //!< byte offset to first entry
+			std::uint64_t theFlags; //!< same as PathHeader::theFlags
+			std::array<char, 8u> theMagic; //!< sPathMagic
+		};
+
+		static_assert(32u == sizeof(PathTrailer), "PathTrailer pack");
+
+		//! Byte count rounded up to 8-byte alignment.
+		inline
+		std::size_t
+		padded
+			( std::size_t const & numBytes
+			)
+		{
+			return ((numBytes + 7u) / 8u) * 8u;
+		}
+
+		/*! \brief Byte offsets (relative to ray data start) of columns.
+		 *
+		 * Column order: three location (double or float delta), three
+		 * prev tangent, prev nu, next nu, three next tangent, change.
+		 */
+		struct ColumnLayout
+		{
+			std::size_t theLocs[3]{};
+			std::size_t thePrevTans[3]{};
+			std::size_t thePrevNus{};
+			std::size_t theNextNus{};
+			std::size_t theNextTans[3]{};
+			std::size_t theChanges{};
+			std::size_t theSize{}; //!< total bytes for ray data
+
+			explicit
+			ColumnLayout
+				( std::size_t const & numNodes
+				, bool const & useDeltaLocs
+				)
+			{
+				std::size_t const dubSize{ numNodes * sizeof(double) };
+				std::size_t const fltSize
+					{ padded(numNodes * sizeof(float)) };
+				std::size_t const locSize
+					{ useDeltaLocs ? fltSize : dubSize };
+				std::size_t off{ 0u };
+				for (std::size_t & col : theLocs)
+				{
+					col = off;
+					off += locSize;
+				}
+				for (std::size_t & col : thePrevTans)
+				{
+					col = off;
+					off += dubSize;
+				}
+				thePrevNus = off;
+				off += dubSize;
+				theNextNus = off;
+				off += dubSize;
+				for (std::size_t & col : theNextTans)
+				{
+					col = off;
+					off += dubSize;
+				}
+				theChanges = off;
+				off += padded(numNodes);
+				theSize = off;
+			}
+		};
+
+		//! Put binary representation of item into stream.
+		template <typename Type>
+		inline
+		void
+		putBinary
+			( std::ostream & ostrm
+			, Type const & item
+			)
+		{
+			ostrm.write(reinterpret_cast<char const *>(&item), sizeof(item));
+		}
+
+		//! Put (padded) column of values into stream.
+		template <typename Type>
+		inline
+		void
+		putColumn
+			( std::ostream & ostrm
+			, std::vector<Type> const & values
+			)
+		{
+			std::size_t const numBytes{ values.size() * sizeof(Type) };
+			ostrm.write
+				( reinterpret_cast<char const *>(values.data())
+				, static_cast<std::streamsize>(numBytes)
+				);
+			constexpr std::array<char, 8u> zeros{};
+			std::size_t const numPad{ padded(numBytes) - numBytes };
+			ostrm.write(zeros.data(), static_cast<std::streamsize>(numPad));
+		}
+
+		//! Location decoded (same as encoded) from previous and delta.
+		inline
+		Vector
+		nextLocFrom
+			( Vector const & prevLoc
+			, float const & dx
+			, float const & dy
+			, float const & dz
+			)
+		{
+			return Vector
+				{ prevLoc[0] + static_cast<double>(dx)
+				, prevLoc[1] + static_cast<double>(dy)
+				, prevLoc[2] + static_cast<double>(dz)
+				};
+		}
+
+	} // [priv]
+
+
+//
+// PathEntry
+//
+
+Start
+PathEntry :: start
+	() const
+{
+	return Start
+		{ Vector{ theStartDir[0], theStartDir[1], theStartDir[2] }
+		, Vector{ theStartLoc[0], theStartLoc[1], theStartLoc[2] }
+		};
+}
+
+//
+// PathColumns
+//
+
+bool
+PathColumns :: isValid
+	() const
+{
+	return
+		(  (0u < theNumNodes)
+		&& ((nullptr != theLocs[0]) || (nullptr != theLocDeltas[0]))
+		&& (nullptr != theChanges)
+		);
+}
+
+std::vector<Node>
+PathColumns :: nodes
+	() const
+{
+	std::vector<Node> nodes;
+	if (isValid())
+	{
+		nodes.reserve(theNumNodes);
+		Vector loc{ theBaseLoc };
+		for (std::size_t nn{0u} ; nn < theNumNodes ; ++nn)
+		{
+			if (nullptr != theLocs[0])
+			{
+				loc = Vector{ theLocs[0][nn], theLocs[1][nn], theLocs[2][nn] };
+			}
+			else
+			{
+				loc = priv::nextLocFrom
+					( loc
+					, theLocDeltas[0][nn]
+					, theLocDeltas[1][nn]
+					, theLocDeltas[2][nn]
+					);
+			}
+			nodes.emplace_back
+				( Node
+					{ Vector
+						{ thePrevTans[0][nn]
+						, thePrevTans[1][nn]
+						, thePrevTans[2][nn]
+						}
+					, thePrevNus[nn]
+					, loc
+					, theNextNus[nn]
+					, Vector
+						{ theNextTans[0][nn]
+						, theNextTans[1][nn]
+						, theNextTans[2][nn]
+						}
+					, static_cast<DirChange>(theChanges[nn])
+					}
+				);
+		}
+	}
+	return nodes;
+}
+
+//
+// PathWriter
+//
+
+PathWriter :: PathWriter
+	( std::filesystem::path const & outPath
+	, bool const & useDeltaLocs
+	)
+	: theOfs(outPath.native(), std::ios::binary | std::ios::trunc)
+	, theFlags{ useDeltaLocs ? sPathDeltaLocs : 0u }
+	, theOffset{ 0u }
+	, theEntries{}
+	, theIsOpen{ false }
+{
+	if (theOfs.good())
+	{
+		priv::PathHeader const header{ priv::sPathMagic, theFlags, { 0u, 0u } };
+		priv::putBinary(theOfs, header);
+		theOffset = sizeof(header);
+		theIsOpen = theOfs.good();
+	}
+}
+
+PathWriter :: ~PathWriter
+	()
+{
+	close();
+}
+
+bool
+PathWriter :: isValid
+	() const
+{
+	return (theIsOpen && theOfs.good());
+}
+
+std::size_t
+PathWriter :: numRays
+	() const
+{
+	return theEntries.size();
+}
+
+bool
+PathWriter :: appendRay
+	( Start const & start
+	, std::vector<Node> const & nodes
+	)
+{
+	bool okay{ isValid() };
+	if (okay)
+	{
+		std::size_t const numNodes{ nodes.size() };
+		bool const useDeltaLocs{ 0u != (theFlags & sPathDeltaLocs) };
+		Vector const baseLoc
+			{ nodes.empty() ? start.thePntLoc : nodes.front().theCurrLoc };
+
+		PathEntry entry{};
+		for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+		{
+			entry.theStartDir[ax] = start.theTanDir[ax];
+			entry.theStartLoc[ax] = start.thePntLoc[ax];
+			entry.theBaseLoc[ax] = baseLoc[ax];
+		}
+		entry.theDataOffset = theOffset;
+		entry.theNumNodes = numNodes;
+		entry.theReserved = 0u;
+
+		// locations
+		if (useDeltaLocs)
+		{
+			std::array<std::vector<float>, 3u> deltas;
+			for (std::vector<float> & column : deltas)
+			{
+				column.reserve(numNodes);
+			}
+			Vector prevLoc{ baseLoc };
+			for (Node const & node : nodes)
+			{
+				Vector const delta{ node.theCurrLoc - prevLoc };
+				for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+				{
+					deltas[ax].emplace_back(static_cast<float>(delta[ax]));
+				}
+				// track decoded location (errors do not accumulate)
+				prevLoc = priv::nextLocFrom
+					( prevLoc
+					, deltas[0].back(), deltas[1].back(), deltas[2].back()
+					);
+			}
+			for (std::vector<float> const & column : deltas)
+			{
+				priv::putColumn(theOfs, column);
+			}
+		}
+
+		// double precision columns
+		std::vector<double> column(numNodes);
+		using VecMember = Vector const Node::*;
+		using DubMember = double const Node::*;
+		auto const putVecColumns
+			{ [this, & nodes, & column] (VecMember const & member)
+				{
+					for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+					{
+						for (std::size_t nn{0u} ; nn < nodes.size() ; ++nn)
+						{
+							column[nn] = (nodes[nn].*member)[ax];
+						}
+						priv::putColumn(theOfs, column);
+					}
+				}
+			};
+		auto const putDubColumn
+			{ [this, & nodes, & column] (DubMember const & member)
+				{
+					for (std::size_t nn{0u} ; nn < nodes.size() ; ++nn)
+					{
+						column[nn] = nodes[nn].*member;
+					}
+					priv::putColumn(theOfs, column);
+				}
+			};
+		if (! useDeltaLocs)
+		{
+			putVecColumns(&Node::theCurrLoc);
+		}
+		putVecColumns(&Node::thePrevTan);
+		putDubColumn(&Node::thePrevNu);
+		putDubColumn(&Node::theNextNu);
+		putVecColumns(&Node::theNextTan);
+
+		// direction changes
+		std::vector<std::uint8_t> changes;
+		changes.reserve(numNodes);
+		for (Node const & node : nodes)
+		{
+			changes.emplace_back(static_cast<std::uint8_t>(node.theDirChange));
+		}
+		priv::putColumn(theOfs, changes);
+
+		okay = theOfs.good();
+		if (okay)
+		{
+			theEntries.emplace_back(entry);
+			theOffset += priv::ColumnLayout(numNodes, useDeltaLocs).theSize;
+		}
+	}
+	return okay;
+}
+
+bool
+PathWriter :: close
+	()
+{
+	bool okay{ isValid() };
+	if (okay)
+	{
+		std::uint64_t const indexOffset{ theOffset };
+		for (PathEntry const & entry : theEntries)
+		{
+			priv::putBinary(theOfs, entry);
+		}
+		priv::PathTrailer const trailer
+			{ theEntries.size(), indexOffset, theFlags, priv::sPathMagic };
+		priv::putBinary(theOfs, trailer);
+		theOfs.close();
+		okay = (! theOfs.fail());
+	}
+	theIsOpen = false;
+	return okay;
+}
+
+//
+// PathArchive
+//
+
+PathArchive :: PathArchive
+	( std::filesystem::path const & archivePath
+	)
+{
+	int const fd{ ::open(archivePath.c_str(), O_RDONLY) };
+	if (! (fd < 0))
+	{
+		struct stat status{};
+		if ((0 == ::fstat(fd, &status)) && (0 < status.st_size))
+		{
+			std::size_t const mapSize
+				{ static_cast<std::size_t>(status.st_size) };
+			void * const addr
+				{ ::mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0) };
+			if (MAP_FAILED != addr)
+			{
+				theMapAddr = addr;
+				theMapSize = mapSize;
+			}
+		}
+		// mapping remains valid after descriptor is closed
+		::close(fd);
+	}
+
+	// check header, trailer and index consistency
+	constexpr std::size_t minSize
+		{ sizeof(priv::PathHeader) + sizeof(priv::PathTrailer) };
+	if (! (theMapSize < minSize))
+	{
+		char const * const base{ static_cast<char const *>(theMapAddr) };
+		priv::PathHeader header{};
+		std::memcpy(&header, base, sizeof(header));
+		priv::PathTrailer trailer{};
+		std::memcpy
+			( &trailer
+			, base + (theMapSize - sizeof(trailer))
+			, sizeof(trailer)
+			);
+		// (sizes compared by subtraction/division to avoid wrap around)
+		std::size_t const indexBeg{ trailer.theIndexOffset };
+		std::size_t const indexEnd{ theMapSize - sizeof(trailer) };
+		bool okay
+			{  (priv::sPathMagic == header.theMagic)
+			&& (priv::sPathMagic == trailer.theMagic)
+			&& (header.theFlags == trailer.theFlags)
+			&& (0u == (indexBeg % alignof(PathEntry)))
+			&& (! (indexBeg < sizeof(header)))
+			&& (! (indexEnd < indexBeg))
+			};
+		if (okay)
+		{
+			std::size_t const indexSize{ indexEnd - indexBeg };
+			okay =
+				(  (0u == (indexSize % sizeof(PathEntry)))
+				&& (trailer.theNumEntries == (indexSize / sizeof(PathEntry)))
+				);
+		}
+		if (okay)
+		{
+			PathEntry const * const entries
+				{ reinterpret_cast<PathEntry const *>
+					(base + trailer.theIndexOffset)
+				};
+			bool const useDeltaLocs
+				{ 0u != (trailer.theFlags & sPathDeltaLocs) };
+			std::size_t const numEntries{ trailer.theNumEntries };
+			for (std::size_t nn{0u} ; okay && (nn < numEntries) ; ++nn)
+			{
+				PathEntry const & entry = entries[nn];
+				std::size_t const dataBeg{ entry.theDataOffset };
+				// each node needs (much) more than one double, so this
+				// bounds numNodes (and layout sizes cannot wrap around)
+				okay =
+					(  (0u == (dataBeg % alignof(double)))
+					&& (! (dataBeg < sizeof(header)))
+					&& (! (indexBeg < dataBeg))
+					&& (! ((indexBeg / sizeof(double)) < entry.theNumNodes))
+					);
+				if (okay)
+				{
+					priv::ColumnLayout const layout
+						(entry.theNumNodes, useDeltaLocs);
+					okay = (! ((indexBeg - dataBeg) < layout.theSize));
+				}
+			}
+			if (okay)
+			{
+				theEntries = entries;
+				theNumEntries = numEntries;
+				theFlags = trailer.theFlags;
+			}
+		}
+	}
+}
+
+PathArchive :: ~PathArchive
+	()
+{
+	if (nullptr != theMapAddr)
+	{
+		::munmap(const_cast<void *>(theMapAddr), theMapSize);
+	}
+}
+
+bool
+PathArchive :: isValid
+	() const
+{
+	return (nullptr != theEntries);
+}
+
+std::size_t
+PathArchive :: size
+	() const
+{
+	return theNumEntries;
+}
+
+bool
+PathArchive :: hasDeltaLocs
+	() const
+{
+	return (0u != (theFlags & sPathDeltaLocs));
+}
+
+PathEntry const &
+PathArchive :: entryAt
+	( std::size_t const & ndx
+	) const
+{
+	return theEntries[ndx];
+}
+
+PathColumns
+PathArchive :: columnsAt
+	( std::size_t const & ndx
+	) const
+{
+	PathColumns view{};
+	if (ndx < theNumEntries)
+	{
+		PathEntry const & entry = theEntries[ndx];
+		std::size_t const numNodes{ entry.theNumNodes };
+		priv::ColumnLayout const layout(numNodes, hasDeltaLocs());
+		char const * const data
+			{ static_cast<char const *>(theMapAddr) + entry.theDataOffset };
+		auto const dubAt
+			{ [& data] (std::size_t const & offset)
+				{ return reinterpret_cast<double const *>(data + offset); }
+			};
+		view.theNumNodes = numNodes;
+		view.theBaseLoc = Vector
+			{ entry.theBaseLoc[0], entry.theBaseLoc[1], entry.theBaseLoc[2] };
+		for (std::size_t ax{0u} ; ax < 3u ; ++ax)
+		{
+			if (hasDeltaLocs())
+			{
+				view.theLocDeltas[ax] = reinterpret_cast<float const *>
+					(data + layout.theLocs[ax]);
+			}
+			else
+			{
+				view.theLocs[ax] = dubAt(layout.theLocs[ax]);
+			}
+			view.thePrevTans[ax] = dubAt(layout.thePrevTans[ax]);
+			view.theNextTans[ax] = dubAt(layout.theNextTans[ax]);
+		}
+		view.thePrevNus = dubAt(layout.thePrevNus);
+		view.theNextNus = dubAt(layout.theNextNus);
+		view.theChanges = reinterpret_cast<std::uint8_t const *>
+			(data + layout.theChanges);
+	}
+	return view;
+}
+
+std::vector<Node>
+PathArchive :: nodesAt
+	( std::size_t const & ndx
+	) const
+{
+	return columnsAt(ndx).nodes();
+}
+
+std::string
+PathArchive :: infoString
+	( std::string const & title
+	) const
+{
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	std::size_t numNodes{ 0u };
+	for (std::size_t nn{0u} ; nn < size() ; ++nn)
+	{
+		numNodes += entryAt(nn).theNumNodes;
+	}
+	oss << "isValid: " << std::boolalpha << isValid()
+		<< "  numRays: " << size()
+		<< "  numNodes: " << numNodes
+		<< "  deltaLocs: " << hasDeltaLocs()
+		;
+	return oss.str();
+}
+
+
+} // [ray]
+} // [aply]
+
@@ -0,0 +1,357 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::PathArena, ray::PathPool and ray::PooledPath
+*/
+
+
+#include "rayPathPool.hpp"
+
+#include <algorithm>
+
+
+namespace aply
+{
+namespace ray
+{
+
+//
+// PathArena
+//
+
+PathArena :: PathArena
+	( std::size_t const & slabSize
+	)
+	: theSlabSize{ std::max(slabSize, std::size_t{ 1u }) }
+	, theSlabs{}
+	, theCurrSlab{ 0u }
+	, theEntries{}
+	, theOpenBeg{ 0u }
+	, theIsOpen{ false }
+{ }
+
+bool
+PathArena :: open
+	( std::size_t const & maxNodes
+	)
+{
+	if (! theIsOpen)
+	{
+		// advance to a slab with enough free space (if one is current)
+		bool hasSpace{ false };
+		while ((! hasSpace) && (theCurrSlab < theSlabs.size()))
+		{
+			Slab const & slab = *(theSlabs[theCurrSlab]);
+			std::size_t const used{ slab.theNodes.size() };
+			std::size_t const room{ slab.theNodes.capacity() - used };
+			hasSpace = (! (room < maxNodes));
+			if (! hasSpace)
+			{
+				if (0u == used)
+				{
+					// empty (reused) slab too small for this range
+					theSlabs[theCurrSlab].reset();
+					break;
+				}
+				++theCurrSlab;
+			}
+		}
+
+		if (! hasSpace)
+		{
+			// allocate new slab (or replace one that is too small)
+			std::unique_ptr<Slab> ptSlab{ std::make_unique<Slab>() };
+			std::size_t const slabSize{ std::max(theSlabSize, maxNodes) };
+			ptSlab->theNodes.reserve(slabSize);
+			ptSlab->theArcDists.reserve(slabSize);
+			ptSlab->theOptDists.reserve(slabSize);
+			if (theCurrSlab < theSlabs.size())
+			{
+				theSlabs[theCurrSlab] = std::move(ptSlab);
+			}
+			else
+			{
+				theSlabs.emplace_back(std::move(ptSlab));
+				theCurrSlab = theSlabs.size() - 1u;
+			}
+		}
+
+		theOpenBeg = theSlabs[theCurrSlab]->theNodes.size();
+		theIsOpen = true;
+		return true;
+	}
+	return false;
+}
+
+std::size_t
+PathArena :: openSize
+	() const
+{
+	std::size_t numNodes{ 0u };
+	if (theIsOpen)
+	{
+		numNodes = theSlabs[theCurrSlab]->theNodes.size() - theOpenBeg;
+	}
+	return numNodes;
+}
+
+void
+PathArena :: append
+	( Node const & node
+	, double const & arcDist
+	, double const & optDist
+	)
+{
+	if (theIsOpen)
+	{
+		// within reserved capacity (ref open()) - no reallocation
+		Slab & slab = *(theSlabs[theCurrSlab]);
+		slab.theNodes.emplace_back(node);
+		slab.theArcDists.emplace_back(arcDist);
+		slab.theOptDists.emplace_back(optDist);
+	}
+}
+
+void
+PathArena :: close
+	( Start const & start
+	)
+{
+	if (theIsOpen)
+	{
+		theEntries.emplace_back
+			(Entry{ start, theCurrSlab, theOpenBeg, openSize() });
+		theIsOpen = false;
+	}
+}
+
+void
+PathArena :: reset
+	()
+{
+	for (std::unique_ptr<Slab> & ptSlab : theSlabs)
+	{
+		// clear() retains vector capacity
+		ptSlab->theNodes.clear();
+		ptSlab->theArcDists.clear();
+		ptSlab->theOptDists.clear();
+	}
+	theCurrSlab = 0u;
+	theEntries.clear();
+	theOpenBeg = 0u;
+	theIsOpen = false;
+}
+
+std::size_t
+PathArena :: size
+	() const
+{
+	return theEntries.size();
+}
+
+std::size_t
+PathArena :: numSlabs
+	() const
+{
+	return theSlabs.size();
+}
+
+PathSpan
+PathArena :: pathAt
+	( std::size_t const & ndx
+	) const
+{
+	Entry const & entry = theEntries[ndx];
+	Slab const & slab = *(theSlabs[entry.theSlabNdx]);
+	return PathSpan
+		{ entry.theStart
+		, slab.theNodes.data() + entry.theBegNdx
+		, slab.theArcDists.data() + entry.theBegNdx
+		, slab.theOptDists.data() + entry.theBegNdx
+		, entry.theNumNodes
+		};
+}
+
+//
+// PathPool
+//
+
+PathPool :: PathPool
+	( std::size_t const & numArenas
+	, std::size_t const & slabSize
+	)
+	: theArenas{}
+{
+	// separate allocations keep per-thread arena state on own cache lines
+	theArenas.reserve(numArenas);
+	for (std::size_t nn{0u} ; nn < numArenas ; ++nn)
+	{
+		theArenas.emplace_back(std::make_unique<PathArena>(slabSize));
+	}
+}
+
+std::size_t
+PathPool :: numArenas
+	() const
+{
+	return theArenas.size();
+}
+
+PathArena &
+PathPool :: arena
+	( std::size_t const & ndx
+	)
+{
+	return *(theArenas[ndx]);
+}
+
+PathArena const &
+PathPool :: arena
+	( std::size_t const & ndx
+	) const
+{
+	return *(theArenas[ndx]);
+}
+
+std::size_t
+PathPool :: numPaths
+	() const
+{
+	std::size_t sum{ 0u };
+	for (std::unique_ptr<PathArena> const & ptArena : theArenas)
+	{
+		sum += ptArena->size();
+	}
+	return sum;
+}
+
+std::size_t
+PathPool :: numSlabs
+	() const
+{
+	std::size_t sum{ 0u };
+	for (std::unique_ptr<PathArena> const & ptArena : theArenas)
+	{
+		sum += ptArena->numSlabs();
+	}
+	return sum;
+}
+
+void
+PathPool :: reset
+	()
+{
+	for (std::unique_ptr<PathArena> & ptArena : theArenas)
+	{
+		ptArena->reset();
+	}
+}
+
+//
+// PooledPath
+//
+
+PooledPath :: PooledPath
+	( Start const & start
+	, double const & saveStepDist
+	, PathArena * const & ptArena
+	, std::size_t const & maxNodes
+	)
+	: theStart{ start }
+	, theSaveDist{ saveStepDist }
+	, thePtArena{ ptArena }
+	, theMaxNodes{ maxNodes }
+	, theBook{}
+	, theIsOpen{ false }
+{
+	if (thePtArena)
+	{
+		theIsOpen = thePtArena->open(theMaxNodes);
+	}
+}
+
+PooledPath :: ~PooledPath
+	()
+{
+	finish();
+}
+
+std::size_t
+PooledPath :: size
+	() const
+{
+	std::size_t numNodes{ 0u };
+	if (theIsOpen)
+	{
+		numNodes = thePtArena->openSize();
+	}
+	return numNodes;
+}
+
+std::size_t
+PooledPath :: capacity
+	() const
+{
+	std::size_t maxNodes{ 0u };
+	if (theIsOpen)
+	{
+		maxNodes = theMaxNodes;
+	}
+	return maxNodes;
+}
+
+void
+PooledPath :: emplace_back
+	( ray::Node const & node
+	)
+{
+	if (theIsOpen && (size() < theMaxNodes))
+	{
+		// same decimation as Path::considerNode()
+		double arcDist{ null<double>() };
+		double optDist{ null<double>() };
+		bool const isFirst{ 0u == size() };
+		if (theBook.consider(node, theSaveDist, isFirst, &arcDist, &optDist))
+		{
+			thePtArena->append(node, arcDist, optDist);
+		}
+	}
+}
+
+void
+PooledPath :: finish
+	()
+{
+	if (theIsOpen)
+	{
+		thePtArena->close(theStart);
+		theIsOpen = false;
+	}
+}
+
+} // [ray]
+} // [aply]
+
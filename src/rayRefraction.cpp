@@ -31,18 +31,49 @@
 */
 
 
-#include "mathDiffEqSolve.hpp"
+#include "mathQuadratureGK.hpp"
 #include "rayRefraction.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
+#include <vector>
 
 
 namespace
 {
 
+	/*! \brief Quadrature configured for integration of Gyer Eqn[12].
+	 *
+	 * Deviation observed at the sensor is computed from differences
+	 * of nearly equal angles and is amplified by (about)
+	 * radiusEarth/pathLength. Theta tolerance of 1.e-15 [rad] for each
+	 * piece keeps the deviation error well below a nano radian.
+	 */
+	inline
+	aply::math::QuadratureGK
+	gyerQuadrature
+		( double const & tolAbs = 1.e-15 // [rad] - for each piece
+		)
+	{
+		constexpr double tolRel{ 1.e-13 }; // [-]
+		return aply::math::QuadratureGK(tolAbs, tolRel);
+	}
+
+	/*! \brief Largest tolerance accepted for a grazing piece.
+	 *
+	 * Ref RefractGyer::pieceIntegral(). Grazing rays are long (e.g.
+	 * hundreds of km) such that the deviation amplification is
+	 * modest and this keeps the deviation error to a few nano radians.
+	 */
+	constexpr double sTolAbsGrazing{ 1.e-10 }; // [rad]
+
 	/*! \brief Implementation of Gyer paper Eqn[13] integration.
+	 *
+	 * Fixed dimension (single equation) system compatible with
+	 * the templated solvers (ref mathDiffEqSystemArray.hpp).
  	*/
-	struct RefractGyer : public aply::math::DiffEqSystem
+	struct RefractGyer
 	{
 		//! \brief Refraction constant (invariant along ray).
 		double const theRefConst{ engabra::g3::null<double>() };
@@ -50,85 +81,345 @@ namespace
 		/*! \brief Initial conditions comprising....
 		 *
 		 *	- .first: starting height (relative to Earth \b center)
-		 *	- .second: vector of size one
+		 *	- .second: array of size one
 		 *		- : constant of integration for Theta_c
 		 *
 		 */
-		std::pair<double, std::vector<double> > const theInitRadTheta
-			{ std::make_pair
-				( engabra::g3::null<double>()
-				, std::vector<double>{}
-				)
+		aply::math::DiffEqValues<1u> const theInitRadTheta
+			{ engabra::g3::null<double>()
+			, { engabra::g3::null<double>() }
 			};
 
 		//! \brief AirProfile model in location of interest.
-		aply::env::AirProfile const theAirProfile{ };
+		aply::env::AirProfile const & theAirProfile;
 
 		//! \brief Radius of Earth in vicinity of location of interest.
 		double const theRadEarth{ engabra::g3::null<double>() };
 
 
-		//! \brief Value ctor.
-		explicit
-		RefractGyer
-			( double const & refConst
-			, std::pair<double, std::vector<double> > const & initRadTheta
-			, aply::env::AirProfile const & airProfile
-			, double const & radEarth
-			)
-			: DiffEqSystem{}
-			, theRefConst{ refConst }
-			, theInitRadTheta{ initRadTheta }
-			, theAirProfile{ airProfile }
-			, theRadEarth{ radEarth }
-		{ }
-
-		//! \brief No-op dtor.
-		virtual
-		~RefractGyer
-			() = default;
-
-
-		/*! \brief Single ODE from Gyer Eqn[12].
+		/*! \brief Integrand of Gyer Eqn[12].
 		 *
-		 * Implements integration of Eqn(12) in Gyer's paper
+		 * Implements integrand of Eqn(12) in Gyer's paper
 		 *   https://www.asprs.org/wp-content/uploads/
 		 *     pers/1996journal/mar/1996_mar_301-310.pdf
 		 *
 		 * I.e.
 		 * \arg Theta_c = integral{ k / (r*sqrt(n*n*r*r - k*k)) * dr };
 		 */
-		virtual
-		std::vector<double>
+		inline
+		double
 		operator()
-			( std::pair<double, std::vector<double> > const & in
+			( double const & currRad
 			) const
 		{
-			std::vector<double> derivFuncs(1u);
-
-			// Current evaluation functions
-			double const currRad(in.first);
-			// std::vector<double> const & currRnFuncs = in.second;
-
 			// height relative to Earth radius
 			double const elev{ currRad - theRadEarth };
 			double const currIoR{ theAirProfile.indexOfRefraction(elev) };
 			using engabra::g3::sq;
 			double const radicand{ sq(currRad*currIoR) - sq(theRefConst) };
 			double const denom{ currRad * std::sqrt(radicand) };
+			return (theRefConst / denom);
+		}
 
+		//! \brief Single ODE from Gyer Eqn[12] (integrand is free of theta).
+		inline
+		std::array<double, 1u>
+		operator()
+			( double const & currRad
+			, std::array<double, 1u> const & // currRnFuncs
+			) const
+		{
 			// Derivative function values
-			double const r0Prime{ theRefConst / denom }; // integrand
+			return std::array<double, 1u>
+				{ (*this)(currRad)
+				};
+		}
 
-			// Derivative function values
-			return std::vector<double>
-				{ r0Prime
+		/*! \brief Integral of Eqn[12] integrand from radLo to radHi.
+		 *
+		 * For grazing rays, the radicand (n*n*r*r - k*k) approaches zero
+		 * at the lower end of the range such that the integrand behaves
+		 * as 1/sqrt(r-rLow). If isTurnLo, the piece is therefore
+		 * integrated with the singularity removing substitution provided
+		 * by QuadratureGK::integralFromSingular(). The radicand is then
+		 * evaluated as an increment relative to its (non negative)
+		 * value at radLo. This avoids the catastrophic cancellation
+		 * (and resulting imaginary values) that otherwise occurs when
+		 * radLo is (numerically) the ray tangent radius.
+		 *
+		 * Close to the tangent radius, roundoff in the IoR values
+		 * (amplified by radLo in the radicand increment) limits the
+		 * accuracy that can be attained. The tolerance for such a
+		 * piece is therefore relaxed (by factors of ten, up to
+		 * sTolAbsGrazing) until the quadrature converges.
+		 */
+		inline
+		double
+		pieceIntegral
+			( double const & radLo
+			, double const & radHi
+			, bool const & isTurnLo
+			) const
+		{
+			if (! isTurnLo)
+			{
+				return gyerQuadrature().integralOf(*this, radLo, radHi);
+			}
+
+			// radicand relative to that at the lowest radius
+			double const & radBase = radLo;
+			double const nuBase
+				{ theAirProfile.indexOfRefraction(radBase - theRadEarth) };
+			// negative (beyond roundoff) if ray does not reach radBase
+			using engabra::g3::sq;
+			double const refConstSq{ sq(theRefConst) };
+			double radicandBase{ sq(radBase*nuBase) - refConstSq };
+			constexpr double eps{ std::numeric_limits<double>::epsilon() };
+			if (! (radicandBase < -(16.*eps*refConstSq)))
+			{
+				radicandBase = std::max(0., radicandBase);
+			}
+			auto const integrandAbove
+				{ [this, & radBase, & nuBase, & radicandBase]
+					(double const & delRad) // currRad - radBase
+					{
+						double const currRad{ radBase + delRad };
+						double const elev{ currRad - theRadEarth };
+						double const currIoR
+							{ theAirProfile.indexOfRefraction(elev) };
+						// (n*r)^2 - (nBase*rBase)^2 without cancellation
+						double const delNR
+							{ currIoR*delRad + (currIoR - nuBase)*radBase };
+						double const sumNR
+							{ currIoR*currRad + nuBase*radBase };
+						double const radicand
+							{ delNR*sumNR + radicandBase };
+						return theRefConst / (currRad*std::sqrt(radicand));
+					}
+				};
+			double integral{ engabra::g3::null<double>() };
+			for (double tolAbs{ 1.e-15 }
+				; (! engabra::g3::isValid(integral))
+				  && (! (sTolAbsGrazing < tolAbs))
+				  && (! (radicandBase < 0.)) // (ray does not reach radLo)
+				; tolAbs *= 10.)
+			{
+				integral = gyerQuadrature(tolAbs).integralFromSingular
+					(integrandAbove, radHi - radBase);
+			}
+			return integral;
+		}
+
+		//! \brief Radii of AirProfile data heights between radLo and radHi.
+		inline
+		std::vector<double>
+		breakRadiiWithin
+			( double const & radLo
+			, double const & radHi
+			) const
+		{
+			std::vector<double> radii;
+			for (aply::env::Height const & height
+				: theAirProfile.breakHeights())
+			{
+				double const radius{ theRadEarth + height };
+				if ((radLo < radius) && (radius < radHi))
+				{
+					radii.emplace_back(radius);
+				}
+			}
+			return radii;
+		}
+
+		/*! \brief Theta_c at radiusEnd by (direct) quadrature of Eqn[12].
+		 *
+		 * The integration range is split at the AirProfile data heights
+		 * (where the interpolated IoR has discontinuous derivatives) and
+		 * each piece is integrated with adaptive Gauss-Kronrod quadrature.
+		 * The lowest piece is integrated with the grazing ray treatment
+		 * described at pieceIntegral().
+		 */
+		inline
+		double
+		thetaAngleAt
+			( double const & radiusEnd
+			) const
+		{
+			double const & radiusBeg = theInitRadTheta.first;
+			double const radLo{ std::min(radiusBeg, radiusEnd) };
+			double const radHi{ std::max(radiusBeg, radiusEnd) };
+
+			double integral{ 0. };
+			if (radLo < radHi)
+			{
+				// piece boundaries at profile data heights within range
+				std::vector<double> radii{ radLo };
+				for (double const & radius : breakRadiiWithin(radLo, radHi))
+				{
+					radii.emplace_back(radius);
+				}
+				radii.emplace_back(radHi);
+
+				integral = pieceIntegral(radii[0], radii[1], true);
+				for (std::size_t nn{2u} ; nn < radii.size() ; ++nn)
+				{
+					integral += pieceIntegral
+						(radii[nn-1u], radii[nn], false);
+				}
+			}
+
+			// Eqn[12] integrand is positive: theta decreases going down
+			double const dir{ (radiusEnd < radiusBeg) ? -1. : 1. };
+			return (theInitRadTheta.second[0] + dir * integral);
+		}
+
+		/*! \brief Theta_c at each of radiiEnd by cumulative quadrature.
+		 *
+		 * The range from the start radius to the farthest of radiiEnd
+		 * is split at the AirProfile data heights and at each of the
+		 * radiiEnd. Each piece is integrated once (as in thetaAngleAt())
+		 * and the pieces are accumulated outward from the start radius.
+		 * Pieces with a radiiEnd value at their lower end get the
+		 * grazing ray treatment (ref pieceIntegral()) since any of
+		 * these may be at the ray tangent radius. For rays going
+		 * down, the farthest (lowest) radius is evaluated with a
+		 * single piece up to the next data height (as in
+		 * thetaAngleAt()) rather than from the (possibly very short)
+		 * piece up to the next of radiiEnd.
+		 *
+		 * Radii on the other side of the start radius (relative to the
+		 * farthest one) produce null values.
+		 */
+		inline
+		std::vector<double>
+		thetaAnglesAt
+			( std::vector<double> const & radiiEnd
+			) const
+		{
+			using engabra::g3::null;
+			std::vector<double> thetas(radiiEnd.size(), null<double>());
+
+			// farthest radius determines direction of integration
+			double const & radiusBeg = theInitRadTheta.first;
+			double radFar{ radiusBeg };
+			for (double const & radius : radiiEnd)
+			{
+				if (std::abs(radFar - radiusBeg) < std::abs(radius - radiusBeg))
+				{
+					radFar = radius;
+				}
+			}
+			bool const isDown{ radFar < radiusBeg };
+			double const radLo{ std::min(radiusBeg, radFar) };
+			double const radHi{ std::max(radiusBeg, radFar) };
+			auto const isInRange
+				{ [& radLo, & radHi] (double const & radius)
+					{ return ((radLo <= radius) && (radius <= radHi)); }
 				};
+
+			// piece boundaries (ascending) with lower end turn flags
+			std::vector<std::pair<double, bool> > bounds;
+			bounds.reserve(radiiEnd.size() + 2u);
+			bounds.emplace_back(radLo, true);
+			bounds.emplace_back(radHi, false);
+			for (double const & radius : radiiEnd)
+			{
+				if (isInRange(radius))
+				{
+					bounds.emplace_back(radius, true);
+				}
+			}
+			for (double const & radius : breakRadiiWithin(radLo, radHi))
+			{
+				bounds.emplace_back(radius, false);
+			}
+			// sort (turn flags first) and keep one of each radius
+			std::sort
+				( bounds.begin(), bounds.end()
+				, [] (std::pair<double, bool> const & bnd1
+					, std::pair<double, bool> const & bnd2)
+					{
+						return (bnd1.first < bnd2.first)
+							|| ( (bnd1.first == bnd2.first)
+							  && (bnd1.second && (! bnd2.second))
+							   );
+					}
+				);
+			bounds.erase
+				( std::unique
+					( bounds.begin(), bounds.end()
+					, [] (std::pair<double, bool> const & bnd1
+						, std::pair<double, bool> const & bnd2)
+						{ return (bnd1.first == bnd2.first); }
+					)
+				, bounds.end()
+				);
+
+			// cumulative integral from start to each boundary
+			std::size_t const numBnds{ bounds.size() };
+			std::vector<double> cumInts(numBnds, 0.);
+			for (std::size_t nn{1u} ; nn < numBnds ; ++nn)
+			{
+				// fill from the start end of the range outward
+				std::size_t const ndxHi{ isDown ? (numBnds - nn) : nn };
+				std::size_t const ndxLo{ ndxHi - 1u };
+				if (isDown && (0u == ndxLo))
+				{
+					// As thetaAngleAt(), the lowest (possibly tangent)
+					// radius gets one piece up to the next break, else
+					// short pieces there are dominated by IoR roundoff.
+					std::size_t ndxUp{ 1u };
+					while (bounds[ndxUp].second && (ndxUp + 1u < numBnds))
+					{
+						++ndxUp;
+					}
+					cumInts[0u] = cumInts[ndxUp] + pieceIntegral
+						(bounds[0u].first, bounds[ndxUp].first, true);
+					break;
+				}
+				double const piece
+					{ pieceIntegral
+						( bounds[ndxLo].first, bounds[ndxHi].first
+						, bounds[ndxLo].second
+						)
+					};
+				if (isDown)
+				{
+					cumInts[ndxLo] = cumInts[ndxHi] + piece;
+				}
+				else
+				{
+					cumInts[ndxHi] = cumInts[ndxLo] + piece;
+				}
+			}
+
+			// Eqn[12] integrand is positive: theta decreases going down
+			double const dir{ isDown ? -1. : 1. };
+			for (std::size_t nr{0u} ; nr < radiiEnd.size() ; ++nr)
+			{
+				double const & radius = radiiEnd[nr];
+				if (isInRange(radius))
+				{
+					std::vector<std::pair<double, bool> >::const_iterator
+						const itBnd
+						{ std::lower_bound
+							( bounds.cbegin(), bounds.cend(), radius
+							, [] (std::pair<double, bool> const & bnd
+								, double const & rad)
+								{ return (bnd.first < rad); }
+							)
+						};
+					std::size_t const ndx
+						{ static_cast<std::size_t>(itBnd - bounds.cbegin()) };
+					thetas[nr] = theInitRadTheta.second[0] + dir * cumInts[ndx];
+				}
+			}
+			return thetas;
 		}
 
 		//! \brief Start height and inital 'Theta_c' value (generally 0.)
-		virtual
-		std::pair<double, std::vector<double> >
+		inline
+		aply::math::DiffEqValues<1u>
 		initValues
 			() const
 		{
@@ -216,8 +507,7 @@ Refraction :: Refraction
 		* theAirProfile.indexOfRefraction(theStartRadius-theRadiusEarth)
 		* std::sin(lookAngle)
 		}
-	, theInitRadTheta
-		{ std::make_pair(theStartRadius, std::vector<double>{ theTheta0 }) }
+	, theInitRadTheta{ theStartRadius, { theTheta0 } }
 {
 }
 
@@ -232,25 +522,155 @@ Refraction :: thetaAngleAt
 	( double const & radius
 	) const
 {
-	// For aerial sensing work, an integration step size of 50 [m] seems
-	// to be a good value. E.g. 10x larger or 10x smaller still produces
-	// the same ray deviation angle from 9k[m] at pi/4 look dir.
-	constexpr double stepSize{ 50. }; // a resonable step size
-
-	math::DiffEqSolve solver(stepSize);
 	RefractGyer const refractionSystem
-		( theRefractiveInvariant
+		{ theRefractiveInvariant
 		, theInitRadTheta
 		, theAirProfile
 		, theRadiusEarth
-		);
-	// Return initial value like structure includes:
-	//	- endValues.first : radius (should match method input argument)
-	//	- endValues.second: size of 1u
-	//		- [0] : Theta_c angle (ray path polar angle from center of Earth)
-	std::pair<double, std::vector<double> > const endValues
-		{ solver.solutionFor(radius, refractionSystem) };
-	return endValues.second[0];
+		};
+	return refractionSystem.thetaAngleAt(radius);
+}
+
+std::pair<double, double>
+Refraction :: thetaAngleApprox
+	( double const & radiusEnd
+	) const
+{
+	using engabra::g3::null;
+	std::pair<double, double> thetaError{ null<double>(), null<double>() };
+	if (! isValid())
+	{
+		return thetaError;
+	}
+	if (radiusEnd == theStartRadius)
+	{
+		return std::make_pair(theTheta0, 0.);
+	}
+
+	double const radLo{ std::min(theStartRadius, radiusEnd) };
+	double const radHi{ std::max(theStartRadius, radiusEnd) };
+	double const highLo{ radLo - theRadiusEarth };
+	double const highHi{ radHi - theRadiusEarth };
+	double const highDel{ highHi - highLo };
+	double const radMean{ .5 * (radLo + radHi) };
+
+	// profile samples: refractivity N = n-1 at ends and middle of path
+	double const nuLo{ theAirProfile.indexOfRefraction(highLo) };
+	double const nuHi{ theAirProfile.indexOfRefraction(highHi) };
+	double const nuMid{ theAirProfile.indexOfRefraction(highLo + .5*highDel) };
+	double const refLo{ nuLo - 1. };
+	double const refHi{ nuHi - 1. };
+	double const refMid{ nuMid - 1. };
+	double const & nuStart = (theStartRadius < radiusEnd) ? nuLo : nuHi;
+	double const refStart{ nuStart - 1. };
+
+	// straight line (constant IoR) polar angle magnitude
+	double const cosBeg{ theRefractiveInvariant / (nuStart * theStartRadius) };
+	double const cosEnd{ theRefractiveInvariant / (nuStart * radiusEnd) };
+	double const theta0{ std::abs(std::acos(cosEnd) - std::acos(cosBeg)) };
+
+	// integral of N(h) over path heights for exponential profile
+	double intRef{ .5 * highDel * (refLo + refHi) };
+	double refFitMid{ .5 * (refLo + refHi) };
+	double const logRatio{ std::log(refLo / refHi) };
+	if (std::numeric_limits<double>::epsilon() < std::abs(logRatio))
+	{
+		double const scaleHigh{ highDel / logRatio };
+		intRef = refLo * scaleHigh * (1. - (refHi / refLo));
+		refFitMid = std::sqrt(refLo * refHi);
+	}
+	// (parabolic) correction for profile departure from exponential
+	double const intRefCorr{ (2./3.) * highDel * (refMid - refFitMid) };
+	intRef += intRefCorr;
+
+	// first order refraction correction (flat Earth geometry)
+	double const beta
+		{ std::min(theStartLookAngle, engabra::g3::pi - theStartLookAngle) };
+	double const tanBeta{ std::tan(beta) };
+	double const cosBeta{ std::cos(beta) };
+	double const coef{ tanBeta / (radMean * cosBeta * cosBeta * nuStart) };
+	double const intEps{ intRef - refStart * highDel };
+	double const corr{ coef * intEps };
+
+	// direction of integration (ref thetaAngleAt())
+	double const dir{ (radiusEnd < theStartRadius) ? -1. : 1. };
+	double const theta{ theTheta0 + dir * (theta0 - corr) };
+
+	// relative magnitude of neglected terms in the correction
+	double relGeom{ 3. * (highDel / radMean) };
+	if (0. < tanBeta)
+	{
+		// change in zenith angle along path is about theta0
+		relGeom += theta0 * (1./tanBeta + 3.*tanBeta);
+	}
+	double const relOrder2
+		{ 1.5 * std::abs(refLo - refHi) / (nuStart * cosBeta * cosBeta) };
+	double const error
+		{ std::abs(coef * intRefCorr) + std::abs(corr) * (relGeom + relOrder2) };
+
+	thetaError = std::make_pair(theta, error);
+	return thetaError;
+}
+
+double
+Refraction :: thetaAngleWithin
+	( double const & radiusEnd
+	, double const & tolTheta
+	, RefractionStats * const & ptStats
+	) const
+{
+	std::pair<double, double> const thetaError{ thetaAngleApprox(radiusEnd) };
+	double theta{ thetaError.first };
+	// note: null estimate (e.g. grazing ray) uses numeric integration
+	bool const isFast{ (thetaError.second <= tolTheta) };
+	if (! isFast)
+	{
+		theta = thetaAngleAt(radiusEnd);
+	}
+	if (ptStats)
+	{
+		if (isFast)
+		{
+			++(ptStats->theNumFast);
+		}
+		else
+		{
+			++(ptStats->theNumSlow);
+		}
+	}
+	return theta;
+}
+
+std::vector<double>
+Refraction :: thetaAnglesAt
+	( std::vector<double> const & radiiEnd
+	) const
+{
+	std::vector<double> thetas(radiiEnd.size(), engabra::g3::null<double>());
+	if (isValid())
+	{
+		RefractGyer const refractionSystem
+			{ theRefractiveInvariant
+			, theInitRadTheta
+			, theAirProfile
+			, theRadiusEarth
+			};
+		thetas = refractionSystem.thetaAnglesAt(radiiEnd);
+	}
+	return thetas;
+}
+
+// static
+double
+Refraction :: angularDeviationFor
+	( double const & lookAngle
+	, double const & radiusStart
+	, double const & radiusEnd
+	, double const & thetaEnd
+	)
+{
+	NetRayInfo const netRayInfo{ radiusStart, lookAngle };
+	return netRayInfo.refractionDeviation(radiusEnd, thetaEnd);
 }
 
 double
@@ -262,8 +682,8 @@ Refraction :: angularDeviationFromStart
 	double deviation{ engabra::g3::null<double>() };
 	if (isValid())
 	{
-		NetRayInfo const netRayInfo{ theStartRadius, theStartLookAngle };
-		deviation = netRayInfo.refractionDeviation(radiusEnd, thetaEnd);
+		deviation = angularDeviationFor
+			(theStartLookAngle, theStartRadius, radiusEnd, thetaEnd);
 	}
 	return deviation;
 }
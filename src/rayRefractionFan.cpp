@@ -0,0 +1,531 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::RefractionFan
+*/
+
+
+#include "rayRefractionFan.hpp"
+
+#include "rayRefraction.hpp"
+
+#include "mathQuadratureGK.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+	/*! \brief Relative tolerance for each piece (as for Refraction).
+	 *
+	 * Together with the (constructor provided) absolute tolerance,
+	 * this reproduces the convergence criteria used by
+	 * aply::ray::Refraction::thetaAngleAt() for each fan member.
+	 */
+	constexpr double sTolRel{ 1.e-13 }; // [-]
+
+	/*! \brief Maximum number of subintervals per (lockstep) integral.
+	 *
+	 * Well behaved integrands converge with a few tens of subintervals.
+	 * Additional subintervals would be spent (evaluating all members)
+	 * on the few members (if any) that are roundoff limited near their
+	 * tangent radius. These are better evaluated individually.
+	 */
+	constexpr std::size_t sMaxIntervals{ 100u };
+
+	/*! \brief Accumulate Kronrod and Gauss sums for one abscissa.
+	 *
+	 * Integrand values for each fan member are
+	 * \code
+	 * scale * refInvs[k] / sqrt(radicand + bases[k])
+	 * \endcode
+	 * Inner loop over all look angles for a single abscissa. Written
+	 * as a simple contiguous loop over restrict pointers so that it is
+	 * vectorized by the compiler.
+	 */
+	inline
+	void
+	accumulateNode
+		( double const scale
+		, double const radicand
+		, double const weightK
+		, double const weightG
+		, double const * const __restrict refInvs
+		, double const * const __restrict bases
+		, double * const __restrict sumsK
+		, double * const __restrict sumsG
+		, std::size_t const numK
+		)
+	{
+		for (std::size_t nk{0u} ; nk < numK ; ++nk)
+		{
+			double const func
+				{ scale * refInvs[nk] / std::sqrt(radicand + bases[nk]) };
+			sumsK[nk] += weightK * func;
+			sumsG[nk] += weightG * func;
+		}
+	}
+
+	//! Gauss-Kronrod estimates (all fan members) over one subinterval.
+	struct FanPiece
+	{
+		//! Start of subinterval.
+		double theBeg;
+		//! End of subinterval.
+		double theEnd;
+		//! Largest (error / tolerance) ratio of any fan member.
+		double theWorst;
+		//! Kronrod (15-point) integral estimate for each member.
+		std::vector<double> theValues;
+		//! Magnitude of Kronrod minus Gauss estimates for each member.
+		std::vector<double> theErrors;
+
+		//! Ordering for heap with largest error ratio at front.
+		inline
+		bool
+		operator<
+			( FanPiece const & other
+			) const
+		{
+			return (theWorst < other.theWorst);
+		}
+	};
+
+	/*! \brief Adaptive Gauss-Kronrod quadrature for all fan members.
+	 *
+	 * Same rule and convergence criteria as aply::math::QuadratureGK
+	 * but applied to all fan members over one common (adaptively
+	 * bisected) set of subintervals. The NodeFunc provides the
+	 * member independent (scale, radicand) terms of the integrand
+	 * (ref accumulateNode()) at an abscissa such that the (expensive)
+	 * index of refraction is evaluated once per abscissa for all
+	 * members. The subinterval bisected next is the one with the
+	 * largest error estimate relative to the tolerance of any member.
+	 */
+	struct LockstepGK
+	{
+		//! Integrand numerator for each member (zero for inactive ones).
+		std::vector<double> const & theRefInvs;
+
+		//! Integrand radicand offset for each member.
+		std::vector<double> const & theBases;
+
+		//! Absolute tolerance on each member integral.
+		double const theTolAbs;
+
+		//! Error tolerance for each member given current values.
+		inline
+		std::vector<double>
+		tolerancesFor
+			( std::vector<double> const & values
+			) const
+		{
+			std::vector<double> tols(values.size());
+			for (std::size_t nk{0u} ; nk < values.size() ; ++nk)
+			{
+				tols[nk] = std::max(theTolAbs, sTolRel * std::abs(values[nk]));
+			}
+			return tols;
+		}
+
+		//! Gauss-Kronrod 7-15 estimates for all members over [xBeg,xEnd].
+		template <typename NodeFunc>
+		inline
+		FanPiece
+		pieceFor
+			( NodeFunc const & nodeFunc
+			, double const & xBeg
+			, double const & xEnd
+			, std::vector<double> const & tols
+			) const
+		{
+			using aply::math::QuadratureGK;
+			std::size_t const numK{ theRefInvs.size() };
+			std::vector<double> sumsK(numK, 0.);
+			std::vector<double> sumsG(numK, 0.);
+
+			double const xMid{ .5 * (xEnd + xBeg) };
+			double const xHalf{ .5 * (xEnd - xBeg) };
+			auto const accumulate
+				{ [&] (double const & xx, double const & wK, double const & wG)
+				{
+					std::pair<double, double> const terms{ nodeFunc(xx) };
+					accumulateNode
+						( terms.first, terms.second, wK, wG
+						, theRefInvs.data(), theBases.data()
+						, sumsK.data(), sumsG.data(), numK
+						);
+				}
+				};
+			accumulate
+				(xMid, QuadratureGK::sWeightsK[7], QuadratureGK::sWeightsG[3]);
+			for (std::size_t nn{0u} ; nn < 7u ; ++nn)
+			{
+				double const dx{ xHalf * QuadratureGK::sNodesK[nn] };
+				double const wK{ QuadratureGK::sWeightsK[nn] };
+				double const wG
+					{ (1u == (nn % 2u)) ? QuadratureGK::sWeightsG[nn/2u] : 0. };
+				accumulate(xMid - dx, wK, wG);
+				accumulate(xMid + dx, wK, wG);
+			}
+
+			FanPiece piece{ xBeg, xEnd, 0., std::move(sumsK), {} };
+			piece.theErrors = std::move(sumsG);
+			for (std::size_t nk{0u} ; nk < numK ; ++nk)
+			{
+				double & value = piece.theValues[nk];
+				double & error = piece.theErrors[nk];
+				value = xHalf * value;
+				error = std::abs(value - xHalf * error);
+				// (NaN error ratios are treated as largest)
+				double const ratio{ error / tols[nk] };
+				if (! (ratio <= piece.theWorst))
+				{
+					piece.theWorst = ratio;
+				}
+			}
+			return piece;
+		}
+
+		/*! \brief Integral from xBeg to xEnd for each member.
+		 *
+		 * Members for which the tolerance is not attained (within
+		 * sMaxIntervals subintervals) are flagged in ptIsUnresolved.
+		 */
+		template <typename NodeFunc>
+		inline
+		std::vector<double>
+		integralsOf
+			( NodeFunc const & nodeFunc
+			, double const & xBeg
+			, double const & xEnd
+			, std::vector<bool> * const & ptIsUnresolved
+			) const
+		{
+			std::size_t const numK{ theRefInvs.size() };
+			std::vector<double> const tolsAbs(numK, theTolAbs);
+			std::vector<FanPiece> pieces;
+			pieces.reserve(sMaxIntervals);
+			pieces.emplace_back(pieceFor(nodeFunc, xBeg, xEnd, tolsAbs));
+			std::vector<double> sumValues{ pieces.front().theValues };
+			std::vector<double> sumErrors{ pieces.front().theErrors };
+
+			std::vector<double> tols{ tolerancesFor(sumValues) };
+			auto const isConverged
+				{ [&] ()
+				{
+					for (std::size_t nk{0u} ; nk < numK ; ++nk)
+					{
+						if (! (sumErrors[nk] <= tols[nk]))
+						{
+							return false;
+						}
+					}
+					return true;
+				}
+				};
+			while ( (! isConverged())
+				 && (pieces.size() < sMaxIntervals)
+				  )
+			{
+				// bisect subinterval with largest error ratio
+				std::pop_heap(pieces.begin(), pieces.end());
+				FanPiece const worst{ std::move(pieces.back()) };
+				pieces.pop_back();
+				double const xMid{ .5 * (worst.theBeg + worst.theEnd) };
+				FanPiece piece1{ pieceFor(nodeFunc, worst.theBeg, xMid, tols) };
+				FanPiece piece2{ pieceFor(nodeFunc, xMid, worst.theEnd, tols) };
+				for (std::size_t nk{0u} ; nk < numK ; ++nk)
+				{
+					sumValues[nk] += piece1.theValues[nk]
+						+ piece2.theValues[nk] - worst.theValues[nk];
+					sumErrors[nk] += piece1.theErrors[nk]
+						+ piece2.theErrors[nk] - worst.theErrors[nk];
+				}
+				pieces.emplace_back(std::move(piece1));
+				std::push_heap(pieces.begin(), pieces.end());
+				pieces.emplace_back(std::move(piece2));
+				std::push_heap(pieces.begin(), pieces.end());
+				tols = tolerancesFor(sumValues);
+			}
+
+			// final sums (without incremental update roundoff)
+			sumValues.assign(numK, 0.);
+			sumErrors.assign(numK, 0.);
+			for (FanPiece const & piece : pieces)
+			{
+				for (std::size_t nk{0u} ; nk < numK ; ++nk)
+				{
+					sumValues[nk] += piece.theValues[nk];
+					sumErrors[nk] += piece.theErrors[nk];
+				}
+			}
+			tols = tolerancesFor(sumValues);
+			for (std::size_t nk{0u} ; nk < numK ; ++nk)
+			{
+				if (! (sumErrors[nk] <= tols[nk]))
+				{
+					(*ptIsUnresolved)[nk] = true;
+				}
+			}
+			return sumValues;
+		}
+
+	}; // LockstepGK
+
+} // [anon]
+
+
+namespace aply
+{
+namespace ray
+{
+
+RefractionFan :: RefractionFan
+	( std::vector<double> const & lookAngles
+	, double const & radiusSensor
+	, double const & radiusEarth
+	, env::AirProfile const & airProfile
+	, double const & tolAbs
+	)
+	: theLookAngles{ lookAngles }
+	, theStartRadius{ radiusSensor }
+	, theRadiusEarth{ radiusEarth }
+	, theAirProfile{ airProfile }
+	, theTolAbs{ tolAbs }
+	, theRefInvariants(lookAngles.size())
+	, theRefInvariantSqs(lookAngles.size())
+{
+	double const rn
+		{ theStartRadius
+		* theAirProfile.indexOfRefraction(theStartRadius - theRadiusEarth)
+		};
+	for (std::size_t nk{0u} ; nk < theLookAngles.size() ; ++nk)
+	{
+		double const kVal{ rn * std::sin(theLookAngles[nk]) };
+		theRefInvariants[nk] = kVal;
+		theRefInvariantSqs[nk] = kVal * kVal;
+	}
+}
+
+bool
+RefractionFan :: isValid
+	() const
+{
+	return
+		(  engabra::g3::isValid(theRadiusEarth)
+		&& engabra::g3::isValid(theTolAbs)
+		&& (0. < theTolAbs)
+		);
+}
+
+std::size_t
+RefractionFan :: size
+	() const
+{
+	return theLookAngles.size();
+}
+
+std::vector<double> const &
+RefractionFan :: lookAngles
+	() const
+{
+	return theLookAngles;
+}
+
+std::vector<double>
+RefractionFan :: thetaAnglesAt
+	( double const & radiusEnd
+	) const
+{
+	using engabra::g3::null;
+	using engabra::g3::sq;
+	std::size_t const numK{ size() };
+	std::vector<double> thetas(numK, null<double>());
+	if (! isValid())
+	{
+		return thetas;
+	}
+
+	double const radLo{ std::min(theStartRadius, radiusEnd) };
+	double const radHi{ std::max(theStartRadius, radiusEnd) };
+	if (! (radLo < radHi))
+	{
+		thetas.assign(numK, 0.);
+		return thetas;
+	}
+
+	// piece boundaries at profile data heights within range
+	std::vector<double> radii{ radLo };
+	for (env::Height const & height : theAirProfile.breakHeights())
+	{
+		double const radius{ theRadiusEarth + height };
+		if ((radLo < radius) && (radius < radHi))
+		{
+			radii.emplace_back(radius);
+		}
+	}
+	radii.emplace_back(radHi);
+
+	// radicand relative to that at the lowest radius (ref Refraction)
+	double const & radBase = radLo;
+	double const nuBase
+		{ theAirProfile.indexOfRefraction(radBase - theRadiusEarth) };
+	double const rnBaseSq{ sq(radBase*nuBase) };
+	constexpr double eps{ std::numeric_limits<double>::epsilon() };
+	std::vector<bool> isReaching(numK, true);
+	std::vector<double> refInvs{ theRefInvariants };
+	std::vector<double> radicandBases(numK);
+	std::vector<double> negRefInvSqs(numK);
+	for (std::size_t nk{0u} ; nk < numK ; ++nk)
+	{
+		double const & kSq = theRefInvariantSqs[nk];
+		double radicandBase{ rnBaseSq - kSq };
+		if (radicandBase < -(16.*eps*kSq))
+		{
+			// ray does not reach radBase: integrate (harmless) k=0 values
+			isReaching[nk] = false;
+			refInvs[nk] = 0.;
+			radicandBase = rnBaseSq;
+		}
+		radicandBases[nk] = std::max(0., radicandBase);
+		negRefInvSqs[nk] = -sq(refInvs[nk]);
+	}
+
+	// lowest piece: grazing ray (singularity removing) substitution
+	// rad = radBase + delEnd*t^2 (ref QuadratureGK::integralFromSingular())
+	std::vector<bool> isUnresolved(numK, false);
+	double const delEnd{ radii[1] - radBase };
+	auto const nodeTermsGrazing
+		{ [this, & radBase, & nuBase, & delEnd]
+			(double const & tt)
+			{
+				double const delRad{ delEnd*tt*tt };
+				double const currRad{ radBase + delRad };
+				double const elev{ currRad - theRadiusEarth };
+				double const currIoR{ theAirProfile.indexOfRefraction(elev) };
+				// (n*r)^2 - (nBase*rBase)^2 without cancellation
+				double const delNR
+					{ currIoR*delRad + (currIoR - nuBase)*radBase };
+				double const sumNR{ currIoR*currRad + nuBase*radBase };
+				return std::make_pair
+					((2.*delEnd*tt) / currRad, delNR*sumNR);
+			}
+		};
+	std::vector<double> integrals
+		{ LockstepGK{ refInvs, radicandBases, theTolAbs }
+			.integralsOf(nodeTermsGrazing, 0., 1., &isUnresolved)
+		};
+
+	// other pieces: integrand evaluated directly
+	auto const nodeTerms
+		{ [this] (double const & currRad)
+			{
+				double const elev{ currRad - theRadiusEarth };
+				double const currIoR{ theAirProfile.indexOfRefraction(elev) };
+				return std::make_pair(1. / currRad, sq(currRad*currIoR));
+			}
+		};
+	LockstepGK const lockstep{ refInvs, negRefInvSqs, theTolAbs };
+	for (std::size_t nn{2u} ; nn < radii.size() ; ++nn)
+	{
+		std::vector<double> const pieceInts
+			{ lockstep.integralsOf
+				(nodeTerms, radii[nn-1u], radii[nn], &isUnresolved)
+			};
+		for (std::size_t nk{0u} ; nk < numK ; ++nk)
+		{
+			integrals[nk] += pieceInts[nk];
+		}
+	}
+
+	// Eqn[12] integrand is positive: theta decreases going down
+	double const dir{ (radiusEnd < theStartRadius) ? -1. : 1. };
+	for (std::size_t nk{0u} ; nk < numK ; ++nk)
+	{
+		if (! isReaching[nk])
+		{
+			continue; // (null)
+		}
+		if (isUnresolved[nk])
+		{
+			// e.g. roundoff limited integrand near ray tangent radius
+			Refraction const refraction
+				( theLookAngles[nk], theStartRadius, theRadiusEarth
+				, theAirProfile
+				);
+			thetas[nk] = refraction.thetaAngleAt(radiusEnd);
+		}
+		else
+		{
+			thetas[nk] = dir * integrals[nk];
+		}
+	}
+	return thetas;
+}
+
+std::vector<double>
+RefractionFan :: angularDeviationsFromStart
+	( double const & radiusEnd
+	) const
+{
+	std::vector<double> deviations{ thetaAnglesAt(radiusEnd) };
+	for (std::size_t nk{0u} ; nk < deviations.size() ; ++nk)
+	{
+		deviations[nk] = Refraction::angularDeviationFor
+			(theLookAngles[nk], theStartRadius, radiusEnd, deviations[nk]);
+	}
+	return deviations;
+}
+
+std::string
+RefractionFan :: infoString
+	( std::string const & title
+	) const
+{
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	using engabra::g3::io::fixed;
+	oss
+		<< "numLooks: " << size()
+		<< "  radiusStart: " << fixed(theStartRadius, 7u, 3u)
+		<< "  radiusEarth: " << fixed(theRadiusEarth, 7u, 3u)
+		<< "  tolAbs: " << engabra::g3::io::enote(theTolAbs, 1u)
+		;
+	return oss.str();
+}
+
+} // [ray]
+} // [aply]
@@ -0,0 +1,384 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::StepStudy
+*/
+
+
+#include "rayStepStudy.hpp"
+
+#include "rayNodeGenerator.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+
+namespace aply
+{
+namespace ray
+{
+
+namespace
+{
+	using namespace engabra::g3;
+
+	//! Trace one rung (fills end location, deviation and stats).
+	void
+	traceRung
+		( env::IndexVolume const * const ptMedia
+		, Start const start
+		, StepMethod const stepMethod
+		, bool const useAcceleration
+		, StepStudy::Rung * const ptRung
+		)
+	{
+		StepStudy::Rung & rung = *ptRung;
+		Propagator const prop
+			{ ptMedia, rung.theStepDist, useAcceleration, stepMethod };
+
+		// node after numSteps is at end of total path parameter
+		NodeGenerator gen(prop, start, &(rung.theStats));
+		std::size_t numNodes{ 0u };
+		while ((numNodes <= rung.theNumSteps) && gen.next())
+		{
+			++numNodes;
+		}
+		if (numNodes == (rung.theNumSteps + 1u))
+		{
+			Node const & node = gen.node();
+			rung.theEndLoc = node.theCurrLoc;
+
+			// centered (average) tangent at end node
+			Vector const tEnd{ direction(node.thePrevTan + node.theNextTan) };
+			double const cosAng{ (start.theTanDir * tEnd).theSca[0] };
+			double const sinAng{ magnitude((start.theTanDir * tEnd).theBiv) };
+			rung.theDeviation = std::atan2(sinAng, cosAng);
+		}
+	}
+
+	//! Magnitude of value.
+	inline
+	double
+	valMag
+		( Vector const & val
+		)
+	{
+		return magnitude(val);
+	}
+
+	//! Magnitude of value.
+	inline
+	double
+	valMag
+		( double const & val
+		)
+	{
+		return std::abs(val);
+	}
+
+	//! Magnitude of difference between values.
+	inline
+	double
+	difMag
+		( Vector const & valA
+		, Vector const & valB
+		)
+	{
+		return magnitude(valA - valB);
+	}
+
+	//! Magnitude of difference between values.
+	inline
+	double
+	difMag
+		( double const & valA
+		, double const & valB
+		)
+	{
+		return std::abs(valA - valB);
+	}
+
+	//! Observed order and extrapolation from (coarse, mid, fine) values.
+	template <typename Type>
+	std::pair<double, Type>
+	richardson
+		( Type const & qCoarse
+		, Type const & qMid
+		, Type const & qFine
+		)
+	{
+		double order{ null<double>() };
+		Type extrap{ qFine };
+		double const difCoarse{ difMag(qMid, qCoarse) };
+		double const difFine{ difMag(qFine, qMid) };
+		// differences at roundoff level carry no convergence information
+		double const roundTol
+			{ 64. * std::numeric_limits<double>::epsilon() * valMag(qFine) };
+		if ((roundTol < difFine) && (difFine < difCoarse))
+		{
+			order = std::log2(difCoarse / difFine);
+			extrap = qFine + (1. / (std::pow(2., order) - 1.)) * (qFine - qMid);
+		}
+		return { order, extrap };
+	}
+
+	/*! Error estimates of each rung (fine last) vs extrap (at order).
+	 *
+	 * The finest rung (from which extrap is extrapolated) error is
+	 * estimated as |qFine-qMid|/(2^p-1) (rather than its zero
+	 * difference from an extrap equal to itself). All errors are
+	 * null if the order is null (no evidence of convergence).
+	 */
+	template <typename Type, typename Value>
+	std::vector<double>
+	rungErrors
+		( std::vector<StepStudy::Rung> const & rungs
+		, Value const & value // Rung::*
+		, double const & order
+		, Type const & extrap
+		)
+	{
+		std::vector<double> errs(rungs.size(), null<double>());
+		std::size_t const numRungs{ rungs.size() };
+		if (engabra::g3::isValid(order) && (1u < numRungs))
+		{
+			for (std::size_t nr{0u} ; nr < (numRungs - 1u) ; ++nr)
+			{
+				errs[nr] = difMag(rungs[nr].*value, extrap);
+			}
+			Type const & qMid = rungs[numRungs - 2u].*value;
+			Type const & qFine = rungs[numRungs - 1u].*value;
+			errs[numRungs - 1u]
+				= difMag(qFine, qMid) / (std::pow(2., order) - 1.);
+		}
+		return errs;
+	}
+
+} // [anon]
+
+
+bool
+StepStudy :: Rung :: isValid
+	() const
+{
+	return engabra::g3::isValid(theEndLoc);
+}
+
+StepStudy :: StepStudy
+	( env::IndexVolume const * const & ptMedia
+	, Start const & start
+	, double const & pathLength
+	, double const & coarseStep
+	, std::size_t const & numRungs
+	, StepMethod const & stepMethod
+	, bool const & useAcceleration
+	)
+{
+	if (! (ptMedia && (0. < coarseStep) && (0. < pathLength)))
+	{
+		return;
+	}
+
+	// ladder of step sizes (all to same total path parameter)
+	std::size_t const numCoarse
+		{ static_cast<std::size_t>(std::ceil(pathLength / coarseStep)) };
+	theRungs.resize(numRungs);
+	for (std::size_t nr{0u} ; nr < numRungs ; ++nr)
+	{
+		double const scale{ std::ldexp(1., static_cast<int>(nr)) };
+		theRungs[nr].theStepDist = coarseStep / scale;
+		theRungs[nr].theNumSteps
+			= numCoarse * static_cast<std::size_t>(scale);
+	}
+
+	// trace each rung in parallel
+	std::vector<std::thread> threads;
+	threads.reserve(numRungs);
+	for (Rung & rung : theRungs)
+	{
+		threads.emplace_back
+			(traceRung, ptMedia, start, stepMethod, useAcceleration, &rung);
+	}
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+
+	// estimate order and extrapolate from finest three rungs
+	bool const allValid
+		{ std::all_of
+			( theRungs.cbegin(), theRungs.cend()
+			, [] (Rung const & rung) { return rung.isValid(); }
+			)
+		};
+	if (allValid && (2u < numRungs))
+	{
+		Rung const & rCoarse = theRungs[numRungs - 3u];
+		Rung const & rMid = theRungs[numRungs - 2u];
+		Rung const & rFine = theRungs[numRungs - 1u];
+
+		std::pair<double, Vector> const locEst
+			{ richardson(rCoarse.theEndLoc, rMid.theEndLoc, rFine.theEndLoc) };
+		theLocOrder = locEst.first;
+		theExtrapLoc = locEst.second;
+
+		std::pair<double, double> const devEst
+			{ richardson
+				(rCoarse.theDeviation, rMid.theDeviation, rFine.theDeviation)
+			};
+		theDevOrder = devEst.first;
+		theExtrapDev = devEst.second;
+
+		std::vector<double> const locErrs
+			{ rungErrors
+				(theRungs, &Rung::theEndLoc, theLocOrder, theExtrapLoc)
+			};
+		std::vector<double> const devErrs
+			{ rungErrors
+				(theRungs, &Rung::theDeviation, theDevOrder, theExtrapDev)
+			};
+		for (std::size_t nr{0u} ; nr < numRungs ; ++nr)
+		{
+			theRungs[nr].theLocError = locErrs[nr];
+			theRungs[nr].theDevError = devErrs[nr];
+		}
+	}
+}
+
+bool
+StepStudy :: isValid
+	() const
+{
+	return
+		(  engabra::g3::isValid(theExtrapLoc)
+		&& engabra::g3::isValid(theExtrapDev)
+		);
+}
+
+std::vector<StepStudy::Rung> const &
+StepStudy :: rungs
+	() const
+{
+	return theRungs;
+}
+
+double
+StepStudy :: locOrder
+	() const
+{
+	return theLocOrder;
+}
+
+double
+StepStudy :: devOrder
+	() const
+{
+	return theDevOrder;
+}
+
+engabra::g3::Vector
+StepStudy :: extrapolatedLoc
+	() const
+{
+	return theExtrapLoc;
+}
+
+double
+StepStudy :: extrapolatedDeviation
+	() const
+{
+	return theExtrapDev;
+}
+
+double
+StepStudy :: largestStepFor
+	( double const & locTol
+	, double const & devTol
+	) const
+{
+	double stepDist{ engabra::g3::null<double>() };
+	// deviation error only matters if there is a (finite) tolerance
+	bool const useDev{ std::isfinite(devTol) };
+	if ( isValid()
+	  && engabra::g3::isValid(theLocOrder)
+	  && ((! useDev) || engabra::g3::isValid(theDevOrder))
+	   )
+	{
+		// rungs are in order of decreasing step size
+		for (Rung const & rung : theRungs)
+		{
+			bool const okLoc{ (rung.theLocError <= locTol) };
+			bool const okDev{ (! useDev) || (rung.theDevError <= devTol) };
+			if (okLoc && okDev)
+			{
+				stepDist = rung.theStepDist;
+				break;
+			}
+		}
+	}
+	return stepDist;
+}
+
+std::string
+StepStudy :: infoString
+	( std::string const & title
+	) const
+{
+	using engabra::g3::io::fixed;
+	std::ostringstream oss;
+	if (! title.empty())
+	{
+		oss << title << '\n';
+	}
+	oss << "isValid: " << std::boolalpha << isValid() << '\n';
+	oss << "locOrder: " << fixed(theLocOrder, 2u, 3u)
+		<< "  devOrder: " << fixed(theDevOrder, 2u, 3u) << '\n';
+	oss << "extrapLoc: " << theExtrapLoc << '\n';
+	oss << "extrapDev: " << fixed(theExtrapDev, 1u, 12u) << '\n';
+	oss << "     stepDist   numSteps    numLoops"
+		<< "     locError      devError\n";
+	for (Rung const & rung : theRungs)
+	{
+		oss
+			<< fixed(rung.theStepDist, 6u, 6u)
+			<< ' ' << std::setw(10u) << rung.theNumSteps
+			<< ' ' << std::setw(11u) << rung.theStats.theNumLoops
+			<< ' ' << fixed(rung.theLocError, 3u, 9u)
+			<< ' ' << fixed(rung.theDevError, 1u, 12u)
+			<< '\n';
+	}
+	return oss.str();
+}
+
+
+} // [ray]
+} // [aply]
+
@@ -0,0 +1,613 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Definitions for ray::Stratified
+*/
+
+
+#include "rayStratified.hpp"
+
+#include "mathCrossing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+namespace
+{
+	using namespace engabra::g3;
+
+	//! Value indicating "not inside" a layer
+	constexpr std::size_t sNoLayer{ std::numeric_limits<std::size_t>::max() };
+
+	//! Parameter value for a ray that never reaches a boundary
+	constexpr double sNever{ std::numeric_limits<double>::infinity() };
+
+	//! IoR values from airProfile at each height
+	inline
+	std::vector<double>
+	nusFor
+		( std::vector<double> const & heights
+		, aply::env::AirProfile const & airProfile
+		)
+	{
+		std::vector<double> nus;
+		nus.reserve(heights.size());
+		for (double const & height : heights)
+		{
+			nus.emplace_back(airProfile.indexOfRefraction(height));
+		}
+		return nus;
+	}
+
+	//! Scalar (dot) product of two vectors
+	inline
+	double
+	dotOf
+		( Vector const & aVec
+		, Vector const & bVec
+		)
+	{
+		return (aVec * bVec).theSca[0];
+	}
+
+	//! Unitary direction perpendicular to (unitary) dirUp.
+	inline
+	Vector
+	anyPerpTo
+		( Vector const & dirUp
+		)
+	{
+		Vector rej{ e1 - dotOf(e1, dirUp) * dirUp };
+		if (magnitude(rej) < .5)
+		{
+			rej = e2 - dotOf(e2, dirUp) * dirUp;
+		}
+		return direction(rej);
+	}
+
+	//! asinh(xx)/xx (with value 1 at xx==0)
+	inline
+	double
+	asinhRatio
+		( double const & xx
+		)
+	{
+		double ratio{ 1. };
+		if (1.e-4 < std::abs(xx))
+		{
+			ratio = std::asinh(xx) / xx;
+		}
+		else
+		{
+			ratio = 1. - (1./6.)*xx*xx;
+		}
+		return ratio;
+	}
+
+	/*! \brief Flattened arc length for momentum change from pw0 to pw1.
+	 *
+	 * Arc length is (2/B)*(G(pw1) - G(pw0)) where
+	 * \arg G(q) = (1/2)*(q*sqrt(C^2+q^2) + C^2*asinh(q/C))
+	 *
+	 * For (non zero) pw0, pw1 with the same sign, the differences are
+	 * rearranged algebraically (with B*sigma=2*(pw1-pw0)) such that
+	 * there is no cancellation (even for B=0).
+	 */
+	inline
+	double
+	arcSameSign
+		( double const & cInv
+		, double const & pw0
+		, double const & pw1
+		, double const & sigma
+		)
+	{
+		double const cSq{ cInv * cInv };
+		double const nf0{ std::sqrt(cSq + pw0*pw0) };
+		double arc{ nf0 * sigma };
+		double const sum{ pw0 + pw1 };
+		if (0. != sum)
+		{
+			double const nf1{ std::sqrt(cSq + pw1*pw1) };
+			double const dif{ pw1 - pw0 };
+			double const den1{ pw1*nf1 + pw0*nf0 };
+			double const den2{ pw1*nf0 + pw0*nf1 };
+			double const term1{ sum * (cSq + pw0*pw0 + pw1*pw1) / den1 };
+			double const term2{ cSq * (sum / den2) * asinhRatio(dif*sum/den2) };
+			arc = .5 * sigma * (term1 + term2);
+		}
+		return arc;
+	}
+
+	//! Flattened arc length from parameter 0 to sigma in layer with slope.
+	inline
+	double
+	flatArc
+		( double const & cInv
+		, double const & pw0
+		, double const & slope
+		, double const & sigma
+		)
+	{
+		double arc{ 0. };
+		double const pw1{ pw0 + .5*slope*sigma };
+		if ((pw0 * pw1) < 0.)
+		{
+			// split at turning point
+			double const sigTurn{ -2. * pw0 / slope };
+			arc = arcSameSign(cInv, pw0, 0., sigTurn)
+				+ arcSameSign(cInv, 0., pw1, sigma - sigTurn);
+		}
+		else
+		{
+			arc = arcSameSign(cInv, pw0, pw1, sigma);
+		}
+		return arc;
+	}
+
+	//! Propagate (flattened) ray state by sigma within layer with slope.
+	inline
+	void
+	moveBy
+		( aply::ray::Stratified::RayState * const & ptState
+		, double const & slope
+		, double const & sigma
+		)
+	{
+		ptState->theW += (ptState->thePw + .25*slope*sigma) * sigma;
+		ptState->theU += ptState->theC * sigma;
+		ptState->thePw += .5 * slope * sigma;
+	}
+
+} // [anon]
+
+
+namespace aply
+{
+namespace ray
+{
+
+Stratified :: Stratified
+	( std::vector<double> const & heights
+	, std::vector<double> const & nus
+	, double const & radiusEarth
+	)
+	: theRadius{ radiusEarth }
+	, theWs{}
+	, theQs{}
+	, theSlopes{}
+{
+	bool okay
+		{  (1u < heights.size())
+		&& (heights.size() == nus.size())
+		&& ((! engabra::g3::isValid(theRadius)) || (0. < theRadius))
+		};
+	for (std::size_t ndx{0u} ; okay && (ndx < heights.size()) ; ++ndx)
+	{
+		okay = (0. < nus[ndx]);
+		if (0u < ndx)
+		{
+			okay &= (heights[ndx-1u] < heights[ndx]);
+		}
+	}
+
+	if (okay)
+	{
+		std::size_t const numBounds{ heights.size() };
+		theWs.reserve(numBounds);
+		theQs.reserve(numBounds);
+		for (std::size_t ndx{0u} ; ndx < numBounds ; ++ndx)
+		{
+			double wVal{ heights[ndx] };
+			double nf{ nus[ndx] };
+			if (engabra::g3::isValid(theRadius))
+			{
+				// Earth flattening transformation
+				double const rOverR{ (theRadius + heights[ndx]) / theRadius };
+				wVal = theRadius * std::log(rOverR);
+				nf = nus[ndx] * rOverR;
+			}
+			theWs.emplace_back(wVal);
+			theQs.emplace_back(nf * nf);
+		}
+		theSlopes.reserve(numBounds - 1u);
+		for (std::size_t ndx{1u} ; ndx < numBounds ; ++ndx)
+		{
+			theSlopes.emplace_back
+				( (theQs[ndx] - theQs[ndx-1u])
+				/ (theWs[ndx] - theWs[ndx-1u])
+				);
+		}
+	}
+}
+
+Stratified :: Stratified
+	( std::vector<double> const & heights
+	, env::AirProfile const & airProfile
+	, double const & radiusEarth
+	)
+	: Stratified(heights, nusFor(heights, airProfile), radiusEarth)
+{
+}
+
+bool
+Stratified :: isValid() const
+{
+	return (! theSlopes.empty());
+}
+
+std::size_t
+Stratified :: numLayers() const
+{
+	return theSlopes.size();
+}
+
+std::size_t
+Stratified :: layerIndexFor
+	( double const & wVal
+	) const
+{
+	std::size_t ndx{ sNoLayer };
+	if ((! (wVal < theWs.front())) && (! (theWs.back() < wVal)))
+	{
+		std::vector<double>::const_iterator const itUp
+			{ std::upper_bound(theWs.cbegin(), theWs.cend(), wVal) };
+		ndx = static_cast<std::size_t>(itUp - theWs.cbegin());
+		// upper boundary belongs to the top layer
+		ndx = std::min(ndx, theSlopes.size()) - 1u;
+	}
+	return ndx;
+}
+
+double
+Stratified :: qValueFor
+	( std::size_t const & ndx
+	, double const & wVal
+	) const
+{
+	return (theQs[ndx] + theSlopes[ndx] * (wVal - theWs[ndx]));
+}
+
+double
+Stratified :: scaleFor
+	( double const & wVal
+	) const
+{
+	double scale{ 1. };
+	if (engabra::g3::isValid(theRadius))
+	{
+		scale = std::exp(wVal / theRadius); // r/R
+	}
+	return scale;
+}
+
+double
+Stratified :: arcLengthFor
+	( RayState const & state
+	, double const & sigma
+	) const
+{
+	double const & slope = theSlopes[state.theLayer];
+	double const arcFlat{ flatArc(state.theC, state.thePw, slope, sigma) };
+	// for spherical shells, scale by r/R at parameter mid point
+	double const halfSig{ .5 * sigma };
+	double const wMid
+		{ state.theW + (state.thePw + .25*slope*halfSig) * halfSig };
+	return (scaleFor(wMid) * arcFlat);
+}
+
+double
+Stratified :: sigmaForArc
+	( RayState const & state
+	, double const & arcDist
+	, double const & sigMax
+	) const
+{
+	double const & slope = theSlopes[state.theLayer];
+	double const & cInv = state.theC;
+	double const nf0{ std::sqrt(cInv*cInv + state.thePw*state.thePw) };
+	double sigma{ std::min(sigMax, arcDist / (scaleFor(state.theW) * nf0)) };
+
+	// Newton iteration (arc length is monotonic in sigma)
+	constexpr std::size_t maxLoop{ 16u };
+	constexpr double eps{ std::numeric_limits<double>::epsilon() };
+	for (std::size_t numLoop{0u} ; numLoop < maxLoop ; ++numLoop)
+	{
+		double const resid{ arcLengthFor(state, sigma) - arcDist };
+		double const pwSig{ state.thePw + .5*slope*sigma };
+		double const nfSig{ std::sqrt(cInv*cInv + pwSig*pwSig) };
+		RayState stateSig{ state };
+		moveBy(&stateSig, slope, sigma);
+		double const delta{ resid / (scaleFor(stateSig.theW) * nfSig) };
+		sigma = std::min(sigMax, std::max(0., sigma - delta));
+		if (! (4.*eps*sigma < std::abs(delta)))
+		{
+			break;
+		}
+	}
+	return sigma;
+}
+
+double
+Stratified :: nuValue
+	( engabra::g3::Vector const & rVec
+	) const
+{
+	double nu{ engabra::g3::null<double>() };
+	if (isValid())
+	{
+		double wVal{ rVec[2] };
+		if (engabra::g3::isValid(theRadius))
+		{
+			wVal = theRadius * std::log(magnitude(rVec) / theRadius);
+		}
+		std::size_t const ndx{ layerIndexFor(wVal) };
+		if (sNoLayer != ndx)
+		{
+			nu = std::sqrt(qValueFor(ndx, wVal)) / scaleFor(wVal);
+		}
+	}
+	return nu;
+}
+
+Stratified::RayState
+Stratified :: rayStateFor
+	( Start const & start
+	) const
+{
+	RayState state{};
+	if (isValid())
+	{
+		Vector const & rBeg = start.thePntLoc;
+		Vector const tBeg{ direction(start.theTanDir) };
+
+		// vertical direction and flattened height at start
+		Vector origin{ 0., 0., 0. };
+		Vector dirUp{ e3 };
+		double wBeg{ dotOf(rBeg, e3) };
+		if (engabra::g3::isValid(theRadius))
+		{
+			double const rMag{ magnitude(rBeg) };
+			dirUp = (1./rMag) * rBeg;
+			wBeg = theRadius * std::log(rMag / theRadius);
+		}
+		else
+		{
+			origin = rBeg - wBeg * e3;
+		}
+
+		// decompose tangent into vertical and forward horizontal parts
+		double const tUp{ dotOf(tBeg, dirUp) };
+		Vector const tHor{ tBeg - tUp * dirUp };
+		double const horMag{ magnitude(tHor) };
+		Vector dirFwd{ anyPerpTo(dirUp) };
+		if (0. < horMag)
+		{
+			dirFwd = (1./horMag) * tHor;
+		}
+
+		std::size_t const ndx{ layerIndexFor(wBeg) };
+		if (sNoLayer != ndx)
+		{
+			double const nfBeg{ std::sqrt(qValueFor(ndx, wBeg)) };
+			state.theLayer = ndx;
+			state.theW = wBeg;
+			state.theU = 0.;
+			state.thePw = nfBeg * tUp;
+			state.theC = nfBeg * horMag;
+			state.theOrigin = origin;
+			state.theDirUp = dirUp;
+			state.theDirFwd = dirFwd;
+		}
+	}
+	return state;
+}
+
+bool
+Stratified :: advance
+	( RayState * const & ptState
+	, double const & arcDist
+	) const
+{
+	bool isInside{ ptState && ptState->isInside() };
+	if (isInside)
+	{
+		RayState & state = *ptState;
+		double remDist{ arcDist };
+		std::size_t numStuck{ 0u }; // consecutive zero length crossings
+		while (isInside && (0. < remDist))
+		{
+			std::size_t const ndx{ state.theLayer };
+			double const & wLo = theWs[ndx];
+			double const & wHi = theWs[ndx + 1u];
+			double const & slope = theSlopes[ndx];
+
+			// (roundoff) keep current location within the layer
+			state.theW = std::min(wHi, std::max(wLo, state.theW));
+
+			// parameter at which ray leaves layer through top or bottom
+			double const & pw = state.thePw;
+			double const sigTop
+				{ math::crossingParameter(wHi - state.theW, pw, slope) };
+			double const sigBot
+				{ math::crossingParameter(state.theW - wLo, -pw, -slope) };
+			double const sigExit{ std::min(sigTop, sigBot) };
+
+			double arcExit{ sNever };
+			if (sigExit < sNever)
+			{
+				arcExit = arcLengthFor(state, sigExit);
+			}
+
+			if (2u < numStuck)
+			{
+				// ray is trapped (horizontal) at a boundary with an
+				// IoR maximum - the path follows the boundary
+				double const nf{ std::sqrt(qValueFor(ndx, state.theW)) };
+				double const sigma{ remDist / (scaleFor(state.theW) * nf) };
+				state.theU += state.theC * sigma;
+				remDist = 0.;
+			}
+			else
+			if (arcExit < remDist)
+			{
+				// propagate to boundary and into adjacent layer
+				moveBy(&state, slope, sigExit);
+				remDist -= arcExit;
+				if (sigTop < sigBot)
+				{
+					state.theW = wHi;
+					state.theLayer = ndx + 1u;
+					if (! (state.theLayer < numLayers()))
+					{
+						state.theLayer = sNoLayer;
+					}
+				}
+				else
+				{
+					state.theW = wLo;
+					state.theLayer = sNoLayer;
+					if (0u < ndx)
+					{
+						state.theLayer = ndx - 1u;
+					}
+				}
+				isInside = state.isInside();
+
+				if (0. == sigExit)
+				{
+					++numStuck;
+				}
+				else
+				{
+					numStuck = 0u;
+				}
+			}
+			else
+			{
+				// propagate within this layer
+				double const sigma{ sigmaForArc(state, remDist, sigExit) };
+				moveBy(&state, slope, sigma);
+				remDist = 0.;
+			}
+		}
+	}
+	return isInside;
+}
+
+engabra::g3::Vector
+Stratified :: locationFor
+	( RayState const & state
+	) const
+{
+	Vector loc{ state.theOrigin
+		+ state.theU * state.theDirFwd + state.theW * state.theDirUp };
+	if (engabra::g3::isValid(theRadius))
+	{
+		double const rMag{ theRadius * scaleFor(state.theW) };
+		double const theta{ state.theU / theRadius };
+		Vector const dirRad
+			{ std::cos(theta) * state.theDirUp
+			+ std::sin(theta) * state.theDirFwd
+			};
+		loc = state.theOrigin + rMag * dirRad;
+	}
+	return loc;
+}
+
+engabra::g3::Vector
+Stratified :: tangentFor
+	( RayState const & state
+	) const
+{
+	Vector dirUp{ state.theDirUp };
+	Vector dirFwd{ state.theDirFwd };
+	if (engabra::g3::isValid(theRadius))
+	{
+		// local radial and horizontal directions
+		double const theta{ state.theU / theRadius };
+		double const cosT{ std::cos(theta) };
+		double const sinT{ std::sin(theta) };
+		dirUp = cosT*state.theDirUp + sinT*state.theDirFwd;
+		dirFwd = cosT*state.theDirFwd - sinT*state.theDirUp;
+	}
+	// flattening is conformal - angle from horizontal is unchanged
+	return direction(state.theC * dirFwd + state.thePw * dirUp);
+}
+
+double
+Stratified :: nuFor
+	( RayState const & state
+	) const
+{
+	double nu{ engabra::g3::null<double>() };
+	std::size_t const ndx{ layerIndexFor(state.theW) };
+	if (sNoLayer != ndx)
+	{
+		nu = std::sqrt(qValueFor(ndx, state.theW)) / scaleFor(state.theW);
+	}
+	return nu;
+}
+
+DirChange
+Stratified :: changeFor
+	( RayState const & state
+	) const
+{
+	DirChange change{ Stopped };
+	if (state.isInside())
+	{
+		// IoR increases/decreases along ray with sign of (dn/dw)*(dw/ds)
+		// where n = nf/scale, such that
+		//   dn/dw = (dQ/dw / (2*nf) - nf/R) / scale
+		double const & wVal = state.theW;
+		double const nf{ std::sqrt(qValueFor(state.theLayer, wVal)) };
+		double dnDw{ theSlopes[state.theLayer] / (2.*nf) };
+		if (engabra::g3::isValid(theRadius))
+		{
+			dnDw -= nf / theRadius;
+		}
+		double const rate{ dnDw * state.thePw };
+		change = Unaltered;
+		if (0. < rate)
+		{
+			change = Converged;
+		}
+		else
+		if (rate < 0.)
+		{
+			change = Diverged;
+		}
+	}
+	return change;
+}
+
+} // [ray]
+} // [aply]
+
@@ -0,0 +1,152 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+
+/*! \file
+\brief Definitions for ray::nextTangentDirs()
+*/
+
+
+#include "rayTangentBatch.hpp"
+
+#include <cmath>
+
+
+// Compile the kernel for several instruction sets and select among them
+// (via ifunc) at load time. Only for GNU/Clang on x86_64 ELF targets.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+#	define aply_TargetClones \
+		__attribute__((target_clones("avx512f","avx2","default")))
+#else
+#	define aply_TargetClones
+#endif
+
+
+namespace
+{
+	using aply::ray::DirChange;
+
+	//! Refraction of each entry (ref aply::ray::nextTangentDirs()).
+	aply_TargetClones
+	void
+	tangentKernel
+		( std::size_t const numElem
+		, double const * const __restrict__ tXs
+		, double const * const __restrict__ tYs
+		, double const * const __restrict__ tZs
+		, double const * const __restrict__ gXs
+		, double const * const __restrict__ gYs
+		, double const * const __restrict__ gZs
+		, double const * const __restrict__ nuPrevs
+		, double const * const __restrict__ nuNexts
+		, double * const __restrict__ nXs
+		, double * const __restrict__ nYs
+		, double * const __restrict__ nZs
+		, DirChange * const __restrict__ changes
+		)
+	{
+		using namespace aply::ray;
+
+		// branch free arithmetic (vectorizable)
+		for (std::size_t ndx{0u} ; ndx < numElem ; ++ndx)
+		{
+			double const tx{ tXs[ndx] };
+			double const ty{ tYs[ndx] };
+			double const tz{ tZs[ndx] };
+			double const gx{ gXs[ndx] };
+			double const gy{ gYs[ndx] };
+			double const gz{ gZs[ndx] };
+			double const rho{ nuPrevs[ndx] / nuNexts[ndx] };
+
+			double const gSq{ gx*gx + gy*gy + gz*gz };
+			double const gInv{ 1. / gSq };
+			double const tDotG{ tx*gx + ty*gy + tz*gz };
+			double const cx{ rho * (ty*gz - tz*gy) };
+			double const cy{ rho * (tz*gx - tx*gz) };
+			double const cz{ rho * (tx*gy - ty*gx) };
+			double const radicand{ gSq - (cx*cx + cy*cy + cz*cz) };
+
+			// (NaN radicand propagates through the root as in scalar case)
+			double const rootXi{ std::sqrt((radicand < 0.) ? 0. : radicand) };
+			double const sXi{ (tDotG < 0.) ? -rootXi : rootXi };
+			double const rfX{ gInv * (sXi*gx + rho*(gSq*tx - tDotG*gx)) };
+			double const rfY{ gInv * (sXi*gy + rho*(gSq*ty - tDotG*gy)) };
+			double const rfZ{ gInv * (sXi*gz + rho*(gSq*tz - tDotG*gz)) };
+
+			double const twoDot{ 2. * tDotG * gInv };
+			double const rlX{ tx - twoDot*gx };
+			double const rlY{ ty - twoDot*gy };
+			double const rlZ{ tz - twoDot*gz };
+
+			bool const isStop{ ! (nuPrevs[ndx] == nuPrevs[ndx]) };
+			bool const isReflect{ radicand < 0. };
+			bool const isSame{ isStop || ((! isReflect) && (0. == tDotG)) };
+
+			nXs[ndx] = isSame ? tx : (isReflect ? rlX : rfX);
+			nYs[ndx] = isSame ? ty : (isReflect ? rlY : rfY);
+			nZs[ndx] = isSame ? tz : (isReflect ? rlZ : rfZ);
+
+			DirChange const refract
+				{ (tDotG < 0.) ? Diverged
+				: ((0. < tDotG) ? Converged : Unaltered)
+				};
+			changes[ndx] = isStop ? Stopped
+				: (isReflect ? Reflected : refract);
+		}
+	}
+
+} // [anon]
+
+
+namespace aply
+{
+namespace ray
+{
+
+void
+nextTangentDirs
+	( TangentBatch * const & ptBatch
+	)
+{
+	tangentKernel
+		( ptBatch->size()
+		, ptBatch->theTanX.data()
+		, ptBatch->theTanY.data()
+		, ptBatch->theTanZ.data()
+		, ptBatch->theGradX.data()
+		, ptBatch->theGradY.data()
+		, ptBatch->theGradZ.data()
+		, ptBatch->theNuPrev.data()
+		, ptBatch->theNuNext.data()
+		, ptBatch->theNextX.data()
+		, ptBatch->theNextY.data()
+		, ptBatch->theNextZ.data()
+		, ptBatch->theChanges.data()
+		);
+}
+
+} // [ray]
+} // [aply]
+
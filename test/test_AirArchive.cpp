@@ -0,0 +1,308 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+
+/*! \file
+ *
+ * \brief Unit test for env::AirArchive (and related functions)
+ *
+ */
+
+
+#include "envAirArchive.hpp"
+
+#include "tst.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+
+namespace
+{
+	//! Two (abbreviated) soundings in UWyo data page format.
+	constexpr char sUWyoPages[] =
+R"(
+72562 LBF North Platte Observations at 12Z 09 Jan 2024
+
+-----------------------------------------------------------------------------
+   PRES   HGHT   TEMP   DWPT   RELH   MIXR   DRCT   SKNT   THTA   THTE   THTV
+    hPa     m      C      C      %    g/kg    deg   knot     K      K      K 
+-----------------------------------------------------------------------------
+ 1000.0    136                                                               
+  913.0    849   -8.5  -10.3     87   1.92    325     11  271.6  277.1  271.9
+  908.0    892   -9.7  -13.6     73   1.48    317     14  270.8  275.1  271.1
+  907.0    900   -9.8  -13.6     74   1.48    315     15  270.8  275.1  271.1
+Station information and sounding indices
+                         Station identifier: LBF
+                             Station number: 72562
+
+72469 DNR Denver Observations at 00Z 10 Jan 2024
+
+-----------------------------------------------------------------------------
+   PRES   HGHT   TEMP   DWPT   RELH   MIXR   DRCT   SKNT   THTA   THTE   THTV
+    hPa     m      C      C      %    g/kg    deg   knot     K      K      K 
+-----------------------------------------------------------------------------
+  836.0   1625   -1.1   -9.1     55   2.27    170      6  281.9  288.7  282.3
+  800.0   1971   -4.3  -10.3     63   2.14    200      9  282.2  288.6  282.6
+)";
+
+	//! Check UWyo parsing, archive round trip and random access.
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply::env;
+
+		// [DoxyExample00]
+
+		// parse (many) soundings from text
+		std::istringstream iss(sUWyoPages);
+		std::vector<Sounding> const soundings{ soundingsFromUWyo(iss) };
+
+		// write an indexed binary archive (e.g. once, off-line)
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_AirArchive.aplyair"
+			};
+		bool const okSave{ saveAirArchive(arcPath, soundings) };
+
+		// map the archive and fetch a profile by station and time
+		AirArchive const archive(arcPath);
+		SoundingKey const keyLBF
+			{ 72562u, SoundingKey::timeKeyFor(2024, 1, 9, 12) };
+		AirProfile const profile{ archive.airProfileFor(keyLBF) };
+
+		// [DoxyExample00]
+
+		if (! (2u == soundings.size()))
+		{
+			oss << "Failure of soundings size test\n";
+			oss << "exp: " << 2u << '\n';
+			oss << "got: " << soundings.size() << '\n';
+		}
+		else
+		{
+			Sounding const & sndLBF = soundings.front();
+			if (! (sndLBF.theKey == keyLBF))
+			{
+				oss << "Failure of header key test\n";
+				oss << "exp: " << keyLBF.infoBrief() << '\n';
+				oss << "got: " << sndLBF.theKey.infoBrief() << '\n';
+			}
+			if (! ("LBF" == sndLBF.theStationCode))
+			{
+				oss << "Failure of station code test\n";
+				oss << "got: '" << sndLBF.theStationCode << "'\n";
+			}
+			if (! (3u == sndLBF.theAirInfoMap.size()))
+			{
+				oss << "Failure of sounding record count test\n";
+				oss << "got: " << sndLBF.theAirInfoMap.size() << '\n';
+			}
+		}
+
+		if (! (okSave && archive.isValid() && (2u == archive.size())))
+		{
+			oss << "Failure of archive save/open test\n";
+			oss << archive.infoString("archive") << '\n';
+		}
+
+		// check that archive sorted index (by station id)
+		if (archive.isValid() && (2u == archive.size()))
+		{
+			if (! (72469u == archive.entryAt(0u).theStationId))
+			{
+				oss << "Failure of archive index order test\n";
+				oss << archive.infoString("archive") << '\n';
+			}
+			if (! ("DNR" == archive.entryAt(0u).stationCode()))
+			{
+				oss << "Failure of archive station code test\n";
+				oss << archive.infoString("archive") << '\n';
+			}
+		}
+
+		// compare archived profile with original values
+		if (! profile.isValid())
+		{
+			oss << "Failure of valid archive profile test\n";
+		}
+		else
+		{
+			AirProfile const expProfile{ soundings.front().theAirInfoMap };
+			constexpr double high{ 870. };
+			double const expIoR{ expProfile.indexOfRefraction(high) };
+			double const gotIoR{ profile.indexOfRefraction(high) };
+			tst::checkGotExp(oss, gotIoR, expIoR, "archive IoR");
+
+			AirInfo const expInfo{ expProfile.airInfoAtHeight(high) };
+			AirInfo const gotInfo{ profile.airInfoAtHeight(high) };
+			tst::checkGotExp(oss, gotInfo.theRelH, expInfo.theRelH, "RelH");
+		}
+
+		// check behavior for missing data
+		SoundingKey const keyBad
+			{ 72562u, SoundingKey::timeKeyFor(2024, 1, 10, 0) };
+		if (archive.profileViewFor(keyBad).isValid())
+		{
+			oss << "Failure of missing key test\n";
+		}
+		AirArchive const noArchive(arcPath.string() + ".doesNotExist");
+		if (noArchive.isValid() || noArchive.airProfileFor(keyLBF).isValid())
+		{
+			oss << "Failure of missing archive test\n";
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+	//! Check handling of corrupted (truncated) archive file.
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply::env;
+
+		std::istringstream iss(sUWyoPages);
+		std::vector<Sounding> const soundings{ soundingsFromUWyo(iss) };
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_AirArchive_trunc.aplyair"
+			};
+		saveAirArchive(arcPath, soundings);
+		std::filesystem::resize_file
+			(arcPath, std::filesystem::file_size(arcPath) - 8u);
+
+		AirArchive const archive(arcPath);
+		if (archive.isValid())
+		{
+			oss << "Failure of truncated archive test\n";
+			oss << archive.infoString("truncated archive") << '\n';
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+	//! Value of 8 bytes at offset in file
+	std::uint64_t
+	valueAt
+		( std::filesystem::path const & filePath
+		, std::uint64_t const & offset
+		)
+	{
+		std::uint64_t value{ 0u };
+		std::ifstream ifs(filePath, std::ios::binary);
+		ifs.seekg(static_cast<std::streamoff>(offset));
+		ifs.read(reinterpret_cast<char *>(&value), sizeof(value));
+		return value;
+	}
+
+	//! Overwrite 8 bytes at offset in file with value
+	void
+	patchFile
+		( std::filesystem::path const & filePath
+		, std::uint64_t const & offset
+		, std::uint64_t const & value
+		)
+	{
+		std::fstream strm
+			(filePath, std::ios::in | std::ios::out | std::ios::binary);
+		strm.seekp(static_cast<std::streamoff>(offset));
+		strm.write(reinterpret_cast<char const *>(&value), sizeof(value));
+	}
+
+	//! Check that sizes which would wrap around are rejected.
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply::env;
+
+		std::istringstream iss(sUWyoPages);
+		std::vector<Sounding> const soundings{ soundingsFromUWyo(iss) };
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_AirArchive_corrupt.aplyair"
+			};
+
+		// header: theMagic, theNumEntries, theIndexOffset, theDataOffset
+		// entry: id, code, theTimeKey, theDataOffset, theNumLevels
+		constexpr std::uint64_t wrap32{ std::uint64_t{ 1u } << 59u };
+
+		// entry count for which index size (32 bytes each) wraps
+		saveAirArchive(arcPath, soundings);
+		std::uint64_t const numEntries{ valueAt(arcPath, 8u) };
+		std::uint64_t const indexBeg{ valueAt(arcPath, 16u) };
+		patchFile(arcPath, 8u, numEntries + wrap32);
+		AirArchive const badIndex(arcPath);
+		if (badIndex.isValid())
+		{
+			oss << "Failure of wrapped entry count test\n";
+		}
+
+		// level count for which data size (4 doubles each) wraps
+		saveAirArchive(arcPath, soundings);
+		std::uint64_t const numLevels{ valueAt(arcPath, indexBeg + 24u) };
+		patchFile(arcPath, indexBeg + 24u, numLevels + wrap32);
+		AirArchive const badLevels(arcPath);
+		if (badLevels.isValid())
+		{
+			oss << "Failure of wrapped level count test\n";
+		}
+
+		// data offset within header
+		saveAirArchive(arcPath, soundings);
+		patchFile(arcPath, indexBeg + 16u, 0u);
+		AirArchive const badData(arcPath);
+		if (badData.isValid())
+		{
+			oss << "Failure of data offset test\n";
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+}
+
+
+/*! \brief Unit test for env::AirArchive
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+	test2(oss);
+
+	return tst::finish(oss);
+}
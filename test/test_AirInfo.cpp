@@ -34,6 +34,8 @@
 
 #include "tst.hpp"
 
+#include <Engabra>
+
 #include <sstream>
 
 
@@ -108,6 +110,26 @@ namespace
 std::cout << "uwyoLine: " << info << std::endl;
 
 	}
+
+	//! Check group to phase refractivity ratio
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply::env;
+
+		// values from the (independent) Edlen 1966 dispersion formula
+		constexpr double tol{ 1.e-4 };
+		tst::checkGotExp
+			(oss, ior::groupRatio(1.064), 1.01002, "groupRatio(1.064)", tol);
+		tst::checkGotExp
+			(oss, ior::groupRatio(.532), 1.04146, "groupRatio(.532)", tol);
+
+		// negligible dispersion at long wavelengths
+		tst::checkGotExp
+			(oss, ior::groupRatio(1.e3), 1., "groupRatio(1e3)", 1.e-6);
+	}
 }
 
 
@@ -120,6 +142,7 @@ main
 	std::ostringstream oss;
 
 	test0(oss);
+	test1(oss);
 
 	return tst::finish(oss);
 }
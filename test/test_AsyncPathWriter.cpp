@@ -0,0 +1,236 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::AsyncPathWriter (and ray::PathRing)
+ *
+ */
+
+
+#include "rayAsyncPathWriter.hpp"
+
+#include "tst.hpp"
+
+#include "rayPathArchive.hpp"
+#include "rayStratified.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Check single producer, single consumer queue semantics
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		ray::PathRing ring(3u);
+
+		std::size_t numPushed{ 0u };
+		for (std::size_t nn{0u} ; nn < 5u ; ++nn)
+		{
+			ray::PathRecord record{ nn, e1, zero<Vector>(), {} };
+			for (std::size_t kk{0u} ; kk < nn ; ++kk)
+			{
+				record.theNodes.emplace_back
+					(ray::Node{ e1, 1., zero<Vector>(), 1., e1, ray::Null });
+			}
+			if (ring.tryPush(std::move(record)))
+			{
+				++numPushed;
+			}
+		}
+		if (! (ring.capacity() == numPushed))
+		{
+			oss << "Failure of full ring test\n";
+			oss << "exp: " << ring.capacity() << '\n';
+			oss << "got: " << numPushed << '\n';
+		}
+
+		ray::PathRecord got{};
+		for (std::size_t nn{0u} ; nn < numPushed ; ++nn)
+		{
+			bool const okPop{ ring.tryPop(&got) };
+			if (! (okPop && (nn == got.theSeq) && (nn == got.theNodes.size())))
+			{
+				oss << "Failure of ring pop order test, nn: " << nn << '\n';
+			}
+		}
+		if (ring.tryPop(&got))
+		{
+			oss << "Failure of empty ring test\n";
+		}
+	}
+
+	//! Check deterministic archive content from several tracing threads
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		std::vector<double> const heights{ 0., 1., 2.5, 4., 10. };
+		std::vector<double> nus;
+		for (double const & height : heights)
+		{
+			nus.emplace_back(std::sqrt(2.25 - .01*height));
+		}
+		ray::Stratified const media(heights, nus);
+
+		constexpr std::size_t numRays{ 64u };
+		std::vector<ray::Start> starts;
+		for (std::size_t nn{0u} ; nn < numRays ; ++nn)
+		{
+			double const elev{ .01 + .002*static_cast<double>(nn) };
+			Vector const tBeg{ std::cos(elev), 0., std::sin(elev) };
+			starts.emplace_back(ray::Start{ tBeg, zero<Vector>() });
+		}
+		constexpr double nodeDist{ .25 };
+		constexpr std::size_t maxNodes{ 4096u };
+
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_AsyncPathWriter.aplyray"
+			};
+
+		// [DoxyExample01]
+
+		// one queue per tracing thread (small queues apply backpressure)
+		constexpr std::size_t numThreads{ 4u };
+		constexpr std::size_t ringSize{ 2u };
+		constexpr std::size_t reorderWindow{ 8u };
+		ray::AsyncPathWriter writer
+			(arcPath, numThreads, ringSize, false, reorderWindow);
+
+		// e.g. each thread traces a contiguous block of rays (ascending)
+		constexpr std::size_t numPer{ numRays / numThreads };
+		auto const traceRays
+			{ [&] (std::size_t const & thNdx)
+				{
+					std::size_t const nBeg{ thNdx * numPer };
+					for (std::size_t nn{nBeg} ; nn < (nBeg + numPer) ; ++nn)
+					{
+						// stream hands off path when it goes out of scope
+						ray::AsyncPathStream stream
+							(starts[nn], &writer, thNdx, nn, maxNodes);
+						media.tracePath(&stream, nodeDist);
+					}
+				}
+			};
+		std::vector<std::thread> threads;
+		for (std::size_t thNdx{0u} ; thNdx < numThreads ; ++thNdx)
+		{
+			threads.emplace_back(traceRays, thNdx);
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+
+		// write remaining paths and close archive (rays in seq order)
+		bool const okFinish{ writer.finish() };
+
+		// [DoxyExample01]
+
+		if (! (okFinish && (numRays == writer.numWritten())))
+		{
+			oss << "Failure of finish test\n";
+			oss << "numWritten: " << writer.numWritten() << '\n';
+		}
+
+		// blocks far ahead in sequence wait rather than being held
+		if (! (writer.maxNumHeld() < reorderWindow))
+		{
+			oss << "Failure of bounded reorder test\n";
+			oss << "maxNumHeld: " << writer.maxNumHeld() << '\n';
+		}
+
+		ray::PathArchive const archive(arcPath);
+		if (! (archive.isValid() && (numRays == archive.size())))
+		{
+			oss << "Failure of async archive test\n";
+			oss << archive.infoString("archive") << '\n';
+		}
+		else
+		{
+			// archive order matches sequence (compare with direct trace)
+			std::size_t numBad{ 0u };
+			for (std::size_t nn{0u} ; nn < numRays ; ++nn)
+			{
+				std::vector<ray::Node> const gotNodes{ archive.nodesAt(nn) };
+				ray::PathStream expPath(starts[nn], nullptr, maxNodes);
+				media.tracePath(&expPath, nodeDist);
+				ray::Start const gotStart{ archive.entryAt(nn).start() };
+				bool const same
+					{  (expPath.size() == gotNodes.size())
+					&& (starts[nn].theTanDir[2] == gotStart.theTanDir[2])
+					&& (0. < gotNodes.back().theCurrLoc[0])
+					};
+				if (! same)
+				{
+					++numBad;
+				}
+			}
+			if (0u < numBad)
+			{
+				oss << "Failure of archive order test\n";
+				oss << "numBad: " << numBad << '\n';
+			}
+		}
+
+		if (writer.push(0u, numRays, starts.front(), {}))
+		{
+			oss << "Failure of push after finish test\n";
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+}
+
+
+/*! \brief Unit test for ray::AsyncPathWriter (and ray::PathRing)
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
@@ -0,0 +1,165 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for math::Dual and env::AutoDiffVolume
+ *
+ */
+
+
+#include "envAutoDiffVolume.hpp"
+#include "mathDual.hpp"
+
+#include "tst.hpp"
+
+#include "example/indexModel.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <sstream>
+
+
+namespace
+{
+	//! Smooth IoR blob: nu = 1 + amp*exp(-|r-c|^2/wid^2) / (1+|r|^2)
+	struct Blob : public aply::env::AutoDiffVolume<Blob>
+	{
+		engabra::g3::Vector const theCenter{ .25, -.5, .75 };
+
+		//! IoR expression (written once for double and math::Dual)
+		template <typename Scalar>
+		inline
+		Scalar
+		nuValueOf
+			( aply::math::Vec3<Scalar> const & rVec
+			) const
+		{
+			namespace math = aply::math;
+			math::Vec3<Scalar> const delta
+				{ math::difference(rVec, theCenter) };
+			Scalar const arg{ -math::magSq(delta) / 4. };
+			return 1. + .125 * math::exp(arg) / (1. + math::magSq(rVec))
+				+ .001 * math::log(1. + math::magnitude(rVec));
+		}
+
+	}; // Blob
+
+	//! Check Dual arithmetic
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// [DoxyExample01]
+
+		// independent variable (d/dx) at x = 2.
+		using aply::math::Dual;
+		Dual const xx{ Dual::variable(2., 0u) };
+
+		// any expression of (overloaded) operations and functions
+		Dual const ff{ (xx * xx + 3.) / aply::math::sqrt(xx) };
+
+		// ff.theValue is the value, ff.theGrad[0] is df/dx
+		double const gotVal{ ff.theValue };
+		double const gotDer{ ff.theGrad[0] };
+
+		// [DoxyExample01]
+
+		// f = (x^2+3)/sqrt(x) = x^1.5 + 3x^-.5
+		double const expVal{ std::pow(2., 1.5) + 3./std::sqrt(2.) };
+		double const expDer{ 1.5*std::sqrt(2.) - 1.5*std::pow(2., -1.5) };
+		tst::checkGotExp(oss, gotVal, expVal, "Dual value");
+		tst::checkGotExp(oss, gotDer, expDer, "Dual deriv", 1.e-15);
+
+		// other partials are zero for expression in one variable
+		if (! ((0. == ff.theGrad[1]) && (0. == ff.theGrad[2])))
+		{
+			oss << "Failure of Dual zero partials test\n";
+		}
+
+		// exp/log chain rule
+		Dual const gg{ aply::math::log(aply::math::exp(-xx) + 1.) };
+		double const expG{ -std::exp(-2.) / (std::exp(-2.) + 1.) };
+		tst::checkGotExp(oss, gg.theGrad[0], expG, "exp/log deriv", 1.e-15);
+	}
+
+	//! Check AutoDiffVolume gradient against finite difference
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace engabra::g3;
+
+		// [DoxyExample02]
+
+		// Blob provides only a generic nuValueOf() (ref above)
+		Blob const blob{};
+		Vector const rVec{ .5, .25, -.125 };
+
+		// value and exact gradient (stepSize argument is not used)
+		double const nu{ blob.nuValue(rVec) };
+		Vector const grad{ blob.nuGradient(rVec, 0.) };
+
+		// [DoxyExample02]
+
+		// compare with (default) finite difference gradient
+		Vector const expGrad
+			{ blob.aply::env::IndexVolume::nuGradient(rVec, 1.e-4) };
+		tst::checkGotExp(oss, grad, expGrad, "blob gradient", 1.e-9);
+
+		double const expNu{ blob.nuValueOf(aply::math::vec3Of(rVec)) };
+		tst::checkGotExp(oss, nu, expNu, "blob value");
+
+		// ported atmosphere model
+		aply::env::index::AtmModel const atm(aply::env::sEarth);
+		double const radMid{ aply::env::sEarth.theRadGround + 5000. };
+		Vector const rAtm{ radMid * direction(e1 + 2.*e2 + 3.*e3) };
+		Vector const gotAtm{ atm.nuGradient(rAtm, 0.) };
+		Vector const fdAtm
+			{ atm.aply::env::IndexVolume::nuGradient(rAtm, 1.) };
+		// (compare relative to gradient magnitude ~ 1e-8)
+		double const scale{ 1. / magnitude(fdAtm) };
+		tst::checkGotExp
+			(oss, scale*gotAtm, scale*fdAtm, "atm gradient", 1.e-6);
+	}
+
+}
+
+/*! \brief Unit test for math::Dual and env::AutoDiffVolume
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // dual number arithmetic
+	test1(oss); // gradient vs finite difference
+
+	return tst::finish(oss);
+}
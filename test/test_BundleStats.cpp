@@ -0,0 +1,236 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::BundleStats (and math::RunningStats)
+ *
+ */
+
+
+#include "rayBundleStats.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Check running and merged statistics with simple samples
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// samples 1, 2, ... 10 : mean 5.5, variance 55/6
+		math::RunningStats allStats{};
+		math::RunningStats lowStats{};
+		math::RunningStats highStats{};
+		math::Histogram hist(0., 5., 5u);
+		for (std::size_t nn{1u} ; nn <= 10u ; ++nn)
+		{
+			double const value{ static_cast<double>(nn) };
+			allStats.add(value);
+			if (nn < 4u)
+			{
+				lowStats.add(value);
+			}
+			else
+			{
+				highStats.add(value);
+			}
+			hist.add(value);
+		}
+		lowStats.merge(highStats);
+
+		constexpr double tol{ 1.e-15 };
+		tst::checkGotExp(oss, allStats.mean(), 5.5, "mean", tol);
+		tst::checkGotExp(oss, allStats.variance(), 55./6., "variance", tol);
+		tst::checkGotExp(oss, lowStats.mean(), 5.5, "merged mean", tol);
+		tst::checkGotExp
+			(oss, lowStats.variance(), 55./6., "merged variance", tol);
+		if (! ((1. == lowStats.theMin) && (10. == lowStats.theMax)))
+		{
+			oss << "Failure of merged range test\n";
+		}
+
+		// bins [0,1) ... [4,5) contain 1,2,3,4 (values 5..10 over)
+		std::size_t const numIn
+			{ std::accumulate(hist.theCounts.cbegin(), hist.theCounts.cend()
+				, std::size_t{ 0u })
+			};
+		if (! ( (0u == hist.theCounts[0]) && (1u == hist.theCounts[4])
+			 && (4u == numIn) && (6u == hist.theNumOver)
+			  ))
+		{
+			oss << "Failure of histogram count test\n";
+		}
+	}
+
+	//! Check per-thread accumulation (merged) against serial result
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		ray::Propagator const prop{ &media, 10. };
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+		constexpr std::size_t numRays{ 64u };
+		constexpr std::size_t maxNodes{ 500u };
+		std::vector<ray::Start> starts;
+		for (std::size_t nn{0u} ; nn < numRays ; ++nn)
+		{
+			double const elev{ .01 + .001*static_cast<double>(nn) };
+			starts.emplace_back(ray::Start::from(Vector{ 1., 0., elev }, rBeg));
+		}
+		constexpr double maxDev{ 2.e-4 };
+		constexpr double maxDefl{ .5 };
+
+		// serial accumulation
+		ray::BundleStats expStats(maxDev, maxDefl);
+		for (ray::Start const & start : starts)
+		{
+			ray::PathSummary summary(start, maxNodes);
+			prop.tracePath(&summary);
+			expStats.add(summary);
+		}
+
+		// [DoxyExample01]
+
+		// each thread accumulates (constant memory) into its own stats
+		constexpr std::size_t numThreads{ 4u };
+		std::vector<ray::BundleStats> threadStats
+			(numThreads, ray::BundleStats(maxDev, maxDefl));
+		std::vector<std::thread> threads;
+		for (std::size_t nt{0u} ; nt < numThreads ; ++nt)
+		{
+			threads.emplace_back
+				( [&, nt] ()
+					{
+						std::size_t nn{ nt };
+						for ( ; nn < numRays ; nn += numThreads)
+						{
+							ray::PathSummary summary(starts[nn], maxNodes);
+							prop.tracePath(&summary);
+							threadStats[nt].add(summary);
+						}
+					}
+				);
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+
+		// combine per-thread results
+		ray::BundleStats gotStats(maxDev, maxDefl);
+		for (ray::BundleStats const & stats : threadStats)
+		{
+			gotStats.merge(stats);
+		}
+
+		// [DoxyExample01]
+
+		math::Histogram const & gotDevs = gotStats.theDevHist;
+		math::Histogram const & gotDefls = gotStats.theDeflHist;
+		if (! ( (numRays == gotStats.theNumRays)
+			 && (0u == gotStats.theNumEmpty)
+			 && (gotDevs.theCounts == expStats.theDevHist.theCounts)
+			 && (gotDefls.theCounts == expStats.theDeflHist.theCounts)
+			 && (0u == gotDevs.theNumOver)
+			 && (0u == gotDefls.theNumOver)
+			  ))
+		{
+			oss << "Failure of merged count test\n";
+			oss << gotStats.infoString("gotStats") << '\n';
+			oss << expStats.infoString("expStats") << '\n';
+		}
+		constexpr double tol{ 1.e-12 };
+		tst::checkGotExp
+			( oss, gotStats.theDeviations.mean(), expStats.theDeviations.mean()
+			, "deviation mean", tol
+			);
+		tst::checkGotExp
+			( oss, gotStats.theDeflections.stdDev()
+			, expStats.theDeflections.stdDev()
+			, "deflection stdDev", tol
+			);
+		tst::checkGotExp
+			( oss, gotStats.thePathDists.mean(), expStats.thePathDists.mean()
+			, "pathDist mean", tol
+			);
+
+		// different bins are not merged
+		if (gotStats.merge(ray::BundleStats(maxDev, maxDefl, 8u)))
+		{
+			oss << "Failure of bin mismatch merge test\n";
+		}
+
+		// nothing is merged if only the deflection bins differ
+		ray::BundleStats otherStats(maxDev, 2.*maxDefl);
+		ray::PathSummary summary(starts.front(), maxNodes);
+		prop.tracePath(&summary);
+		otherStats.add(summary);
+		std::vector<std::size_t> const devCounts
+			{ gotStats.theDevHist.theCounts };
+		if ( gotStats.merge(otherStats)
+		  || (numRays != gotStats.theNumRays)
+		  || (devCounts != gotStats.theDevHist.theCounts)
+		   )
+		{
+			oss << "Failure of partial bin mismatch merge test\n";
+		}
+	}
+
+}
+
+
+/*! \brief Unit test for ray::BundleStats
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
@@ -0,0 +1,200 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::Checkpoint (and Propagator::continuePath())
+ *
+ */
+
+
+#include "rayCheckpoint.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include <Engabra>
+
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! True if paths have identical nodes and arc distances
+	bool
+	samePath
+		( ray::Path const & gotPath
+		, ray::Path const & expPath
+		)
+	{
+		bool same
+			{  (gotPath.theNodes.size() == expPath.theNodes.size())
+			&& (gotPath.theArcDists == expPath.theArcDists)
+			&& (gotPath.theOptDists == expPath.theOptDists)
+			};
+		for (std::size_t nn{0u} ; same && (nn < gotPath.size()) ; ++nn)
+		{
+			ray::Node const & gotNode = gotPath.theNodes[nn];
+			ray::Node const & expNode = expPath.theNodes[nn];
+			Vector const & gotLoc = gotNode.theCurrLoc;
+			Vector const & expLoc = expNode.theCurrLoc;
+			Vector const & gotTan = gotNode.theNextTan;
+			Vector const & expTan = expNode.theNextTan;
+			same =
+				(  (gotLoc[0] == expLoc[0])
+				&& (gotLoc[1] == expLoc[1])
+				&& (gotLoc[2] == expLoc[2])
+				&& (gotTan[0] == expTan[0])
+				&& (gotTan[1] == expTan[1])
+				&& (gotTan[2] == expTan[2])
+				&& (gotNode.theNextNu == expNode.theNextNu)
+				&& (gotNode.theDirChange == expNode.theDirChange)
+				);
+		}
+		return same;
+	}
+
+	//! Check that extended and resumed paths match uninterrupted trace
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		constexpr double stepDist{ 10. };
+		ray::Propagator const prop{ &media, stepDist };
+
+		// low elevation ray in the (strongly curving) lower atmosphere
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .02 }, rBeg) };
+		constexpr double saveDist{ 35. };
+		constexpr std::size_t numSave{ 600u };
+
+		// uninterrupted trace
+		ray::Path expPath(start, saveDist);
+		expPath.reserve(numSave);
+		ray::LoopStats expStats{};
+		prop.tracePath(&expPath, &expStats);
+
+		// extend an existing path (without re-tracing from start)
+		ray::Path extPath(start, saveDist);
+		extPath.reserve(numSave / 3u);
+		ray::Propagator::TraceState extState{ prop.traceStateFor(start) };
+		prop.continuePath(&extPath, &extState);
+		extPath.reserve(numSave);
+		prop.continuePath(&extPath, &extState);
+
+		if (! samePath(extPath, expPath))
+		{
+			oss << "Failure of extended path test\n";
+			oss << extPath.infoString("extPath") << '\n';
+			oss << expPath.infoString("expPath") << '\n';
+		}
+
+		std::filesystem::path const checkPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_Checkpoint.aplyckp"
+			};
+
+		// [DoxyExample01]
+
+		// trace in chunks (of steps) and save checkpoint after each
+		constexpr std::size_t chunkSteps{ 500u };
+		{
+			ray::Path path(start, saveDist);
+			path.reserve(numSave);
+			ray::LoopStats stats{};
+			ray::Propagator::TraceState state{ prop.traceStateFor(start) };
+			for (std::size_t nc{0u} ; nc < 3u ; ++nc) // ... interrupted
+			{
+				prop.continuePath(&path, &state, &stats, chunkSteps);
+				ray::Checkpoint::from(path, state, stats).save(checkPath);
+			}
+		}
+
+		// (e.g. after restart) resume from last checkpoint
+		ray::Checkpoint const check{ ray::Checkpoint::load(checkPath) };
+		ray::Path path{ check.path() };
+		ray::Propagator::TraceState state{ check.theTraceState };
+		ray::LoopStats stats{ check.theStats };
+		prop.continuePath(&path, &state, &stats);
+
+		// [DoxyExample01]
+
+		std::size_t const & checkSteps = check.theStats.theNumSteps;
+		if (! (check.isValid() && ((3u*chunkSteps) == checkSteps)))
+		{
+			oss << "Failure of loaded checkpoint test\n";
+			oss << check.infoString("check") << '\n';
+		}
+		if (! samePath(path, expPath))
+		{
+			oss << "Failure of resumed path test\n";
+			oss << path.infoString("path") << '\n';
+			oss << expPath.infoString("expPath") << '\n';
+		}
+		if (! ( (stats.theNumSteps == expStats.theNumSteps)
+			 && (stats.theNumLoops == expStats.theNumLoops)
+			  ))
+		{
+			oss << "Failure of resumed stats test\n";
+			oss << "exp: " << expStats.theNumSteps << '\n';
+			oss << "got: " << stats.theNumSteps << '\n';
+		}
+
+		// truncated checkpoint is rejected
+		std::filesystem::resize_file
+			(checkPath, std::filesystem::file_size(checkPath) - 8u);
+		if (ray::Checkpoint::load(checkPath).isValid())
+		{
+			oss << "Failure of truncated checkpoint test\n";
+		}
+
+		std::filesystem::remove(checkPath);
+	}
+
+}
+
+
+/*! \brief Unit test for ray::Checkpoint
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+
+	return tst::finish(oss);
+}
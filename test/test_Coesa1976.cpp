@@ -0,0 +1,175 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for analytic atmosphere model env::coesa
+ *
+ */
+
+
+#include "envCoesa1976.hpp"
+
+#include "tst.hpp"
+
+#include <Engabra>
+
+#include <array>
+#include <cmath>
+#include <sstream>
+
+
+namespace
+{
+
+	//! Check values against published US Standard Atmosphere 1976 table
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// [DoxyExample01]
+
+		// model values at any geometric height (-5km to 86km)
+		double const height{ 1000. };
+		aply::env::AirInfo const info{ aply::env::coesa::airInfoAt(height) };
+		double const nu{ aply::env::coesa::indexOfRefraction(height) };
+		double const dNuDh{ aply::env::coesa::indexGradient(height) };
+
+		// or as an AirProfile (e.g. for use with ray::Refraction)
+		aply::env::AirProfile const profile{ aply::env::coesa::airProfile() };
+		double const nuProfile{ profile.indexOfRefraction(height) };
+
+		// [DoxyExample01]
+
+		tst::checkGotExp(oss, info.theTemp, 281.651, "temp 1km", 1.e-3);
+		tst::checkGotExp(oss, info.thePres, 89874.6, "pres 1km", 1.e-1);
+		tst::checkGotExp(oss, nuProfile, nu, "profile nu", 0.);
+		if (! (dNuDh < 0.))
+		{
+			oss << "Failure of dNuDh sign test\n";
+			oss << "dNuDh: " << dNuDh << '\n';
+		}
+
+		// geometric height, temperature [K], pressure [Pa]
+		struct Sample { double theHigh, theTemp, thePres; };
+		constexpr std::array<Sample, 6u> samples
+			{{ {     0., 288.150, 101325.   }
+			 , { 11000., 216.774,  22699.9  }
+			 , { 20000., 216.650,   5529.3  }
+			 , { 32000., 228.490,    889.06 }
+			 , { 50000., 270.650,     79.779}
+			 , { 80000., 198.639,     1.0524 }
+			}};
+		for (Sample const & sample : samples)
+		{
+			aply::env::AirInfo const got
+				{ aply::env::coesa::airInfoAt(sample.theHigh) };
+			double const tolPres{ 1.e-4 * sample.thePres };
+			tst::checkGotExp(oss, got.theTemp, sample.theTemp, "temp", 1.e-3);
+			tst::checkGotExp(oss, got.thePres, sample.thePres, "pres", tolPres);
+		}
+
+		// outside of model range
+		double const nuAbove{ aply::env::coesa::indexOfRefraction(86001.) };
+		double const nuBelow{ aply::env::coesa::indexOfRefraction(-5001.) };
+		if (engabra::g3::isValid(nuAbove) || engabra::g3::isValid(nuBelow))
+		{
+			oss << "Failure of out of range null test\n";
+			oss << "nuAbove: " << nuAbove << '\n';
+			oss << "nuBelow: " << nuBelow << '\n';
+		}
+	}
+
+	//! Check gradient and continuity
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply::env::coesa;
+
+		// analytic gradient agrees with finite difference
+		constexpr double del{ .5 };
+		for (double height{-4000.} ; height < 85000. ; height += 1234.5)
+		{
+			double const expGrad
+				{ (indexOfRefraction(height + del)
+				 - indexOfRefraction(height - del)) / (2.*del)
+				};
+			double const gotGrad{ indexGradient(height) };
+			double const tol{ 1.e-6 * std::abs(expGrad) + 1.e-15 };
+			tst::checkGotExp(oss, gotGrad, expGrad, "indexGradient", tol);
+		}
+
+		// values are continuous across layer boundaries
+		for (double const & breakHigh : sBreakHeights)
+		{
+			double const nuLo{ indexOfRefraction(breakHigh - 1.e-6) };
+			double const nuHi{ indexOfRefraction(breakHigh + 1.e-6) };
+			tst::checkGotExp(oss, nuHi, nuLo, "break continuity", 1.e-13);
+		}
+
+		// agreement with tabulated values (within their precision)
+		aply::env::AirProfile const tabProfile
+			{ aply::env::sAirInfoCoesa1976 };
+		for (double height{0.} ; height < 20000. ; height += 1000.)
+		{
+			double const expNu{ tabProfile.indexOfRefraction(height) };
+			double const gotNu{ indexOfRefraction(height) };
+			tst::checkGotExp(oss, gotNu, expNu, "vs table", 2.e-7);
+		}
+
+		// radial index volume
+		double const radEarth{ aply::env::sEarth.theRadGround };
+		AirVolume const volume(radEarth);
+		using engabra::g3::e1;
+		using engabra::g3::e3;
+		engabra::g3::Vector const rVec{ (radEarth + 5000.) * e3 + 10.*e1 };
+		double const rMag{ engabra::g3::magnitude(rVec) };
+		double const gotNu{ volume.nuValue(rVec) };
+		double const expNu{ indexOfRefraction(rMag - radEarth) };
+		tst::checkGotExp(oss, gotNu, expNu, "volume nu", 0.);
+		engabra::g3::Vector const gotGrad{ volume.nuGradient(rVec, 1.) };
+		engabra::g3::Vector const expGrad
+			{ volume.aply::env::IndexVolume::nuGradient(rVec, 1.) };
+		tst::checkGotExp(oss, gotGrad, expGrad, "volume grad", 1.e-13);
+	}
+
+}
+
+/*! \brief Unit test for env::coesa analytic atmosphere model
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // standard table values
+	test1(oss); // gradient, continuity, volume
+
+	return tst::finish(oss);
+}
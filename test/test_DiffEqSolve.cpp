@@ -31,6 +31,8 @@
 
 
 #include "mathDiffEqSolve.hpp"
+#include "mathDiffEqSolveDP45.hpp"
+#include "mathDiffEqSolveRK4.hpp"
 #include "mathDiffEqSystem.hpp"
 
 #include "../example/diffeqSystem.hpp"
@@ -139,6 +141,223 @@ namespace
 		}
 	}
 
+	//! Check fixed dimension solver against original (vector) solver.
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		// initial conditions
+		constexpr double t0{  1.25 };
+		constexpr double h0{ 10. };
+		constexpr double v0{  3.5 };
+
+		// end point of integration for this test
+		constexpr double t1{  2.1 + t0 };
+		constexpr double stepSize{ .001 };
+
+		using aply::examp::diffeq::UniformAccel;
+		UniformAccel const uniAccelEquations(t0, h0, v0);
+
+		// [DoxyExample01]
+
+		// equation system with std::array values (ref DiffEqSystemArray.hpp)
+		using aply::examp::diffeq::UniformAccelArray;
+		UniformAccelArray const uniAccelArray{ uniAccelEquations };
+
+		// configure (allocation free) integrator
+		aply::math::DiffEqSolveRK4 const solver(stepSize);
+
+		// solution: { time, std::array{ funcVal, func'Val } }
+		aply::math::DiffEqValues<2u> const soln
+			{ solver.solutionFor(t1, uniAccelArray) };
+
+		// [DoxyExample01]
+
+		// compare with (original) std::vector solver
+		aply::math::DiffEqSolve vecSolver(stepSize);
+		std::pair<double, std::vector<double> > const expSoln
+			{ vecSolver.solutionFor(t1, uniAccelEquations) };
+
+		tst::checkGotExp(oss, soln.first, expSoln.first, "rk4 t1");
+		tst::checkGotExp(oss, soln.second[0], expSoln.second[0], "rk4 pos");
+		tst::checkGotExp(oss, soln.second[1], expSoln.second[1], "rk4 vel");
+
+		// and with analytic solution
+		constexpr double tol{ 1.e-12 };
+		tst::checkGotExp
+			( oss, soln.second[0], uniAccelEquations.expPositionAt(t1)
+			, "rk4 exp pos", tol
+			);
+
+		// backward integration should return to start
+		aply::math::DiffEqValues<2u> const revBeg{ soln };
+		std::array<double, 2u> const revEnd
+			{ solver.valuesFrom(revBeg, t0, uniAccelArray) };
+		tst::checkGotExp(oss, revEnd[0], h0, "rk4 rev pos", tol);
+		tst::checkGotExp(oss, revEnd[1], v0, "rk4 rev vel", tol);
+	}
+
+	//! Simple harmonic oscillator: y'' = -omega^2 * y
+	struct Oscillator
+	{
+		double const theOmega{ 2. * engabra::g3::pi };
+
+		//! Derivative values: (y0' = y1, y1' = -omega^2 * y0)
+		inline
+		std::array<double, 2u>
+		operator()
+			( double const & // xValue
+			, std::array<double, 2u> const & yFuncs
+			) const
+		{
+			return { yFuncs[1], -theOmega*theOmega*yFuncs[0] };
+		}
+
+		//! Start at rest with unit displacement
+		inline
+		aply::math::DiffEqValues<2u>
+		initValues
+			() const
+		{
+			return { 0., { 1., 0. } };
+		}
+
+		//! Known solution value (position)
+		inline
+		double
+		expPositionAt
+			( double const & tau
+			) const
+		{
+			return std::cos(theOmega * tau);
+		}
+
+	}; // Oscillator
+
+	//! Check adaptive (Dormand-Prince) solver and dense output
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		Oscillator const oscillator{};
+		constexpr double t1{ 3.3 };
+
+		// [DoxyExample02]
+
+		// tolerances (per function value) determine step sizes
+		constexpr double tolAbs{ 1.e-10 };
+		constexpr double tolRel{ 1.e-10 };
+		aply::math::DiffEqSolveDP45 const solver(tolAbs, tolRel);
+
+		// solution at end point (and optional work counters)
+		aply::math::DiffEqStats stats{};
+		aply::math::DiffEqValues<2u> const soln
+			{ solver.solutionFor(t1, oscillator, &stats) };
+
+		// continuous solution - evaluate anywhere within [t0,t1]
+		aply::math::DenseSolution<2u> const dense
+			{ solver.denseSolutionFor(t1, oscillator) };
+		std::array<double, 2u> const midVals{ dense.valuesAt(1.7) };
+
+		// [DoxyExample02]
+
+		// accuracy commensurate with tolerance (over several periods)
+		constexpr double tolCheck{ 1.e-8 };
+		tst::checkGotExp
+			( oss, soln.second[0], oscillator.expPositionAt(t1)
+			, "dp45 end pos", tolCheck
+			);
+		tst::checkGotExp
+			( oss, midVals[0], oscillator.expPositionAt(1.7)
+			, "dp45 dense pos", tolCheck
+			);
+
+		// should take far fewer steps than fixed step integration
+		if (! ((10u < stats.theNumAccept) && (stats.theNumAccept < 1000u)))
+		{
+			oss << "Failure of dp45 step count test\n";
+			oss << "theNumAccept: " << stats.theNumAccept << '\n';
+			oss << "theNumReject: " << stats.theNumReject << '\n';
+			oss << "  theNumEval: " << stats.theNumEval << '\n';
+		}
+
+		// tighter tolerance should improve result
+		aply::math::DiffEqSolveDP45 const fineSolver(1.e-13, 1.e-13);
+		aply::math::DiffEqValues<2u> const fineSoln
+			{ fineSolver.solutionFor(t1, oscillator) };
+		tst::checkGotExp
+			( oss, fineSoln.second[0], oscillator.expPositionAt(t1)
+			, "dp45 fine pos", 1.e-11
+			);
+
+		// reverse direction integration
+		aply::math::DiffEqValues<2u> const revBeg{ t1, fineSoln.second };
+		std::array<double, 2u> const revEnd
+			{ fineSolver.valuesFrom(revBeg, 0., oscillator) };
+		tst::checkGotExp(oss, revEnd[0], 1., "dp45 rev pos", 1.e-10);
+
+		// outside of dense solution interval
+		if (engabra::g3::isValid(dense.valuesAt(t1 + 1.)[0]))
+		{
+			oss << "Failure of dp45 dense null extrapolation test\n";
+		}
+	}
+
+	//! Check multi-output solutions (single pass over many x values)
+	void
+	test3
+		( std::ostringstream & oss
+		)
+	{
+		Oscillator const oscillator{};
+
+		// requested in arbitrary order (and including start point)
+		std::vector<double> const xValues{ 2.5, .25, 0., 1.125, 3.75, -1. };
+
+		aply::math::DiffEqSolveDP45 const solver(1.e-12, 1.e-12);
+		std::vector<aply::math::DiffEqValues<2u> > const solns
+			{ solver.solutionsAt(xValues, oscillator) };
+
+		aply::math::DiffEqSolveRK4 const rk4Solver(.0001);
+		std::vector<aply::math::DiffEqValues<2u> > const rk4Solns
+			{ rk4Solver.solutionsAt(xValues, oscillator) };
+
+		if (! (xValues.size() == solns.size()))
+		{
+			oss << "Failure of solutionsAt size test\n";
+		}
+		else
+		{
+			for (std::size_t nn{0u} ; nn < xValues.size() ; ++nn)
+			{
+				double const & xValue = xValues[nn];
+				if (xValue < 0.) // behind start: expect null
+				{
+					if ( engabra::g3::isValid(solns[nn].second[0])
+					  || engabra::g3::isValid(rk4Solns[nn].second[0])
+					   )
+					{
+						oss << "Failure of solutionsAt null value test\n";
+					}
+					continue;
+				}
+				double const expPos{ oscillator.expPositionAt(xValue) };
+				tst::checkGotExp
+					(oss, solns[nn].first, xValue, "solutionsAt x");
+				tst::checkGotExp
+					( oss, solns[nn].second[0], expPos
+					, "dp45 solutionsAt pos", 1.e-10
+					);
+				tst::checkGotExp
+					( oss, rk4Solns[nn].second[0], expPos
+					, "rk4 solutionsAt pos", 1.e-10
+					);
+			}
+		}
+	}
+
 } // [anon]
 
 
@@ -151,6 +370,9 @@ main
 	std::ostringstream oss;
 
 	test0(oss); // Falling object equation of motion test
+	test1(oss); // fixed dimension (std::array) solver
+	test2(oss); // adaptive step solver
+	test3(oss); // multiple outputs from single integration
 
 	return tst::finish(oss);
 }
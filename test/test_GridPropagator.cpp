@@ -0,0 +1,274 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for env::IndexGrid and ray::GridPropagator
+ *
+ */
+
+
+#include "rayGridPropagator.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/indexModel.hpp"
+#include "example/nodeList.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	using aply::examp::NodeList;
+
+	//! Media with nu^2 linear in height (ray paths are parabolas)
+	struct SqLinearNu : public env::IndexVolume
+	{
+		double const theNuSq0{ 2.25 };
+		double const theSlope{ -.05 };
+
+		inline
+		virtual
+		double
+		nuValue
+			( Vector const & rVec
+			) const
+		{
+			double nu{ null<double>() };
+			double const nuSq{ theNuSq0 + theSlope*rVec[2] };
+			if (0. < nuSq)
+			{
+				nu = std::sqrt(nuSq);
+			}
+			return nu;
+		}
+	};
+
+	//! Check grid interpolation and cell models
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// IoR linear in location (reproduced exactly by trilinear grid)
+		env::index::Linear const media{ Vector{ .010, -.020, .005 }, 1.25 };
+		Vector const origin{ -1., -2., -3. };
+		constexpr double delta{ .5 };
+		env::IndexGrid const grid
+			{ env::IndexGrid::sampled(media, origin, delta, { 9u, 7u, 5u }) };
+
+		if (! grid.isValid())
+		{
+			oss << "Failure of sampled grid isValid test\n";
+		}
+
+		// trilinear interpolation reproduces linear field
+		std::mt19937 gen(12345u);
+		std::uniform_real_distribution<double> distX(-1., 3.);
+		std::uniform_real_distribution<double> distY(-2., 1.);
+		std::uniform_real_distribution<double> distZ(-3., -1.);
+		constexpr double tol{ 1.e-14 };
+		for (std::size_t nn{0u} ; nn < 100u ; ++nn)
+		{
+			Vector const rVec{ distX(gen), distY(gen), distZ(gen) };
+			std::pair<double, Vector> const gotNuGrad
+				{ grid.nuValueAndGradient(rVec, 0.) };
+			tst::checkGotExp
+				(oss, gotNuGrad.first, media.nuValue(rVec), "grid nu", tol);
+			tst::checkGotExp
+				(oss, gotNuGrad.second, media.theGradient, "grid grad", tol);
+		}
+
+		// cell model at cell center
+		env::IndexGrid::Cell const cell{ 3u, 2u, 1u };
+		Vector const rCenter
+			{ grid.cellMinCorner(cell) + (.5*delta) * Vector{ 1., 1., 1. } };
+		std::pair<double, Vector> const cellNuGrad
+			{ grid.cellNuAndGradient(cell) };
+		tst::checkGotExp
+			(oss, cellNuGrad.first, media.nuValue(rCenter), "cell nu", tol);
+		tst::checkGotExp
+			(oss, cellNuGrad.second, media.theGradient, "cell grad", tol);
+
+		// outside of grid
+		Vector const rOut{ 3.25, 0., -2. };
+		if ( grid.isCell(grid.cellFor(rOut))
+		  || engabra::g3::isValid(grid.nuValue(rOut))
+		   )
+		{
+			oss << "Failure of outside grid test\n";
+		}
+	}
+
+	//! Check uniform media (straight line from face to face)
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		std::vector<double> const nus(5u*5u*5u, 1.3);
+		env::IndexGrid const grid
+			(Vector{ 0., 0., 0. }, 1., { 5u, 5u, 5u }, nus);
+		ray::GridPropagator const prop{ &grid };
+
+		Vector const tBeg{ direction(Vector{ 1., .7, .3 }) };
+		Vector const rBeg{ .1, .2, .3 };
+		NodeList nodes{ ray::Start{ tBeg, rBeg }, {} };
+		nodes.theNodes.reserve(64u);
+		prop.tracePath(&nodes);
+
+		// start, then faces x=1,2,3,4 y=1,2 z=1 (end at x=4 face)
+		std::size_t const expSize{ 1u + 4u + 2u + 1u };
+		std::size_t const gotSize{ nodes.theNodes.size() };
+		if (! (expSize == gotSize))
+		{
+			oss << "Failure of uniform grid node count test\n";
+			oss << "exp: " << expSize << '\n';
+			oss << "got: " << gotSize << '\n';
+		}
+
+		ray::Node const & endNode = nodes.theNodes.back();
+		double const endDist{ (4. - rBeg[0]) / tBeg[0] };
+		Vector const expEnd{ rBeg + endDist * tBeg };
+		constexpr double tol{ 1.e-14 };
+		tst::checkGotExp(oss, endNode.theCurrLoc, expEnd, "uniform end", tol);
+		tst::checkGotExp(oss, endNode.theNextTan, tBeg, "uniform tan", tol);
+
+		if (! (ray::Stopped == endNode.theDirChange))
+		{
+			oss << "Failure of uniform grid Stopped test\n";
+		}
+		for (std::size_t ndx{1u} ; (ndx + 1u) < gotSize ; ++ndx)
+		{
+			if (! (ray::Unaltered == nodes.theNodes[ndx].theDirChange))
+			{
+				oss << "Failure of uniform grid Unaltered test\n";
+				oss << nodes.theNodes[ndx].infoBrief() << '\n';
+				break;
+			}
+		}
+	}
+
+	//! Distance from ground return point of analytic (parabolic) path
+	inline
+	double
+	returnError
+		( SqLinearNu const & media
+		, double const & elev
+		, double const & delta
+		, std::size_t * const & ptNumNodes
+		)
+	{
+		std::size_t const numX{ static_cast<std::size_t>(40./delta) + 1u };
+		std::size_t const numY{ static_cast<std::size_t>(2./delta) + 1u };
+		std::size_t const numZ{ static_cast<std::size_t>(8./delta) + 1u };
+		Vector const origin{ 0., -1., 0. };
+
+		// [DoxyExample01]
+
+		// sample media onto a grid
+		env::IndexGrid const grid
+			{ env::IndexGrid::sampled
+				(media, origin, delta, { numX, numY, numZ })
+			};
+
+		// propagate ray cell by cell (ray::Path or similar consumer)
+		ray::GridPropagator const prop{ &grid };
+		Vector const tBeg{ std::cos(elev), 0., std::sin(elev) };
+		NodeList nodes{ ray::Start{ tBeg, zero<Vector>() }, {} };
+		nodes.theNodes.reserve(4096u);
+		prop.tracePath(&nodes);
+
+		// [DoxyExample01]
+
+		// ray returns to ground at parameter -4*pw0/slope
+		double const nu0{ std::sqrt(media.theNuSq0) };
+		double const sigRet{ -4. * nu0 * std::sin(elev) / media.theSlope };
+		Vector const expEnd{ (nu0 * std::cos(elev) * sigRet) * e1 };
+
+		*ptNumNodes = nodes.theNodes.size();
+		return magnitude(nodes.theNodes.back().theCurrLoc - expEnd);
+	}
+
+	//! Check path through smooth media against analytic solution
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		SqLinearNu const media{};
+		constexpr double elev{ .2 };
+
+		// cell model error is second order in cell size
+		std::size_t numBig{ 0u };
+		std::size_t numSmall{ 0u };
+		double const errBig{ returnError(media, elev, .5, &numBig) };
+		double const errSmall{ returnError(media, elev, .125, &numSmall) };
+		if (! ((errBig < 1.e-3) && (8. < (errBig / errSmall))))
+		{
+			oss << "Failure of grid path accuracy test\n";
+			oss << "errBig: " << io::fixed(errBig) << '\n';
+			oss << "errSmall: " << io::fixed(errSmall) << '\n';
+		}
+
+		// effort is proportional to number of cells crossed
+		// (path is about 36 units long with up to 2 crossings per cell)
+		if (! ((numBig < 2u*72u) && (numSmall < 2u*288u)))
+		{
+			oss << "Failure of grid node count test\n";
+			oss << "numBig: " << numBig << '\n';
+			oss << "numSmall: " << numSmall << '\n';
+		}
+	}
+
+}
+
+/*! \brief Unit test for env::IndexGrid and ray::GridPropagator
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // grid interpolation
+	test1(oss); // uniform media
+	test2(oss); // smooth media
+
+	return tst::finish(oss);
+}
+
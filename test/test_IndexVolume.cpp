@@ -90,6 +90,68 @@ namespace
 		TestVolume const tVolume{};
 		TestEmpty const tEmpty{};
 	}
+
+	//! Linear IoR field clipped to unit box
+	struct TestLinear : public aply::env::IndexVolume
+	{
+		inline
+		TestLinear
+			()
+			: IndexVolume
+				( std::make_shared<aply::env::ActiveBox>
+					( engabra::g3::Vector{ 0., 0., 0. }
+					, engabra::g3::Vector{ 1., 1., 1. }
+					)
+				)
+		{ }
+
+		inline
+		double
+		nuValue
+			( engabra::g3::Vector const & rVec
+			) const
+		{
+			return (1. + .25*rVec[0] - .5*rVec[1] + .125*rVec[2]);
+		}
+
+	}; // TestLinear
+
+	//! Check (default) combined value and gradient
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace engabra::g3;
+		TestLinear const media{};
+		Vector const rIn{ .25, .5, .75 };
+		Vector const rOut{ 1.25, .5, .75 };
+		Vector const expGrad{ .25, -.5, .125 };
+
+		std::pair<double, Vector> const gotIn
+			{ media.qualifiedNuValueAndGradient(rIn, .125) };
+		tst::checkGotExp(oss, gotIn.first, media.nuValue(rIn), "nuIn");
+		tst::checkGotExp(oss, gotIn.second, expGrad, "gradIn", 1.e-14);
+
+		// value is null outside of active volume (gradient is not used)
+		std::pair<double, Vector> const gotOut
+			{ media.qualifiedNuValueAndGradient(rOut, .125) };
+		if (isValid(gotOut.first))
+		{
+			oss << "Failure of qualified null value test\n";
+			oss << "gotOut.first: " << gotOut.first << '\n';
+		}
+
+		// analytic override is consistent with separate methods
+		aply::env::coesa::AirVolume const air{};
+		double const radius{ aply::env::sEarth.theRadGround + 2000. };
+		Vector const rAir{ radius * direction(e1 - e3) };
+		std::pair<double, Vector> const gotAir
+			{ air.nuValueAndGradient(rAir, 1.) };
+		tst::checkGotExp(oss, gotAir.first, air.nuValue(rAir), "nuAir");
+		tst::checkGotExp
+			(oss, gotAir.second, air.nuGradient(rAir, 1.), "gradAir");
+	}
 }
 
 
@@ -102,6 +164,7 @@ main
 	std::ostringstream oss;
 
 	test0(oss);
+	test1(oss); // nuValueAndGradient
 
 	return tst::finish(oss);
 }
@@ -0,0 +1,228 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::NodeGenerator
+ *
+ */
+
+
+#include "rayNodeGenerator.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/nodeList.hpp"
+
+#include <Engabra>
+
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	using aply::examp::NodeList;
+
+	//! True if all node data are identical
+	bool
+	sameNode
+		( ray::Node const & nodeA
+		, ray::Node const & nodeB
+		)
+	{
+		Vector const & rA = nodeA.theCurrLoc;
+		Vector const & rB = nodeB.theCurrLoc;
+		Vector const & tA = nodeA.theNextTan;
+		Vector const & tB = nodeB.theNextTan;
+		return
+			(  (rA[0] == rB[0]) && (rA[1] == rB[1]) && (rA[2] == rB[2])
+			&& (tA[0] == tB[0]) && (tA[1] == tB[1]) && (tA[2] == tB[2])
+			&& (nodeA.thePrevNu == nodeB.thePrevNu)
+			&& (nodeA.theNextNu == nodeB.theNextNu)
+			&& (nodeA.theDirChange == nodeB.theDirChange)
+			);
+	}
+
+	//! Check generated nodes (whole path) against tracePath()
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		constexpr double stepDist{ 10. };
+		ray::Propagator const prop{ &media, stepDist };
+
+		// ray leaving the atmosphere (after a modest number of steps)
+		Vector const rBeg{ (env::sEarth.theRadGround + 80000.) * e3 };
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., 1. }, rBeg) };
+
+		NodeList expNodes{ start };
+		expNodes.theNodes.reserve(16384u);
+		prop.tracePath(&expNodes);
+
+		// [DoxyExample01]
+
+		// nodes are computed (one step each) as the loop requests them
+		ray::NodeGenerator gen(prop, start);
+		std::vector<ray::Node> gotNodes;
+		for (ray::Node const & node : gen)
+		{
+			gotNodes.emplace_back(node);
+		}
+
+		// [DoxyExample01]
+
+		if (! (expNodes.theNodes.size() < expNodes.theNodes.capacity()))
+		{
+			oss << "Failure of test path length (not stopped) test\n";
+		}
+		if (! (gotNodes.size() == expNodes.theNodes.size()))
+		{
+			oss << "Failure of generated node count test\n";
+			oss << "exp: " << expNodes.theNodes.size() << '\n';
+			oss << "got: " << gotNodes.size() << '\n';
+		}
+		else
+		{
+			for (std::size_t nn{0u} ; nn < gotNodes.size() ; ++nn)
+			{
+				if (! sameNode(gotNodes[nn], expNodes.theNodes[nn]))
+				{
+					oss << "Failure of generated node test, nn: " << nn << '\n';
+					break;
+				}
+			}
+		}
+		if (gen.isActive() || gen.next() || gen.hasNode())
+		{
+			oss << "Failure of stopped generator test\n";
+		}
+	}
+
+	//! Check partial consumption and round robin interleaving of rays
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		constexpr double stepDist{ 10. };
+		ray::Propagator const prop{ &media, stepDist };
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+
+		std::vector<ray::Start> starts;
+		for (double const & elev : { .01, .02, .05, .10 })
+		{
+			starts.emplace_back(ray::Start::from(Vector{ 1., 0., elev }, rBeg));
+		}
+		constexpr std::size_t numNodes{ 50u };
+
+		// interleave rays - one node from each in turn
+		std::vector<ray::NodeGenerator> gens;
+		for (ray::Start const & start : starts)
+		{
+			gens.emplace_back(ray::NodeGenerator(prop, start));
+		}
+		std::vector<std::vector<ray::Node> > gotPaths(gens.size());
+		for (std::size_t kk{0u} ; kk < numNodes ; ++kk)
+		{
+			for (std::size_t nn{0u} ; nn < gens.size() ; ++nn)
+			{
+				if (gens[nn].next())
+				{
+					gotPaths[nn].emplace_back(gens[nn].node());
+				}
+			}
+		}
+
+		// compare with separately traced (same length) paths
+		for (std::size_t nn{0u} ; nn < starts.size() ; ++nn)
+		{
+			NodeList expNodes{ starts[nn] };
+			expNodes.theNodes.reserve(numNodes);
+			prop.tracePath(&expNodes);
+			bool same{ expNodes.theNodes.size() == gotPaths[nn].size() };
+			for (std::size_t kk{0u} ; same && (kk < numNodes) ; ++kk)
+			{
+				same = sameNode(gotPaths[nn][kk], expNodes.theNodes[kk]);
+			}
+			if (! (same && (numNodes == gens[nn].numNodes())))
+			{
+				oss << "Failure of interleaved path test, nn: " << nn << '\n';
+			}
+		}
+
+		// only requested nodes are computed
+		ray::LoopStats stats{};
+		ray::NodeGenerator gen(prop, starts.front(), &stats);
+		std::size_t numUsed{ 0u };
+		for (ray::Node const & node : gen)
+		{
+			if (! (node.theCurrLoc[0] < 95.))
+			{
+				break;
+			}
+			++numUsed;
+		}
+		constexpr std::size_t expUsed{ 10u }; // ~10m steps (nearly level)
+		if (! ((expUsed == numUsed) && ((numUsed + 1u) == stats.theNumSteps)))
+		{
+			oss << "Failure of partial path test\n";
+			oss << "numUsed: " << numUsed << '\n';
+			oss << "theNumSteps: " << stats.theNumSteps << '\n';
+		}
+
+		ray::NodeGenerator nullGen{};
+		if (nullGen.isActive() || (nullGen.begin() != nullGen.end()))
+		{
+			oss << "Failure of null generator test\n";
+		}
+	}
+
+}
+
+
+/*! \brief Unit test for ray::NodeGenerator
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
@@ -39,6 +39,7 @@
 
 #include <Engabra>
 
+#include <cmath>
 #include <iostream>
 #include <sstream>
 
@@ -175,6 +176,36 @@ namespace
 			}
 		}
 
+		// optical path length exceeds arc length by (1.5-1.) times
+		// the arc length within the slab (entered at 54.7 deg from e1)
+		ray::PathView const view{ &path };
+		double const arcDist{ view.pathDistance() };
+		double const optDist{ view.opticalDistance() };
+		double const cosInside{ std::sqrt(1. - (2./3.)/(1.5*1.5)) };
+		double const expExcess{ .5 * (2. / cosInside) };
+		double const gotExcess{ optDist - arcDist };
+		constexpr double tolExcess{ 4. * propStepDist };
+		if (! (std::abs(gotExcess - expExcess) < tolExcess))
+		{
+			oss << "Failure of optical distance test\n";
+			oss << "expExcess: " << expExcess << '\n';
+			oss << "gotExcess: " << gotExcess << '\n';
+		}
+
+		// group distance scales the excess (and is optical if unity)
+		double const expGroup{ arcDist + 2.*gotExcess };
+		double const gotGroup{ view.groupDistance(2.) };
+		if (! ( nearlyEquals(gotGroup, expGroup)
+			 && nearlyEquals(view.groupDistance(), optDist)
+			 && nearlyEquals
+				(view.groupDelay(2.) * ray::sLightSpeed, expGroup)
+			  ))
+		{
+			oss << "Failure of group distance test\n";
+			oss << "expGroup: " << expGroup << '\n';
+			oss << "gotGroup: " << gotGroup << '\n';
+		}
+
 		return oss.str();
 	}
 
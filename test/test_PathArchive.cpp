@@ -0,0 +1,382 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::PathWriter, ray::PathStream, ray::PathArchive
+ *
+ */
+
+
+#include "rayPathArchive.hpp"
+
+#include "tst.hpp"
+
+#include "rayStratified.hpp"
+
+#include "example/nodeList.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	using aply::examp::NodeList;
+
+	//! Planar layered media (with turning rays) for test paths.
+	ray::Stratified
+	testMedia
+		()
+	{
+		std::vector<double> const heights{ 0., 1., 2.5, 4., 10. };
+		std::vector<double> nus;
+		for (double const & height : heights)
+		{
+			nus.emplace_back(std::sqrt(2.25 - .01*height));
+		}
+		return ray::Stratified(heights, nus);
+	}
+
+	//! Starting conditions for several (different length) test rays.
+	std::vector<ray::Start>
+	testStarts
+		()
+	{
+		std::vector<ray::Start> starts;
+		for (std::size_t nn{0u} ; nn < 5u ; ++nn)
+		{
+			double const elev{ .02 + .03*static_cast<double>(nn) };
+			Vector const tBeg{ std::cos(elev), 0., std::sin(elev) };
+			Vector const rBeg{ 1000. + 3.*static_cast<double>(nn), -7., 0. };
+			starts.emplace_back(ray::Start{ tBeg, rBeg });
+		}
+		return starts;
+	}
+
+	//! True if all components are identical
+	bool
+	sameVec
+		( Vector const & vecA
+		, Vector const & vecB
+		)
+	{
+		return
+			(  (vecA[0] == vecB[0])
+			&& (vecA[1] == vecB[1])
+			&& (vecA[2] == vecB[2])
+			);
+	}
+
+	//! Max location difference (or infinity if sizes/other data differ)
+	double
+	maxLocDiff
+		( std::vector<ray::Node> const & gots
+		, std::vector<ray::Node> const & exps
+		)
+	{
+		double maxDiff{ std::numeric_limits<double>::infinity() };
+		if (gots.size() == exps.size())
+		{
+			maxDiff = 0.;
+			for (std::size_t nn{0u} ; nn < gots.size() ; ++nn)
+			{
+				ray::Node const & got = gots[nn];
+				ray::Node const & exp = exps[nn];
+				bool const same
+					{  sameVec(got.thePrevTan, exp.thePrevTan)
+					&& (got.thePrevNu == exp.thePrevNu)
+					&& (got.theNextNu == exp.theNextNu)
+					&& sameVec(got.theNextTan, exp.theNextTan)
+					&& (got.theDirChange == exp.theDirChange)
+					};
+				if (! same)
+				{
+					maxDiff = std::numeric_limits<double>::infinity();
+					break;
+				}
+				double const diff{ magnitude(got.theCurrLoc - exp.theCurrLoc) };
+				maxDiff = std::max(maxDiff, diff);
+			}
+		}
+		return maxDiff;
+	}
+
+	//! Check write/read round trip (full precision and delta encoded)
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		ray::Stratified const media{ testMedia() };
+		std::vector<ray::Start> const starts{ testStarts() };
+		constexpr double nodeDist{ .125 };
+		constexpr std::size_t maxNodes{ 4096u };
+
+		// expected paths (traced into memory)
+		std::vector<std::vector<ray::Node> > expPaths;
+		for (ray::Start const & start : starts)
+		{
+			NodeList nodes{ start, {} };
+			nodes.theNodes.reserve(maxNodes);
+			media.tracePath(&nodes, nodeDist);
+			expPaths.emplace_back(nodes.theNodes);
+		}
+
+		std::filesystem::path const tmpDir
+			{ std::filesystem::temp_directory_path() };
+		std::filesystem::path const fullPath
+			{ tmpDir / "test_PathArchive_full.aplyray" };
+		std::filesystem::path const deltaPath
+			{ tmpDir / "test_PathArchive_delta.aplyray" };
+
+		for (bool const useDelta : { false, true })
+		{
+			std::filesystem::path const & arcPath
+				= (useDelta ? deltaPath : fullPath);
+
+			// [DoxyExample01]
+
+			// open archive (delta encoding of locations is optional)
+			ray::PathWriter writer(arcPath, useDelta);
+			for (ray::Start const & start : starts)
+			{
+				// consumer appends ray to archive when it goes out of scope
+				ray::PathStream stream(start, &writer, maxNodes);
+				media.tracePath(&stream, nodeDist);
+			}
+			writer.close(); // or let destructor finalize the archive
+
+			// map the archive and access any ray
+			ray::PathArchive const archive(arcPath);
+			std::vector<ray::Node> const nodes{ archive.nodesAt(2u) };
+
+			// [DoxyExample01]
+
+			if (! (archive.isValid() && (starts.size() == archive.size())))
+			{
+				oss << "Failure of valid archive test\n";
+				oss << archive.infoString("archive") << '\n';
+				continue;
+			}
+			if (! (useDelta == archive.hasDeltaLocs()))
+			{
+				oss << "Failure of hasDeltaLocs test\n";
+			}
+
+			// random access (reverse order)
+			constexpr double fltEps{ std::numeric_limits<float>::epsilon() };
+			double const tol{ useDelta ? (fltEps * nodeDist) : 0. };
+			for (std::size_t nn{starts.size()} ; 0u < nn-- ; )
+			{
+				ray::Start const gotStart{ archive.entryAt(nn).start() };
+				if (! ( sameVec(gotStart.theTanDir, starts[nn].theTanDir)
+					 && sameVec(gotStart.thePntLoc, starts[nn].thePntLoc)
+					  ))
+				{
+					oss << "Failure of start test, nn: " << nn << '\n';
+				}
+				double const diff
+					{ maxLocDiff(archive.nodesAt(nn), expPaths[nn]) };
+				if (! (diff <= tol))
+				{
+					oss << "Failure of node round trip test\n";
+					oss << "useDelta: " << useDelta << "  nn: " << nn << '\n';
+					oss << "diff: " << io::fixed(diff, 1u, 15u) << '\n';
+				}
+			}
+
+			// column view shares (uncopied) data
+			ray::PathColumns const cols{ archive.columnsAt(1u) };
+			std::size_t const expNum{ expPaths[1].size() };
+			if (! (cols.isValid() && (expNum == cols.theNumNodes)))
+			{
+				oss << "Failure of columns test\n";
+			}
+			else
+			if (! (expPaths[1][7u].theNextNu == cols.theNextNus[7u]))
+			{
+				oss << "Failure of column value test\n";
+			}
+			if (archive.columnsAt(starts.size()).isValid())
+			{
+				oss << "Failure of out of range columns test\n";
+			}
+		}
+
+		// delta encoding reduces file size
+		std::uintmax_t const fullSize{ std::filesystem::file_size(fullPath) };
+		std::uintmax_t const deltaSize{ std::filesystem::file_size(deltaPath) };
+		if (! (deltaSize < fullSize))
+		{
+			oss << "Failure of delta file size test\n";
+			oss << "fullSize: " << fullSize << '\n';
+			oss << "deltaSize: " << deltaSize << '\n';
+		}
+
+		std::filesystem::remove(fullPath);
+		std::filesystem::remove(deltaPath);
+	}
+
+	//! Check that incomplete (e.g. unclosed, truncated) archive is invalid
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_PathArchive_trunc.aplyray"
+			};
+		{
+			ray::PathWriter writer(arcPath);
+			ray::PathStream stream(testStarts().front(), &writer, 64u);
+			testMedia().tracePath(&stream, 1.);
+		}
+		ray::PathArchive const okArchive(arcPath);
+		if (! (okArchive.isValid() && (1u == okArchive.size())))
+		{
+			oss << "Failure of destructor finalized archive test\n";
+		}
+
+		std::filesystem::resize_file
+			(arcPath, std::filesystem::file_size(arcPath) - 8u);
+		ray::PathArchive const archive(arcPath);
+		if (archive.isValid())
+		{
+			oss << "Failure of truncated archive test\n";
+			oss << archive.infoString("truncated archive") << '\n';
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+	//! Overwrite 8 bytes at offset in file with value
+	void
+	patchFile
+		( std::filesystem::path const & filePath
+		, std::uint64_t const & offset
+		, std::uint64_t const & value
+		)
+	{
+		std::fstream strm
+			(filePath, std::ios::in | std::ios::out | std::ios::binary);
+		strm.seekp(static_cast<std::streamoff>(offset));
+		strm.write(reinterpret_cast<char const *>(&value), sizeof(value));
+	}
+
+	//! Check that sizes which would wrap around are rejected
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		std::filesystem::path const arcPath
+			{ std::filesystem::temp_directory_path()
+			/ "test_PathArchive_corrupt.aplyray"
+			};
+		auto const writeArchive
+			{ [&arcPath] ()
+				{
+					ray::PathWriter writer(arcPath);
+					ray::PathStream stream
+						(testStarts().front(), &writer, 64u);
+					testMedia().tracePath(&stream, 1.);
+				}
+			};
+
+		// trailer: theNumEntries, theIndexOffset, theFlags, theMagic
+		writeArchive();
+		std::uint64_t const fileSize{ std::filesystem::file_size(arcPath) };
+		std::uint64_t const trailerBeg{ fileSize - 32u };
+		std::uint64_t indexBeg{ 0u };
+		{
+			std::ifstream ifs(arcPath, std::ios::binary);
+			ifs.seekg(static_cast<std::streamoff>(trailerBeg + 8u));
+			ifs.read(reinterpret_cast<char *>(&indexBeg), sizeof(indexBeg));
+		}
+
+		// (1 + 2^59) entries: entry bytes wrap around to one entry size
+		patchFile(arcPath, trailerBeg, 1u + (std::uint64_t{ 1u } << 59u));
+		ray::PathArchive const badIndex(arcPath);
+		if (badIndex.isValid())
+		{
+			oss << "Failure of wrapped index size test\n";
+		}
+
+		// entry theNumNodes for which layout size wraps (to < 1kB)
+		// (entry: 9 doubles, theDataOffset, theNumNodes, theReserved)
+		writeArchive();
+		constexpr std::uint64_t maxU64
+			{ std::numeric_limits<std::uint64_t>::max() };
+		// (11 double and 1 byte columns: 89 bytes per node)
+		std::uint64_t const wrapNodes{ 8u * ((maxU64 / 89u) / 8u + 1u) };
+		patchFile(arcPath, indexBeg + 80u, wrapNodes);
+		ray::PathArchive const badNodes(arcPath);
+		if (badNodes.isValid())
+		{
+			oss << "Failure of wrapped node count test\n";
+		}
+
+		// entry theDataOffset within header
+		writeArchive();
+		patchFile(arcPath, indexBeg + 72u, 0u);
+		ray::PathArchive const badData(arcPath);
+		if (badData.isValid())
+		{
+			oss << "Failure of data offset test\n";
+		}
+
+		std::filesystem::remove(arcPath);
+	}
+
+}
+
+
+/*! \brief Unit test for ray::PathWriter, ray::PathStream, ray::PathArchive
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+	test2(oss);
+
+	return tst::finish(oss);
+}
@@ -0,0 +1,250 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::PathPool (and ray::PooledPath)
+ *
+ */
+
+
+#include "rayPathPool.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include <Engabra>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! True if nodes have identical locations and changes
+	bool
+	sameNode
+		( ray::Node const & nodeA
+		, ray::Node const & nodeB
+		)
+	{
+		Vector const & locA = nodeA.theCurrLoc;
+		Vector const & locB = nodeB.theCurrLoc;
+		return
+			(  (locA[0] == locB[0])
+			&& (locA[1] == locB[1])
+			&& (locA[2] == locB[2])
+			&& (nodeA.theDirChange == nodeB.theDirChange)
+			);
+	}
+
+	//! Check arena range handling
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		ray::PathArena arena(4u);
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., 0. }, zero<Vector>()) };
+
+		// only one open range at a time
+		bool const okOpen{ arena.open(3u) };
+		bool const badOpen{ arena.open(3u) };
+		ray::Node const node{};
+		arena.append(node, 0., 0.);
+		arena.append(node, 1., 1.);
+		arena.close(start);
+		// larger than slab size
+		(void)arena.open(9u);
+		arena.close(start);
+		if (! ( okOpen && (! badOpen)
+			 && (2u == arena.size())
+			 && (2u == arena.pathAt(0u).size())
+			 && (0u == arena.pathAt(1u).size())
+			 && (1. == arena.pathAt(0u).pathDistance())
+			 && (2u == arena.numSlabs())
+			  ))
+		{
+			oss << "Failure of arena range test\n";
+			oss << "okOpen: " << okOpen << '\n';
+			oss << "badOpen: " << badOpen << '\n';
+			oss << "arena.size: " << arena.size() << '\n';
+			oss << "arena.numSlabs: " << arena.numSlabs() << '\n';
+		}
+
+		// consumer without arena consumes nothing
+		ray::PooledPath nullPath(start, 1., nullptr, 10u);
+		if (! ((0u == nullPath.size()) && (0u == nullPath.capacity())))
+		{
+			oss << "Failure of null arena test\n";
+		}
+	}
+
+	//! Check pooled paths (traced by several threads) against ray::Path
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		ray::Propagator const prop{ &media, 10. };
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+		constexpr std::size_t numRays{ 32u };
+		constexpr std::size_t maxNodes{ 200u };
+		constexpr double saveDist{ 25. };
+		std::vector<ray::Start> starts;
+		for (std::size_t nn{0u} ; nn < numRays ; ++nn)
+		{
+			double const elev{ .01 + .001*static_cast<double>(nn) };
+			starts.emplace_back(ray::Start::from(Vector{ 1., 0., elev }, rBeg));
+		}
+
+		// [DoxyExample01]
+
+		// one arena per thread (small slabs here to exercise slab changes)
+		constexpr std::size_t numThreads{ 4u };
+		constexpr std::size_t slabSize{ 3u * maxNodes };
+		ray::PathPool pool(numThreads, slabSize);
+		auto const traceBatch
+			{ [&] ()
+				{
+					std::vector<std::thread> threads;
+					for (std::size_t nt{0u} ; nt < numThreads ; ++nt)
+					{
+						ray::PathArena * const ptArena{ &(pool.arena(nt)) };
+						threads.emplace_back
+							( [&, nt, ptArena] ()
+							{
+								std::size_t nn{ nt };
+								for ( ; nn < numRays ; nn += numThreads)
+								{
+									ray::PooledPath path
+										( starts[nn], saveDist
+										, ptArena, maxNodes
+										);
+									prop.tracePath(&path);
+								} // path recorded in arena (dtor)
+							}
+							);
+					}
+					for (std::thread & thread : threads)
+					{
+						thread.join();
+					}
+				}
+			};
+		traceBatch();
+
+		// paths from arena nt are in order traced by thread nt
+		ray::PathSpan const span{ pool.arena(1u).pathAt(0u) }; // ray 1
+		double const pathDist{ span.pathDistance() };
+
+		// [DoxyExample01]
+
+		// compare with individually allocated paths
+		bool okay{ (numRays == pool.numPaths()) };
+		for (std::size_t nn{0u} ; okay && (nn < numRays) ; ++nn)
+		{
+			ray::Path expPath(starts[nn], saveDist);
+			expPath.reserve(maxNodes);
+			prop.tracePath(&expPath);
+
+			ray::PathSpan const got
+				{ pool.arena(nn % numThreads).pathAt(nn / numThreads) };
+			okay = (expPath.size() == got.size()) && (0u < got.size());
+			for (std::size_t ndx{0u} ; okay && (ndx < got.size()) ; ++ndx)
+			{
+				okay =
+					(  sameNode(expPath.theNodes[ndx], got[ndx])
+					&& (expPath.theArcDists[ndx] == got.thePtArcDists[ndx])
+					&& (expPath.theOptDists[ndx] == got.thePtOptDists[ndx])
+					);
+			}
+			if (! okay)
+			{
+				oss << "Failure of pooled path test for ray: " << nn << '\n';
+				oss << "exp.size: " << expPath.size() << '\n';
+				oss << "got.size: " << got.size() << '\n';
+			}
+		}
+		if (! (0. < pathDist))
+		{
+			oss << "Failure of pathDistance test\n";
+			oss << "pathDist: " << pathDist << '\n';
+		}
+
+		// each thread's paths need more than one slab
+		std::size_t const numSlabs{ pool.numSlabs() };
+		if (! ((numThreads < numSlabs) && (numSlabs < numRays)))
+		{
+			oss << "Failure of slab count test\n";
+			oss << "numSlabs: " << numSlabs << '\n';
+		}
+
+		// next batch reuses slabs (no allocation)
+		pool.reset();
+		if (! (0u == pool.numPaths()))
+		{
+			oss << "Failure of reset test\n";
+		}
+		traceBatch();
+		if (! ((numRays == pool.numPaths()) && (numSlabs == pool.numSlabs())))
+		{
+			oss << "Failure of slab reuse test\n";
+			oss << "numSlabs: " << numSlabs << '\n';
+			oss << "pool.numSlabs(): " << pool.numSlabs() << '\n';
+		}
+		ray::PathSpan const again{ pool.arena(1u).pathAt(0u) };
+		if (! ( (again.size() == span.size())
+			 && sameNode(again.back(), span.back())
+			  ))
+		{
+			oss << "Failure of reused path test\n";
+		}
+	}
+
+}
+
+/*! \brief Unit test for ray::PathPool
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
+
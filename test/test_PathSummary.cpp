@@ -0,0 +1,136 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::PathSummary
+ *
+ */
+
+
+#include "rayPathSummary.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include <Engabra>
+
+#include <sstream>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Check metrics against PathView of Path with all nodes archived
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		env::coesa::AirVolume const media{};
+		constexpr double stepDist{ 10. };
+		ray::Propagator const prop{ &media, stepDist };
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .02 }, rBeg) };
+		constexpr std::size_t maxNodes{ 2000u };
+
+		// all nodes archived (save distance less than step size)
+		ray::Path path(start, .5*stepDist);
+		path.reserve(maxNodes);
+		prop.tracePath(&path);
+		ray::PathView const view(&path);
+
+		// [DoxyExample01]
+
+		// consumer retains only first/last nodes and path distance
+		ray::PathSummary summary(start, maxNodes);
+		prop.tracePath(&summary);
+
+		// same metrics as PathView (without storing the path)
+		BiVector const totalDev{ summary.totalDeviation() };
+		double const pathDist{ summary.pathDistance() };
+		double const endDefl{ summary.endDeflection() };
+
+		// [DoxyExample01]
+
+		if (! (maxNodes == summary.size()))
+		{
+			oss << "Failure of summary size test\n";
+			oss << summary.infoString("summary") << '\n';
+		}
+		constexpr double tol{ 1.e-15 };
+		tst::checkGotExp
+			(oss, totalDev, view.totalDeviation(), "totalDeviation", tol);
+		tst::checkGotExp
+			(oss, summary.begDeviation(), view.begDeviation(), "begDev", tol);
+		tst::checkGotExp
+			(oss, summary.endDeviation(), view.endDeviation(), "endDev", tol);
+		tst::checkGotExp
+			(oss, pathDist, view.pathDistance(), "pathDistance", tol);
+		tst::checkGotExp
+			(oss, endDefl, view.endDeflection(), "endDeflection", tol);
+		tst::checkGotExp
+			( oss, summary.opticalDistance(), view.opticalDistance()
+			, "opticalDistance", tol
+			);
+		tst::checkGotExp
+			( oss, summary.begDeflection(), view.begDeflection()
+			, "begDeflection", tol
+			);
+		tst::checkGotExp
+			( oss, summary.endNode().theCurrLoc, view.endNode().theCurrLoc
+			, "endNode", tol
+			);
+
+		// empty summary has no path distance or net direction
+		ray::PathSummary const empty(start, 0u);
+		if (! ( (0. == empty.pathDistance())
+			 && (! engabra::g3::isValid(empty.netDirection()))
+			  ))
+		{
+			oss << "Failure of empty summary test\n";
+		}
+	}
+
+}
+
+
+/*! \brief Unit test for ray::PathSummary
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+
+	return tst::finish(oss);
+}
@@ -35,6 +35,14 @@
 
 #include "tst.hpp"
 
+#include "example/indexModel.hpp"
+#include "example/nodeList.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 
 namespace
 {
@@ -201,6 +209,308 @@ namespace
 		}
 
 	}
+
+	using aply::examp::NodeList;
+
+	//! Check accelerated refinement loop (vs plain fixed-point iteration)
+	void
+	test1
+		( std::ostream & oss
+		)
+	{
+		// no refracting steps, no average
+		ray::LoopStats const nullStats{};
+		if (engabra::g3::isValid(nullStats.loopsPerRefract()))
+		{
+			oss << "Failure of null LoopStats test\n";
+		}
+
+		// [DoxyExample01]
+
+		env::coesa::AirVolume const media{};
+		constexpr double propStepDist{ 10. };
+		ray::Propagator const fastProp{ &media, propStepDist, true };
+		ray::Propagator const slowProp{ &media, propStepDist, false };
+
+		// low elevation ray in the (strongly curving) lower atmosphere
+		Vector const rBeg{ (env::sEarth.theRadGround + 2.) * e3 };
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .02 }, rBeg) };
+		constexpr std::size_t numNodes{ 2048u };
+
+		NodeList fastList{ start };
+		fastList.theNodes.reserve(numNodes);
+		ray::LoopStats fastStats{};
+		fastProp.tracePath(&fastList, &fastStats);
+
+		NodeList slowList{ start };
+		slowList.theNodes.reserve(numNodes);
+		ray::LoopStats slowStats{};
+		slowProp.tracePath(&slowList, &slowStats);
+
+		// average iterations per refracting step: about 1 vs about 2
+		double const fastLoops{ fastStats.loopsPerRefract() };
+		double const slowLoops{ slowStats.loopsPerRefract() };
+
+		// [DoxyExample01]
+
+		if (! (numNodes == fastStats.theNumSteps))
+		{
+			oss << "Failure of LoopStats step count test\n";
+			oss << "exp: " << numNodes << '\n';
+			oss << "got: " << fastStats.theNumSteps << '\n';
+		}
+		if (! ((fastLoops < 1.1) && (fastLoops < slowLoops)))
+		{
+			oss << "Failure of accelerated loop count test\n";
+			oss << "fastLoops: " << fastLoops << '\n';
+			oss << "slowLoops: " << slowLoops << '\n';
+		}
+
+		// converged results should agree (to within loop tolerance)
+		if (! (fastList.size() == slowList.size()))
+		{
+			oss << "Failure of accelerated path size test\n";
+			oss << "exp: " << slowList.size() << '\n';
+			oss << "got: " << fastList.size() << '\n';
+			return;
+		}
+		double maxLocDif{ 0. };
+		double maxTanDif{ 0. };
+		for (std::size_t nn{0u} ; nn < slowList.size() ; ++nn)
+		{
+			ray::Node const & expNode = slowList.theNodes[nn];
+			ray::Node const & gotNode = fastList.theNodes[nn];
+			maxLocDif = std::max
+				(maxLocDif, magnitude(gotNode.theCurrLoc - expNode.theCurrLoc));
+			maxTanDif = std::max
+				(maxTanDif, magnitude(gotNode.theNextTan - expNode.theNextTan));
+		}
+		constexpr double tolLoc{ 1.e-6 }; // [m] over about 20 [km]
+		constexpr double tolTan{ 1.e-10 };
+		if (! ((maxLocDif < tolLoc) && (maxTanDif < tolTan)))
+		{
+			oss << "Failure of accelerated path agreement test\n";
+			oss << "maxLocDif: " << io::fixed(maxLocDif) << '\n';
+			oss << "maxTanDif: " << io::fixed(maxTanDif) << '\n';
+		}
+	}
+
+	//! Check closed form implicit tangent update (vs defining equation)
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		Vector const tPrev{ direction(Vector{ 1., .25, .5 }) };
+		Vector const grad{ -.75, .5, -1.25 };
+		double const nu{ 1.25 };
+		for (double const & stepDist : { 1./64., 1., 64. })
+		{
+			Vector const tNext
+				{ ray::implicitTangentDir(tPrev, nu, grad, stepDist) };
+
+			// solution of a*x + x*b = D (ref test_Sylvester.cpp) with
+			// W evaluated along mean tangent direction
+			Vector const tSum{ tPrev + tNext };
+			BiVector const wBiv
+				{ (1./nu) * (direction(tSum) * grad).theBiv };
+			double const hm{ stepDist / magnitude(tSum) };
+			Spinor const spinA{  .5, (.5*hm) * wBiv };
+			Spinor const spinB{  .5, (-.5*hm) * wBiv };
+			Vector const expD{ tPrev + hm * (tPrev * wBiv).theVec };
+			ImSpin const gotLhs{ spinA * tNext + tNext * spinB };
+			double const tol{ 8. * std::numeric_limits<double>::epsilon() };
+			double const solTol{ 1.e-14 * (1. + hm*magnitude(wBiv)) };
+			tst::checkGotExp
+				(oss, gotLhs.theVec, expD, "implicit solution", solTol);
+			tst::checkGotExp
+				(oss, magnitude(tNext), 1., "implicit unitary", tol);
+
+			// never turn further from gradient (for any step size)
+			Vector const gDir{ direction(grad) };
+			double const cosPrev{ (tPrev * gDir).theSca[0] };
+			double const cosNext{ (tNext * gDir).theSca[0] };
+			if (! (cosPrev < cosNext))
+			{
+				oss << "Failure of implicit stability test\n";
+				oss << "stepDist: " << stepDist << '\n';
+				oss << "cosPrev: " << io::fixed(cosPrev) << '\n';
+				oss << "cosNext: " << io::fixed(cosNext) << '\n';
+			}
+
+			// reverse step returns to start
+			Vector const gotRev
+				{ ray::implicitTangentDir(-tNext, nu, grad, stepDist) };
+			tst::checkGotExp(oss, gotRev, -tPrev, "implicit reverse", tol);
+		}
+	}
+
+	//! Largest height error of implicit step path (vs analytic solution)
+	double
+	maxHeightError
+		( env::index::Linear const & media
+		, ray::Start const & start
+		, double const & stepDist
+		, NodeList * const & ptNodes
+		)
+	{
+		// nu*t (horizontal) is constant, and with ds = nu*dSigma
+		// nu(sigma) = nu0*cosh(.25*sigma) - nu0*tz0*sinh(.25*sigma)
+		Vector const & tBeg = start.theTanDir;
+		Vector const & rBeg = start.thePntLoc;
+		double const nu0{ media.nuValue(rBeg) };
+		double const nuHorz{ nu0 * std::hypot(tBeg[0], tBeg[1]) };
+
+		ray::Propagator const prop
+			{ &media, stepDist, true, ray::ImplicitStep };
+		prop.tracePath(ptNodes);
+
+		double maxErr{ 0. };
+		for (ray::Node const & node : ptNodes->theNodes)
+		{
+			Vector const & rLoc = node.theCurrLoc;
+			double const sigma{ (rLoc[0] - rBeg[0]) / nuHorz };
+			double const nuExp
+				{ nu0*std::cosh(.25*sigma) - nu0*tBeg[2]*std::sinh(.25*sigma) };
+			double const zExp{ (1.5 - nuExp) / .25 };
+			maxErr = std::max(maxErr, std::abs(rLoc[2] - zExp));
+		}
+		return maxErr;
+	}
+
+	//! Check implicit step propagation (accuracy and reversibility)
+	void
+	test3
+		( std::ostringstream & oss
+		)
+	{
+		// IoR decreasing with height (rays curve back down)
+		env::index::Linear const media
+			( -.25*e3, 1.5
+			, std::make_shared<env::ActiveBox>
+				(Vector{ -40., -40., -4. }, Vector{ 40., 40., 4. })
+			);
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .5 }, Vector{ -30., 0., 0. }) };
+		constexpr std::size_t maxNodes{ 8192u };
+
+		// [DoxyExample02]
+
+		// large steps (about 1/100 of path) through turning point
+		constexpr double stepDist{ 1./8. };
+		NodeList nodes{ start };
+		nodes.theNodes.reserve(maxNodes);
+		double const errBig{ maxHeightError(media, start, stepDist, &nodes) };
+
+		// error reduction (second order) with half the step size
+		NodeList nodesHalf{ start };
+		nodesHalf.theNodes.reserve(maxNodes);
+		double const errHalf
+			{ maxHeightError(media, start, .5*stepDist, &nodesHalf) };
+
+		// [DoxyExample02]
+
+		if (! ((errBig < 1.e-3) && (3.5 < (errBig / errHalf))))
+		{
+			oss << "Failure of implicit step accuracy test\n";
+			oss << "errBig: " << io::fixed(errBig) << '\n';
+			oss << "errHalf: " << io::fixed(errHalf) << '\n';
+		}
+		for (ray::Node const & node : nodes.theNodes)
+		{
+			if (ray::Reflected == node.theDirChange)
+			{
+				oss << "Failure of implicit step no reflection test\n";
+				break;
+			}
+		}
+
+		// trace back from end (with end tangent at last node)
+		ray::Node const & endNode = nodes.theNodes.back();
+		Vector const & rEnd = endNode.theCurrLoc;
+		std::pair<double, Vector> const nuGrad
+			{ media.nuValueAndGradient(rEnd, stepDist) };
+		Vector const tEnd
+			{ ray::implicitTangentDir
+				(-endNode.theNextTan, nuGrad.first, nuGrad.second, .5*stepDist)
+			};
+		NodeList revNodes{ ray::Start::from(tEnd, rEnd) };
+		revNodes.theNodes.reserve(nodes.size());
+		ray::Propagator const prop
+			{ &media, stepDist, true, ray::ImplicitStep };
+		prop.tracePath(&revNodes);
+		Vector const & gotBeg = revNodes.theNodes.back().theCurrLoc;
+		Vector const & expBeg = start.thePntLoc;
+		double const begDif{ magnitude(gotBeg - expBeg) };
+		if (! (begDif < 1.e-5))
+		{
+			oss << "Failure of implicit step reverse path test\n";
+			oss << "expBeg: " << expBeg << '\n';
+			oss << "gotBeg: " << gotBeg << '\n';
+		}
+	}
+
+	//! Check symplectic step node spacing (arc length per step)
+	void
+	test4
+		( std::ostringstream & oss
+		)
+	{
+		// IoR decreasing with height (rays curve back down)
+		env::index::Linear const media
+			( -.25*e3, 1.5
+			, std::make_shared<env::ActiveBox>
+				(Vector{ -40., -40., -4. }, Vector{ 40., 40., 4. })
+			);
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .5 }, Vector{ -30., 0., 0. }) };
+		double const nuBeg{ media.nuValue(start.thePntLoc) };
+
+		constexpr double stepDist{ 1./8. };
+		ray::Propagator const prop
+			{ &media, stepDist, true, ray::SymplecticStep };
+		NodeList nodes{ start };
+		nodes.theNodes.reserve(1024u);
+		prop.tracePath(&nodes);
+
+		if (! (16u < nodes.size()))
+		{
+			oss << "Failure of symplectic node count test\n";
+			oss << "nodes.size: " << nodes.size() << '\n';
+			return;
+		}
+
+		// first step is (nearly) theStepDist of arc length
+		std::vector<ray::Node> const & allNodes = nodes.theNodes;
+		double const begDist
+			{ magnitude(allNodes[1].theCurrLoc - allNodes[0].theCurrLoc) };
+		if (! (std::abs(begDist - stepDist) < (.01 * stepDist)))
+		{
+			oss << "Failure of symplectic first step spacing test\n";
+			oss << "exp: " << io::fixed(stepDist) << '\n';
+			oss << "got: " << io::fixed(begDist) << '\n';
+		}
+
+		// each step, ds = nu*dSigma, scales with the local IoR
+		std::size_t numBad{ 0u };
+		for (std::size_t ndx{1u} ; ndx < allNodes.size() ; ++ndx)
+		{
+			ray::Node const & prevNode = allNodes[ndx - 1u];
+			double const gotDist
+				{ magnitude(allNodes[ndx].theCurrLoc - prevNode.theCurrLoc) };
+			double const expDist{ stepDist * prevNode.theNextNu / nuBeg };
+			if (! (std::abs(gotDist - expDist) < (1.e-12 * stepDist)))
+			{
+				++numBad;
+			}
+		}
+		if (0u < numBad)
+		{
+			oss << "Failure of symplectic node spacing test\n";
+			oss << "numBad: " << numBad << '\n';
+		}
+	}
 }
 
 
@@ -214,6 +524,10 @@ main
 
 	testBox(oss);
 	test0(oss);
+	test1(oss);
+	test2(oss);
+	test3(oss);
+	test4(oss);
 
 	return tst::finish(oss);
 }
@@ -0,0 +1,171 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for class math::QuadratureGK
+ *
+ */
+
+
+#include "mathQuadratureGK.hpp"
+
+#include "tst.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <sstream>
+
+
+namespace
+{
+
+	//! Check integration of smooth functions.
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// [DoxyExample01]
+
+		// tolerances on integral value determine subdivision
+		constexpr double tolAbs{ 1.e-14 };
+		constexpr double tolRel{ 1.e-14 };
+		aply::math::QuadratureGK const quad(tolAbs, tolRel);
+
+		// any function object with 'double operator()(double const &)'
+		auto const func
+			{ [] (double const & xx) { return std::sin(xx); } };
+
+		// integral value (and optional work counters)
+		aply::math::QuadratureStats stats{};
+		double const got{ quad.integralOf(func, 0., engabra::g3::pi, &stats) };
+
+		// [DoxyExample01]
+
+		tst::checkGotExp(oss, got, 2., "sin integral", 1.e-14);
+
+		// smooth integrand: a few GK15 intervals suffice
+		if (! (stats.theNumIntervals < 10u))
+		{
+			oss << "Failure of smooth interval count test\n";
+			oss << "theNumIntervals: " << stats.theNumIntervals << '\n';
+			oss << "     theNumEval: " << stats.theNumEval << '\n';
+		}
+
+		// reverse direction integration is negative
+		double const gotRev{ quad.integralOf(func, engabra::g3::pi, 0.) };
+		tst::checkGotExp(oss, gotRev, -2., "sin reverse", 1.e-14);
+
+		// empty interval
+		double const gotZero{ quad.integralOf(func, 1., 1.) };
+		tst::checkGotExp(oss, gotZero, 0., "empty interval", 0.);
+	}
+
+	//! Check integration of inverse square root endpoint singularity.
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		aply::math::QuadratureGK const quad(1.e-14, 1.e-14);
+
+		// integral of 1/sqrt(x) over [0,4] is 4
+		auto const func
+			{ [] (double const & xx) { return 1. / std::sqrt(xx); } };
+
+		// direct integration is possible but expensive
+		aply::math::QuadratureStats statsDirect{};
+		double const gotDirect{ quad.integralOf(func, 0., 4., &statsDirect) };
+		tst::checkGotExp(oss, gotDirect, 4., "direct singular", 1.e-13);
+
+		// substitution removes the singularity
+		aply::math::QuadratureStats statsSubst{};
+		double const gotSubst
+			{ quad.integralFromSingular(func, 4., &statsSubst) };
+		tst::checkGotExp(oss, gotSubst, 4., "subst singular", 1.e-14);
+
+		if (! (statsSubst.theNumEval < statsDirect.theNumEval))
+		{
+			oss << "Failure of singular substitution efficiency test\n";
+			oss << "statsDirect.theNumEval: " << statsDirect.theNumEval << '\n';
+			oss << " statsSubst.theNumEval: " << statsSubst.theNumEval << '\n';
+		}
+
+		// singularity at upper end: integral over x in [-4,0] of
+		// 1/sqrt(-x) with del = x-xSing for xSing=0 (i.e. delEnd=-4)
+		auto const funcNeg
+			{ [] (double const & del) { return 1. / std::sqrt(-del); } };
+		double const gotNeg{ quad.integralFromSingular(funcNeg, -4.) };
+		tst::checkGotExp(oss, gotNeg, -4., "subst singular neg", 1.e-14);
+	}
+
+	//! Check that non-finite integrands produce null results.
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		aply::math::QuadratureGK const quad{};
+
+		// imaginary square root over part of the range
+		auto const func
+			{ [] (double const & xx) { return std::sqrt(xx); } };
+		double const got{ quad.integralOf(func, -1., 1.) };
+		if (engabra::g3::isValid(got))
+		{
+			oss << "Failure of null integral test\n";
+			oss << "got: " << got << '\n';
+		}
+
+		// too few intervals to reach tolerance
+		aply::math::QuadratureGK const coarse(1.e-15, 1.e-15, 2u);
+		auto const spiky
+			{ [] (double const & xx) { return 1. / (1.e-6 + xx*xx); } };
+		double const gotCoarse{ coarse.integralOf(spiky, -1., 1.) };
+		if (engabra::g3::isValid(gotCoarse))
+		{
+			oss << "Failure of max interval null test\n";
+			oss << "gotCoarse: " << gotCoarse << '\n';
+		}
+	}
+
+}
+
+/*! \brief Unit test for math::QuadratureGK
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // smooth integrands
+	test1(oss); // end point singularity
+	test2(oss); // null results
+
+	return tst::finish(oss);
+}
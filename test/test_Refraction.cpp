@@ -325,6 +325,208 @@ test2
 
 }
 
+/*! \brief Check batch theta evaluation against individual evaluations.
+ */
+std::string
+test3
+	( std::ostringstream & oss
+	)
+{
+	constexpr double fwdLookAngle{ engabra::g3::piQtr }; // 45-deg off Nadir
+	constexpr double highSensor{  9000. };
+
+	double const radEarth{ aply::env::sEarth.theRadGround };
+	double const radSen{ radEarth + highSensor };
+	aply::ray::Refraction const refract(fwdLookAngle, radSen, radEarth);
+
+	// e.g. ground point, building top, tower top (any order)
+	std::vector<double> const radiiEnd
+		{ radEarth + 250., radEarth + 0., radEarth + 40. };
+	std::vector<double> const gotThetas{ refract.thetaAnglesAt(radiiEnd) };
+
+	if (! (radiiEnd.size() == gotThetas.size()))
+	{
+		oss << "Failure of thetaAnglesAt size test\n";
+	}
+	else
+	{
+		for (std::size_t nn{0u} ; nn < radiiEnd.size() ; ++nn)
+		{
+			double const expTheta{ refract.thetaAngleAt(radiiEnd[nn]) };
+			// agreement to within integration tolerance
+			constexpr double tolTheta{ 1.e-12 };
+			using engabra::g3::nearlyEqualsAbs;
+			if (! nearlyEqualsAbs(gotThetas[nn], expTheta, tolTheta))
+			{
+				using engabra::g3::io::fixed;
+				oss << "Failure of thetaAnglesAt value test\n";
+				oss << "exp: " << fixed(expTheta, 1u, 15u) << '\n';
+				oss << "got: " << fixed(gotThetas[nn], 1u, 15u) << '\n';
+			}
+		}
+	}
+
+	return oss.str();
+}
+
+/*! \brief Check grazing ray (integrand singular at tangent radius).
+ */
+std::string
+test4
+	( std::ostringstream & oss
+	)
+{
+	// uniform atmosphere: ray is a straight line
+	using aply::env::AirInfo;
+	aply::env::AirProfile const uniformAir
+		{ { { -1000., AirInfo{ -1000., 288.16, 101325. } }
+		  , { 20000., AirInfo{ 20000., 288.16, 101325. } }
+		} };
+
+	double const radEarth{ aply::env::sEarth.theRadGround };
+	double const radSen{ radEarth + 9000. };
+
+	// ray is horizontal (grazing) at the tangent radius
+	double const radTan{ radEarth + 1000. };
+	double const lookAngle{ std::asin(radTan / radSen) };
+
+	aply::ray::Refraction const refract
+		(lookAngle, radSen, radEarth, uniformAir);
+	double const gotTheta{ refract.thetaAngleAt(radTan) };
+
+	// straight line from sensor to tangent point (theta decreases downward)
+	double const expTheta{ -std::acos(radTan / radSen) };
+
+	constexpr double tolTheta{ 1.e-12 };
+	using engabra::g3::nearlyEqualsAbs;
+	if (! nearlyEqualsAbs(gotTheta, expTheta, tolTheta))
+	{
+		using engabra::g3::io::fixed;
+		oss << "Failure of grazing ray theta test\n";
+		oss << "exp: " << fixed(expTheta, 1u, 15u) << '\n';
+		oss << "got: " << fixed(gotTheta, 1u, 15u) << '\n';
+	}
+
+	return oss.str();
+}
+
+/*! \brief Check closed form approximation and tiered evaluation.
+ */
+std::string
+test5
+	( std::ostringstream & oss
+	)
+{
+	double const radEarth{ aply::env::sEarth.theRadGround };
+	double const radSen{ radEarth + 9000. };
+	double const radGnd{ radEarth + 0. };
+
+	// error estimate should bound actual approximation error
+	constexpr double degPerRad{ 180. / engabra::g3::pi };
+	for (double lookDeg{0.} ; lookDeg < 85. ; lookDeg += 5.)
+	{
+		aply::ray::Refraction const refract
+			(lookDeg/degPerRad, radSen, radEarth);
+		std::pair<double, double> const thetaError
+			{ refract.thetaAngleApprox(radGnd) };
+		double const expTheta{ refract.thetaAngleAt(radGnd) };
+		double const gotErr{ std::abs(thetaError.first - expTheta) };
+		if (! (gotErr <= thetaError.second))
+		{
+			using engabra::g3::io::fixed;
+			oss << "Failure of approximation error estimate test\n";
+			oss << "lookDeg: " << fixed(lookDeg, 2u, 1u) << '\n';
+			oss << " gotErr: " << gotErr << '\n';
+			oss << " estErr: " << thetaError.second << '\n';
+		}
+	}
+
+	// [DoxyExample02]
+
+	// near nadir queries use the approximation, oblique ones integrate
+	constexpr double tolTheta{ 1.e-9 }; // [rad]
+	aply::ray::RefractionStats stats{};
+	std::vector<double> const lookDegs{ 1., 5., 10., 80. };
+	for (double const & lookDeg : lookDegs)
+	{
+		aply::ray::Refraction const refract
+			(lookDeg/degPerRad, radSen, radEarth);
+		double const gotTheta
+			{ refract.thetaAngleWithin(radGnd, tolTheta, &stats) };
+		// ...
+	// [DoxyExample02]
+
+		double const expTheta{ refract.thetaAngleAt(radGnd) };
+		using engabra::g3::nearlyEqualsAbs;
+		if (! nearlyEqualsAbs(gotTheta, expTheta, tolTheta))
+		{
+			using engabra::g3::io::fixed;
+			oss << "Failure of thetaAngleWithin value test\n";
+			oss << "lookDeg: " << fixed(lookDeg, 2u, 1u) << '\n';
+			oss << "exp: " << fixed(expTheta, 1u, 15u) << '\n';
+			oss << "got: " << fixed(gotTheta, 1u, 15u) << '\n';
+		}
+	}
+
+	if (! ((3u == stats.theNumFast) && (1u == stats.theNumSlow)))
+	{
+		oss << "Failure of thetaAngleWithin stats test\n";
+		oss << "theNumFast: " << stats.theNumFast << '\n';
+		oss << "theNumSlow: " << stats.theNumSlow << '\n';
+	}
+	tst::checkGotExp(oss, stats.fastFraction(), .75, "fastFraction", 0.);
+
+	return oss.str();
+}
+
+/*! \brief Check batch theta evaluation for a grazing ray.
+ */
+std::string
+test6
+	( std::ostringstream & oss
+	)
+{
+	aply::env::AirProfile const airProfile{ aply::env::coesa::airProfile() };
+	double const radEarth{ aply::env::sEarth.theRadGround };
+	double const radSen{ radEarth + 9000. };
+
+	// ray is horizontal (grazing) at the tangent radius
+	double const radTan{ radEarth + 1000. };
+	double const nuSen{ airProfile.indexOfRefraction(radSen - radEarth) };
+	double const nuTan{ airProfile.indexOfRefraction(radTan - radEarth) };
+	double const lookAngle{ std::asin((radTan*nuTan) / (radSen*nuSen)) };
+	aply::ray::Refraction const refract(lookAngle, radSen, radEarth);
+
+	// tangent radius, just above it, and partway down
+	std::vector<double> const radiiEnd
+		{ radEarth + 5000., radTan, radTan + 1.e-3, radEarth + 1100. };
+	std::vector<double> const gotThetas{ refract.thetaAnglesAt(radiiEnd) };
+
+	if (! (radiiEnd.size() == gotThetas.size()))
+	{
+		oss << "Failure of grazing thetaAnglesAt size test\n";
+	}
+	else
+	{
+		for (std::size_t nn{0u} ; nn < radiiEnd.size() ; ++nn)
+		{
+			double const expTheta{ refract.thetaAngleAt(radiiEnd[nn]) };
+			constexpr double tolTheta{ 1.e-12 };
+			using engabra::g3::nearlyEqualsAbs;
+			if (! nearlyEqualsAbs(gotThetas[nn], expTheta, tolTheta))
+			{
+				using engabra::g3::io::fixed;
+				oss << "Failure of grazing thetaAnglesAt value test\n";
+				oss << "height: " << fixed(radiiEnd[nn] - radEarth) << '\n';
+				oss << "exp: " << fixed(expTheta, 1u, 15u) << '\n';
+				oss << "got: " << fixed(gotThetas[nn], 1u, 15u) << '\n';
+			}
+		}
+	}
+
+	return oss.str();
+}
+
 /*! \brief Unit test for Refraction computation
  */
 int
@@ -336,6 +538,10 @@ main
 	test0(oss);
 	test1(oss);
 	test2(oss);
+	test3(oss);
+	test4(oss);
+	test5(oss);
+	test6(oss);
 
 	return tst::finish(oss);
 }
@@ -0,0 +1,202 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Unit test for ray::RefractionFan
+*/
+
+
+#include "envAirProfile.hpp"
+#include "envCoesa1976.hpp"
+#include "envPlanet.hpp"
+#include "rayRefraction.hpp"
+#include "rayRefractionFan.hpp"
+
+#include "tst.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	//! Check lockstep fan values against individual Refraction instances.
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		using namespace engabra::g3;
+
+		constexpr double highSensor{ 9000. };
+		constexpr double highGround{  250. };
+		double const radEarth{ aply::env::sEarth.theRadGround };
+		double const radSen{ radEarth + highSensor };
+		double const radGnd{ radEarth + highGround };
+
+		// [DoxyExample00]
+
+		// look angles (from Nadir) for which to compute deviations
+		constexpr std::size_t numLooks{ 1000u };
+		constexpr double maxLook{ 80. * pi / 180. };
+		std::vector<double> lookAngles;
+		lookAngles.reserve(numLooks);
+		for (std::size_t nn{0u} ; nn < numLooks ; ++nn)
+		{
+			double const frac{ double(nn) / double(numLooks - 1u) };
+			lookAngles.emplace_back(frac * maxLook);
+		}
+
+		// all look angles integrated together (IoR evaluated once per node)
+		aply::ray::RefractionFan const fan(lookAngles, radSen, radEarth);
+		std::vector<double> const gotThetas{ fan.thetaAnglesAt(radGnd) };
+		std::vector<double> const gotDevs
+			{ fan.angularDeviationsFromStart(radGnd) };
+
+		// [DoxyExample00]
+
+		if (! ((numLooks == gotThetas.size()) && (numLooks == gotDevs.size())))
+		{
+			oss << "Failure of fan size test\n";
+			return;
+		}
+
+		// check against individual evaluations
+		for (std::size_t nn{0u} ; nn < numLooks ; ++nn)
+		{
+			double const & look = lookAngles[nn];
+			aply::ray::Refraction const refract(look, radSen, radEarth);
+			double const expTheta{ refract.thetaAngleAt(radGnd) };
+			double const expDev
+				{ refract.angularDeviationFromStart(radGnd, expTheta) };
+
+			// both converge to quadrature tolerance (1.e-15 per piece)
+			// deviation is amplified by about radiusEarth/pathLength
+			constexpr double tolTheta{ 1.e-14 };
+			constexpr double tolDev{ 1.e-11 };
+			if ( (! nearlyEqualsAbs(gotThetas[nn], expTheta, tolTheta))
+			  || (! nearlyEqualsAbs(gotDevs[nn], expDev, tolDev))
+			   )
+			{
+				oss << "Failure of fan theta/deviation test\n";
+				oss << "   look: " << io::fixed(look, 1u, 6u) << '\n';
+				oss << "expTheta: " << io::fixed(expTheta, 1u, 15u) << '\n';
+				oss << "gotTheta: " << io::fixed(gotThetas[nn], 1u, 15u)
+					<< '\n';
+				oss << "  expDev: " << io::fixed(expDev, 1u, 12u) << '\n';
+				oss << "  gotDev: " << io::fixed(gotDevs[nn], 1u, 12u)
+					<< '\n';
+				break;
+			}
+		}
+	}
+
+	//! Check fan values for (near) grazing look angles.
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace engabra::g3;
+
+		aply::env::AirProfile const airProfile
+			{ aply::env::coesa::airProfile() };
+		double const radEarth{ aply::env::sEarth.theRadGround };
+		double const radSen{ radEarth + 9000. };
+
+		// look angle for ray that is horizontal at the tangent radius
+		double const radTan{ radEarth + 1000. };
+		double const nuSen{ airProfile.indexOfRefraction(radSen - radEarth) };
+		double const nuTan{ airProfile.indexOfRefraction(radTan - radEarth) };
+		double const lookTan{ std::asin((radTan*nuTan) / (radSen*nuSen)) };
+
+		// fan with looks grazing, nearly grazing, and missing radTan
+		std::vector<double> const lookAngles
+			{ lookTan - 1.e-3, lookTan - 1.e-6, lookTan - 1.e-9
+			, lookTan, lookTan + 1.e-6
+			};
+		aply::ray::RefractionFan const fan(lookAngles, radSen, radEarth);
+
+		// tangent radius, just above it, and partway down
+		std::vector<double> const radiiEnd
+			{ radEarth + 5000., radTan, radTan + 1.e-3, radEarth + 1100. };
+		for (double const & radiusEnd : radiiEnd)
+		{
+			std::vector<double> const gotThetas
+				{ fan.thetaAnglesAt(radiusEnd) };
+			for (std::size_t nn{0u} ; nn < lookAngles.size() ; ++nn)
+			{
+				aply::ray::Refraction const refract
+					(lookAngles[nn], radSen, radEarth);
+				double const expTheta{ refract.thetaAngleAt(radiusEnd) };
+
+				// grazing rays may be evaluated with relaxed tolerance
+				constexpr double tolTheta{ 1.e-12 };
+				bool const sameValid
+					{ isValid(expTheta) == isValid(gotThetas[nn]) };
+				bool const okay
+					{ (! isValid(expTheta))
+					|| nearlyEqualsAbs(gotThetas[nn], expTheta, tolTheta)
+					};
+				if (! (sameValid && okay))
+				{
+					oss << "Failure of grazing fan theta test\n";
+					oss << "height: " << io::fixed(radiusEnd - radEarth)
+						<< '\n';
+					oss << "lookDel: " << (lookAngles[nn] - lookTan) << '\n';
+					oss << "exp: " << io::fixed(expTheta, 1u, 15u) << '\n';
+					oss << "got: " << io::fixed(gotThetas[nn], 1u, 15u)
+						<< '\n';
+				}
+			}
+		}
+
+		// ray tangent at radTan is valid all the way down to it
+		std::vector<double> const tanThetas{ fan.thetaAnglesAt(radTan) };
+		if (! isValid(tanThetas[3u]))
+		{
+			oss << "Failure of tangent ray fan validity test\n";
+		}
+	}
+
+} // [anon]
+
+
+/*! \brief Unit test for ray::RefractionFan
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
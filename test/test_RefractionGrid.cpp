@@ -0,0 +1,231 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+\brief Unit test for cam::RefractionGrid
+*/
+
+
+#include "camRefractionGrid.hpp"
+#include "envPlanet.hpp"
+#include "rayRefraction.hpp"
+
+#include "tst.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	//! Expected displacement (evaluated with individual Refraction).
+	aply::cam::ImgRowCol
+	expDisplacementAt
+		( aply::cam::Interior const & interior
+		, aply::cam::ImgRowCol const & rowCol
+		, double const & heightSensor
+		, double const & heightGround
+		)
+	{
+		double const radEarth{ aply::env::sEarth.theRadGround };
+		double const radSen{ radEarth + heightSensor };
+		double const radGnd{ radEarth + heightGround };
+
+		double const dRow{ rowCol[0] - interior.thePrincipalPoint[0] };
+		double const dCol{ rowCol[1] - interior.thePrincipalPoint[1] };
+		double const rho{ std::hypot(dRow, dCol) };
+		double const lookAngle{ interior.angleForRadialPixels(rho) };
+
+		aply::ray::Refraction const refract(lookAngle, radSen, radEarth);
+		double const deviation{ refract.angularDeviationFromStart(radGnd) };
+		double const rhoIdeal
+			{ interior.radialPixelsForAngle(lookAngle - deviation) };
+		double const scl{ (rhoIdeal - rho) / rho };
+		return aply::cam::ImgRowCol{ scl * dRow, scl * dCol };
+	}
+
+	//! Check frame camera grid values against individual Refraction.
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		constexpr double heightSensor{ 3000. };
+		constexpr double heightGround{  100. };
+
+		// [DoxyExample01]
+
+		// e.g. 6 Mpix frame with 5 micron pixels and 50 mm lens
+		aply::cam::Interior const interior
+			{ aply::cam::Interior::frame(2000u, 3000u, 5.e-6, .050) };
+
+		// displacement grid (filled in parallel)
+		aply::cam::RefractionGrid const grid
+			(interior, heightSensor, heightGround);
+
+		// correction for a measured image location
+		aply::cam::ImgRowCol const rowCol{ 123.4, 2876.5 };
+		aply::cam::ImgRowCol const disp{ grid.displacementAt(rowCol) };
+		aply::cam::ImgRowCol const fixRowCol{ grid.correctedRowCol(rowCol) };
+
+		// [DoxyExample01]
+
+		if (! grid.isValid())
+		{
+			oss << "Failure of valid grid test\n";
+			oss << grid.infoString("grid") << '\n';
+		}
+
+		// correction is toward nadir (refraction displaces images outward)
+		aply::cam::ImgRowCol const expDisp
+			{ expDisplacementAt(interior, rowCol, heightSensor, heightGround) };
+		constexpr double tolPix{ 1.e-4 }; // interpolation and integration
+		tst::checkGotExp(oss, disp[0], expDisp[0], "disp row", tolPix);
+		tst::checkGotExp(oss, disp[1], expDisp[1], "disp col", tolPix);
+		tst::checkGotExp
+			(oss, fixRowCol[0], rowCol[0] + disp[0], "fix row", 0.);
+		tst::checkGotExp
+			(oss, fixRowCol[1], rowCol[1] + disp[1], "fix col", 0.);
+		if (! ((0. < disp[0]) && (disp[1] < 0.)))
+		{
+			oss << "Failure of displacement direction test\n";
+			oss << "disp: " << disp[0] << ", " << disp[1] << '\n';
+		}
+
+		// check at several other locations (including format corners)
+		std::vector<aply::cam::ImgRowCol> const rowCols
+			{ { 0., 0. }
+			, { 1999., 2999. }
+			, { 0., 2999. }
+			, { 1000.25, 17.75 }
+			, { 640., 1500. }
+			};
+		for (aply::cam::ImgRowCol const & rc : rowCols)
+		{
+			aply::cam::ImgRowCol const got{ grid.displacementAt(rc) };
+			aply::cam::ImgRowCol const exp
+				{ expDisplacementAt(interior, rc, heightSensor, heightGround) };
+			tst::checkGotExp(oss, got[0], exp[0], "grid row", tolPix);
+			tst::checkGotExp(oss, got[1], exp[1], "grid col", tolPix);
+		}
+
+		// no displacement at nadir
+		aply::cam::ImgRowCol const nadirDisp
+			{ grid.displacementAt(interior.thePrincipalPoint) };
+		tst::checkGotExp(oss, nadirDisp[0], 0., "nadir row", tolPix);
+		tst::checkGotExp(oss, nadirDisp[1], 0., "nadir col", tolPix);
+
+		// null outside of format
+		if (engabra::g3::isValid(grid.displacementAt({ -1., 10. })[0]))
+		{
+			oss << "Failure of outside format null test\n";
+		}
+
+		// row-wise evaluation matches individual queries
+		std::vector<aply::cam::ImgRowCol> rowDisps;
+		grid.displacementsForRow(1000u, &rowDisps);
+		if (! (interior.theNumCols == rowDisps.size()))
+		{
+			oss << "Failure of displacementsForRow size test\n";
+		}
+		else
+		{
+			for (std::size_t col{0u} ; col < rowDisps.size() ; col += 37u)
+			{
+				aply::cam::ImgRowCol const & got = rowDisps[col];
+				double const colAt{ static_cast<double>(col) };
+				aply::cam::ImgRowCol const exp
+					{ grid.displacementAt({ 1000., colAt }) };
+				tst::checkGotExp(oss, got[0], exp[0], "rowDisps row", 1.e-12);
+				tst::checkGotExp(oss, got[1], exp[1], "rowDisps col", 1.e-12);
+			}
+		}
+
+		// result is independent of thread count
+		aply::cam::RefractionGrid const grid1
+			( interior, heightSensor, heightGround
+			, aply::env::coesa::airProfile()
+			, aply::env::sEarth.theRadGround
+			, 32u
+			, 1u
+			);
+		aply::cam::ImgRowCol const got1{ grid1.displacementAt(rowCol) };
+		tst::checkGotExp(oss, got1[0], disp[0], "thread row", 0.);
+		tst::checkGotExp(oss, got1[1], disp[1], "thread col", 0.);
+	}
+
+	//! Check pushbroom (single line) camera.
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		constexpr double heightSensor{ 9000. };
+		constexpr double heightGround{    0. };
+
+		aply::cam::Interior const interior
+			{ aply::cam::Interior::pushbroom(12000u, 6.5e-6, .100) };
+		aply::cam::RefractionGrid const grid
+			(interior, heightSensor, heightGround);
+
+		std::vector<aply::cam::ImgRowCol> const rowCols
+			{ { 0., 0. }
+			, { 0., 101.5 }
+			, { 0., 11999. }
+			};
+		for (aply::cam::ImgRowCol const & rc : rowCols)
+		{
+			aply::cam::ImgRowCol const got{ grid.displacementAt(rc) };
+			aply::cam::ImgRowCol const exp
+				{ expDisplacementAt(interior, rc, heightSensor, heightGround) };
+			tst::checkGotExp(oss, got[0], 0., "line row", 0.);
+			tst::checkGotExp(oss, got[1], exp[1], "line col", 1.e-4);
+		}
+
+		// only the detector line is within format
+		if (engabra::g3::isValid(grid.displacementAt({ .5, 10. })[0]))
+		{
+			oss << "Failure of pushbroom outside format null test\n";
+		}
+	}
+
+}
+
+/*! \brief Unit test for cam::RefractionGrid
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // frame camera
+	test1(oss); // pushbroom camera
+
+	return tst::finish(oss);
+}
@@ -0,0 +1,218 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::StepStudy
+ *
+ */
+
+
+#include "rayStepStudy.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+
+#include "example/indexModel.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Height error of location (vs analytic path in linear media)
+	double
+	heightError
+		( Vector const & rLoc
+		, ray::Start const & start
+		)
+	{
+		// nu*t (horizontal) is constant, and with ds = nu*dSigma
+		// nu(sigma) = nu0*cosh(.25*sigma) - nu0*tz0*sinh(.25*sigma)
+		Vector const & tBeg = start.theTanDir;
+		Vector const & rBeg = start.thePntLoc;
+		double const nu0{ 1.5 - .25*rBeg[2] };
+		double const nuHorz{ nu0 * std::hypot(tBeg[0], tBeg[1]) };
+		double const sigma{ (rLoc[0] - rBeg[0]) / nuHorz };
+		double const nuExp
+			{ nu0*std::cosh(.25*sigma) - nu0*tBeg[2]*std::sinh(.25*sigma) };
+		double const zExp{ (1.5 - nuExp) / .25 };
+		return std::abs(rLoc[2] - zExp);
+	}
+
+	//! Check observed order and extrapolation for implicit step method
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// IoR decreasing with height (rays curve back down)
+		env::index::Linear const media
+			( -.25*e3, 1.5
+			, std::make_shared<env::ActiveBox>
+				(Vector{ -40., -40., -4. }, Vector{ 40., 40., 4. })
+			);
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .5 }, Vector{ -30., 0., 0. }) };
+
+		// [DoxyExample01]
+
+		// trace ray with step sizes 1/4, 1/8, ... 1/64 (in parallel)
+		constexpr double pathLength{ 8. };
+		constexpr double coarseStep{ 1./4. };
+		ray::StepStudy const study
+			( &media, start, pathLength, coarseStep, 5u, ray::ImplicitStep );
+
+		// observed order (about 2 for ImplicitStep) and zero step result
+		double const order{ study.locOrder() };
+		Vector const bestLoc{ study.extrapolatedLoc() };
+
+		// cheapest step size with estimated end location error < 1mm
+		double const useStep{ study.largestStepFor(1.e-3) };
+
+		// [DoxyExample01]
+
+		if (! study.isValid())
+		{
+			oss << "Failure of valid study test\n";
+			oss << study.infoString("study") << '\n';
+			return;
+		}
+		if (! ((1.8 < order) && (order < 2.2)))
+		{
+			oss << "Failure of implicit step order test\n";
+			oss << study.infoString("study") << '\n';
+		}
+
+		// extrapolation is more accurate than finest rung
+		ray::StepStudy::Rung const & fine = study.rungs().back();
+		double const errFine{ heightError(fine.theEndLoc, start) };
+		double const errBest{ heightError(bestLoc, start) };
+		if (! (errBest < .1*errFine))
+		{
+			oss << "Failure of extrapolation improvement test\n";
+			oss << "errFine: " << io::fixed(errFine, 1u, 12u) << '\n';
+			oss << "errBest: " << io::fixed(errBest, 1u, 12u) << '\n';
+		}
+
+		// estimated errors bracket actual ones (within factor of 2)
+		for (ray::StepStudy::Rung const & rung : study.rungs())
+		{
+			double const errGot{ heightError(rung.theEndLoc, start) };
+			double const errEst{ rung.theLocError };
+			if (! ((errGot < 2.*errEst) && (errEst < 2.*errGot)))
+			{
+				oss << "Failure of rung error estimate test\n";
+				oss << "errEst: " << io::fixed(errEst, 1u, 12u) << '\n';
+				oss << "errGot: " << io::fixed(errGot, 1u, 12u) << '\n';
+				oss << study.infoString("study") << '\n';
+				break;
+			}
+		}
+
+		// chosen step meets tolerance and next larger step does not
+		bool okStep{ engabra::g3::isValid(useStep) };
+		for (ray::StepStudy::Rung const & rung : study.rungs())
+		{
+			if (useStep < rung.theStepDist)
+			{
+				okStep &= (1.e-3 < rung.theLocError);
+			}
+			else
+			if (useStep == rung.theStepDist)
+			{
+				okStep &= (! (1.e-3 < rung.theLocError));
+			}
+		}
+		if (! okStep)
+		{
+			oss << "Failure of largest step test\n";
+			oss << "useStep: " << useStep << '\n';
+			oss << study.infoString("study") << '\n';
+		}
+
+		// ray leaving media invalidates study
+		ray::StepStudy const badStudy(&media, start, 1000., coarseStep, 3u);
+		double const badStep{ badStudy.largestStepFor(1.) };
+		if (badStudy.isValid() || engabra::g3::isValid(badStep))
+		{
+			oss << "Failure of invalid study test\n";
+		}
+	}
+
+	//! Check that no step size qualifies without evidence of convergence
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		// uniform media: all rungs agree (to roundoff), no order
+		std::shared_ptr<env::ActiveVolume> const ptVolume
+			{ std::make_shared<env::ActiveBox>
+				(Vector{ -40., -40., -4. }, Vector{ 40., 40., 4. })
+			};
+		env::index::Slab const media(e1, -1., 1., 1.5, 1.5, 1.5, ptVolume);
+		ray::Start const start
+			{ ray::Start::from(Vector{ 1., 0., .5 }, Vector{ -30., 0., 0. }) };
+		ray::StepStudy const study(&media, start, 8., 1./4., 4u);
+
+		double const useStep{ study.largestStepFor(1.) };
+		ray::StepStudy::Rung const & fine = study.rungs().back();
+		if (! ( study.isValid()
+			 && (! engabra::g3::isValid(study.locOrder()))
+			 && (! engabra::g3::isValid(fine.theLocError))
+			 && (! engabra::g3::isValid(useStep))
+			  ))
+		{
+			oss << "Failure of no convergence test\n";
+			oss << "useStep: " << useStep << '\n';
+			oss << study.infoString("study") << '\n';
+		}
+	}
+
+}
+
+
+/*! \brief Unit test for ray::StepStudy
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss);
+	test1(oss);
+
+	return tst::finish(oss);
+}
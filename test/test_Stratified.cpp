@@ -0,0 +1,304 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::Stratified
+ *
+ */
+
+
+#include "rayStratified.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+#include "rayRefraction.hpp"
+
+#include "example/nodeList.hpp"
+
+#include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	using aply::examp::NodeList;
+
+	//! Check turning point (and layer crossings) against analytic path
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		// nu^2 = nuSq0 + slope*height (same slope in all layers)
+		constexpr double nuSq0{ 2.25 };
+		constexpr double slope{ -.01 };
+		std::vector<double> const heights{ 0., 1., 2.5, 4., 10. };
+		std::vector<double> nus;
+		for (double const & height : heights)
+		{
+			nus.emplace_back(std::sqrt(nuSq0 + slope*height));
+		}
+
+		// ray leaving ground (slightly upward) turns back down
+		double const elev{ .05 };
+		Vector const tBeg{ std::cos(elev), 0., std::sin(elev) };
+		Vector const rBeg{ 3., 4., 0. };
+		constexpr double nodeDist{ .25 };
+
+		// [DoxyExample01]
+
+		// planar layers (ref ctor for spherical shells)
+		ray::Stratified const media(heights, nus);
+
+		// trace ray (ray::Path or similar consumer)
+		NodeList nodes{ ray::Start{ tBeg, rBeg }, {} };
+		nodes.theNodes.reserve(1024u);
+		media.tracePath(&nodes, nodeDist);
+
+		// last node is at location where ray leaves media
+		ray::Node const & endNode = nodes.theNodes.back();
+
+		// [DoxyExample01]
+
+		// analytic solution - ray returns to ground (at parameter sigRet)
+		double const nf{ std::sqrt(nuSq0) };
+		double const pw0{ nf * std::sin(elev) };
+		double const cInv{ nf * std::cos(elev) };
+		double const sigRet{ -4. * pw0 / slope };
+		Vector const expEndLoc{ rBeg + (cInv * sigRet) * e1 };
+		Vector const expEndTan{ tBeg[0], 0., -tBeg[2] };
+		double const expApex{ (cInv*cInv - nuSq0) / slope };
+
+		// arc length: (2/B)*(G(-pw0) - G(pw0))
+		double const gArc
+			{ pw0*std::sqrt(cInv*cInv + pw0*pw0)
+			+ cInv*cInv*std::asinh(pw0/cInv)
+			};
+		double const arcLen{ -2. * gArc / slope };
+		std::size_t const expSize
+			{ static_cast<std::size_t>(std::ceil(arcLen / nodeDist)) + 1u };
+
+		constexpr double tol{ 1.e-12 };
+		Vector const & gotEndLoc = endNode.theCurrLoc;
+		Vector const & gotEndTan = endNode.theNextTan;
+		tst::checkGotExp(oss, gotEndLoc, expEndLoc, "end location", tol);
+		tst::checkGotExp(oss, gotEndTan, expEndTan, "end tangent", tol);
+
+		std::size_t const & gotSize = nodes.theNodes.size();
+		if (! (expSize == gotSize))
+		{
+			oss << "Failure of node count test\n";
+			oss << "exp: " << expSize << '\n';
+			oss << "got: " << gotSize << '\n';
+		}
+
+		if (! (ray::Stopped == endNode.theDirChange))
+		{
+			oss << "Failure of end node Stopped test\n";
+		}
+
+		// nodes spaced by nodeDist (chords are very slightly shorter)
+		double gotApex{ 0. };
+		double maxSpaceErr{ 0. };
+		for (std::size_t ndx{1u} ; (ndx + 1u) < gotSize ; ++ndx)
+		{
+			ray::Node const & node = nodes.theNodes[ndx];
+			Vector const & rPrev = nodes.theNodes[ndx - 1u].theCurrLoc;
+			double const chord{ magnitude(node.theCurrLoc - rPrev) };
+			maxSpaceErr = std::max(maxSpaceErr, std::abs(chord - nodeDist));
+			gotApex = std::max(gotApex, node.theCurrLoc[2]);
+
+			// IoR is consistent with (linear) media model
+			double const expNu
+				{ std::sqrt(nuSq0 + slope*node.theCurrLoc[2]) };
+			tst::checkGotExp(oss, node.theNextNu, expNu, "node nu", tol);
+		}
+		if (! (maxSpaceErr < 1.e-6))
+		{
+			oss << "Failure of node spacing test\n";
+			oss << "maxSpaceErr: " << maxSpaceErr << '\n';
+		}
+		// a node is near the apex (tangent is horizontal there)
+		double const apexErr{ expApex - gotApex };
+		if (! ((0. < apexErr) && (apexErr < nodeDist*nodeDist)))
+		{
+			oss << "Failure of apex height test\n";
+			oss << "expApex: " << io::fixed(expApex) << '\n';
+			oss << "gotApex: " << io::fixed(gotApex) << '\n';
+		}
+	}
+
+	//! Check mirage (turning inside a layer) and path reversal
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		// IoR increasing with height (e.g. air above hot surface)
+		std::vector<double> const heights{ 0., .5, 1., 2., 5. };
+		std::vector<double> const nus
+			{ 1.000200, 1.000230, 1.000250, 1.000262, 1.000270 };
+		ray::Stratified const media(heights, nus);
+
+		// downward ray turns upward (and leaves through the top)
+		Vector const tBeg{ direction(Vector{ 1., 0., -.004 }) };
+		Vector const rBeg{ 0., 0., 1.5 };
+		NodeList fwdNodes{ ray::Start{ tBeg, rBeg }, {} };
+		fwdNodes.theNodes.reserve(4096u);
+		media.tracePath(&fwdNodes, 1.);
+
+		double minHigh{ rBeg[2] };
+		for (ray::Node const & node : fwdNodes.theNodes)
+		{
+			minHigh = std::min(minHigh, node.theCurrLoc[2]);
+		}
+		Vector const & endLoc = fwdNodes.theNodes.back().theCurrLoc;
+		bool const okayTurn
+			{  (0. < minHigh)
+			&& (minHigh < heights[2])
+			&& (heights.back() == endLoc[2])
+			};
+		if (! okayTurn)
+		{
+			oss << "Failure of mirage turning test\n";
+			oss << "minHigh: " << io::fixed(minHigh) << '\n';
+			oss << "endLoc: " << io::fixed(endLoc) << '\n';
+		}
+
+		// trace forward (through the turning point), then back again
+		constexpr std::size_t numNodes{ 601u };
+		NodeList aheadNodes{ ray::Start{ tBeg, rBeg }, {} };
+		aheadNodes.theNodes.reserve(numNodes);
+		media.tracePath(&aheadNodes, .75);
+
+		ray::Node const & aheadEnd = aheadNodes.theNodes.back();
+		ray::Start const revStart{ -aheadEnd.theNextTan, aheadEnd.theCurrLoc };
+		NodeList backNodes{ revStart, {} };
+		backNodes.theNodes.reserve(numNodes);
+		media.tracePath(&backNodes, .75);
+
+		ray::Node const & backEnd = backNodes.theNodes.back();
+		constexpr double tol{ 1.e-12 };
+		tst::checkGotExp(oss, backEnd.theCurrLoc, rBeg, "reverse loc", tol);
+		tst::checkGotExp(oss, backEnd.theNextTan, -tBeg, "reverse tan", tol);
+	}
+
+
+	//! Check spherical shells (COESA atmosphere) against ray::Refraction
+	void
+	test2
+		( std::ostringstream & oss
+		)
+	{
+		double const radEarth{ env::sEarth.theRadGround };
+		env::AirProfile const airProfile{ env::coesa::airProfile() };
+
+		// layer boundaries (including profile break heights)
+		std::vector<double> heights;
+		for (double height{0.} ; height < 12000. ; height += 25.)
+		{
+			heights.emplace_back(height);
+		}
+		for (double const & breakHigh : airProfile.breakHeights())
+		{
+			if ((0. < breakHigh) && (breakHigh < 12000.))
+			{
+				heights.emplace_back(breakHigh);
+			}
+		}
+		std::sort(heights.begin(), heights.end());
+		heights.erase
+			(std::unique(heights.begin(), heights.end()), heights.end());
+		ray::Stratified const media(heights, airProfile, radEarth);
+
+		// sensor above ground looking down at various (off nadir) angles
+		double const radSen{ radEarth + 10000. };
+		Vector const rBeg{ radSen * e3 };
+		for (double const & lookAngle : { .30, .75, 1.30 })
+		{
+			Vector const tBeg
+				{ std::sin(lookAngle), 0., -std::cos(lookAngle) };
+			ray::Start const start{ tBeg, rBeg };
+
+			// path ends where ray reaches the ground (bottom layer)
+			NodeList nodes{ start, {} };
+			nodes.theNodes.reserve(8192u);
+			media.tracePath(&nodes, 10.);
+			Vector const & endLoc = nodes.theNodes.back().theCurrLoc;
+			double const gotTheta{ std::atan2(endLoc[0], endLoc[2]) };
+
+			// numerically integrated path through (continuous) profile
+			ray::Refraction const refraction(lookAngle, radSen, radEarth);
+			double const expTheta
+				{ std::abs(refraction.thetaAngleAt(radEarth)) };
+
+			std::ostringstream msg;
+			msg << "theta at lookAngle: " << lookAngle;
+			tst::checkGotExp(oss, gotTheta, expTheta, msg.str(), 1.e-8);
+
+			// effort (and result) is independent of node spacing
+			NodeList endNodes{ start, {} };
+			endNodes.theNodes.reserve(8u);
+			media.tracePath(&endNodes, 1.e9);
+			std::size_t const expSize{ 2u };
+			std::size_t const gotSize{ endNodes.theNodes.size() };
+			if (! (expSize == gotSize))
+			{
+				oss << "Failure of large nodeDist size test\n";
+				oss << "exp: " << expSize << '\n';
+				oss << "got: " << gotSize << '\n';
+			}
+			Vector const & gotEnd = endNodes.theNodes.back().theCurrLoc;
+			tst::checkGotExp(oss, gotEnd, endLoc, "large nodeDist", 1.e-15);
+		}
+	}
+
+}
+
+/*! \brief Unit test for ray::Stratified
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // planar layers, turning point
+	test1(oss); // mirage, reversal
+	test2(oss); // spherical shells, compare with ray::Refraction
+
+	return tst::finish(oss);
+}
+
@@ -0,0 +1,291 @@
+// 
+// MIT License
+// 
+// Copyright (c) 2023 Stellacore Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+
+
+/*! \file
+ *
+ * \brief Unit test for ray::nextTangentDirs() and Propagator::tracePacket()
+ *
+ */
+
+
+#include "rayTangentBatch.hpp"
+
+#include "tst.hpp"
+
+#include "env.hpp"
+#include "ray.hpp"
+
+#include "example/indexModel.hpp"
+#include "example/nodeList.hpp"
+
+#include <Engabra>
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+	using namespace engabra::g3;
+
+	//! Check batched kernel against scalar nextTangentDir()
+	void
+	test0
+		( std::ostringstream & oss
+		)
+	{
+		std::mt19937 gen(47989u);
+		std::uniform_real_distribution<double> distCoord(-1., 1.);
+		std::uniform_real_distribution<double> distNu(1., 1.6);
+		auto const randVec
+			{ [&gen, &distCoord] ()
+				{
+					double const xx{ distCoord(gen) };
+					double const yy{ distCoord(gen) };
+					double const zz{ distCoord(gen) };
+					return Vector{ xx, yy, zz };
+				}
+			};
+
+		constexpr std::size_t numSamp{ 4096u };
+		std::vector<Vector> tans;
+		std::vector<Vector> grads;
+		std::vector<double> nuPrevs;
+		std::vector<double> nuNexts;
+		for (std::size_t ns{0u} ; ns < numSamp ; ++ns)
+		{
+			Vector const tan{ direction(randVec()) };
+			Vector grad{ (1./1024.) * randVec() };
+			double nuPrev{ distNu(gen) };
+			if (0u == (ns % 97u))
+			{
+				nuPrev = null<double>(); // stop condition
+			}
+			if (0u == (ns % 89u))
+			{
+				// gradient (nearly) orthogonal to tangent
+				Vector const rnd{ randVec() };
+				grad = rnd - (rnd * tan).theSca[0] * tan;
+				grad = grad - (grad * tan).theSca[0] * tan;
+			}
+			tans.emplace_back(tan);
+			grads.emplace_back(grad);
+			nuPrevs.emplace_back(nuPrev);
+			nuNexts.emplace_back(distNu(gen));
+		}
+
+		// [DoxyExample01]
+
+		// load all cases into (structure of arrays) batch
+		aply::ray::TangentBatch batch;
+		batch.resize(numSamp);
+		for (std::size_t ns{0u} ; ns < numSamp ; ++ns)
+		{
+			batch.set(ns, tans[ns], nuPrevs[ns], grads[ns], nuNexts[ns]);
+		}
+
+		// evaluate all together
+		aply::ray::nextTangentDirs(&batch);
+
+		// results are batch.nextTanAt(ndx) and batch.theChanges[ndx]
+
+		// [DoxyExample01]
+
+		std::size_t numReflect{ 0u };
+		for (std::size_t ns{0u} ; ns < numSamp ; ++ns)
+		{
+			std::pair<Vector, aply::ray::DirChange> const exp
+				{ aply::ray::nextTangentDir
+					(tans[ns], nuPrevs[ns], grads[ns], nuNexts[ns])
+				};
+			Vector const got{ batch.nextTanAt(ns) };
+			tst::checkGotExp(oss, got, exp.first, "batch tangent", 1.e-14);
+			if (! (exp.second == batch.theChanges[ns]))
+			{
+				oss << "Failure of batch change test\n";
+				oss << "exp: " << aply::ray::nameFor(exp.second) << '\n';
+				oss << "got: " << aply::ray::nameFor(batch.theChanges[ns])
+					<< '\n';
+			}
+			if (aply::ray::Reflected == exp.second)
+			{
+				++numReflect;
+			}
+		}
+
+		// test should include all cases
+		if (! (0u < numReflect))
+		{
+			oss << "Failure of reflection case coverage test\n";
+		}
+	}
+
+	using aply::examp::NodeList;
+
+	//! Compare nodes of two traces
+	void
+	checkNodes
+		( std::ostringstream & oss
+		, NodeList const & gotList
+		, NodeList const & expList
+		, std::string const & tname
+		)
+	{
+		if (! (gotList.size() == expList.size()))
+		{
+			oss << "Failure of packet size '" << tname << "' test\n";
+			oss << "exp: " << expList.size() << '\n';
+			oss << "got: " << gotList.size() << '\n';
+			return;
+		}
+		for (std::size_t nn{0u} ; nn < expList.size() ; ++nn)
+		{
+			aply::ray::Node const & expNode = expList.theNodes[nn];
+			aply::ray::Node const & gotNode = gotList.theNodes[nn];
+			tst::checkGotExp
+				(oss, gotNode.theCurrLoc, expNode.theCurrLoc, tname, 1.e-12);
+			tst::checkGotExp
+				(oss, gotNode.theNextTan, expNode.theNextTan, tname, 1.e-12);
+			if (! (gotNode.theDirChange == expNode.theDirChange))
+			{
+				oss << "Failure of packet change '" << tname << "' test\n";
+				oss << "exp: " << nameFor(expNode.theDirChange) << '\n';
+				oss << "got: " << nameFor(gotNode.theDirChange) << '\n';
+			}
+		}
+	}
+
+	//! Trace starts together and individually, return num reflections
+	std::size_t
+	checkPacket
+		( std::ostringstream & oss
+		, aply::ray::Propagator const & prop
+		, std::vector<aply::ray::Start> const & starts
+		, std::string const & tname
+		)
+	{
+		using namespace aply;
+		constexpr std::size_t maxNodes{ 4096u };
+
+		// [DoxyExample02]
+
+		// consumers (e.g. ray::Path) for each ray in the packet
+		std::vector<NodeList> lists;
+		lists.reserve(starts.size());
+		std::vector<NodeList *> ptLists;
+		for (ray::Start const & start : starts)
+		{
+			lists.emplace_back(NodeList{ start });
+			lists.back().theNodes.reserve(maxNodes);
+			ptLists.emplace_back(&(lists.back()));
+		}
+
+		// trace all together
+		prop.tracePacket(ptLists);
+
+		// [DoxyExample02]
+
+		std::size_t numReflect{ 0u };
+		for (std::size_t np{0u} ; np < starts.size() ; ++np)
+		{
+			NodeList expList{ starts[np] };
+			expList.theNodes.reserve(maxNodes);
+			prop.tracePath(&expList);
+			checkNodes(oss, lists[np], expList, tname);
+			for (ray::Node const & node : expList.theNodes)
+			{
+				if (ray::Reflected == node.theDirChange)
+				{
+					++numReflect;
+				}
+			}
+		}
+		return numReflect;
+	}
+
+	//! Check packet tracing against individual path tracing
+	void
+	test1
+		( std::ostringstream & oss
+		)
+	{
+		using namespace aply;
+		constexpr double stepDist{ 1./512. };
+
+		// glass plate (refraction at interfaces)
+		std::shared_ptr<env::ActiveVolume> const ptVolume
+			{ std::make_shared<env::ActiveBox>
+				(Vector{ -4., -4., -4. }, Vector{ 4., 4., 4. })
+			};
+		env::index::Slab const slab
+			(e3, -.5, .5, 1.0, 1.5, 1.25, ptVolume);
+		std::vector<ray::Start> slabStarts;
+		for (double const & zDir : { -.05, -.25, -1., -4. })
+		{
+			slabStarts.emplace_back
+				(ray::Start::from(Vector{ 1., .25, zDir }, .25*e3));
+		}
+		ray::Propagator const slabProp{ &slab, stepDist };
+		(void)checkPacket(oss, slabProp, slabStarts, "slab packet");
+
+		// gradient media (rays turn back, i.e. reflect, at different times)
+		env::index::Linear const linear
+			( -.25*e3, 1.5
+			, std::make_shared<env::ActiveBox>
+				(Vector{ -4., -4., -4. }, Vector{ 4., 4., 4. })
+			);
+		std::vector<ray::Start> linStarts;
+		for (double const & zDir : { .5, .25, .1, .02 })
+		{
+			linStarts.emplace_back
+				(ray::Start::from(Vector{ 1., .25, zDir }, -3.*e1));
+		}
+		ray::Propagator const linProp{ &linear, stepDist };
+		std::size_t const numReflect
+			{ checkPacket(oss, linProp, linStarts, "linear packet") };
+		if (! (linStarts.size() == numReflect))
+		{
+			oss << "Failure of packet reflection coverage test\n";
+			oss << "numReflect: " << numReflect << '\n';
+		}
+	}
+
+}
+
+/*! \brief Unit test for ray::nextTangentDirs() and Propagator::tracePacket()
+ */
+int
+main
+	()
+{
+	std::ostringstream oss;
+
+	test0(oss); // batched kernel
+	test1(oss); // packet trace
+
+	return tst::finish(oss);
+}
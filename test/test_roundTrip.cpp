@@ -37,9 +37,115 @@
 #include "example/indexModel.hpp"
 
 #include <Engabra>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 
+namespace
+{
+	using namespace aply;
+	using namespace engabra::g3;
+
+	//! Angular momentum, r^p (Bouguer's invariant nu*|r|*sin(zenith))
+	inline
+	double
+	bouguerValue
+		( Vector const & rVec
+		, Vector const & pVec
+		)
+	{
+		return magnitude((rVec * pVec).theBiv);
+	}
+
+	//! Round trip with (Hamiltonian) symplectic steps much larger than main
+	void
+	testSymplectic
+		( std::ostringstream & oss
+		)
+	{
+		env::index::AtmModel const atm(env::sEarth);
+
+		// [DoxyExample01]
+
+		// steps 256 times larger than main() over a long low angle path
+		constexpr double propStepDist{ 16. }; // meters
+		constexpr double saveStepDist{ 1024. }; // meters
+		std::size_t const pathSize{ 64u };
+		ray::Propagator const prop
+			{ &atm, propStepDist, true, ray::SymplecticStep };
+
+		Vector const tFwdBeg{ direction(e1 + .02*e3) };
+		double const pad{ 2. * propStepDist };
+		Vector const rFwdBeg{ (env::sEarth.theRadGround + pad) * e3 };
+		ray::Start const fwdStart{ ray::Start::from(tFwdBeg, rFwdBeg) };
+
+		ray::Path fwdPath(fwdStart, saveStepDist);
+		fwdPath.reserve(pathSize);
+		prop.tracePath(&fwdPath);
+
+		// node momentum is the average of half step momenta
+		ray::Node const & lastNode = fwdPath.theNodes.back();
+		Vector const pLast
+			{ .5 * ( lastNode.thePrevNu * lastNode.thePrevTan
+				   + lastNode.theNextNu * lastNode.theNextTan
+				   )
+			};
+		ray::Start const revStart
+			{ ray::Start::from(-direction(pLast), lastNode.theCurrLoc) };
+		ray::Path revPath(revStart, saveStepDist);
+		revPath.reserve(pathSize);
+
+		// same parameter step, ds = nu*dSigma, as the forward path
+		// (i.e. scale step distance by ratio of IoR at path starts)
+		double const revStepDist
+			{ propStepDist
+			* (atm.nuValue(revStart.thePntLoc) / atm.nuValue(rFwdBeg))
+			};
+		ray::Propagator const revProp
+			{ &atm, revStepDist, true, ray::SymplecticStep };
+		revProp.tracePath(&revPath);
+
+		// [DoxyExample01]
+
+		Vector const & rExp = rFwdBeg;
+		Vector const & rGot = revPath.theNodes.back().theCurrLoc;
+		double const tol
+			{ 8. * magnitude(rExp) * std::numeric_limits<double>::epsilon() };
+		if (! nearlyEquals(rExp, rGot, tol))
+		{
+			oss << "Failure of symplectic location round trip test\n";
+			oss << "rExp: "  << rExp << '\n';
+			oss << "rGot: "  << rGot << '\n';
+			oss << "rDif: "  << io::fixed(magnitude(rGot - rExp)) << '\n';
+		}
+
+		// Bouguer invariant (r^p) holds to roundoff at every node
+		double const expInv
+			{ bouguerValue(rFwdBeg, atm.nuValue(rFwdBeg) * tFwdBeg) };
+		double maxRelDif{ 0. };
+		for (ray::Node const & node : fwdPath.theNodes)
+		{
+			double const gotInv
+				{ bouguerValue
+					(node.theCurrLoc, node.theNextNu * node.theNextTan)
+				};
+			maxRelDif = std::max
+				(maxRelDif, std::abs((gotInv - expInv) / expInv));
+		}
+		double const tolInv{ 64. * std::numeric_limits<double>::epsilon() };
+		if (! (maxRelDif < tolInv))
+		{
+			oss << "Failure of symplectic invariant test\n";
+			oss << "maxRelDif: " << maxRelDif << '\n';
+		}
+	}
+
+} // [anon]
+
+
 /*! \brief Run ray trace forward and backward - check round trip consistency.
  */
 int
@@ -145,6 +251,8 @@ std::cout << "revPath.size: " << revPath.theNodes.size() << std::endl;
 		}
 	}
 
+	testSymplectic(oss);
+
 	if (! oss.str().empty())
 	{
 		std::cerr << " propStepDist: "